@@ -10,8 +10,10 @@
 */
 
 #include "BeamFlashTrackMatchTaggerAlg.h"
+#include "larana/OpticalDetector/WeightedMoments.h"
 #include "larcorealg/Geometry/OpDetGeo.h"
 
+#include <array>
 #include <limits>
 
 #include "TH1F.h"
@@ -307,20 +309,27 @@ void cosmic::BeamFlashTrackMatchTaggerAlg::FillFlashProperties(std::vector<float
 							       float& z, float& sigmaz,
 							       geo::GeometryCore const& geom){
   y=0; sigmay=0; z=0; sigmaz=0; sum=0;
+
+  // opdet centres, looked up once for both passes
+  size_t const nOpDets = opdetVector.size();
+  std::vector<double> opdetY(nOpDets), opdetZ(nOpDets);
   double xyz[3];
-  for(unsigned int opdet=0; opdet<opdetVector.size(); opdet++){
-    sum+=opdetVector[opdet];
+  for(unsigned int opdet=0; opdet<nOpDets; opdet++){
     geom.Cryostat(0).OpDet(opdet).GetCenter(xyz);
-    y += opdetVector[opdet]*xyz[1];
-    z += opdetVector[opdet]*xyz[2];
+    opdetY[opdet] = xyz[1];
+    opdetZ[opdet] = xyz[2];
   }
 
-  y /= sum; z /= sum;
+  opdet::WeightedMoments<double,2> moments;
+  opdet::AccumulateMoments(nOpDets,opdetVector.data(),
+			   std::array<double const*,2>{{opdetY.data(),opdetZ.data()}},moments);
+  sum = moments.SumW;
+  y = moments.SumWX[0]/sum;
+  z = moments.SumWX[1]/sum;
 
-  for(unsigned int opdet=0; opdet<opdetVector.size(); opdet++){
-    geom.Cryostat(0).OpDet(opdet).GetCenter(xyz);
-    sigmay += (opdetVector[opdet]*xyz[1]-y)*(opdetVector[opdet]*xyz[1]-y);
-    sigmaz += (opdetVector[opdet]*xyz[2]-y)*(opdetVector[opdet]*xyz[2]-y);
+  for(unsigned int opdet=0; opdet<nOpDets; opdet++){
+    sigmay += (opdetVector[opdet]*opdetY[opdet]-y)*(opdetVector[opdet]*opdetY[opdet]-y);
+    sigmaz += (opdetVector[opdet]*opdetZ[opdet]-y)*(opdetVector[opdet]*opdetZ[opdet]-y);
   }
 
   sigmay = std::sqrt(sigmay)/sum;
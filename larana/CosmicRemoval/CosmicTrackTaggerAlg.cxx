@@ -0,0 +1,210 @@
+/*!
+ * Title:   Cosmic Track Tagger Algorithm Class
+ *
+ * Description: Tags tracks as cosmic rays when their hits are outside the
+ *              drift window, when their end points are at the Y/Z borders
+ *              of the detector, or when they cross the whole detector in X.
+ *              Short untagged tracks (delta rays and other stubs) pointing
+ *              to a tagged track then take the tag of that track.
+ * Input:       per-track summaries (end points, length, hit tick range)
+ * Output:      anab::CosmicTag, one per track
+*/
+
+#include "CosmicTrackTaggerAlg.h"
+
+#include "fhiclcpp/ParameterSet.h"
+
+cosmic::CosmicTrackTaggerAlg::CosmicTrackTaggerAlg(fhicl::ParameterSet const& p)
+  : fTPCXBoundary(p.get<float>("TPCXBoundary", 5))
+  , fTPCYBoundary(p.get<float>("TPCYBoundary", 5))
+  , fTPCZBoundary(p.get<float>("TPCZBoundary", 5))
+{}
+
+void
+cosmic::CosmicTrackTaggerAlg::SetDetector(float detHalfHeight,
+                                          float detWidth,
+                                          float detLength,
+                                          int minTickDrift,
+                                          int maxTickDrift)
+{
+  fDetHalfHeight = detHalfHeight;
+  fDetWidth = detWidth;
+  fDetLength = detLength;
+  fMinTickDrift = minTickDrift;
+  fMaxTickDrift = maxTickDrift;
+}
+
+bool
+cosmic::CosmicTrackTaggerAlg::HasValidEndPoints(TrackSummary const& track)
+{
+  for (size_t i = 0; i < 3; ++i) {
+    if (std::isnan((float)track.Start[i]) || std::isnan((float)track.End[i])) return false;
+  }
+  return true;
+}
+
+void
+cosmic::CosmicTrackTaggerAlg::MakeTags(std::vector<TrackSummary> const& tracks,
+                                       std::vector<anab::CosmicTag>& cosmicTags) const
+{
+  cosmicTags.clear();
+  cosmicTags.reserve(tracks.size());
+  for (auto const& track : tracks)
+    cosmicTags.push_back(TagTrack(track));
+
+  TagDeltaRays(tracks, cosmicTags);
+}
+
+anab::CosmicTag
+cosmic::CosmicTrackTaggerAlg::TagTrack(TrackSummary const& track) const
+{
+  int isCosmic = 0;
+  anab::CosmicTagID_t tag_id = anab::CosmicTagID_t::kNotTagged;
+
+  // I don't want to deal with these "tracks"
+  if (!HasValidEndPoints(track))
+    return anab::CosmicTag({-999, -999, -999}, {-999, -999, -999}, -999, tag_id);
+
+  float const trackEndPt1_X = track.Start[0];
+  float const trackEndPt1_Y = track.Start[1];
+  float const trackEndPt1_Z = track.Start[2];
+  float const trackEndPt2_X = track.End[0];
+  float const trackEndPt2_Y = track.End[1];
+  float const trackEndPt2_Z = track.End[2];
+
+  /////////////////////////////////////////////////////////
+  // Are any of the ticks outside of the ReadOutWindow ?
+  /////////////////////////////////////////////////////////
+  if (track.MinTick < fMinTickDrift || track.MaxTick > fMaxTickDrift) {
+    isCosmic = 1;
+    tag_id = anab::CosmicTagID_t::kOutsideDrift_Partial;
+  }
+
+  /////////////////////////////////
+  // Now check Y & Z boundaries:
+  /////////////////////////////////
+  int nBdY = 0, nBdZ = 0;
+  if (isCosmic == 0) {
+
+    // Checking lower side of TPC
+    if (fabs(fDetHalfHeight + trackEndPt1_Y) < fTPCYBoundary ||
+        fabs(fDetHalfHeight + trackEndPt2_Y) < fTPCYBoundary || trackEndPt1_Y < -fDetHalfHeight ||
+        trackEndPt2_Y < -fDetHalfHeight)
+      nBdY++;
+
+    // Checking upper side of TPC
+    if (fabs(fDetHalfHeight - trackEndPt1_Y) < fTPCYBoundary ||
+        fabs(fDetHalfHeight - trackEndPt2_Y) < fTPCYBoundary || trackEndPt1_Y > fDetHalfHeight ||
+        trackEndPt2_Y > fDetHalfHeight)
+      nBdY++;
+
+    if (fabs(trackEndPt1_Z - fDetLength) < fTPCZBoundary ||
+        fabs(trackEndPt2_Z - fDetLength) < fTPCZBoundary)
+      nBdZ++;
+    if (fabs(trackEndPt1_Z) < fTPCZBoundary || fabs(trackEndPt2_Z) < fTPCZBoundary) nBdZ++;
+    if ((nBdY + nBdZ) > 1) {
+      isCosmic = 2;
+      if (nBdY > 1)
+        tag_id = anab::CosmicTagID_t::kGeometry_YY;
+      else if (nBdZ > 1)
+        tag_id = anab::CosmicTagID_t::kGeometry_ZZ;
+      else
+        tag_id = anab::CosmicTagID_t::kGeometry_YZ;
+    }
+    else if ((nBdY + nBdZ) == 1) {
+      isCosmic = 3;
+      if (nBdY == 1)
+        tag_id = anab::CosmicTagID_t::kGeometry_Y;
+      else if (nBdZ == 1)
+        tag_id = anab::CosmicTagID_t::kGeometry_Z;
+    }
+  }
+
+  float cosmicScore = isCosmic > 0 ? 1 : 0;
+  if (isCosmic == 3) cosmicScore = 0.5;
+
+  ///////////////////////////////////////////////////////
+  // Doing a very basic check on X boundaries
+  // this gets the types of tracks that go through both X boundaries of the detector
+  if (fabs(trackEndPt1_X - trackEndPt2_X) > fDetWidth - fTPCXBoundary) {
+    cosmicScore = 1;
+    isCosmic = 4;
+    tag_id = anab::CosmicTagID_t::kGeometry_XX;
+  }
+
+  return anab::CosmicTag({trackEndPt1_X, trackEndPt1_Y, trackEndPt1_Z},
+                         {trackEndPt2_X, trackEndPt2_Y, trackEndPt2_Z},
+                         cosmicScore,
+                         tag_id);
+}
+
+void
+cosmic::CosmicTrackTaggerAlg::TagDeltaRays(std::vector<TrackSummary> const& tracks,
+                                           std::vector<anab::CosmicTag>& cosmicTags) const
+{
+  if (tracks.empty()) return;
+
+  auto makeLine = [&tracks](size_t iTrk, float score, anab::CosmicTagID_t type) {
+    TrackSummary const& track = tracks[iTrk];
+    double const dx = track.End[0] - track.Start[0];
+    double const dy = track.End[1] - track.Start[1];
+    double const dz = track.End[2] - track.Start[2];
+    return TaggedLine{
+      track.Start, track.End, std::sqrt(dx * dx + dy * dy + dz * dz), score, type, iTrk};
+  };
+
+  // The tagged tracks do not change: the score of a re-tagged track is
+  // lowered, so it never becomes a candidate itself
+  fTaggedLines.clear();
+  for (size_t iTrk = 0; iTrk < tracks.size(); ++iTrk) {
+    float const getScore = cosmicTags[iTrk].CosmicScore();
+    if (getScore == 1 || getScore == 0.5)
+      fTaggedLines.push_back(makeLine(iTrk, getScore, cosmicTags[iTrk].CosmicType()));
+  }
+
+  // With no tagged track at all, tracks are compared with the first track
+  // of the event, with no score
+  TaggedLine const noTaggedLine = makeLine(0, 0, anab::CosmicTagID_t::kNotTagged);
+
+  for (size_t iTrk = 0; iTrk < tracks.size(); ++iTrk) {
+    if (cosmicTags[iTrk].CosmicScore() != 0) continue;
+
+    // only short tracks can be re-tagged: skip the search for the others
+    TrackSummary const& track = tracks[iTrk];
+    if (!(track.Length < 60)) continue;
+
+    // Tagged track closest to the end of this one; the first among equals
+    float temp = 0;
+    TaggedLine const* closest = &noTaggedLine;
+    for (size_t iLine = 0; iLine < fTaggedLines.size(); ++iLine) {
+      float const dE = DistFromLine(track.End, fTaggedLines[iLine]);
+      if (iLine == 0 || dE < temp) {
+        temp = dE;
+        closest = &fTaggedLines[iLine];
+      }
+    }
+
+    float const dS = DistFromLine(track.Start, *closest);
+    if ((dS < 5 && temp < 5) || (dS < temp && dS < 5)) {
+      cosmicTags[iTrk].CosmicScore() = closest->Score - 0.05;
+      cosmicTags[iTrk].CosmicType() = closest->Type;
+    }
+  }
+}
+
+float
+cosmic::CosmicTrackTaggerAlg::DistFromLine(std::array<double, 3> const& point,
+                                           TaggedLine const& line)
+{
+  // |(P - A) x (P - B)| / |B - A|
+  double const ax = point[0] - line.Start[0];
+  double const ay = point[1] - line.Start[1];
+  double const az = point[2] - line.Start[2];
+  double const bx = point[0] - line.End[0];
+  double const by = point[1] - line.End[1];
+  double const bz = point[2] - line.End[2];
+  double const cx = ay * bz - by * az;
+  double const cy = az * bx - bz * ax;
+  double const cz = ax * by - bx * ay;
+  return std::sqrt(cx * cx + cy * cy + cz * cz) / line.Length;
+}
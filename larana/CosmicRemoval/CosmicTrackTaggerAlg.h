@@ -0,0 +1,110 @@
+#ifndef COSMICTRACKTAGGERALG_H
+#define COSMICTRACKTAGGERALG_H
+/*!
+ * Title:   Cosmic Track Tagger Algorithm Class
+ *
+ * Description: Tags tracks as cosmic rays when their hits are outside the
+ *              drift window, when their end points are at the Y/Z borders
+ *              of the detector, or when they cross the whole detector in X.
+ *              Short untagged tracks (delta rays and other stubs) pointing
+ *              to a tagged track then take the tag of that track.
+ *              Used by CosmicTrackTagger.
+ * Input:       per-track summaries (end points, length, hit tick range)
+ * Output:      anab::CosmicTag, one per track
+*/
+
+#include "fhiclcpp/fwd.h"
+
+#include "lardataobj/AnalysisBase/CosmicTag.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace cosmic {
+  class CosmicTrackTaggerAlg;
+}
+
+class cosmic::CosmicTrackTaggerAlg {
+public:
+  /// What the tagger uses of a track, computed once per event
+  struct TrackSummary {
+    std::array<double, 3> Start; ///< track vertex
+    std::array<double, 3> End;
+    double Length;
+    float MinTick = 9999;  ///< smallest peak time - RMS of the hits
+    float MaxTick = -9999; ///< largest peak time + RMS of the hits
+  };
+
+  CosmicTrackTaggerAlg(fhicl::ParameterSet const& p);
+
+  /// Sets the detector size and the ticks of the drift window
+  void SetDetector(float detHalfHeight,
+                   float detWidth,
+                   float detLength,
+                   int minTickDrift,
+                   int maxTickDrift);
+
+  /// Summary of a track from its end points, length and hits; HitList is
+  /// a sequence of pointers (or art::Ptr) to recob::Hit
+  template <typename Point, typename HitList>
+  static TrackSummary MakeSummary(Point const& start,
+                                  Point const& end,
+                                  double length,
+                                  HitList const& hits);
+
+  /// False when an end point of the track is not a number
+  static bool HasValidEndPoints(TrackSummary const& track);
+
+  /// Makes the tag of each track, in the same order
+  void MakeTags(std::vector<TrackSummary> const& tracks,
+                std::vector<anab::CosmicTag>& cosmicTags) const;
+
+private:
+  float fTPCXBoundary, fTPCYBoundary, fTPCZBoundary;
+  float fDetHalfHeight = 0, fDetWidth = 0, fDetLength = 0;
+  int fMinTickDrift = 0, fMaxTickDrift = 0;
+
+  /// Tag of a track from its own properties only
+  anab::CosmicTag TagTrack(TrackSummary const& track) const;
+
+  /// Gives short untagged tracks the tag of the track they point to
+  void TagDeltaRays(std::vector<TrackSummary> const& tracks,
+                    std::vector<anab::CosmicTag>& cosmicTags) const;
+
+  /// Line through a tagged track, for the delta-ray search
+  struct TaggedLine {
+    std::array<double, 3> Start;
+    std::array<double, 3> End;
+    double Length; ///< distance between Start and End
+    float Score;
+    anab::CosmicTagID_t Type;
+    size_t Track;
+  };
+  mutable std::vector<TaggedLine> fTaggedLines;
+
+  /// Distance of a point from the line through a tagged track
+  static float DistFromLine(std::array<double, 3> const& point, TaggedLine const& line);
+};
+
+template <typename Point, typename HitList>
+cosmic::CosmicTrackTaggerAlg::TrackSummary
+cosmic::CosmicTrackTaggerAlg::MakeSummary(Point const& start,
+                                          Point const& end,
+                                          double length,
+                                          HitList const& hits)
+{
+  TrackSummary track;
+  track.Start = {start.X(), start.Y(), start.Z()};
+  track.End = {end.X(), end.Y(), end.Z()};
+  track.Length = length;
+
+  // Getting first and last ticks
+  for (auto const& hit : hits) {
+    if (hit->PeakTimeMinusRMS() < track.MinTick) track.MinTick = hit->PeakTimeMinusRMS();
+    if (hit->PeakTimePlusRMS() > track.MaxTick) track.MaxTick = hit->PeakTimePlusRMS();
+  }
+  return track;
+}
+
+#endif
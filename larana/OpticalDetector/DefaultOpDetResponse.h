@@ -28,6 +28,7 @@ namespace opdet
         virtual void doReconfigure(fhicl::ParameterSet const& p);
         virtual bool doDetected(int OpChannel, const sim::OnePhoton& Phot, int &newOpChannel) const;
         virtual bool doDetectedLite(int OpChannel, int &newOpChannel) const;
+        virtual int  doDetectedLiteCount(int OpChannel, int n, CLHEP::HepRandomEngine& engine) const;
 
     }; // class DefaultOpDetResponse
 
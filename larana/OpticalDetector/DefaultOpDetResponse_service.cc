@@ -46,6 +46,13 @@ namespace opdet{
         return true;
     }
 
+    //--------------------------------------------------------------------
+    int DefaultOpDetResponse::doDetectedLiteCount(int /*OpChannel*/, int n, CLHEP::HepRandomEngine& /*engine*/) const
+    {
+        // Every photon is detected
+        return n;
+    }
+
 
 
 } // namespace
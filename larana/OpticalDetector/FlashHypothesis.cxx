@@ -62,7 +62,7 @@ void opdet::FlashHypothesisCollection::SetPromptHypAndPromptFraction(const Flash
   _prompt_hyp = prompt;
   _prompt_frac = frac;
   _late_hyp = prompt; _late_hyp.Normalize( (1/frac - 1.)*prompt.GetTotalPEs() );
-  _total_hyp = _prompt_hyp + _late_hyp;
+  _total_hyp = _prompt_hyp; _total_hyp += _late_hyp;
 }
 
 void opdet::FlashHypothesisCollection::Normalize(float totalPE_target){
@@ -83,7 +83,7 @@ void opdet::FlashHypothesisCollection::CheckFrac(float f)
 
 void opdet::FlashHypothesisCollection::UpdateTotalHyp()
 {
-  _total_hyp = _prompt_hyp + _late_hyp;
+  _total_hyp = _prompt_hyp; _total_hyp += _late_hyp;
   const float total_pe = _total_hyp.GetTotalPEs();
   if(total_pe > std::numeric_limits<float>::epsilon())
     _prompt_frac = _prompt_hyp.GetTotalPEs() / total_pe;
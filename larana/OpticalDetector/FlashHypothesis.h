@@ -38,6 +38,11 @@ namespace opdet{
 
     void SetHypothesisAndError( size_t i_opdet, float pe , float err=-999 );
 
+    //contiguous storage of the GetVectorSize() NPEs and errors, for filling
+    //the whole hypothesis at once
+    float* HypothesisData() { return _NPEs_Vector.data(); }
+    float* HypothesisErrorData() { return _NPEs_ErrorVector.data(); }
+
     float GetTotalPEs() const
     { return std::accumulate(_NPEs_Vector.begin(),_NPEs_Vector.end(),0.0); }
     float GetTotalPEsError() const
@@ -50,18 +55,25 @@ namespace opdet{
     void Print();
 
     FlashHypothesis operator+(const FlashHypothesis& fh){
+      FlashHypothesis flashhyp(*this);
+      flashhyp += fh;
+      return flashhyp;
+    }
+
+    //add another hypothesis to this one without temporaries: NPEs are summed,
+    //errors are combined in quadrature
+    FlashHypothesis& operator+=(const FlashHypothesis& fh){ AddInPlace(fh); return *this; }
+    void AddInPlace(const FlashHypothesis& fh){
 
       if( _NPEs_Vector.size() != fh.GetVectorSize() )
 	throw std::runtime_error("ERROR in FlashHypothesisAddition: Cannot add hypothesis of different size");
 
-      FlashHypothesis flashhyp(_NPEs_Vector.size());
       for(size_t i=0; i<_NPEs_Vector.size(); i++){
-	flashhyp._NPEs_Vector[i] = _NPEs_Vector[i] + fh._NPEs_Vector[i];
-	flashhyp._NPEs_ErrorVector[i] =
-	  std::sqrt(this->_NPEs_ErrorVector[i]*this->_NPEs_ErrorVector[i] +
+	_NPEs_Vector[i] += fh._NPEs_Vector[i];
+	_NPEs_ErrorVector[i] =
+	  std::sqrt(_NPEs_ErrorVector[i]*_NPEs_ErrorVector[i] +
 		    fh._NPEs_ErrorVector[i]*fh._NPEs_ErrorVector[i]);
       }
-      return flashhyp;
     }
 
   private:
@@ -99,16 +111,22 @@ namespace opdet{
     void Print();
 
     FlashHypothesisCollection operator+(const FlashHypothesisCollection& fhc){
+      FlashHypothesisCollection sum(*this);
+      sum += fhc;
+      return sum;
+    }
+
+    //in-place addition of prompt and late hypotheses; the total is rebuilt
+    //in the existing storage
+    FlashHypothesisCollection& operator+=(const FlashHypothesisCollection& fhc){ AddInPlace(fhc); return *this; }
+    void AddInPlace(const FlashHypothesisCollection& fhc){
 
       if( this->GetVectorSize() != fhc.GetVectorSize() )
 	throw std::runtime_error("ERROR in FlashHypothesisCollectionAddition: Cannot add hypothesis of different size");
 
-      FlashHypothesis ph = this->GetPromptHypothesis();
-      ph = ph + fhc.GetPromptHypothesis();
-      FlashHypothesis lh = this->GetLateHypothesis();
-      lh = lh + fhc.GetLateHypothesis();
-
-      return (FlashHypothesisCollection(ph,lh));
+      _prompt_hyp += fhc.GetPromptHypothesis();
+      _late_hyp += fhc.GetLateHypothesis();
+      UpdateTotalHyp();
     }
 
   private:
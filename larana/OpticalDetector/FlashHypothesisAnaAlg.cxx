@@ -68,12 +68,12 @@ void opdet::FlashHypothesisAnaAlg::RunComparison(const unsigned int run,
   for(auto const& mctrack : mctrackVec){
     if(mctrack.size()==0) continue;
     std::vector<float> dEdxVector(mctrack.size()-1,fdEdx);
-    fhc = fhc + fFHCreator.GetFlashHypothesisCollection(mctrack,
-							dEdxVector,
-							providers,
-							pvs,
-							opdigip,
-							fXOffset);
+    fhc += fFHCreator.GetFlashHypothesisCollection(mctrack,
+						   dEdxVector,
+						   providers,
+						   pvs,
+						   opdigip,
+						   fXOffset);
   }
 
   fSPCAlg.InitializeCounters(*geom,opdigip);
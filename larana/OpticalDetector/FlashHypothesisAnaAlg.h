@@ -44,6 +44,7 @@ namespace opdet{
     fCounterIndex(p.get<unsigned int>("SimPhotonCounterIndex",0)),
       fdEdx(p.get<float>("dEdx",2.1)),
       fXOffset(p.get<float>("HypothesisXOffset",0.0)),
+      fFHCreator(p.get<bool>("MergeVoxelRuns",false)),
       fSPCAlg(p.get<fhicl::ParameterSet>("SimPhotonCounterAlgParams")) {}
 
 
@@ -1,6 +1,5 @@
 #include "FlashHypothesisCalculator.h"
 
-#include "larana/OpticalDetector/FlashHypothesis.h"
 #include "lardataalg/Utilities/MappedContainer.h"
 
 std::vector<double> opdet::FlashHypothesisCalculator::SegmentMidpoint(TVector3 const& pt1, TVector3 const& pt2, float XOffset)
@@ -12,6 +11,13 @@ std::vector<double> opdet::FlashHypothesisCalculator::SegmentMidpoint(TVector3 c
   return xyz_segment;
 }
 
+std::array<double,3> opdet::FlashHypothesisCalculator::SegmentMidpointArray(TVector3 const& pt1, TVector3 const& pt2, float XOffset)
+{
+  return {{ 0.5*(pt2.x()+pt1.x()) + XOffset,
+	    0.5*(pt2.y()+pt1.y()),
+	    0.5*(pt2.z()+pt1.z()) }};
+}
+
 void opdet::FlashHypothesisCalculator::FillFlashHypothesis(const float& yield,
 							   const float& dEdx,
 							   const TVector3& pt1,
@@ -21,12 +27,7 @@ void opdet::FlashHypothesisCalculator::FillFlashHypothesis(const float& yield,
 							   FlashHypothesis& hyp)
 {
 
-  if(qe_vector.size()!=hyp.GetVectorSize() || !vis_vector)
-    throw std::runtime_error("ERROR in FlashHypothesisCalculator: vector sizes not equal!");
-
   const float total_yield = yield*dEdx*(pt2-pt1).Mag();
-
-  for(size_t i_chan=0; i_chan<hyp.GetVectorSize(); i_chan++)
-    hyp.SetHypothesisAndError(i_chan,total_yield*vis_vector[i_chan]*qe_vector[i_chan]);
+  FillFlashHypothesis(total_yield,qe_vector,vis_vector,hyp);
 
 }
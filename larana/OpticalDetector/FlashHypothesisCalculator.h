@@ -8,15 +8,18 @@
  * Description: Simple class for calculating flash hypotheses
 */
 
+#include<array>
+#include<cmath>
+#include<stdexcept>
 #include<vector>
 
 #include "larsim/PhotonPropagation/PhotonVisibilityTypes.h" // phot::MappedCounts_t
 
 #include "TVector3.h"
 
-namespace opdet{
+#include "FlashHypothesis.h"
 
-  class FlashHypothesis;
+namespace opdet{
 
   class FlashHypothesisCalculator{
 
@@ -25,6 +28,8 @@ namespace opdet{
     FlashHypothesisCalculator(){}
 
     std::vector<double> SegmentMidpoint(const TVector3 &pt1, const TVector3 &pt2, float XOffset=0);
+    //same, without allocating
+    std::array<double,3> SegmentMidpointArray(const TVector3 &pt1, const TVector3 &pt2, float XOffset=0);
     void FillFlashHypothesis(const float& yield,
 			     const float& dEdx,
 			     const TVector3& pt1,
@@ -33,8 +38,127 @@ namespace opdet{
 			     phot::MappedCounts_t const& vis_vector,
 			     FlashHypothesis& hyp);
 
+    //fill hyp for a given number of produced photons (yield*dEdx*length)
+    template <typename VisVector>
+    void FillFlashHypothesis(float total_yield,
+			     const std::vector<float>& qe_vector,
+			     VisVector const& vis_vector,
+			     FlashHypothesis& hyp);
+
+    //npe[i] = total_yield*vis[i]*qe[i] and npe_error[i] = sqrt(npe[i]) for
+    //the n opdets, in a single loop without checks; vis is read through its
+    //operator[], so mapped visibilities are not copied first
+    template <typename VisVector>
+    static void FillHypothesisArrays(size_t n,
+				     float total_yield,
+				     VisVector const& vis,
+				     float const* qe,
+				     float* npe,
+				     float* npe_error);
+
+    /*
+      Accumulate into fhc the hypotheses of all segments of a trajectory.
+      Consecutive segments whose midpoints fall into the same visibility voxel
+      are merged, summing their yields, so that each run of segments costs one
+      visibility lookup and one FillFlashHypothesis call.
+
+      VisProvider needs:
+        int VoxelID(double const* xyz) const;  //negative: never merge this segment
+        <vis vector> GetAllVisibilities(double const* xyz) const;
+    */
+    template <typename VisProvider>
+    void AccumulateTrajectory(const std::vector<TVector3>& trajVector,
+			      const std::vector<float>& dEdxVector,
+			      bool interpolate_dEdx,
+			      float yield,
+			      float prompt_frac,
+			      const std::vector<float>& qe_vector,
+			      VisProvider const& vis,
+			      float XOffset,
+			      FlashHypothesisCollection& fhc);
+
   };
 
 }
 
+template <typename VisVector>
+void opdet::FlashHypothesisCalculator::FillFlashHypothesis(float total_yield,
+							   const std::vector<float>& qe_vector,
+							   VisVector const& vis_vector,
+							   FlashHypothesis& hyp)
+{
+  if(qe_vector.size()!=hyp.GetVectorSize() || !vis_vector)
+    throw std::runtime_error("ERROR in FlashHypothesisCalculator: vector sizes not equal!");
+
+  FillHypothesisArrays(hyp.GetVectorSize(),total_yield,vis_vector,qe_vector.data(),
+		       hyp.HypothesisData(),hyp.HypothesisErrorData());
+}
+
+template <typename VisVector>
+void opdet::FlashHypothesisCalculator::FillHypothesisArrays(size_t n,
+							    float total_yield,
+							    VisVector const& vis,
+							    float const* qe,
+							    float* npe,
+							    float* npe_error)
+{
+  for(size_t i=0; i<n; i++){
+    const float pe = total_yield*vis[i]*qe[i];
+    npe[i] = pe;
+    npe_error[i] = std::sqrt(pe);
+  }
+}
+
+template <typename VisProvider>
+void opdet::FlashHypothesisCalculator::AccumulateTrajectory(const std::vector<TVector3>& trajVector,
+							    const std::vector<float>& dEdxVector,
+							    bool interpolate_dEdx,
+							    float yield,
+							    float prompt_frac,
+							    const std::vector<float>& qe_vector,
+							    VisProvider const& vis,
+							    float XOffset,
+							    FlashHypothesisCollection& fhc)
+{
+  FlashHypothesis prompt_hyp(fhc.GetVectorSize());
+  FlashHypothesisCollection run_fhc;
+
+  std::array<double,3> run_xyz;
+  int run_voxel = -1;
+  float run_yield = 0;
+  bool in_run = false;
+
+  auto close_run = [&](){
+    auto const& PointVisibility = vis.GetAllVisibilities(run_xyz.data());
+    //null visibility (outside the library) contributes nothing
+    if(!PointVisibility) return;
+    FillFlashHypothesis(run_yield,qe_vector,PointVisibility,prompt_hyp);
+    run_fhc.SetPromptHypAndPromptFraction(prompt_hyp,prompt_frac);
+    fhc += run_fhc;
+  };
+
+  for(size_t pt=1; pt<trajVector.size(); pt++){
+    TVector3 const& pt1 = trajVector[pt-1];
+    TVector3 const& pt2 = trajVector[pt];
+    const std::array<double,3> xyz = SegmentMidpointArray(pt1,pt2,XOffset);
+
+    const float dEdx = interpolate_dEdx? 0.5*(dEdxVector[pt]+dEdxVector[pt-1]) : dEdxVector[pt-1];
+    const float seg_yield = yield*dEdx*(pt2-pt1).Mag();
+
+    const int voxel = vis.VoxelID(xyz.data());
+    if(in_run && voxel>=0 && voxel==run_voxel){
+      run_yield += seg_yield;
+      continue;
+    }
+
+    if(in_run) close_run();
+    in_run = true;
+    run_voxel = voxel;
+    run_yield = seg_yield;
+    run_xyz = xyz;
+  }
+
+  if(in_run) close_run();
+}
+
 #endif
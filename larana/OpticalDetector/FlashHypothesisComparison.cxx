@@ -13,19 +13,35 @@
 #include "larana/OpticalDetector/FlashHypothesis.h"
 #include "larana/OpticalDetector/FlashUtilities.h"
 #include "larana/OpticalDetector/SimPhotonCounter.h"
+#include "larana/OpticalDetector/WeightedMoments.h"
 
 #include "TTree.h"
 #include "TH1F.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+opdet::FlashHypothesisComparison::~FlashHypothesisComparison()
+{
+  Flush();
+}
 
 void opdet::FlashHypothesisComparison::SetOutputObjects(TTree *tree,
 							TH1F* h_h_p, TH1F* h_s_p, TH1F* h_c_p,
 							TH1F* h_h_l, TH1F* h_s_l, TH1F* h_c_l,
 							TH1F* h_h_t, TH1F* h_s_t, TH1F* h_c_t,
 							const unsigned int n_opdet,
-							bool fill)
+							bool fill,
+							unsigned int buffer_size)
 {
+  // rows buffered for a previous tree go to that tree
+  Flush();
+
   fTree = tree;
   fFillTree = fill;
   fTree->SetName("ctree");
@@ -33,107 +49,52 @@ void opdet::FlashHypothesisComparison::SetOutputObjects(TTree *tree,
   fTree->Branch("run",&fRun,"run/i");
   fTree->Branch("event",&fEvent,"event/i");
 
-  fHypHist_p = h_h_p;
-  fSimHist_p = h_s_p;
-  fCompareHist_p = h_c_p;
-
-  fHypHist_p->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-  fSimHist_p->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-  fCompareHist_p->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-
-  fHypHist_p->SetNameTitle("hHypHist_p","Hypothesis (Prompt);Opdet;PEs");
-  fSimHist_p->SetNameTitle("hSimHist_p","SimPhoton (Prompt);Opdet;PEs");
-  fCompareHist_p->SetNameTitle("hCompareHist_p","Comparison (Hyp - Sim) (Prompt);Opdet;PEs");
-
-  fTree->Branch("hyp_PEs_p",&fHypPEs_p,"hyp_PEs_p/F");
-  fTree->Branch("hyp_PEsError_p",&fHypPEsError_p,"hyp_PEsError_p/F");
-  fTree->Branch("sim_PEs_p",&fSimPEs_p,"sim_PEs_p/F");
-
-  fTree->Branch("hyp_Y_p",&fHypY_p,"hyp_Y_p/F");
-  fTree->Branch("sim_Y_p",&fSimY_p,"sim_Y_p/F");
-
-  fTree->Branch("hyp_RMSY_p",&fHypRMSY_p,"hyp_RMSY_p/F");
-  fTree->Branch("sim_RMSY_p",&fSimRMSY_p,"sim_RMSY_p/F");
-
-  fTree->Branch("hyp_Z_p",&fHypZ_p,"hyp_Z_p/F");
-  fTree->Branch("sim_Z_p",&fSimZ_p,"sim_Z_p/F");
-
-  fTree->Branch("hyp_RMSZ_p",&fHypRMSZ_p,"hyp_RMSZ_p/F");
-  fTree->Branch("sim_RMSZ_p",&fSimRMSZ_p,"sim_RMSZ_p/F");
-
-  fTree->Branch("comp_total_p",&fCompare_p,"comp_total_p/F");
-
-  fTree->Branch("hHypHist_p",&fHypHist_p);
-  fTree->Branch("hSimHist_p",&fSimHist_p);
-  fTree->Branch("hCompareHist_p",&fCompareHist_p);
-
-  fHypHist_l = h_h_l;
-  fSimHist_l = h_s_l;
-  fCompareHist_l = h_c_l;
-
-  fHypHist_l->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-  fSimHist_l->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-  fCompareHist_l->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-
-  fHypHist_l->SetNameTitle("hHypHist_l","Hypothesis (Late);Opdet;PEs");
-  fSimHist_l->SetNameTitle("hSimHist_l","SimPhoton (Late);Opdet;PEs");
-  fCompareHist_l->SetNameTitle("hCompareHist_l","Comparison (Hyp - Sim) (Late);Opdet;PEs");
-
-  fTree->Branch("hyp_PEs_l",&fHypPEs_l,"hyp_PEs_l/F");
-  fTree->Branch("hyp_PEsError_l",&fHypPEsError_l,"hyp_PEsError_l/F");
-  fTree->Branch("sim_PEs_l",&fSimPEs_l,"sim_PEs_l/F");
-
-  fTree->Branch("hyp_Y_l",&fHypY_l,"hyp_Y_l/F");
-  fTree->Branch("sim_Y_l",&fSimY_l,"sim_Y_l/F");
-
-  fTree->Branch("hyp_RMSY_l",&fHypRMSY_l,"hyp_RMSY_l/F");
-  fTree->Branch("sim_RMSY_l",&fSimRMSY_l,"sim_RMSY_l/F");
-
-  fTree->Branch("hyp_Z_l",&fHypZ_l,"hyp_Z_l/F");
-  fTree->Branch("sim_Z_l",&fSimZ_l,"sim_Z_l/F");
-
-  fTree->Branch("hyp_RMSZ_l",&fHypRMSZ_l,"hyp_RMSZ_l/F");
-  fTree->Branch("sim_RMSZ_l",&fSimRMSZ_l,"sim_RMSZ_l/F");
-
-  fTree->Branch("comp_total_l",&fCompare_l,"comp_total_l/F");
-
-  fTree->Branch("hHypHist_l",&fHypHist_l);
-  fTree->Branch("hSimHist_l",&fSimHist_l);
-  fTree->Branch("hCompareHist_l",&fCompareHist_l);
-
-  fHypHist_t = h_h_t;
-  fSimHist_t = h_s_t;
-  fCompareHist_t = h_c_t;
-
-  fHypHist_t->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-  fSimHist_t->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-  fCompareHist_t->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
-
-  fHypHist_t->SetNameTitle("hHypHist_t","Hypothesis (Total);Opdet;PEs");
-  fSimHist_t->SetNameTitle("hSimHist_t","SimPhoton (Total);Opdet;PEs");
-  fCompareHist_t->SetNameTitle("hCompareHist_t","Comparison (Hyp - Sim) (Total);Opdet;PEs");
-
-  fTree->Branch("hyp_PEs_t",&fHypPEs_t,"hyp_PEs_t/F");
-  fTree->Branch("hyp_PEsError_t",&fHypPEsError_t,"hyp_PEsError_t/F");
-  fTree->Branch("sim_PEs_t",&fSimPEs_t,"sim_PEs_t/F");
-
-  fTree->Branch("hyp_Y_t",&fHypY_t,"hyp_Y_t/F");
-  fTree->Branch("sim_Y_t",&fSimY_t,"sim_Y_t/F");
-
-  fTree->Branch("hyp_RMSY_t",&fHypRMSY_t,"hyp_RMSY_t/F");
-  fTree->Branch("sim_RMSY_t",&fSimRMSY_t,"sim_RMSY_t/F");
-
-  fTree->Branch("hyp_Z_t",&fHypZ_t,"hyp_Z_t/F");
-  fTree->Branch("sim_Z_t",&fSimZ_t,"sim_Z_t/F");
-
-  fTree->Branch("hyp_RMSZ_t",&fHypRMSZ_t,"hyp_RMSZ_t/F");
-  fTree->Branch("sim_RMSZ_t",&fSimRMSZ_t,"sim_RMSZ_t/F");
-
-  fTree->Branch("comp_total_t",&fCompare_t,"comp_total_t/F");
+  TH1F* const hyp[kNWindows] = { h_h_p, h_h_l, h_h_t };
+  TH1F* const sim[kNWindows] = { h_s_p, h_s_l, h_s_t };
+  TH1F* const cmp[kNWindows] = { h_c_p, h_c_l, h_c_t };
+
+  const std::string windowName[kNWindows] = { "p", "l", "t" };
+  const std::string windowTitle[kNWindows] = { "Prompt", "Late", "Total" };
+  const std::string quantityName[kNQuantities] =
+    { "hyp_PEs", "hyp_PEsError", "sim_PEs",
+      "hyp_Y", "sim_Y", "hyp_RMSY", "sim_RMSY",
+      "hyp_Z", "sim_Z", "hyp_RMSZ", "sim_RMSZ",
+      "comp_total" };
+
+  for(int w=0; w<kNWindows; w++){
+    fHypHist[w] = hyp[w];
+    fSimHist[w] = sim[w];
+    fCompareHist[w] = cmp[w];
+
+    fHypHist[w]->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
+    fSimHist[w]->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
+    fCompareHist[w]->SetBins(n_opdet,-0.5,(float)n_opdet - 0.5);
+
+    fHypHist[w]->SetNameTitle(("hHypHist_"+windowName[w]).c_str(),
+			      ("Hypothesis ("+windowTitle[w]+");Opdet;PEs").c_str());
+    fSimHist[w]->SetNameTitle(("hSimHist_"+windowName[w]).c_str(),
+			      ("SimPhoton ("+windowTitle[w]+");Opdet;PEs").c_str());
+    fCompareHist[w]->SetNameTitle(("hCompareHist_"+windowName[w]).c_str(),
+				  ("Comparison (Hyp - Sim) ("+windowTitle[w]+");Opdet;PEs").c_str());
+
+    for(int q=0; q<kNQuantities; q++){
+      std::string const name = quantityName[q]+"_"+windowName[w];
+      fTree->Branch(name.c_str(),&fValues.value[w][q],(name+"/F").c_str());
+    }
+
+    fTree->Branch(("hHypHist_"+windowName[w]).c_str(),&fHypHist[w]);
+    fTree->Branch(("hSimHist_"+windowName[w]).c_str(),&fSimHist[w]);
+    fTree->Branch(("hCompareHist_"+windowName[w]).c_str(),&fCompareHist[w]);
+  }
 
-  fTree->Branch("hHypHist_t",&fHypHist_t);
-  fTree->Branch("hSimHist_t",&fSimHist_t);
-  fTree->Branch("hCompareHist_t",&fCompareHist_t);
+  // without filling, the branches must hold each comparison right away
+  fNOpDets = n_opdet;
+  fBufferSize = fill? std::max(buffer_size,1u) : 1;
+  fNBuffered = 0;
+  fRunColumn.resize(fBufferSize);
+  fEventColumn.resize(fBufferSize);
+  fValueColumns.resize(kNWindows*kNQuantities*fBufferSize);
+  fHistColumns.resize(3*kNWindows*fNOpDets*fBufferSize);
 }
 
 void opdet::FlashHypothesisComparison::RunComparison(const unsigned int run,
@@ -143,91 +104,157 @@ void opdet::FlashHypothesisComparison::RunComparison(const unsigned int run,
 						     const std::vector<float>& posY,
 						     const std::vector<float>& posZ)
 {
-  if(fhc.GetVectorSize() != (unsigned int)fHypHist_p->GetNbinsX() ||
+  if(fhc.GetVectorSize() != (unsigned int)fHypHist[kPrompt]->GetNbinsX() ||
      fhc.GetVectorSize() != spc.PromptPhotonVector().size() ||
      fhc.GetVectorSize() != posY.size() ||
      fhc.GetVectorSize() != posZ.size() ){
-    std::cout << (unsigned int)fHypHist_p->GetNbinsX() << " " << spc.PromptPhotonVector().size() << " " << posY.size() << " " << posZ.size() << std::endl;
+    std::cout << (unsigned int)fHypHist[kPrompt]->GetNbinsX() << " " << spc.PromptPhotonVector().size() << " " << posY.size() << " " << posZ.size() << std::endl;
     throw std::runtime_error("ERROR in FlashHypothesisComparison: Mismatch in vector sizes.");
   }
-  fRun = run;
-  fEvent = event;
-
-  FillFlashHypothesisInfo(fhc,posY,posZ);
-  FillSimPhotonCounterInfo(spc,posY,posZ);
-  FillComparisonInfo(fhc,spc);
 
-  if(fFillTree) fTree->Fill();
+  unsigned int const row = fNBuffered;
+  fRunColumn[row] = run;
+  fEventColumn[row] = event;
+
+  // hypothesis, sim and comparison histograms of the row, window by window
+  float* hists = &fHistColumns[row*3*kNWindows*fNOpDets];
+  FlashHypothesis const* hyp[kNWindows] =
+    { &fhc.GetPromptHypothesis(), &fhc.GetLateHypothesis(), &fhc.GetTotalHypothesis() };
+  std::vector<float> const& sim_p = spc.PromptPhotonVector();
+  std::vector<float> const& sim_l = spc.LatePhotonVector();
+  for(int w=0; w<kNWindows; w++)
+    std::copy(hyp[w]->GetHypothesisVector().begin(),hyp[w]->GetHypothesisVector().end(),
+	      hists + w*fNOpDets);
+  float* sim = hists + kNWindows*fNOpDets;
+  std::copy(sim_p.begin(),sim_p.end(),sim + kPrompt*fNOpDets);
+  std::copy(sim_l.begin(),sim_l.end(),sim + kLate*fNOpDets);
+  for(size_t i=0; i<fNOpDets; i++)
+    sim[kTotal*fNOpDets + i] = sim_p[i] + sim_l[i];
+
+  Values_t values;
+  Compare(fhc,spc,posY,posZ,values,hists + 2*kNWindows*fNOpDets);
+  for(int w=0; w<kNWindows; w++)
+    for(int q=0; q<kNQuantities; q++)
+      fValueColumns[(w*kNQuantities+q)*fBufferSize + row] = values.value[w][q];
+
+  ++fNBuffered;
+  if(!fFillTree){
+    SetBranchValues(row);
+    fNBuffered = 0;
+  }
+  else if(fNBuffered==fBufferSize)
+    Flush();
 }
 
-void opdet::FlashHypothesisComparison::FillFlashHypothesisInfo(const FlashHypothesisCollection& fhc,
-							       const std::vector<float>& posY,
-							       const std::vector<float>& posZ)
+void opdet::FlashHypothesisComparison::Flush()
 {
-  fHypPEs_p = fhc.GetPromptHypothesis().GetTotalPEs();
-  fHypPEsError_p = fhc.GetPromptHypothesis().GetTotalPEsError();
-  fUtil.GetPosition(fhc.GetPromptHypothesis().GetHypothesisVector(),posY,fHypY_p,fHypRMSY_p);
-  fUtil.GetPosition(fhc.GetPromptHypothesis().GetHypothesisVector(),posZ,fHypZ_p,fHypRMSZ_p);
-
-  for(size_t i=0; i<fhc.GetVectorSize(); i++)
-    fHypHist_p->SetBinContent(i+1,fhc.GetPromptHypothesis().GetHypothesis(i));
-
-  fHypPEs_l = fhc.GetLateHypothesis().GetTotalPEs();
-  fHypPEsError_l = fhc.GetLateHypothesis().GetTotalPEsError();
-  fUtil.GetPosition(fhc.GetLateHypothesis().GetHypothesisVector(),posY,fHypY_l,fHypRMSY_l);
-  fUtil.GetPosition(fhc.GetLateHypothesis().GetHypothesisVector(),posZ,fHypZ_l,fHypRMSZ_l);
-
-  for(size_t i=0; i<fhc.GetVectorSize(); i++)
-    fHypHist_l->SetBinContent(i+1,fhc.GetLateHypothesis().GetHypothesis(i));
-
-  fHypPEs_t = fhc.GetTotalHypothesis().GetTotalPEs();
-  fHypPEsError_t = fhc.GetTotalHypothesis().GetTotalPEsError();
-  fUtil.GetPosition(fhc.GetTotalHypothesis().GetHypothesisVector(),posY,fHypY_t,fHypRMSY_t);
-  fUtil.GetPosition(fhc.GetTotalHypothesis().GetHypothesisVector(),posZ,fHypZ_t,fHypRMSZ_t);
-
-  for(size_t i=0; i<fhc.GetVectorSize(); i++)
-    fHypHist_t->SetBinContent(i+1,fhc.GetLateHypothesis().GetHypothesis(i));
+  if(!fFillTree || !fTree) return;
+  for(unsigned int row=0; row<fNBuffered; row++){
+    SetBranchValues(row);
+    fTree->Fill();
+  }
+  fNBuffered = 0;
 }
 
-void opdet::FlashHypothesisComparison::FillSimPhotonCounterInfo(const SimPhotonCounter& spc,
-								const std::vector<float>& posY,
-								const std::vector<float>& posZ)
+void opdet::FlashHypothesisComparison::SetBranchValues(unsigned int row)
 {
-  fSimPEs_p = spc.PromptPhotonTotal();
-  fUtil.GetPosition(spc.PromptPhotonVector(),posY,fSimY_p,fSimRMSY_p);
-  fUtil.GetPosition(spc.PromptPhotonVector(),posZ,fSimZ_p,fSimRMSZ_p);
-
-  for(size_t i=0; i<spc.PromptPhotonVector().size(); i++)
-    fSimHist_p->SetBinContent(i+1,spc.PromptPhotonVector()[i]);
-
-  fSimPEs_l = spc.LatePhotonTotal();
-  fUtil.GetPosition(spc.LatePhotonVector(),posY,fSimY_l,fSimRMSY_l);
-  fUtil.GetPosition(spc.LatePhotonVector(),posZ,fSimZ_l,fSimRMSZ_l);
-
-  for(size_t i=0; i<spc.LatePhotonVector().size(); i++)
-    fSimHist_l->SetBinContent(i+1,spc.LatePhotonVector()[i]);
-
-  fSimPEs_t = fSimPEs_p+fSimPEs_l;
-  fUtil.GetPosition(spc.TotalPhotonVector(),posY,fSimY_t,fSimRMSY_t);
-  fUtil.GetPosition(spc.TotalPhotonVector(),posZ,fSimZ_t,fSimRMSZ_t);
-
-  for(size_t i=0; i<spc.GetVectorSize(); i++)
-    fSimHist_t->SetBinContent(i+1,spc.TotalPhotonVector(i));
-
+  fRun = fRunColumn[row];
+  fEvent = fEventColumn[row];
+  for(int w=0; w<kNWindows; w++)
+    for(int q=0; q<kNQuantities; q++)
+      fValues.value[w][q] = fValueColumns[(w*kNQuantities+q)*fBufferSize + row];
+
+  float const* hists = &fHistColumns[row*3*kNWindows*fNOpDets];
+  for(int w=0; w<kNWindows; w++){
+    float const* hyp = hists + w*fNOpDets;
+    float const* sim = hists + (kNWindows+w)*fNOpDets;
+    float const* cmp = hists + (2*kNWindows+w)*fNOpDets;
+    for(size_t i=0; i<fNOpDets; i++){
+      fHypHist[w]->SetBinContent(i+1,hyp[i]);
+      fSimHist[w]->SetBinContent(i+1,sim[i]);
+      fCompareHist[w]->SetBinContent(i+1,cmp[i]);
+    }
+  }
 }
 
-void opdet::FlashHypothesisComparison::FillComparisonInfo(const FlashHypothesisCollection& fhc,
-							  const SimPhotonCounter& spc)
+void opdet::FlashHypothesisComparison::Compare(const FlashHypothesisCollection& fhc,
+					       const SimPhotonCounter& spc,
+					       const std::vector<float>& posY,
+					       const std::vector<float>& posZ,
+					       Values_t& values,
+					       float* compare)
 {
-  std::vector<float> result_p,result_l,result_t;
-  fCompare_p = fUtil.CompareByError(fhc.GetPromptHypothesis(),spc.PromptPhotonVector(),result_p);
-  fCompare_l = fUtil.CompareByError(fhc.GetLateHypothesis(),spc.LatePhotonVector(),result_l);
-  fCompare_t = fUtil.CompareByError(fhc.GetTotalHypothesis(),spc.TotalPhotonVector(),result_t);
-
-  for(size_t i=0; i<result_p.size(); i++){
-    fCompareHist_p->SetBinContent(i+1,result_p[i]);
-    fCompareHist_l->SetBinContent(i+1,result_l[i]);
-    fCompareHist_t->SetBinContent(i+1,result_t[i]);
+  size_t const n = fhc.GetVectorSize();
+  if(spc.PromptPhotonVector().size() != n || spc.LatePhotonVector().size() != n ||
+     posY.size() != n || posZ.size() != n)
+    throw std::runtime_error("ERROR in FlashHypothesisComparison Compare: Mismatching vector sizes.");
+
+  float const eps = std::numeric_limits<float>::epsilon();
+
+  FlashHypothesis const* hyp[kNWindows] =
+    { &fhc.GetPromptHypothesis(), &fhc.GetLateHypothesis(), &fhc.GetTotalHypothesis() };
+  float const* pe[kNWindows];
+  float const* err[kNWindows];
+  for(int w=0; w<kNWindows; w++){
+    pe[w] = hyp[w]->GetHypothesisVector().data();
+    err[w] = hyp[w]->GetHypothesisErrorVector().data();
+  }
+  float const* sim_p = spc.PromptPhotonVector().data();
+  float const* sim_l = spc.LatePhotonVector().data();
+
+  // y and z moments of each hypothesis and sim window; the moments are
+  // linear in the weights, so the sim total is prompt plus late
+  std::array<float const*,2> const yz{{ posY.data(), posZ.data() }};
+  WeightedMoments<double,2> hypMoments[kNWindows], simMoments[kNWindows];
+  for(int w=0; w<kNWindows; w++)
+    AccumulateMoments(n,pe[w],yz,hypMoments[w]);
+  AccumulateMoments(n,sim_p,yz,simMoments[kPrompt]);
+  AccumulateMoments(n,sim_l,yz,simMoments[kLate]);
+  simMoments[kTotal] = simMoments[kPrompt];
+  simMoments[kTotal] += simMoments[kLate];
+
+  // sums and per-opdet values of CompareByError
+  double err2[kNWindows] = {};
+  float  simSum[kNWindows] = {};
+  for(size_t i=0; i<n; i++){
+    float const sim[kNWindows] = { sim_p[i], sim_l[i], sim_p[i]+sim_l[i] };
+    for(int w=0; w<kNWindows; w++){
+      err2[w] += double(err[w][i])*err[w][i];
+      simSum[w] += sim[w];
+      if(compare){
+	float const diff = pe[w][i] - sim[w];
+	float& result = compare[w*n + i];
+	if(std::abs(diff)<eps)  result = 0;
+	else if(err[w][i]<eps)  result = diff / eps;
+	else                    result = diff / err[w][i];
+      }
+    }
   }
 
+  // mean and width as in FlashUtilities::GetPosition
+  auto const position = [eps](WeightedMoments<double,2> const& m, size_t c, float& mean, float& rms){
+    if(float(m.SumW) < eps){ mean=0; rms=0; return; }
+    mean = m.Mean(c);
+    rms = std::sqrt(m.SumWDev2(c))/m.SumW;
+  };
+
+  for(int w=0; w<kNWindows; w++){
+    float* v = values.value[w];
+
+    v[kHypPEs] = hypMoments[w].SumW;
+    v[kHypPEsError] = std::sqrt(err2[w]);
+    v[kSimPEs] = simMoments[w].SumW;
+    position(hypMoments[w],0,v[kHypY],v[kHypRMSY]);
+    position(simMoments[w],0,v[kSimY],v[kSimRMSY]);
+    position(hypMoments[w],1,v[kHypZ],v[kHypRMSZ]);
+    position(simMoments[w],1,v[kSimZ],v[kSimRMSZ]);
+
+    // as FlashUtilities::CompareByError
+    float const total_diff = v[kHypPEs] - simSum[w];
+    if(std::abs(total_diff) < eps)   v[kCompare] = 0;
+    else if(v[kHypPEsError] < eps)   v[kCompare] = total_diff / eps;
+    else                             v[kCompare] = total_diff / v[kHypPEsError];
+  }
+  // as SimPhotonCounter::PhotonTotal
+  values.value[kTotal][kSimPEs] = values.value[kPrompt][kSimPEs] + values.value[kLate][kSimPEs];
 }
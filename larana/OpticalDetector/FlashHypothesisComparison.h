@@ -9,12 +9,19 @@
  * Class for comparing a flash hypothesis to MC truth (via SimPhotonCounter).
  * Needs a flash hypothesis and a SimPhotonCounter object as input.
  * Outputs a Tree with relevent info.
+ *
+ * All the quantities of a comparison are computed together, from the
+ * weighted moments of the opdet arrays (WeightedMoments.h). When the class
+ * fills the tree itself, comparisons are kept in columns and written to the
+ * tree together, every few comparisons and on Flush().
  */
 
 #include "FlashHypothesis.h"
 #include "SimPhotonCounter.h"
 #include "FlashUtilities.h"
 
+#include <vector>
+
 class TTree;
 class TH1F;
 
@@ -25,14 +32,35 @@ namespace opdet{
   class FlashHypothesisComparison{
 
   public:
+
+    enum Window_t   { kPrompt, kLate, kTotal, kNWindows };
+    enum Quantity_t { kHypPEs, kHypPEsError, kSimPEs,
+		      kHypY, kSimY, kHypRMSY, kSimRMSY,
+		      kHypZ, kSimZ, kHypRMSZ, kSimRMSZ,
+		      kCompare, kNQuantities };
+
+    /// Quantities of one comparison, per window
+    struct Values_t { float value[kNWindows][kNQuantities]; };
+
     FlashHypothesisComparison(){}
 
+    /// Writes the comparisons still buffered; the tree must still exist
+    ~FlashHypothesisComparison();
+
+    FlashHypothesisComparison(FlashHypothesisComparison const&) = delete;
+    FlashHypothesisComparison& operator=(FlashHypothesisComparison const&) = delete;
+
+    /// With fill, the comparisons are written to the tree buffer_size at a
+    /// time, the rest on Flush() or on destruction; call Flush() (e.g. in
+    /// endJob) if the tree may be gone before this object. Without fill,
+    /// the branches hold the last comparison, for the owner of the tree to fill
     void SetOutputObjects(TTree*,
 			  TH1F*,TH1F*,TH1F*,
 			  TH1F*,TH1F*,TH1F*,
 			  TH1F*,TH1F*,TH1F*,
 			  const unsigned int,
-			  bool fill=true);
+			  bool fill=true,
+			  unsigned int buffer_size=1);
 
     void RunComparison(const unsigned int,
 		       const unsigned int,
@@ -41,75 +69,46 @@ namespace opdet{
 		       const std::vector<float>&,
 		       const std::vector<float>&);
 
-  private:
+    /// Writes the buffered comparisons to the tree
+    void Flush();
 
-    FlashUtilities fUtil;
+    unsigned int NBuffered() const { return fNBuffered; }
 
-    void FillFlashHypothesisInfo(const FlashHypothesisCollection&,
-				 const std::vector<float>&,
-				 const std::vector<float>&);
+    /// Computes all the quantities of a comparison together; compare, if
+    /// not null, gets the (hyp-sim)/error of each opdet, kNWindows rows of
+    /// the number of opdets
+    static void Compare(const FlashHypothesisCollection&,
+			const SimPhotonCounter&,
+			const std::vector<float>& posY,
+			const std::vector<float>& posZ,
+			Values_t& values,
+			float* compare=nullptr);
 
-    void FillSimPhotonCounterInfo(const SimPhotonCounter&,
-				  const std::vector<float>&,
-				  const std::vector<float>&);
+  private:
 
-    void FillComparisonInfo(const FlashHypothesisCollection&,
-			    const SimPhotonCounter&);
+    /// Branch values and histograms from buffered comparison row
+    void SetBranchValues(unsigned int row);
 
-    bool   fFillTree;
-    TTree* fTree;
+    bool   fFillTree = false;
+    TTree* fTree = nullptr;
 
-    TH1F* fHypHist_p;
-    TH1F* fSimHist_p;
-    TH1F* fCompareHist_p;
-    TH1F* fHypHist_l;
-    TH1F* fSimHist_l;
-    TH1F* fCompareHist_l;
-    TH1F* fHypHist_t;
-    TH1F* fSimHist_t;
-    TH1F* fCompareHist_t;
+    TH1F* fHypHist[kNWindows];
+    TH1F* fSimHist[kNWindows];
+    TH1F* fCompareHist[kNWindows];
 
     unsigned int fRun;
     unsigned int fEvent;
-
-    float fHypPEs_p;
-    float fHypPEsError_p;
-    float fSimPEs_p;
-    float fHypY_p;
-    float fSimY_p;
-    float fHypRMSY_p;
-    float fSimRMSY_p;
-    float fHypZ_p;
-    float fSimZ_p;
-    float fHypRMSZ_p;
-    float fSimRMSZ_p;
-    float fCompare_p;
-
-    float fHypPEs_l;
-    float fHypPEsError_l;
-    float fSimPEs_l;
-    float fHypY_l;
-    float fSimY_l;
-    float fHypRMSY_l;
-    float fSimRMSY_l;
-    float fHypZ_l;
-    float fSimZ_l;
-    float fHypRMSZ_l;
-    float fSimRMSZ_l;
-    float fCompare_l;
-
-    float fHypPEs_t;
-    float fHypPEsError_t;
-    float fSimPEs_t;
-    float fHypY_t;
-    float fSimY_t;
-    float fHypRMSY_t;
-    float fSimRMSY_t;
-    float fHypZ_t;
-    float fSimZ_t;
-    float fHypRMSZ_t;
-    float fSimRMSZ_t;
-    float fCompare_t;
+    Values_t     fValues;
+
+    // buffered comparisons: one column per quantity, and one per histogram
+    // with the opdets of each row next to each other
+    unsigned int fNOpDets;
+    unsigned int fBufferSize;
+    unsigned int fNBuffered = 0;
+    std::vector<unsigned int> fRunColumn;
+    std::vector<unsigned int> fEventColumn;
+    std::vector<float> fValueColumns;
+    std::vector<float> fHistColumns;
   };
 
 }
@@ -25,21 +25,12 @@ opdet::FlashHypothesisCreator::GetFlashHypothesisCollection(recob::Track const&
   else
     throw "ERROR in FlashHypothesisCreator: dEdx vector size not compatible with track size.";
 
-  auto const* geom = providers.get<geo::GeometryCore>();
-  FlashHypothesisCollection fhc(geom->NOpDets());
-  for(size_t pt=1; pt<track.NumberTrajectoryPoints(); pt++){
-    if(interpolate_dEdx)
-      fhc = fhc + CreateFlashHypothesesFromSegment(track.LocationAtPoint<TVector3>(pt-1),
-						   track.LocationAtPoint<TVector3>(pt),
-						   0.5*(dEdxVector[pt]+dEdxVector[pt-1]),
-						   providers,pvs,opdigip,XOffset);
-    else
-      fhc = fhc + CreateFlashHypothesesFromSegment(track.LocationAtPoint<TVector3>(pt-1),
-						   track.LocationAtPoint<TVector3>(pt),
-						   dEdxVector[pt-1],
-						   providers,pvs,opdigip,XOffset);
-  }
-  return fhc;
+  _traj.resize(track.NumberTrajectoryPoints());
+  for(size_t pt=0; pt<track.NumberTrajectoryPoints(); pt++)
+    _traj[pt] = track.LocationAtPoint<TVector3>(pt);
+
+  return CreateFlashHypothesesFromTrajectory(_traj,dEdxVector,interpolate_dEdx,
+					     providers,pvs,opdigip,XOffset);
 }
 
 opdet::FlashHypothesisCollection
@@ -58,21 +49,12 @@ opdet::FlashHypothesisCreator::GetFlashHypothesisCollection(sim::MCTrack const&
   else
     throw "ERROR in FlashHypothesisCreator: dEdx vector size not compatible with mctrack size.";
 
-  auto const* geom = providers.get<geo::GeometryCore>();
-  FlashHypothesisCollection fhc(geom->NOpDets());
-  for(size_t pt=1; pt<mctrack.size(); pt++){
-    if(interpolate_dEdx)
-      fhc = fhc + CreateFlashHypothesesFromSegment(mctrack[pt-1].Position().Vect(),
-						   mctrack[pt].Position().Vect(),
-						   0.5*(dEdxVector[pt]+dEdxVector[pt-1]),
-						   providers,pvs,opdigip,XOffset);
-    else
-      fhc = fhc + CreateFlashHypothesesFromSegment(mctrack[pt-1].Position().Vect(),
-						   mctrack[pt].Position().Vect(),
-						   dEdxVector[pt-1],
-						   providers,pvs,opdigip,XOffset);
-  }
-  return fhc;
+  _traj.resize(mctrack.size());
+  for(size_t pt=0; pt<mctrack.size(); pt++)
+    _traj[pt] = mctrack[pt].Position().Vect();
+
+  return CreateFlashHypothesesFromTrajectory(_traj,dEdxVector,interpolate_dEdx,
+					     providers,pvs,opdigip,XOffset);
 }
 
 opdet::FlashHypothesisCollection
@@ -91,21 +73,8 @@ opdet::FlashHypothesisCreator::GetFlashHypothesisCollection(std::vector<TVector3
   else
     throw "ERROR in FlashHypothesisCreator: dEdx vector size not compatible with trajVector size.";
 
-  auto const* geom = providers.get<geo::GeometryCore>();
-  FlashHypothesisCollection fhc(geom->NOpDets());
-  for(size_t pt=1; pt<trajVector.size(); pt++){
-    if(interpolate_dEdx)
-      fhc = fhc + CreateFlashHypothesesFromSegment(trajVector[pt-1],
-						   trajVector[pt],
-						   0.5*(dEdxVector[pt]+dEdxVector[pt-1]),
-						   providers,pvs,opdigip,XOffset);
-    else
-      fhc = fhc + CreateFlashHypothesesFromSegment(trajVector[pt-1],
-						   trajVector[pt],
-						   dEdxVector[pt-1],
-						   providers,pvs,opdigip,XOffset);
-  }
-  return fhc;
+  return CreateFlashHypothesesFromTrajectory(trajVector,dEdxVector,interpolate_dEdx,
+					     providers,pvs,opdigip,XOffset);
 }
 
 opdet::FlashHypothesisCollection
@@ -126,31 +95,80 @@ opdet::FlashHypothesisCreator::CreateFlashHypothesesFromSegment(TVector3 const&
 							    phot::PhotonVisibilityService const& pvs,
 							    opdet::OpDigiProperties const& opdigip,
 							    float XOffset)
+{
+  auto const* geom = providers.get<geo::GeometryCore>();
+  FlashHypothesisCollection fhc(geom->NOpDets());
+  CreateFlashHypothesesFromSegment(pt1,pt2,dEdx,providers,pvs,opdigip,XOffset,fhc);
+  return fhc;
+}
+
+void
+opdet::FlashHypothesisCreator::CreateFlashHypothesesFromSegment(TVector3 const& pt1, TVector3 const& pt2,
+								float const& dEdx,
+								Providers_t providers,
+								phot::PhotonVisibilityService const& pvs,
+								opdet::OpDigiProperties const& opdigip,
+								float XOffset,
+								FlashHypothesisCollection& fhc)
 {
   auto const* geom = providers.get<geo::GeometryCore>();
   auto const* larp = providers.get<detinfo::LArProperties>();
   auto const nOpDets = geom->NOpDets();
-  FlashHypothesisCollection fhc(nOpDets);
-
-  FlashHypothesis prompt_hyp = FlashHypothesis(nOpDets);
 
-  std::vector<double> xyz_segment(_calc.SegmentMidpoint(pt1,pt2,XOffset));
+  const std::array<double,3> xyz_segment = _calc.SegmentMidpointArray(pt1,pt2,XOffset);
 
   //get the visibility vector
-  auto const& PointVisibility = pvs.GetAllVisibilities(&xyz_segment[0]);
+  auto const& PointVisibility = pvs.GetAllVisibilities(xyz_segment.data());
 
   //check visibility pointer, as it may be null if given a y/z outside some range
-  if (!PointVisibility) return fhc;
+  //(adding an empty hypothesis would leave fhc unchanged)
+  if (!PointVisibility) return;
+
+  if(_segment_prompt_hyp.GetVectorSize()!=nOpDets)
+    _segment_prompt_hyp = FlashHypothesis(nOpDets);
 
   //klugey ... right now, set a qe_vector that gives constant qe across all opdets
-  std::vector<float> qe_vector(nOpDets,opdigip.QE());
+  _qe_vector.assign(nOpDets,opdigip.QE());
   _calc.FillFlashHypothesis(larp->ScintYield()*larp->ScintYieldRatio(),
 			    dEdx,
 			    pt1,pt2,
-			    qe_vector,
+			    _qe_vector,
 			    PointVisibility,
-			    prompt_hyp);
+			    _segment_prompt_hyp);
 
-  fhc.SetPromptHypAndPromptFraction(prompt_hyp,larp->ScintYieldRatio());
+  _segment_fhc.SetPromptHypAndPromptFraction(_segment_prompt_hyp,larp->ScintYieldRatio());
+  fhc += _segment_fhc;
+}
+
+opdet::FlashHypothesisCollection
+opdet::FlashHypothesisCreator::CreateFlashHypothesesFromTrajectory(std::vector<TVector3> const& trajVector,
+								   std::vector<float> const& dEdxVector,
+								   bool interpolate_dEdx,
+								   Providers_t providers,
+								   phot::PhotonVisibilityService const& pvs,
+								   opdet::OpDigiProperties const& opdigip,
+								   float XOffset)
+{
+  auto const* geom = providers.get<geo::GeometryCore>();
+  auto const* larp = providers.get<detinfo::LArProperties>();
+  auto const nOpDets = geom->NOpDets();
+  FlashHypothesisCollection fhc(nOpDets);
+
+  //klugey ... right now, set a qe_vector that gives constant qe across all opdets
+  _qe_vector.assign(nOpDets,opdigip.QE());
+  _calc.AccumulateTrajectory(trajVector,dEdxVector,interpolate_dEdx,
+			     larp->ScintYield()*larp->ScintYieldRatio(),
+			     larp->ScintYieldRatio(),
+			     _qe_vector,
+			     PhotonVisibilityVoxels(pvs,_merge_voxel_runs),
+			     XOffset,
+			     fhc);
   return fhc;
 }
+
+int opdet::FlashHypothesisCreator::PhotonVisibilityVoxels::VoxelID(double const* xyz) const
+{
+  //the parametrized visibility has no voxels
+  if(!_merge || _pvs.UseParameterization()) return -1;
+  return _pvs.GetVoxelDef().GetVoxelID(xyz);
+}
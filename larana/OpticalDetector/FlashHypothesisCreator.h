@@ -35,7 +35,11 @@ namespace opdet{
     /// Set of service providers used in the common(est) interface
     using Providers_t = lar::ProviderPack<geo::GeometryCore, detinfo::LArProperties>;
 
-    FlashHypothesisCreator() {}
+    /// With mergeVoxelRuns, consecutive trajectory segments in the same
+    /// visibility voxel share one visibility lookup; this changes the result
+    /// when the photon library interpolates within voxels, so it is off
+    /// unless asked for.
+    explicit FlashHypothesisCreator(bool mergeVoxelRuns=false) : _merge_voxel_runs(mergeVoxelRuns) {}
 
     FlashHypothesisCollection GetFlashHypothesisCollection(recob::Track const& track,
 							   std::vector<float> const& dEdxVector,
@@ -65,7 +69,27 @@ namespace opdet{
 							   opdet::OpDigiProperties const& opdigip,
 							   float XOffset=0);
 
+    /// Voxel interface of PhotonVisibilityService for FlashHypothesisCalculator::AccumulateTrajectory
+    class PhotonVisibilityVoxels{
+    public:
+      PhotonVisibilityVoxels(phot::PhotonVisibilityService const& pvs, bool merge)
+	: _pvs(pvs), _merge(merge) {}
+      int VoxelID(double const* xyz) const;
+      auto GetAllVisibilities(double const* xyz) const { return _pvs.GetAllVisibilities(xyz); }
+    private:
+      phot::PhotonVisibilityService const& _pvs;
+      bool _merge;
+    };
+
   private:
+    FlashHypothesisCollection CreateFlashHypothesesFromTrajectory(std::vector<TVector3> const& trajVector,
+								  std::vector<float> const& dEdxVector,
+								  bool interpolate_dEdx,
+								  Providers_t providers,
+								  phot::PhotonVisibilityService const& pvs,
+								  opdet::OpDigiProperties const& opdigip,
+								  float XOffset);
+
     FlashHypothesisCollection CreateFlashHypothesesFromSegment(TVector3 const& pt1, TVector3 const& pt2,
 							       float const& dEdx,
 							       Providers_t providers,
@@ -73,7 +97,23 @@ namespace opdet{
 							       opdet::OpDigiProperties const& opdigip,
 							       float XOffset);
 
+    //accumulate the hypotheses for one segment into fhc, reusing the scratch below
+    void CreateFlashHypothesesFromSegment(TVector3 const& pt1, TVector3 const& pt2,
+					  float const& dEdx,
+					  Providers_t providers,
+					  phot::PhotonVisibilityService const& pvs,
+					  opdet::OpDigiProperties const& opdigip,
+					  float XOffset,
+					  FlashHypothesisCollection& fhc);
+
     FlashHypothesisCalculator _calc;
+    bool                      _merge_voxel_runs;
+
+    std::vector<TVector3>     _traj;
+
+    std::vector<float>        _qe_vector;
+    FlashHypothesis           _segment_prompt_hyp;
+    FlashHypothesisCollection _segment_fhc;
 
   };
 
@@ -16,6 +16,7 @@
 #include <stdexcept>
 
 #include "FlashUtilities.h"
+#include "WeightedMoments.h"
 
 float opdet::FlashUtilities::CompareByError(const FlashHypothesis& fh,
 					    const std::vector<float>& compare_vector,
@@ -103,19 +104,18 @@ void opdet::FlashUtilities::GetPosition(const std::vector<float>& pe_vector,
   if(pe_vector.size()!=pos_vector.size())
     throw std::runtime_error("ERROR in FlashUtilities GetPosition: Mismatchin vector sizes.");
 
-  float sum = std::accumulate(pe_vector.begin(),pe_vector.end(),0.0);
+  WeightedMoments<double> moments;
+  AccumulateMoments(pe_vector.size(),pe_vector.data(),
+		    std::array<float const*,1>{{pos_vector.data()}},moments);
+
+  float sum = moments.SumW;
 
   if(sum < std::numeric_limits<float>::epsilon()){
     mean=0; rms=0; return;
   }
 
-  mean = std::inner_product(pe_vector.begin(),pe_vector.end(),pos_vector.begin(),0.0) / sum;
-
-  rms=0;
-  for(size_t i=0; i<pe_vector.size(); i++)
-    rms += pe_vector[i]*(pos_vector[i] - mean)*(pos_vector[i] - mean);
-
-  rms = std::sqrt(rms)/sum;
+  mean = moments.Mean();
+  rms = std::sqrt(moments.SumWDev2())/sum;
 }
 
 void opdet::FlashUtilities::GetPosition(const std::vector<float>& pe_vector,
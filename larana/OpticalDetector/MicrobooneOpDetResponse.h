@@ -18,7 +18,7 @@
 
 namespace opdet
 {
-    class MicrobooneOpDetResponse : public opdet::OpDetResponseInterface {
+    class MicrobooneOpDetResponse final : public opdet::OpDetResponseInterface {
     public:
 
         MicrobooneOpDetResponse(fhicl::ParameterSet const& pset);
@@ -28,6 +28,8 @@ namespace opdet
         virtual void doReconfigure(fhicl::ParameterSet const& p);
         virtual bool doDetected(int OpChannel, const sim::OnePhoton& Phot, int &newOpChannel) const;
         virtual bool doDetectedLite(int OpChannel, int &newOpChannel) const;
+        virtual int  doDetectedLiteCount(int OpChannel, int n, CLHEP::HepRandomEngine& engine) const;
+        virtual void doDetectedBatch(int OpChannel, std::vector<sim::OnePhoton> const& photons, std::vector<char>& detected) const;
 
         float fQE;                     // Quantum efficiency of tube
 
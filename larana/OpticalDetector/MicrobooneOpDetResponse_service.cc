@@ -81,6 +81,31 @@ namespace opdet{
         return true;
     }
 
+    //--------------------------------------------------------------------
+    int MicrobooneOpDetResponse::doDetectedLiteCount(int /*OpChannel*/, int n, CLHEP::HepRandomEngine& /*engine*/) const
+    {
+        // No QE here (see doDetectedLite()): every photon is detected
+        return n;
+    }
+
+    //--------------------------------------------------------------------
+    void MicrobooneOpDetResponse::doDetectedBatch(int /*OpChannel*/, std::vector<sim::OnePhoton> const& photons, std::vector<char>& detected) const
+    {
+        // Only the wavelength acceptance, as in doDetected(); the class is
+        // final, so wavelength() is inlined and the loop has no branches.
+        // Everything is read into locals first: the char stores could
+        // otherwise alias the vectors and the cuts.
+        float const low = fWavelengthCutLow;
+        float const high = fWavelengthCutHigh;
+        sim::OnePhoton const* phot = photons.data();
+        char* out = detected.data();
+        size_t const n = photons.size();
+        for (size_t i = 0; i < n; ++i) {
+            double const wavel = wavelength(phot[i].Energy);
+            out[i] = !(wavel < low) & !(wavel > high);
+        }
+    }
+
 
 
 } // namespace
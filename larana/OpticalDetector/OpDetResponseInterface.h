@@ -20,8 +20,11 @@
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "art/Framework/Services/Registry/ServiceMacros.h"
 
+#include "CLHEP/Random/RandBinomial.h"
 #include "CLHEP/Random/RandFlat.h"
 
+#include <vector>
+
 
 namespace opdet
 {
@@ -43,8 +46,21 @@ namespace opdet
         virtual bool detectedLite(int OpChannel, int &newOpChannel) const;
         virtual bool detectedLite(int OpChannel) const;
 
+        // Batch versions of detectedLite() and detected(), for whole
+        // channels at a time. They do not report the readout channel.
+
+        // Number of detected photons among n photons of a SimPhotonsLite
+        // channel; a response which samples the detection draws from engine
+        int  detectedLiteCount(int OpChannel, int n, CLHEP::HepRandomEngine& engine) const;
+        // Sets detected[i] to whether photons[i] is detected
+        void detectedBatch(int OpChannel, std::vector<sim::OnePhoton> const& photons, std::vector<char>& detected) const;
+
         virtual float wavelength(double energy) const;
 
+    protected:
+        // Detected count when each photon is detected with probability p
+        static int sampleDetectedCount(int n, double p, CLHEP::HepRandomEngine& engine);
+
     private:
         virtual void doReconfigure(fhicl::ParameterSet const& p) = 0;
 
@@ -54,6 +70,12 @@ namespace opdet
         virtual bool doDetected(int OpChannel, const sim::OnePhoton& Phot, int &newOpChannel) const = 0;
         virtual bool doDetectedLite(int OpChannel, int &newOpChannel) const = 0;
 
+        // By default, the photons one at a time
+        virtual int  doDetectedLiteCount(int OpChannel, int n, CLHEP::HepRandomEngine& engine) const;
+        virtual void doDetectedBatch(int OpChannel, std::vector<sim::OnePhoton> const& photons, std::vector<char>& detected) const;
+
+        mutable int fNOpChannels = -1; // cached until the next reconfigure
+
     }; // class OpDetResponse
 
 
@@ -61,6 +83,7 @@ namespace opdet
     inline void OpDetResponseInterface::reconfigure(fhicl::ParameterSet const& p)
     {
         doReconfigure(p);
+        fNOpChannels = -1;
     }
 
 
@@ -69,7 +92,9 @@ namespace opdet
     //-------------------------------------------------------------------------------------------------------------
     inline int OpDetResponseInterface::NOpChannels() const
     {
-        return doNOpChannels();
+        // Asked once per configuration (the services are not shared between threads)
+        if (fNOpChannels < 0) fNOpChannels = doNOpChannels();
+        return fNOpChannels;
     }
 
     //-------------------------------------------------------------------------------------------------------------
@@ -123,6 +148,45 @@ namespace opdet
         return doDetectedLite(OpChannel, newOpChannel);
     }
 
+    //-------------------------------------------------------------------------------------------------------------
+    inline int OpDetResponseInterface::detectedLiteCount(int OpChannel, int n, CLHEP::HepRandomEngine& engine) const
+    {
+        return doDetectedLiteCount(OpChannel, n, engine);
+    }
+
+    //-------------------------------------------------------------------------------------------------------------
+    inline int OpDetResponseInterface::doDetectedLiteCount(int OpChannel, int n, CLHEP::HepRandomEngine& /*engine*/) const
+    {
+        int newOpChannel;
+        int nDetected = 0;
+        for (int i = 0; i < n; ++i)
+            if (doDetectedLite(OpChannel, newOpChannel)) ++nDetected;
+        return nDetected;
+    }
+
+    //-------------------------------------------------------------------------------------------------------------
+    inline void OpDetResponseInterface::detectedBatch(int OpChannel, std::vector<sim::OnePhoton> const& photons, std::vector<char>& detected) const
+    {
+        detected.resize(photons.size());
+        doDetectedBatch(OpChannel, photons, detected);
+    }
+
+    //-------------------------------------------------------------------------------------------------------------
+    inline void OpDetResponseInterface::doDetectedBatch(int OpChannel, std::vector<sim::OnePhoton> const& photons, std::vector<char>& detected) const
+    {
+        int newOpChannel;
+        for (size_t i = 0; i < photons.size(); ++i)
+            detected[i] = doDetected(OpChannel, photons[i], newOpChannel);
+    }
+
+    //-------------------------------------------------------------------------------------------------------------
+    inline int OpDetResponseInterface::sampleDetectedCount(int n, double p, CLHEP::HepRandomEngine& engine)
+    {
+        if (n <= 0 || p <= 0) return 0;
+        if (p >= 1) return n;
+        return CLHEP::RandBinomial::shoot(&engine, n, p);
+    }
+
     //-------------------------------------------------------------------------------------------------------------
     inline float OpDetResponseInterface::wavelength(double energy) const
     {
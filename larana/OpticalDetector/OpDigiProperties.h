@@ -23,6 +23,8 @@
 // ROOT includes
 #include "TF1.h"
 
+namespace CLHEP { class HepRandomEngine; }
+
 namespace opdet
 {
     class OpDigiProperties {
@@ -82,8 +84,17 @@ namespace opdet
       double LowGain(optdata::Channel_t ch) const;
       /// Generate & return HIGH gain value for an input channel using mean & spread for this channel
       double HighGain(optdata::Channel_t ch) const;
-
-      /// Returns a vector of double which represents a binned SPE waveform
+      /// Same as LowGain(ch), drawing from the given engine
+      double LowGain(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine) const;
+      /// Same as HighGain(ch), drawing from the given engine
+      double HighGain(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine) const;
+      /// Fills gains with LOW gain values for a channel, drawn one after the other from the engine
+      void LowGains(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine, std::vector<double>& gains) const;
+      /// Fills gains with HIGH gain values for a channel, drawn one after the other from the engine
+      void HighGains(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine, std::vector<double>& gains) const;
+
+      /// Returns a vector of double which represents a binned SPE waveform;
+      /// each waveform file (or analytical shape) is read once per process
       std::vector<double> const& SinglePEWaveform() const noexcept { return fWaveform;        }
       /// Returns an array of HIGH gain
       std::vector<double> const& HighGainArray()    const noexcept { return fHighGainArray;   }
@@ -112,6 +123,7 @@ namespace opdet
 
       std::vector<double> GenEmpiricalWF(std::string WaveformFile);
       std::vector<double> GenAnalyticalWF();
+      std::vector<double> GenAnalyticalWFSamples();
       void GenerateWaveform();
       void FillGainArray();
       void FillPedMeanArray();
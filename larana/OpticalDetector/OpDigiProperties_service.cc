@@ -6,6 +6,7 @@
 
 // LArSoft includes
 #include "larana/OpticalDetector/OpDigiProperties.h"
+#include "larana/OpticalDetector/OpDigiTemplateCache.h"
 #include "lardataobj/OpticalDetectorData/OpticalTypes.h"
 #include "larcore/Geometry/Geometry.h"
 
@@ -16,10 +17,28 @@
 #include "CLHEP/Random/RandGauss.h"
 
 // C++ includes
-#include <fstream>
+#include <algorithm>
 
 namespace opdet{
 
+  namespace {
+    // files and analytical shapes are the same for all the jobs of a process
+    OpDigiTemplateCache& TemplateCache()
+    {
+      static OpDigiTemplateCache cache;
+      return cache;
+    }
+
+    // Values of a gain table, one per line
+    std::vector<double> ReadGainFile(std::string const& FullPath)
+    {
+      std::string text;
+      if(!ReadTextFile(FullPath, text))
+	throw cet::exception("OpDigiProperties")<<"Unable to open file!\n";
+      return ParseValueLines(std::move(text));
+    }
+  }
+
   //--------------------------------------------------------------------
   OpDigiProperties::OpDigiProperties(fhicl::ParameterSet const& p)
     : fAnalyticalSPE(0)
@@ -147,6 +166,32 @@ namespace opdet{
     return CLHEP::RandGauss::shoot(fHighGainArray[ch],fGainSpreadArray[ch]*fHighGainArray[ch]);
   }
   //--------------------------------------------------------------------
+  double OpDigiProperties::LowGain(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine) const
+  {
+    return CLHEP::RandGauss::shoot(&engine,fLowGainArray[ch],fGainSpreadArray[ch]*fLowGainArray[ch]);
+  }
+  //--------------------------------------------------------------------
+  double OpDigiProperties::HighGain(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine) const
+  {
+    return CLHEP::RandGauss::shoot(&engine,fHighGainArray[ch],fGainSpreadArray[ch]*fHighGainArray[ch]);
+  }
+  //--------------------------------------------------------------------
+  void OpDigiProperties::LowGains(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine,
+                                  std::vector<double>& gains) const
+  {
+    if(gains.empty()) return;
+    CLHEP::RandGauss::shootArray(&engine,int(gains.size()),gains.data(),
+                                 fLowGainArray[ch],fGainSpreadArray[ch]*fLowGainArray[ch]);
+  }
+  //--------------------------------------------------------------------
+  void OpDigiProperties::HighGains(optdata::Channel_t ch, CLHEP::HepRandomEngine& engine,
+                                   std::vector<double>& gains) const
+  {
+    if(gains.empty()) return;
+    CLHEP::RandGauss::shootArray(&engine,int(gains.size()),gains.data(),
+                                 fHighGainArray[ch],fGainSpreadArray[ch]*fHighGainArray[ch]);
+  }
+  //--------------------------------------------------------------------
   optdata::TimeSlice_t OpDigiProperties::GetTimeSlice(double time_ns)
   {
     if( time_ns/1.e3 > (fTimeEnd-fTimeBegin)) return std::numeric_limits<optdata::TimeSlice_t>::max();
@@ -160,26 +205,18 @@ namespace opdet{
   //
   std::vector<double> OpDigiProperties::WaveformInit(std::string fWaveformFile)
   {
-    // Read in waveform vector from text file
-    std::ifstream WaveformFile (fWaveformFile.c_str());
-    std::string line;
-
     mf::LogInfo("OpDigiProperties")<<"OpDigiProperties opening OpDet waveform at " << fWaveformFile.c_str();
 
-    // Read in each line and place into waveform vector
-    std::vector<double> PEWaveform;
-    if (WaveformFile.is_open())
-      {
-	while ( WaveformFile.good() )
-	  {
-	    getline (WaveformFile, line);
-	    PEWaveform.push_back( fPERescale * strtod( line.c_str(), NULL ) );
-	  }
-      }
-    else throw cet::exception("OpDigiProperties") << "No Waveform File: Unable to open file\n";
+    return TemplateCache().Get({fWaveformFile, {fPERescale}}, [&]() {
+	// Read in waveform vector from text file, one value per line
+	std::string text;
+	if(!ReadTextFile(fWaveformFile, text))
+	  throw cet::exception("OpDigiProperties") << "No Waveform File: Unable to open file\n";
 
-    WaveformFile.close();
-    return(PEWaveform);
+	std::vector<double> PEWaveform = ParseValueLines(std::move(text));
+	for(double& Amp : PEWaveform) Amp = fPERescale * Amp;
+	return PEWaveform;
+      });
   }
 
   // Fill the array of pedestal mean
@@ -201,42 +238,21 @@ namespace opdet{
 	  throw cet::exception("OpDigiProperties") << "Unable to find high gain spread file in " << sp.to_string() << "\n";
 
 	mf::LogWarning("OpDigiProperties")<<"OpDigiProperties opening high gain spread file at " << FullPath.c_str();
-	std::ifstream HighGainFile(FullPath.c_str());
-	if(HighGainFile.is_open()) {
-	  std::string line;
-	  while ( HighGainFile.good() ){
-	    getline(HighGainFile, line);
-	    fHighGainArray.push_back(strtod(line.c_str(),NULL));
-	  }
-	}else throw cet::exception("OpDigiProperties")<<"Unable to open file!\n";
+	fHighGainArray = ReadGainFile(FullPath);
 
 	FullPath="";
 	if( !sp.find_file(fLowGainFile, FullPath) )
 	  throw cet::exception("OpDigiProperties") << "Unable to find low gain spread file in " << sp.to_string() << "\n";
 
 	mf::LogWarning("OpDigiProperties")<<"OpDigiProperties opening low gain spread file at " << FullPath.c_str();
-	std::ifstream LowGainFile(FullPath.c_str());
-	if(LowGainFile.is_open()) {
-	  std::string line;
-	  while ( LowGainFile.good() ){
-	    getline(LowGainFile, line);
-	    fLowGainArray.push_back(strtod(line.c_str(),NULL));
-	  }
-	}else throw cet::exception("OpDigiProperties")<<"Unable to open file!\n";
+	fLowGainArray = ReadGainFile(FullPath);
 
 	FullPath="";
 	if( !sp.find_file(fGainSpreadFile, FullPath) )
 	  throw cet::exception("OpDigiProperties") << "Unable to find low gain spread file in " << sp.to_string() << "\n";
 
 	mf::LogWarning("OpDigiProperties")<<"OpDigiProperties opening low gain spread file at " << FullPath.c_str();
-	std::ifstream GainSpreadFile(FullPath.c_str());
-	if(GainSpreadFile.is_open()) {
-	  std::string line;
-	  while ( GainSpreadFile.good() ){
-	    getline(GainSpreadFile, line);
-	    fGainSpreadArray.push_back(strtod(line.c_str(),NULL));
-	  }
-	}else throw cet::exception("OpDigiProperties")<<"Unable to open file!\n";
+	fGainSpreadArray = ReadGainFile(FullPath);
 
       }
     else{
@@ -289,41 +305,46 @@ namespace opdet{
 
   std::vector<double> OpDigiProperties::GenEmpiricalWF(std::string fWaveformFile)
   {
-    // Read in waveform vector from text file
-    std::ifstream WaveformFile (fWaveformFile.c_str());
-    std::string line;
-
     mf::LogWarning("OpDigiProperties")<<"OpDigiProperties opening OpDet waveform at " << fWaveformFile.c_str();
 
-    // Read in each line and place into waveform vector
-    std::vector<double> PEWaveform;
-    if (WaveformFile.is_open())
-      {
+    int const MaxSamples = int(fWFLength*fSampleFreq);
+    OpDigiTemplateCache::Key const key
+      {fWaveformFile, {double(MaxSamples), double(fChargeNormalized)}};
+
+    return TemplateCache().Get(key, [&]() {
+	// Read in waveform vector from text file, one value per line
+	std::string text;
+	if(!ReadTextFile(fWaveformFile, text))
+	  throw cet::exception("No Waveform File") << "Unable to open file\n";
+
+	std::vector<double> PEWaveform =
+	  ParseValueLines(std::move(text), std::max(MaxSamples, 0));
+
 	double MaxAmp=0;
 	double Charge=0;
-	int    NSample=0;
-	while ( WaveformFile.good() && NSample<int(fWFLength*fSampleFreq))
-	  {
-	    getline (WaveformFile, line);
-	    double Amp=strtod(line.c_str(),NULL);
-	    PEWaveform.push_back(Amp);
-	    if(Amp>MaxAmp) MaxAmp=Amp;
-	    NSample++;
-	    Charge+=Amp;
-	  }
+	for(double Amp : PEWaveform) {
+	  if(Amp>MaxAmp) MaxAmp=Amp;
+	  Charge+=Amp;
+	}
 	// rescale
 	if(MaxAmp<=0) throw cet::exception("OpDigiProperties_module")<<"Waveform amplitude <=0!\n";
-	if(!fChargeNormalized)for(unsigned short i=0; i<PEWaveform.size(); i++){ PEWaveform[i]=PEWaveform[i]/MaxAmp; }
-	else for(unsigned short i=0; i<PEWaveform.size(); i++){ PEWaveform[i]=PEWaveform[i]/Charge; }
-      }
-    else throw cet::exception("No Waveform File") << "Unable to open file\n";
-
-    WaveformFile.close();
-    return(PEWaveform);
+	if(!fChargeNormalized)for(size_t i=0; i<PEWaveform.size(); i++){ PEWaveform[i]=PEWaveform[i]/MaxAmp; }
+	else for(size_t i=0; i<PEWaveform.size(); i++){ PEWaveform[i]=PEWaveform[i]/Charge; }
+	return PEWaveform;
+      });
   }
 
   std::vector<double> OpDigiProperties::GenAnalyticalWF(){
     mf::LogWarning("OpDigiProperties")<<"    OpDigiProperties using analytical function for WF generation.";
+
+    OpDigiTemplateCache::Key const key
+      {"analytical", {fVoltageAmpForSPE, fWFPowerFactor, fWFTimeConstant,
+		      fWFLength, fSampleFreq, double(fChargeNormalized)}};
+
+    return TemplateCache().Get(key, [&]() { return GenAnalyticalWFSamples(); });
+  }
+
+  std::vector<double> OpDigiProperties::GenAnalyticalWFSamples(){
     //
     // Generate waveform from analytical form
     //
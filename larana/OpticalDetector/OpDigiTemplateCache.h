@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////
+// \file OpDigiTemplateCache.h
+//
+// \brief reading of the SPE waveform and gain text files of
+//        OpDigiProperties, and a cache of the waveform templates
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef OPDET_OPDIGITEMPLATECACHE_H
+#define OPDET_OPDIGITEMPLATECACHE_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace opdet {
+
+  /// Reads the whole file into text; returns false if it can not be opened
+  inline bool ReadTextFile(std::string const& path, std::string& text)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    file.seekg(0, std::ios::end);
+    text.resize(file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read(&text[0], text.size());
+    text.resize(file.gcount());
+    return true;
+  }
+
+  /// Values of a text with one number per line, the same as reading the
+  /// lines with getline() and converting each with strtod(): a line which
+  /// does not start with a number gives 0, and so does the empty line after
+  /// a final newline. At most maxValues lines are read.
+  inline std::vector<double> ParseValueLines(std::string text,
+                                             size_t maxValues = std::numeric_limits<size_t>::max())
+  {
+    std::vector<double> values;
+    if (maxValues == 0) return values;
+    values.reserve(std::min<size_t>(maxValues, std::count(text.begin(), text.end(), '\n') + 1));
+
+    // each line is ended in place, so that strtod() does not go past it
+    char* line = &text[0];
+    char* const end = line + text.size();
+    while (values.size() < maxValues) {
+      char* const eol = std::find(line, end, '\n');
+      *eol = '\0';
+      values.push_back(strtod(line, nullptr));
+      if (eol == end) break;
+      line = eol + 1;
+    }
+    return values;
+  }
+
+  /// Waveform templates, made once per process for each source (file name
+  /// or model) and set of parameters (rescaling, sampling...)
+  class OpDigiTemplateCache {
+  public:
+    using Key = std::pair<std::string, std::vector<double>>;
+
+    /// Returns the template for this key, from make() if not known yet; if
+    /// make() throws, nothing is stored
+    template <typename MakeFunc>
+    std::vector<double> const& Get(Key const& key, MakeFunc&& make)
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      auto it = fTemplates.find(key);
+      if (it == fTemplates.end()) it = fTemplates.emplace(key, make()).first;
+      return it->second;
+    }
+
+    size_t NTemplates() const { return fTemplates.size(); }
+
+  private:
+    std::mutex fMutex;
+    std::map<Key, std::vector<double>> fTemplates;
+  };
+
+} // namespace opdet
+
+#endif
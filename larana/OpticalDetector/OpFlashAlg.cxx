@@ -23,6 +23,7 @@
 #include "lardataobj/RecoBase/OpHit.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
 #include <numeric> // std::iota()
@@ -69,78 +70,24 @@ namespace opdet {
                  detinfo::DetectorClocksData const& ClocksData,
                  float const TrigCoinc)
   {
-    // Initial size for accumulators - will be automatically extended if needed
-    int initialsize = 6400;
-
-    // These are the accumulators which will hold broad-binned light yields
-    std::vector<double> Binned1(initialsize);
-    std::vector<double> Binned2(initialsize);
-
-    // These will keep track of which pulses put activity in each bin
-    std::vector<std::vector<int>> Contributors1(initialsize);
-    std::vector<std::vector<int>> Contributors2(initialsize);
-
-    // These will keep track of where we have met the flash condition
-    // (in order to prevent second pointless loop)
-    std::vector<int> FlashesInAccumulator1;
-    std::vector<int> FlashesInAccumulator2;
-
     double minTime = std::numeric_limits<float>::max();
     for (auto const& hit : HitVector)
       if (hit.PeakTime() < minTime) minTime = hit.PeakTime();
 
-    for (auto const& hit : HitVector) {
+    // These are the accumulators which will hold broad-binned light yields,
+    // the pulses contributing to each bin and the bins meeting the flash condition
+    FlashAccumulator Accumulator1;
+    FlashAccumulator Accumulator2;
 
-      double peakTime = hit.PeakTime();
+    FillAccumulator(HitVector, minTime, BinWidth, 0.0, FlashThreshold, Accumulator1);
 
-      unsigned int AccumIndex1 = GetAccumIndex(peakTime, minTime, BinWidth, 0.0);
-
-      unsigned int AccumIndex2 = GetAccumIndex(peakTime, minTime, BinWidth, BinWidth / 2.0);
-
-      // Extend accumulators if needed (2 always larger than 1)
-      if (AccumIndex2 >= Binned1.size()) {
-        std::cout << "Extending vectors to " << AccumIndex2 * 1.2 << std::endl;
-        Binned1.resize(AccumIndex2 * 1.2);
-        Binned2.resize(AccumIndex2 * 1.2);
-        Contributors1.resize(AccumIndex2 * 1.2);
-        Contributors2.resize(AccumIndex2 * 1.2);
-      }
-
-      size_t const hitIndex = &hit - &HitVector[0];
-
-      FillAccumulator(AccumIndex1,
-                      hitIndex,
-                      hit.PE(),
-                      FlashThreshold,
-                      Binned1,
-                      Contributors1,
-                      FlashesInAccumulator1);
-
-      FillAccumulator(AccumIndex2,
-                      hitIndex,
-                      hit.PE(),
-                      FlashThreshold,
-                      Binned2,
-                      Contributors2,
-                      FlashesInAccumulator2);
-
-    } // End loop over hits
+    FillAccumulator(HitVector, minTime, BinWidth, BinWidth / 2.0, FlashThreshold, Accumulator2);
 
     // Now start to create flashes.
     // First, need vector to keep track of which hits belong to which flashes
     std::vector<std::vector<int>> HitsPerFlash;
 
-    //if (Frame == 1) writeHistogram(Binned1);
-
-    AssignHitsToFlash(FlashesInAccumulator1,
-                      FlashesInAccumulator2,
-                      Binned1,
-                      Binned2,
-                      Contributors1,
-                      Contributors2,
-                      HitVector,
-                      HitsPerFlash,
-                      FlashThreshold);
+    AssignHitsToFlash(Accumulator1, Accumulator2, HitVector, HitsPerFlash, FlashThreshold);
 
     // Now we do the fine grained part.
     // Subdivide each flash into sub-flashes with overlaps within hit widths
@@ -196,6 +143,77 @@ namespace opdet {
       FlashesInAccumulator.push_back(AccumIndex);
   }
 
+  //----------------------------------------------------------------------------
+  void
+  FillAccumulator(std::vector<recob::OpHit> const& HitVector,
+                  double const MinTime,
+                  double const BinWidth,
+                  double const BinOffset,
+                  float const FlashThreshold,
+                  FlashAccumulator& Accumulator)
+  {
+    Accumulator.Bins.clear();
+    Accumulator.BinnedPE.clear();
+    Accumulator.HitOffsets.clear();
+    Accumulator.Hits.clear();
+    Accumulator.Flashes.clear();
+
+    // Order the hits by bin, keeping hit order within each bin
+    std::vector<std::pair<unsigned int, int>> BinAndHit(HitVector.size());
+    unsigned int MaxBin = 0;
+    for (size_t HitIndex = 0; HitIndex < HitVector.size(); ++HitIndex) {
+      unsigned int const Bin =
+        GetAccumIndex(HitVector[HitIndex].PeakTime(), MinTime, BinWidth, BinOffset);
+      BinAndHit[HitIndex] = {Bin, static_cast<int>(HitIndex)};
+      MaxBin = std::max(MaxBin, Bin);
+    }
+
+    if (!BinAndHit.empty() && MaxBin < 4 * BinAndHit.size()) {
+      // Bins are dense enough for a counting sort, which is stable
+      std::vector<unsigned int> BinStart(MaxBin + 2, 0);
+      for (auto const& Entry : BinAndHit)
+        ++BinStart[Entry.first + 1];
+      for (size_t Bin = 1; Bin < BinStart.size(); ++Bin)
+        BinStart[Bin] += BinStart[Bin - 1];
+      std::vector<std::pair<unsigned int, int>> Sorted(BinAndHit.size());
+      for (auto const& Entry : BinAndHit)
+        Sorted[BinStart[Entry.first]++] = Entry;
+      BinAndHit.swap(Sorted);
+    }
+    else
+      std::sort(BinAndHit.begin(), BinAndHit.end());
+
+    // Pairs of (hit making the bin reach threshold, bin position)
+    std::vector<std::pair<int, int>> Crossings;
+
+    Accumulator.Hits.reserve(HitVector.size());
+    for (auto const& [Bin, HitIndex] : BinAndHit) {
+
+      if (Accumulator.Bins.empty() || Accumulator.Bins.back() != Bin) {
+        Accumulator.Bins.push_back(Bin);
+        Accumulator.BinnedPE.push_back(0.0);
+        Accumulator.HitOffsets.push_back(Accumulator.Hits.size());
+      }
+
+      Accumulator.Hits.push_back(HitIndex);
+
+      double const PE = HitVector[HitIndex].PE();
+      double& BinnedPE = Accumulator.BinnedPE.back();
+      BinnedPE += PE;
+
+      // Same flash condition as the per-hit FillAccumulator
+      if (BinnedPE >= FlashThreshold && (BinnedPE - PE) < FlashThreshold)
+        Crossings.emplace_back(HitIndex, Accumulator.Bins.size() - 1);
+    }
+    Accumulator.HitOffsets.push_back(Accumulator.Hits.size());
+
+    // Flashes are listed in the order hits made them, as when filling hit by hit
+    std::sort(Crossings.begin(), Crossings.end());
+    Accumulator.Flashes.reserve(Crossings.size());
+    for (auto const& Crossing : Crossings)
+      Accumulator.Flashes.push_back(Crossing.second);
+  }
+
   //----------------------------------------------------------------------------
   void
   FillFlashesBySizeMap(
@@ -244,6 +262,73 @@ namespace opdet {
       if (HitClaimedByFlash.at(Hit) == -1) HitClaimedByFlash.at(Hit) = HitsPerFlash.size() - 1;
   }
 
+  //----------------------------------------------------------------------------
+  void
+  AssignHitsToFlash(FlashAccumulator const& Accumulator1,
+                    FlashAccumulator const& Accumulator2,
+                    std::vector<recob::OpHit> const& HitVector,
+                    std::vector<std::vector<int>>& HitsPerFlash,
+                    float const FlashThreshold)
+  {
+    // One record per flash-tagged bin, sorted as the FlashesBySize map
+    // does it: by size, then accumulator, then in the order they were found
+    struct FlashCandidate {
+      double PE;
+      int AccumulatorNum;
+      int Order;
+      int Position;
+    };
+
+    std::vector<FlashCandidate> Candidates;
+    Candidates.reserve(Accumulator1.Flashes.size() + Accumulator2.Flashes.size());
+    for (size_t i = 0; i < Accumulator1.Flashes.size(); ++i) {
+      int const Position = Accumulator1.Flashes[i];
+      Candidates.push_back({Accumulator1.BinnedPE[Position], 1, static_cast<int>(i), Position});
+    }
+    for (size_t i = 0; i < Accumulator2.Flashes.size(); ++i) {
+      int const Position = Accumulator2.Flashes[i];
+      Candidates.push_back({Accumulator2.BinnedPE[Position], 2, static_cast<int>(i), Position});
+    }
+
+    std::sort(Candidates.begin(),
+              Candidates.end(),
+              [](FlashCandidate const& a, FlashCandidate const& b) {
+                if (a.PE != b.PE) return a.PE > b.PE;
+                if (a.AccumulatorNum != b.AccumulatorNum)
+                  return a.AccumulatorNum < b.AccumulatorNum;
+                return a.Order < b.Order;
+              });
+
+    // This keeps track of which hits are already claimed by a flash
+    std::vector<bool> HitClaimed(HitVector.size(), false);
+
+    // Walk from largest to smallest, claiming hits.
+    // The biggest flash always gets dibbs
+    for (auto const& Candidate : Candidates) {
+
+      auto const BinHits = (Candidate.AccumulatorNum == 1) ?
+                             Accumulator1.BinHits(Candidate.Position) :
+                             Accumulator2.BinHits(Candidate.Position);
+
+      // Check for newly claimed hits
+      double PE = 0;
+      for (auto const& HitIndex : BinHits)
+        if (!HitClaimed[HitIndex]) PE += HitVector[HitIndex].PE();
+
+      if (PE < FlashThreshold) continue;
+
+      // Add the flash to the list and claim all its hits
+      HitsPerFlash.emplace_back();
+      for (auto const& HitIndex : BinHits)
+        if (!HitClaimed[HitIndex]) {
+          HitsPerFlash.back().push_back(HitIndex);
+          HitClaimed[HitIndex] = true;
+        }
+
+    } // End loop over sorted flashes
+
+  } // End AssignHitsToFlash
+
   //----------------------------------------------------------------------------
   void
   AssignHitsToFlash(std::vector<int> const& FlashesInAccumulator1,
@@ -481,12 +566,8 @@ namespace opdet {
   void
   GetHitGeometryInfo(recob::OpHit const& currentHit,
                      geo::GeometryCore const& geom,
-                     std::vector<double>& sumw,
-                     std::vector<double>& sumw2,
-                     double& sumy,
-                     double& sumy2,
-                     double& sumz,
-                     double& sumz2)
+                     std::vector<WeightedMoments<double>>& wireMoments,
+                     WeightedMoments<double, 2>& yzMoments)
   {
     double xyz[3];
     geom.OpDetGeoFromOpChannel(currentHit.OpChannel()).GetCenter(xyz);
@@ -499,14 +580,10 @@ namespace opdet {
       for (size_t p = 0; p != geom.Nplanes(); ++p) {
         geo::PlaneID const planeID(tpc, p);
         unsigned int w = geom.NearestWire(xyz, planeID);
-        sumw.at(p) += PEThisHit * w;
-        sumw2.at(p) += PEThisHit * w * w;
+        wireMoments.at(p).Add(PEThisHit, std::array<double, 1>{{double(w)}});
       }
     } // if we found the TPC
-    sumy += PEThisHit * xyz[1];
-    sumy2 += PEThisHit * xyz[1] * xyz[1];
-    sumz += PEThisHit * xyz[2];
-    sumz2 += PEThisHit * xyz[2] * xyz[2];
+    yzMoments.Add(PEThisHit, std::array<double, 2>{{xyz[1], xyz[2]}});
   }
 
   //----------------------------------------------------------------------------
@@ -533,40 +610,39 @@ namespace opdet {
 
     std::vector<double> PEs(geom.MaxOpChannel() + 1, 0.0);
     unsigned int Nplanes = geom.Nplanes();
-    std::vector<double> sumw(Nplanes, 0.0);
-    std::vector<double> sumw2(Nplanes, 0.0);
+    std::vector<WeightedMoments<double>> wireMoments(Nplanes);
+    WeightedMoments<double, 2> yzMoments;
 
     double TotalPE = 0;
     double AveTime = 0;
     double AveAbsTime = 0;
     double FastToTotal = 0;
-    double sumy = 0;
-    double sumz = 0;
-    double sumy2 = 0;
-    double sumz2 = 0;
 
     for (auto const& HitID : HitsPerFlashVec) {
       AddHitContribution(
         HitVector.at(HitID), MaxTime, MinTime, AveTime, FastToTotal, AveAbsTime, TotalPE, PEs);
-      GetHitGeometryInfo(HitVector.at(HitID), geom, sumw, sumw2, sumy, sumy2, sumz, sumz2);
+      GetHitGeometryInfo(HitVector.at(HitID), geom, wireMoments, yzMoments);
     }
 
     AveTime /= TotalPE;
     AveAbsTime /= TotalPE;
     FastToTotal /= TotalPE;
 
-    double meany = sumy / TotalPE;
-    double meanz = sumz / TotalPE;
+    // the wire moments only have the hits in a TPC, but all the averages
+    // are over the total PE
+    double meany = yzMoments.SumWX[0] / TotalPE;
+    double meanz = yzMoments.SumWX[1] / TotalPE;
 
-    double widthy = CalculateWidth(sumy, sumy2, TotalPE);
-    double widthz = CalculateWidth(sumz, sumz2, TotalPE);
+    double widthy = CalculateWidth(yzMoments.SumWX[0], yzMoments.SumWX2[0], TotalPE);
+    double widthz = CalculateWidth(yzMoments.SumWX[1], yzMoments.SumWX2[1], TotalPE);
 
     std::vector<double> WireCenters(Nplanes, 0.0);
     std::vector<double> WireWidths(Nplanes, 0.0);
 
     for (size_t p = 0; p != Nplanes; ++p) {
-      WireCenters.at(p) = sumw.at(p) / TotalPE;
-      WireWidths.at(p) = CalculateWidth(sumw.at(p), sumw2.at(p), TotalPE);
+      WireCenters.at(p) = wireMoments.at(p).SumWX[0] / TotalPE;
+      WireWidths.at(p) =
+        CalculateWidth(wireMoments.at(p).SumWX[0], wireMoments.at(p).SumWX2[0], TotalPE);
     }
 
     // Emprical corrections to get the Frame right.
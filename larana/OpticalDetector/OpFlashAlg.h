@@ -9,6 +9,7 @@
  * These are the algorithms used by OpFlashFinder to produce flashes.
  */
 
+#include "larana/OpticalDetector/WeightedMoments.h"
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardataobj/RecoBase/OpFlash.h"
 #include "lardataobj/RecoBase/OpHit.h"
@@ -22,6 +23,30 @@ namespace detinfo {
 
 namespace opdet {
 
+  /// Flash accumulator storing only the non-empty time bins.
+  /// The hits contributing to the bin at position i are
+  /// Hits[HitOffsets[i]] ... Hits[HitOffsets[i+1]-1], in hit order.
+  struct FlashAccumulator {
+    std::vector<unsigned int> Bins;       ///< accumulator index of each non-empty bin, increasing
+    std::vector<double> BinnedPE;         ///< summed PE of each non-empty bin
+    std::vector<unsigned int> HitOffsets; ///< Bins.size()+1 offsets into Hits
+    std::vector<int> Hits;                ///< contributing hit indices, grouped by bin
+    std::vector<int> Flashes; ///< positions of bins reaching the flash threshold, in the order they did
+
+    /// View of the hits contributing to one bin
+    struct HitRange {
+      int const* First;
+      int const* Last;
+      int const* begin() const { return First; }
+      int const* end() const { return Last; }
+    };
+
+    HitRange BinHits(int Position) const
+    {
+      return {Hits.data() + HitOffsets[Position], Hits.data() + HitOffsets[Position + 1]};
+    }
+  };
+
   void RunFlashFinder(std::vector<recob::OpHit> const&,
                       std::vector<recob::OpFlash>&,
                       std::vector<std::vector<int>>&,
@@ -42,6 +67,19 @@ namespace opdet {
                        std::vector<std::vector<int>>& Contributors,
                        std::vector<int>& FlashesInAccumulator);
 
+  void FillAccumulator(std::vector<recob::OpHit> const& HitVector,
+                       double MinTime,
+                       double BinWidth,
+                       double BinOffset,
+                       float FlashThreshold,
+                       FlashAccumulator& Accumulator);
+
+  void AssignHitsToFlash(FlashAccumulator const& Accumulator1,
+                         FlashAccumulator const& Accumulator2,
+                         std::vector<recob::OpHit> const& HitVector,
+                         std::vector<std::vector<int>>& HitsPerFlash,
+                         float FlashThreshold);
+
   void AssignHitsToFlash(std::vector<int> const&,
                          std::vector<int> const&,
                          std::vector<double> const&,
@@ -114,14 +152,12 @@ namespace opdet {
                           double& TotalPE,
                           std::vector<double>& PEs);
 
+  /// Adds the hit to the PE-weighted moments of the nearest wire of each
+  /// plane (only if its opdet is in a TPC) and of the y and z of its opdet
   void GetHitGeometryInfo(recob::OpHit const& currentHit,
                           geo::GeometryCore const& geom,
-                          std::vector<double>& sumw,
-                          std::vector<double>& sumw2,
-                          double& sumy,
-                          double& sumy2,
-                          double& sumz,
-                          double& sumz2);
+                          std::vector<WeightedMoments<double>>& wireMoments,
+                          WeightedMoments<double, 2>& yzMoments);
 
   void RemoveLateLight(std::vector<recob::OpFlash>&, std::vector<std::vector<int>>&);
 
@@ -141,6 +177,16 @@ namespace opdet {
                                 size_t BeginFlash,
                                 std::vector<std::vector<int>>& RefinedHitsPerFlash);
 
+  /// Calls AddAssn(FlashIndex, HitIndex) for each hit of each flash in
+  /// the lists filled by RunFlashFinder, flash by flash and in hit order
+  template <typename AddAssnFunc>
+  void ForEachFlashHit(std::vector<std::vector<int>> const& AssocList, AddAssnFunc&& AddAssn)
+  {
+    for (size_t FlashIndex = 0; FlashIndex != AssocList.size(); ++FlashIndex)
+      for (int const HitIndex : AssocList[FlashIndex])
+        AddAssn(FlashIndex, static_cast<size_t>(HitIndex));
+  }
+
   template <typename T, typename Compare>
   std::vector<int> sort_permutation(std::vector<T> const& vec, int offset, Compare compare);
 
@@ -12,7 +12,6 @@
 #include "larana/OpticalDetector/OpFlashAlg.h"
 #include "larcore/Geometry/Geometry.h"
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
-#include "lardata/Utilities/AssociationUtil.h"
 #include "lardataobj/RecoBase/OpFlash.h"
 #include "lardataobj/RecoBase/OpHit.h"
 
@@ -21,8 +20,9 @@
 #include "art/Framework/Core/ModuleMacros.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
+#include "art/Persistency/Common/PtrMaker.h"
+#include "canvas/Persistency/Common/Assns.h"
 #include "canvas/Persistency/Common/Ptr.h"
-#include "canvas/Persistency/Common/PtrVector.h"
 #include "fhiclcpp/ParameterSet.h"
 
 // ROOT includes
@@ -107,14 +107,11 @@ namespace opdet {
                    fTrigCoinc);
 
     // Make the associations which we noted we need
-    for (size_t i = 0; i != assocList.size(); ++i) {
-      art::PtrVector<recob::OpHit> opHitPtrVector;
-      for (size_t const hitIndex : assocList.at(i)) {
-        opHitPtrVector.emplace_back(opHitHandle, hitIndex);
-      }
-
-      util::CreateAssn(*this, evt, *flashPtr, opHitPtrVector, *(assnPtr.get()), i);
-    }
+    art::PtrMaker<recob::OpFlash> const makeFlashPtr{evt};
+    art::PtrMaker<recob::OpHit> const makeHitPtr{evt, opHitHandle.id()};
+    ForEachFlashHit(assocList, [&](size_t const flashIndex, size_t const hitIndex) {
+      assnPtr->addSingle(makeFlashPtr(flashIndex), makeHitPtr(hitIndex));
+    });
 
     evt.put(std::move(flashPtr));
     evt.put(std::move(assnPtr));
@@ -6,10 +6,11 @@
 
 #include "AlgoCFD.h"
 #include "UtilFunc.h"
+#include "OpticalRecoException.h"
 
 #include "fhiclcpp/ParameterSet.h"
 
-#include <unordered_map>
+#include <algorithm>
 
 namespace pmtana{
 
@@ -30,6 +31,8 @@ namespace pmtana{
     _F = pset.get<float>("Fraction");
     _D = pset.get<int>  ("Delay");
 
+    if(_D < 0) throw OpticalRecoException("AlgoCFD received negative \"Delay\" parameter value!");
+
     //_number_presample = pset.get<int>   ("BaselinePreSample");
     _peak_thresh      = pset.get<double>("PeakThresh");
     _start_thresh     = pset.get<double>("StartThresh");
@@ -52,39 +55,57 @@ namespace pmtana{
 			  const pmtana::PedestalSigma_t& sigma_v)
   //***************************************************************
   {
+    if(mean_v.size() == 1 && sigma_v.size() == 1)
+      return RecoPulseImpl(wf,
+			   pmtana::ConstantPedestal_t{mean_v.front()},
+			   pmtana::ConstantPedestal_t{sigma_v.front()});
 
-    Reset();
+    return RecoPulseImpl(wf,mean_v,sigma_v);
+  }
 
-    std::vector<double> cfd; cfd.reserve(wf.size());
+  //***************************************************************
+  template <typename MeanArray, typename SigmaArray>
+  bool AlgoCFD::RecoPulseImpl(const pmtana::Waveform_t& wf,
+			      const MeanArray& mean_v,
+			      const SigmaArray& sigma_v)
+  //***************************************************************
+  {
+
+    Reset();
 
     // follow cfd procedure: invert waveform, multiply by constant fraction
-    // add to delayed waveform.
+    // add to delayed waveform. Upward zero crossings of the cfd trace are
+    // found on the fly, comparing each value with the previous one.
+    _cross_v.clear();
+
+    double prev_cfd = 0;
+
     for (unsigned int k = 0; k < wf.size(); ++k)  {
 
-      auto delayed = -1.0 * _F *  ( (float) wf.at(k) - mean_v.at(k) );
+      double cfd = -1.0 * _F *  ( (float) wf[k] - mean_v[k] );
 
-      if ((int)k < _D)
+      if ((int)k >= _D)
 
-	cfd.push_back( delayed );
+	cfd += ( (float) wf[k - _D] - mean_v[k] );
 
-      else
+      //find where slope is POSITIVE across zero, then calculate
+      //the crossing X based on linear interpolation bt two pts
+      if ( k > 0 && ::pmtana::sign(prev_cfd) < ::pmtana::sign(cfd) )
 
-	cfd.push_back(delayed +  ( (float) wf.at(k - _D) - mean_v.at(k) ) );
-    }
+	_cross_v.emplace_back( k - 1, (double) (k - 1) - prev_cfd * ( 1.0 / ( cfd - prev_cfd ) ) );
 
+      prev_cfd = cfd;
+    }
 
-    // Get the zero point crossings, how can I tell which are meaningful?
     // go to each crossing, see if waveform is above pedestal (high above pedestal)
 
-    auto crossings = LinearZeroPointX(cfd);
-
     // lambda criteria to determine if inside pulse
 
     auto in_peak = [&wf,&sigma_v,&mean_v](int i, float thresh) -> bool
-      { return wf.at(i) > sigma_v.at(i) * thresh +  mean_v.at(i); };
+      { return wf[i] > sigma_v[i] * thresh +  mean_v[i]; };
 
     // loop over CFD crossings
-    for(const auto& cross : crossings) {
+    for(const auto& cross : _cross_v) {
 
       if( in_peak( cross.first, _peak_thresh) ) {
 	_pulse.reset_param();
@@ -147,8 +168,8 @@ namespace pmtana{
 
 	//x
 
-	auto start_ped = mean_v.at(_pulse.t_start);
-	auto end_ped   = mean_v.at(_pulse.t_end);
+	auto start_ped = mean_v[_pulse.t_start];
+	auto end_ped   = mean_v[_pulse.t_end];
 
 	//just take the "smaller one"
 	_pulse.ped_mean = start_ped <= end_ped ? start_ped : end_ped;
@@ -162,7 +183,7 @@ namespace pmtana{
 	_pulse.t_cfdcross =  cross.second;
 
 	for(auto k = _pulse.t_start; k <= _pulse.t_end; ++k) {
-	  auto a = wf.at(k) - _pulse.ped_mean;
+	  auto a = wf[k] - _pulse.ped_mean;
 	  if ( a > 0 ) _pulse.area += a;
 	}
 
@@ -176,53 +197,39 @@ namespace pmtana{
     // crossing points. Should we check that pulses now have
     // some multiplicity? No lets just delete them.
 
-    auto pulses_copy = _pulse_v;
-    _pulse_v.clear();
-
-    std::unordered_map<unsigned,pulse_param> delta;
-
-    //unsigned width = 0;
-    for( const auto& p : pulses_copy )  {
-
-      if ( delta.count(p.t_start) )  {
-    	if (  (p.t_end - p.t_start) > (delta[p.t_start].t_end - delta[p.t_start].t_start) )
-    	  delta[p.t_start] = p;
-    	else
-    	  continue;
-      }
-      else {
-    	delta[p.t_start] = p;
-      }
-    }
+    // For each start time keep the widest pulse (the earliest crossing
+    // among equals), then do the same for each end time. The result is
+    // ordered in time.
 
-    for(const auto & p : delta)
-      _pulse_v.push_back(p.second);
+    auto width = [](const pulse_param& p) { return p.t_end - p.t_start; };
 
+    std::sort(_pulse_v.begin(), _pulse_v.end(),
+	      [&width](const pulse_param& a, const pulse_param& b) {
+		if(a.t_start != b.t_start) return a.t_start < b.t_start;
+		if(width(a) != width(b)) return width(a) > width(b);
+		return a.t_cfdcross < b.t_cfdcross;
+	      });
+    _pulse_v.erase(std::unique(_pulse_v.begin(), _pulse_v.end(),
+			       [](const pulse_param& a, const pulse_param& b)
+			       { return a.t_start == b.t_start; }),
+		   _pulse_v.end());
 
     //do the same now ensure t_final's are all unique
-    //width = 0;
-
-    pulses_copy.clear();
-    pulses_copy = _pulse_v;
-
-    _pulse_v.clear();
-    delta.clear();
-
-    for( const auto& p : pulses_copy )  {
-
-      if ( delta.count(p.t_end) )  {
-    	if (  (p.t_end - p.t_start) > (delta[p.t_end].t_end - delta[p.t_end].t_start) )
-    	  delta[p.t_end] = p;
-    	else
-    	  continue;
-      }
-      else {
-    	delta[p.t_end] = p;
-      }
-    }
-
-    for(const auto & p : delta)
-      _pulse_v.push_back(p.second);
+    std::sort(_pulse_v.begin(), _pulse_v.end(),
+	      [&width](const pulse_param& a, const pulse_param& b) {
+		if(a.t_end != b.t_end) return a.t_end < b.t_end;
+		return width(a) > width(b);
+	      });
+    _pulse_v.erase(std::unique(_pulse_v.begin(), _pulse_v.end(),
+			       [](const pulse_param& a, const pulse_param& b)
+			       { return a.t_end == b.t_end; }),
+		   _pulse_v.end());
+
+    std::sort(_pulse_v.begin(), _pulse_v.end(),
+	      [](const pulse_param& a, const pulse_param& b) {
+		if(a.t_start != b.t_start) return a.t_start < b.t_start;
+		return a.t_end < b.t_end;
+	      });
 
     //there should be no overlapping pulses now...
 
@@ -230,33 +237,4 @@ namespace pmtana{
 
   }
 
-  // currently returns ALL zero point crossings, we really just want ones associated with peak...
-  const std::map<unsigned,double> AlgoCFD::LinearZeroPointX(const std::vector<double>& trace) {
-
-    std::map<unsigned,double> crossing;
-
-    //step through the trace and find where slope is POSITIVE across zero
-    for ( unsigned i = 0; i < trace.size() - 1; ++i) {
-
-      auto si = ::pmtana::sign(trace.at(i));
-      auto sf = ::pmtana::sign(trace.at(i+1));
-
-      if ( si == sf ) //no sign flip, no zero cross
-	continue;
-
-      if ( sf < si ) //this is a negative slope, continue
-	continue;
-
-      //calculate the crossing X based on linear interpolation bt two pts
-
-      crossing[i] = (double) i - trace.at(i) * ( 1.0 / ( trace.at(i+1) - trace.at(i) ) );
-
-    }
-
-
-    return crossing;
-
-  }
-
-
 }
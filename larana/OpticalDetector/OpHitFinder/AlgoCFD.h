@@ -19,8 +19,8 @@
 #include "fhiclcpp/fwd.h"
 #include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
 
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace pmtana
@@ -51,8 +51,14 @@ namespace pmtana
 		   const pmtana::PedestalMean_t&,
 		   const pmtana::PedestalSigma_t&);
 
+    /// Constant pedestals are handled by RecoPulse without expansion
+    bool AcceptsConstantPedestal() const { return true; }
 
-    const std::map<unsigned,double> LinearZeroPointX(const std::vector<double>& trace);
+    /// RecoPulse body, templated on per-sample vs. constant pedestal access
+    template <typename MeanArray, typename SigmaArray>
+    bool RecoPulseImpl(const pmtana::Waveform_t&,
+		       const MeanArray&,
+		       const SigmaArray&);
 
   private:
     float _F;
@@ -63,6 +69,8 @@ namespace pmtana
     double _start_thresh;
     double _end_thresh;
 
+    /// Upward zero crossings of the CFD trace: (sample before crossing, interpolated crossing)
+    std::vector<std::pair<unsigned,double> > _cross_v;
 
   };
 
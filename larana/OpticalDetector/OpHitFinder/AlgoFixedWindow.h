@@ -53,6 +53,9 @@ namespace pmtana
 		   const pmtana::PedestalMean_t&,
 		   const pmtana::PedestalSigma_t&);
 
+    /// Only the first pedestal sample is used, so constant pedestals need no expansion
+    bool AcceptsConstantPedestal() const { return true; }
+
     size_t _index_start; ///< index marker for the beginning of the pulse time window
     size_t _index_end;   ///< index marker for the end of pulse time window
 
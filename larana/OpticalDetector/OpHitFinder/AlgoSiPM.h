@@ -41,6 +41,9 @@ namespace pmtana {
 		    const pmtana::PedestalMean_t&,
 		    const pmtana::PedestalSigma_t&     );
 
+    /// Only the first pedestal sample is used, so constant pedestals need no expansion
+    bool AcceptsConstantPedestal() const { return true; }
+
     // A variable holder for a user-defined absolute ADC threshold value
     double _adc_thres;
 
@@ -8,6 +8,8 @@
 
 #include "AlgoSlidingWindow.h"
 
+#include <cmath>
+
 namespace pmtana {
 
   //*********************************************************************
@@ -62,6 +64,119 @@ namespace pmtana {
                                const pmtana::PedestalMean_t& mean_v,
                                const pmtana::PedestalSigma_t& sigma_v)
   //***************************************************************
+  {
+    if (mean_v.size() == 1 && sigma_v.size() == 1) {
+      const double sigma = sigma_v.front();
+      return RecoPulseImpl(wf,
+                           pmtana::ConstantPedestal_t{mean_v.front()},
+                           pmtana::ConstantPedestal_t{sigma},
+                           pmtana::ConstantPedestal_t{Threshold<float>(sigma, _nsigma, _adc_thres)});
+    }
+
+    assert(wf.size() == mean_v.size() && wf.size() == sigma_v.size());
+
+    // per-sample start thresholds in a branch-free prepass; tail and end
+    // thresholds are only needed where a pulse starts
+    _start_thres_v.resize(sigma_v.size());
+
+    for (size_t i = 0; i < sigma_v.size(); ++i)
+      _start_thres_v[i] = Threshold<float>(sigma_v[i], _nsigma, _adc_thres);
+
+    return RecoPulseImpl(wf, mean_v, sigma_v, _start_thres_v);
+  }
+
+  //***************************************************************
+  template <typename MeanArray, typename ThresholdArray>
+  size_t
+  AlgoSlidingWindow::NextAboveThreshold(const pmtana::Waveform_t& wf,
+                                        const MeanArray& mean_v,
+                                        const ThresholdArray& thres_v,
+                                        size_t i) const
+  //***************************************************************
+  {
+    const double sign = _positive ? 1. : -1.;
+
+    auto above = [&](size_t j) -> bool {
+      return sign * (((double)(wf[j])) - mean_v[j]) > thres_v[j];
+    };
+
+    // test blocks of samples without early exit first, then find the sample
+    const size_t block = 16;
+    while (i + block <= wf.size()) {
+      bool any = false;
+      for (size_t j = i; j < i + block; ++j)
+        any |= above(j);
+      if (any) break;
+      i += block;
+    }
+
+    while (i < wf.size() && !above(i))
+      ++i;
+
+    return i;
+  }
+
+  //***************************************************************
+  size_t
+  AlgoSlidingWindow::NextAboveThreshold(const pmtana::Waveform_t& wf,
+                                        const pmtana::ConstantPedestal_t& mean,
+                                        const pmtana::ConstantPedestal_t& thres,
+                                        size_t i) const
+  //***************************************************************
+  {
+    const double sign = _positive ? 1. : -1.;
+
+    auto above = [&](int adc) -> bool {
+      return sign * (((double)adc) - mean.value) > thres.value;
+    };
+
+    if (!std::isfinite(mean.value) || !std::isfinite(thres.value) ||
+        std::abs(mean.value) + std::abs(thres.value) > 1.e6)
+      return NextAboveThreshold<pmtana::ConstantPedestal_t>(wf, mean, thres, i);
+
+    // The test is monotonic in the ADC count: find the bounding count once
+    // and compare raw samples against it.
+    int bound = 0;
+    if (_positive) {
+      bound = (int)std::floor(mean.value + thres.value);
+      while (!above(bound)) ++bound;
+      while (above(bound - 1)) --bound;
+    }
+    else {
+      bound = (int)std::ceil(mean.value - thres.value);
+      while (!above(bound)) --bound;
+      while (above(bound + 1)) ++bound;
+    }
+
+    auto pass = [&](size_t j) -> bool {
+      return _positive ? (wf[j] >= bound) : (wf[j] <= bound);
+    };
+
+    const size_t block = 16;
+    while (i + block <= wf.size()) {
+      bool any = false;
+      if (_positive)
+        for (size_t j = i; j < i + block; ++j) any |= (wf[j] >= bound);
+      else
+        for (size_t j = i; j < i + block; ++j) any |= (wf[j] <= bound);
+      if (any) break;
+      i += block;
+    }
+
+    while (i < wf.size() && !pass(i))
+      ++i;
+
+    return i;
+  }
+
+  //***************************************************************
+  template <typename MeanArray, typename SigmaArray, typename ThresholdArray>
+  bool
+  AlgoSlidingWindow::RecoPulseImpl(const pmtana::Waveform_t& wf,
+                                   const MeanArray& mean_v,
+                                   const SigmaArray& sigma_v,
+                                   const ThresholdArray& start_thres_v)
+  //***************************************************************
   {
 
     bool fire = false;
@@ -78,8 +193,6 @@ namespace pmtana {
 
     int post_integration = 0;
 
-    assert(wf.size() == mean_v.size() && wf.size() == sigma_v.size());
-
     //double threshold = ( _adc_thres > (_nsigma * _ped_rms) ? _adc_thres : (_nsigma * _ped_rms) );
 
     //threshold += _ped_mean;
@@ -88,23 +201,19 @@ namespace pmtana {
 
     for (size_t i = 0; i < wf.size(); ++i) {
 
+      // Outside of a pulse nothing happens until the start threshold is crossed
+      if (!fire && !in_tail && !in_post) {
+        i = NextAboveThreshold(wf, mean_v, start_thres_v, i);
+        if (i == wf.size()) break;
+      }
+
       double value = 0.;
       if (_positive)
         value = ((double)(wf[i])) - mean_v[i];
       else
         value = mean_v[i] - ((double)(wf[i]));
 
-      float start_threshold = 0.;
-      float tail_threshold = 0.;
-      if (sigma_v[i] * _nsigma < _adc_thres)
-        start_threshold = _adc_thres;
-      else
-        start_threshold = sigma_v[i] * _nsigma;
-
-      if (sigma_v[i] * _tail_nsigma < _tail_adc_thres)
-        tail_threshold = _tail_adc_thres;
-      else
-        tail_threshold = sigma_v[i] * _tail_nsigma;
+      const float start_threshold = start_thres_v[i];
 
       // End pulse if significantly high peak found (new pulse)
       if ((!fire || in_tail || in_post) && ((double)value > start_threshold)) {
@@ -128,14 +237,10 @@ namespace pmtana {
         // Found a new pulse ... try to get a few samples prior to this
         //
 
-        pulse_tail_threshold = tail_threshold;
+        pulse_tail_threshold = Threshold<float>(sigma_v[i], _tail_nsigma, _tail_adc_thres);
         pulse_start_baseline = mean_v[i];
 
-        pulse_end_threshold = 0.;
-        if (sigma_v[i] * _end_nsigma < _end_adc_thres)
-          pulse_end_threshold = _end_adc_thres;
-        else
-          pulse_end_threshold = sigma_v[i] * _end_nsigma;
+        pulse_end_threshold = Threshold<double>(sigma_v[i], _end_nsigma, _end_adc_thres);
 
         int buffer_num_index = 0;
         if (_pulse_v.size())
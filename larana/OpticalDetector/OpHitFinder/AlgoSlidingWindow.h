@@ -20,6 +20,7 @@
 #include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
 
 #include <string>
+#include <vector>
 
 namespace pmtana
 {
@@ -49,6 +50,36 @@ namespace pmtana
 		   const pmtana::PedestalMean_t&,
 		   const pmtana::PedestalSigma_t&);
 
+    /// Constant pedestals are handled by RecoPulse without expansion
+    bool AcceptsConstantPedestal() const { return true; }
+
+    /// RecoPulse body, templated on per-sample vs. constant pedestal and start threshold access
+    template <typename MeanArray, typename SigmaArray, typename ThresholdArray>
+    bool RecoPulseImpl(const pmtana::Waveform_t&,
+		       const MeanArray&,
+		       const SigmaArray&,
+		       const ThresholdArray& start_thres_v);
+
+    /// First index from "start" whose pedestal-subtracted value is above the threshold (wf.size() if none)
+    template <typename MeanArray, typename ThresholdArray>
+    size_t NextAboveThreshold(const pmtana::Waveform_t&,
+			      const MeanArray&,
+			      const ThresholdArray&,
+			      size_t start) const;
+
+    /// Constant pedestal version of NextAboveThreshold, comparing raw ADC counts
+    size_t NextAboveThreshold(const pmtana::Waveform_t&,
+			      const pmtana::ConstantPedestal_t&,
+			      const pmtana::ConstantPedestal_t&,
+			      size_t start) const;
+
+    /// Larger of the sigma-based and the absolute ADC threshold; the product
+    /// is taken in double and rounded to Real (start and tail thresholds are
+    /// float, the end threshold is double)
+    template <typename Real>
+    static Real Threshold(double sigma, float nsigma, float adc_thres)
+    { return (sigma * nsigma < adc_thres) ? adc_thres : sigma * nsigma; }
+
     /// A boolean to set waveform positive/negative polarity
     bool _positive;
 
@@ -62,6 +93,9 @@ namespace pmtana
     float _nsigma, _tail_nsigma, _end_nsigma;
     bool _verbose;
     size_t _num_presample, _num_postsample;
+
+    /// Per-sample start thresholds for non-constant pedestals
+    std::vector<float> _start_thres_v;
   };
 
 }
@@ -53,6 +53,9 @@ namespace pmtana
 		   const pmtana::PedestalMean_t& mean_v,
 		   const pmtana::PedestalSigma_t& sigma_v);
 
+    /// Only the first pedestal sample is used, so constant pedestals need no expansion
+    bool AcceptsConstantPedestal() const { return true; }
+
     /// A variable holder for a user-defined absolute ADC threshold value
     //double _adc_thres;
     double _start_adc_thres;
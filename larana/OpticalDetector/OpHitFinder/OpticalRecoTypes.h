@@ -1,6 +1,7 @@
 #ifndef larana_OPTICALDETECTOR_OPTICALRECOTYPES_H
 #define larana_OPTICALDETECTOR_OPTICALRECOTYPES_H
 
+#include <cstddef>
 #include <vector>
 
 namespace pmtana {
@@ -9,5 +10,13 @@ namespace pmtana {
   typedef std::vector<double> PedestalMean_t;
   typedef std::vector<double> PedestalSigma_t;
 
+  /// Stand-in for a pedestal array when the pedestal is one value for the whole waveform
+  struct ConstantPedestal_t {
+    double value;
+    double operator[](size_t) const { return value; }
+    double at(size_t) const { return value; }
+    double front() const { return value; }
+  };
+
 }
 #endif
@@ -13,6 +13,11 @@ namespace pmtana{
   PMTPedestalBase::PMTPedestalBase(std::string name) : _name(name)
 				     , _mean_v()
 				     , _sigma_v()
+				     , _constant(false)
+				     , _nsamples(0)
+				     , _full_mean_v()
+				     , _full_sigma_v()
+				     , _expanded(false)
   //**************************************************************
   {}
 
@@ -30,18 +35,21 @@ namespace pmtana{
   bool PMTPedestalBase::Evaluate(const ::pmtana::Waveform_t& wf)
   //************************************************************
   {
-    _mean_v.resize(wf.size(),0);
-    _sigma_v.resize(wf.size(),0);
-
-    for(size_t i=0; i<wf.size(); ++i)
-      _mean_v[i] = _sigma_v[i] = 0;
+    // assign() keeps the capacity from previous waveforms
+    _mean_v.assign(wf.size(),0);
+    _sigma_v.assign(wf.size(),0);
 
     const bool res = ComputePedestal(wf, _mean_v, _sigma_v);
 
-    if(wf.size() != _mean_v.size())
+    if(_mean_v.size() != _sigma_v.size())
+      throw OpticalRecoException("Internal error: computed pedestal mean and sigma array lengths differ!");
+
+    if(wf.size() != _mean_v.size() && _mean_v.size() != 1)
       throw OpticalRecoException("Internal error: computed pedestal mean array length changed!");
-    if(wf.size() != _sigma_v.size())
-      throw OpticalRecoException("Internal error: computed pedestal sigma array length changed!");
+
+    _constant = (_mean_v.size() == 1);
+    _nsamples = wf.size();
+    _expanded = false;
 
     return res;
   }
@@ -50,6 +58,8 @@ namespace pmtana{
   double PMTPedestalBase::Mean(size_t i) const
   //*******************************************
   {
+    if(_constant) return _mean_v.front();
+
     if(i > _mean_v.size()) {
       std::stringstream ss;
       ss << "Invalid index: no pedestal mean exist @ " << i;
@@ -62,6 +72,8 @@ namespace pmtana{
   double PMTPedestalBase::Sigma(size_t i) const
   //*******************************************
   {
+    if(_constant) return _sigma_v.front();
+
     if(i > _sigma_v.size()) {
       std::stringstream ss;
       ss << "Invalid index: no pedestal sigma exist @ " << i;
@@ -73,10 +85,28 @@ namespace pmtana{
   //*************************************************
   const PedestalMean_t& PMTPedestalBase::Mean() const
   //*************************************************
-  { return _mean_v; }
+  {
+    if(!_constant) return _mean_v;
+    if(!_expanded) Expand();
+    return _full_mean_v;
+  }
 
   //***************************************************
   const PedestalSigma_t& PMTPedestalBase::Sigma() const
   //***************************************************
-  { return _sigma_v; }
+  {
+    if(!_constant) return _sigma_v;
+    if(!_expanded) Expand();
+    return _full_sigma_v;
+  }
+
+  //************************************
+  void PMTPedestalBase::Expand() const
+  //************************************
+  {
+    // assign() keeps the capacity from previous waveforms
+    _full_mean_v.assign(_nsamples,_mean_v.front());
+    _full_sigma_v.assign(_nsamples,_sigma_v.front());
+    _expanded = true;
+  }
 }
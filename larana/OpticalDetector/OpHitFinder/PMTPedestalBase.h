@@ -41,23 +41,34 @@ namespace pmtana
     /// Method to compute a pedestal
     bool Evaluate(const pmtana::Waveform_t& wf);
 
+    /// True if the last pedestal computed is one value for the whole waveform
+    bool IsConstant() const { return _constant; }
+
     /// Getter of the pedestal mean value
     double Mean(size_t i) const;
 
     /// Getter of the pedestal standard deviation
     double Sigma(size_t i) const;
 
-    /// Getter of the pedestal mean value
+    /// Getter of the pedestal mean array, one value per ADC sample
     const pmtana::PedestalMean_t& Mean() const;
 
-    /// Getter of the pedestal standard deviation
+    /// Getter of the pedestal standard deviation array, one value per ADC sample
     const pmtana::PedestalSigma_t& Sigma() const;
 
+    /// Getter of the pedestal mean array as computed: a single element if IsConstant()
+    const pmtana::PedestalMean_t& CompactMean() const { return _mean_v; }
+
+    /// Getter of the pedestal standard deviation array as computed: a single element if IsConstant()
+    const pmtana::PedestalSigma_t& CompactSigma() const { return _sigma_v; }
+
   protected:
 
     /**
        Method to compute pedestal: mean and sigma array should be filled per ADC.
-       The length of each array is guaranteed to be same.
+       The length of each array is guaranteed to be same as the waveform.
+       Algorithms finding a single pedestal value may instead resize both
+       arrays to one element (see IsConstant()).
     */
     virtual bool ComputePedestal( const ::pmtana::Waveform_t& wf,
 				  pmtana::PedestalMean_t&   mean_v,
@@ -73,6 +84,22 @@ namespace pmtana
 
     /// A variable holder for pedestal standard deviation
     pmtana::PedestalSigma_t _sigma_v;
+
+    /// Whether the pedestal arrays hold a single value for the whole waveform
+    bool _constant;
+
+    /// Number of samples of the last waveform evaluated
+    size_t _nsamples;
+
+    /// Per-sample copies of a constant pedestal, filled on request by Mean() and Sigma()
+    mutable pmtana::PedestalMean_t  _full_mean_v;
+    mutable pmtana::PedestalSigma_t _full_sigma_v;
+
+    /// Whether the per-sample copies are up to date with the last waveform evaluated
+    mutable bool _expanded;
+
+    /// Fills the per-sample copies of a constant pedestal
+    void Expand() const;
   };
 }
 #endif
@@ -33,7 +33,13 @@ namespace pmtana{
 				      const PedestalSigma_t& sigma_v )
   //******************************************************************
   {
-    _status = this->RecoPulse(wf,mean_v,sigma_v);
+    if(mean_v.size() == 1 && wf.size() > 1 && !AcceptsConstantPedestal()) {
+      _mean_buf.assign(wf.size(),mean_v.front());
+      _sigma_buf.assign(wf.size(),sigma_v.front());
+      _status = this->RecoPulse(wf,_mean_buf,_sigma_buf);
+    }
+    else
+      _status = this->RecoPulse(wf,mean_v,sigma_v);
     return _status;
   }
 
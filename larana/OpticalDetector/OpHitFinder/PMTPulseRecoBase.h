@@ -84,6 +84,8 @@ namespace pmtana
 
     /** A core method: this executes the algorithm and stores reconstructed parameters
       in the pulse_param struct object.
+      Pedestal arrays of a single element stand for a constant pedestal; they are
+      expanded to the waveform length unless the algorithm AcceptsConstantPedestal().
     */
     bool Reconstruct( const pmtana::Waveform_t&,
 		      const pmtana::PedestalMean_t&,
@@ -109,12 +111,19 @@ namespace pmtana
     /// Status after pulse reconstruction
     bool _status;
 
+    /// Per-sample pedestal arrays, used to expand constant pedestals
+    pmtana::PedestalMean_t  _mean_buf;
+    pmtana::PedestalSigma_t _sigma_buf;
+
   protected:
 
     virtual bool RecoPulse( const pmtana::Waveform_t&,
 			    const pmtana::PedestalMean_t&,
 			    const pmtana::PedestalSigma_t&     ) = 0;
 
+    /// Whether RecoPulse handles single-element (constant) pedestal arrays itself
+    virtual bool AcceptsConstantPedestal() const { return false; }
+
     /// A container array of pulse_param struct objects to store (possibly multiple) reconstructed pulse(s).
     pulse_param_array _pulse_v;
 
@@ -53,14 +53,14 @@ namespace pmtana{
     case kHEAD:
       ped_mean  = mean ( wf, 0, _nsample_front);
       ped_sigma = std  ( wf, ped_mean, 0, _nsample_front);
-      for( auto &v : mean_v  ) v = ped_mean;
-      for( auto &v : sigma_v ) v = ped_sigma;
+      mean_v.assign ( 1, ped_mean  ); // constant pedestal
+      sigma_v.assign( 1, ped_sigma );
       break;
     case kTAIL:
       ped_mean  = mean ( wf, (wf.size() - _nsample_tail), _nsample_tail);
       ped_sigma = std  ( wf, ped_mean, (wf.size() - _nsample_tail), _nsample_tail);
-      for( auto &v : mean_v  ) v = ped_mean;
-      for( auto &v : sigma_v ) v = ped_sigma;
+      mean_v.assign ( 1, ped_mean  ); // constant pedestal
+      sigma_v.assign( 1, ped_sigma );
       break;
     case kBOTH:
       double ped_mean_head  = mean ( wf, 0, _nsample_front);
@@ -74,8 +74,8 @@ namespace pmtana{
 	ped_mean  = ped_mean_tail;
 	ped_sigma = ped_sigma_tail;
       }
-      for( auto &v : mean_v  ) v = ped_mean;
-      for( auto &v : sigma_v ) v = ped_sigma;
+      mean_v.assign ( 1, ped_mean  ); // constant pedestal
+      sigma_v.assign( 1, ped_sigma );
       break;
     }
     return true;
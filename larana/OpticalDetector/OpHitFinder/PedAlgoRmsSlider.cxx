@@ -117,7 +117,7 @@ namespace pmtana{
     // the wf itself
     // **********
 
-    pmtana::PedestalMean_t  mean_temp_v;
+    std::vector<double> mean_temp_v; // working precision, not pedestal storage
     mean_temp_v.resize( wf.size(), 0);
 
     for(size_t i=0; i< wf.size(); ++i) {
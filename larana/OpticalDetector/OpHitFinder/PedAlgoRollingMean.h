@@ -20,6 +20,7 @@
 #include "larana/OpticalDetector/OpHitFinder/OpticalRecoTypes.h"
 
 #include <string>
+#include <vector>
 
 namespace pmtana
 {
@@ -61,6 +62,9 @@ namespace pmtana
 
     int _n_presamples;
 
+    /// Scratch counts for the binned mode search
+    std::vector<size_t> _ctr_v;
+
     //double _random_shift;
 
   };
@@ -41,8 +41,8 @@ namespace pmtana{
       double ped_mean  = wf.front(); //first sample
       double ped_sigma = 0;
 
-      for( auto &v : mean_v  ) v = ped_mean;
-      for( auto &v : sigma_v ) v = ped_sigma;
+      mean_v.assign ( 1, ped_mean  ); // constant pedestal
+      sigma_v.assign( 1, ped_sigma );
 
       return true;
 
@@ -51,8 +51,8 @@ namespace pmtana{
     else {
 
       _beamgatealgo.Evaluate(wf);
-      mean_v  = _beamgatealgo.Mean();
-      sigma_v = _beamgatealgo.Sigma();
+      mean_v  = _beamgatealgo.CompactMean();
+      sigma_v = _beamgatealgo.CompactSigma();
 
       return true;
     }
@@ -64,7 +64,7 @@ namespace pmtana{
 
 	pulse_reco_status = ( ped_status &&
 			      pulse_reco_status &&
-			      pulse_algo->Reconstruct( wf, ped_algo->Mean(), ped_algo->Sigma() )
+			      pulse_algo->Reconstruct( wf, ped_algo->CompactMean(), ped_algo->CompactSigma() )
 			      );
 
       } else {
@@ -76,7 +76,7 @@ namespace pmtana{
 	}
 
 	pulse_reco_status = ( pulse_reco_status &&
-			      pulse_algo->Reconstruct( wf, _ped_algo->Mean(), _ped_algo->Sigma() )
+			      pulse_algo->Reconstruct( wf, _ped_algo->CompactMean(), _ped_algo->CompactSigma() )
 			      );
       }
     }
@@ -2,8 +2,13 @@
 #define larana_OPTICALDETECTOR_UTILFUNC_H
 
 #include "OpticalRecoTypes.h"
+#include "OpticalRecoException.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace pmtana {
@@ -20,6 +25,139 @@ namespace pmtana {
 
   int sign(double val);
 
+  //
+  // Range primitives over random access iterators (waveform samples or pedestal
+  // values). Loops keep several independent partial sums so that they can be
+  // vectorized without reassociating a single accumulator; integer samples are
+  // summed exactly in integer arithmetic.
+  //
+
+  namespace details {
+    template <typename Iter>
+    using value_t = typename std::iterator_traits<Iter>::value_type;
+
+    template <typename Iter>
+    using sum_t = std::conditional_t<std::is_integral<value_t<Iter>>::value, long long, double>;
+  }
+
+  /// Sum of the values in [first,last)
+  template <typename Iter>
+  details::sum_t<Iter> range_sum(Iter first, Iter last)
+  {
+    using sum_t = details::sum_t<Iter>;
+    const auto n = std::distance(first,last);
+    sum_t s0=0, s1=0, s2=0, s3=0;
+    std::ptrdiff_t i=0;
+    for(; i+4<=n; i+=4) {
+      s0 += first[i];   s1 += first[i+1];
+      s2 += first[i+2]; s3 += first[i+3];
+    }
+    for(; i<n; ++i) s0 += first[i];
+    return (s0+s1)+(s2+s3);
+  }
+
+  /// Sum of squared deviations from ref of the values in [first,last)
+  template <typename Iter>
+  double range_sum_sq(Iter first, Iter last, double ref=0)
+  {
+    const auto n = std::distance(first,last);
+    double s0=0, s1=0, s2=0, s3=0;
+    std::ptrdiff_t i=0;
+    for(; i+4<=n; i+=4) {
+      const double d0 = first[i]-ref,   d1 = first[i+1]-ref;
+      const double d2 = first[i+2]-ref, d3 = first[i+3]-ref;
+      s0 += d0*d0; s1 += d1*d1; s2 += d2*d2; s3 += d3*d3;
+    }
+    for(; i<n; ++i) { const double d = first[i]-ref; s0 += d*d; }
+    return (s0+s1)+(s2+s3);
+  }
+
+  /// Minimum and maximum of the non-empty range [first,last)
+  template <typename Iter>
+  std::pair<details::value_t<Iter>,details::value_t<Iter>> range_minmax(Iter first, Iter last)
+  {
+    if(first==last) throw OpticalRecoException("Cannot find min/max of an empty range");
+    const auto n = std::distance(first,last);
+    auto lo0 = *first, lo1 = lo0, lo2 = lo0, lo3 = lo0;
+    auto hi0 = lo0, hi1 = lo0, hi2 = lo0, hi3 = lo0;
+    std::ptrdiff_t i=0;
+    for(; i+4<=n; i+=4) {
+      const auto v0 = first[i],   v1 = first[i+1];
+      const auto v2 = first[i+2], v3 = first[i+3];
+      lo0 = v0 < lo0 ? v0 : lo0; hi0 = hi0 < v0 ? v0 : hi0;
+      lo1 = v1 < lo1 ? v1 : lo1; hi1 = hi1 < v1 ? v1 : hi1;
+      lo2 = v2 < lo2 ? v2 : lo2; hi2 = hi2 < v2 ? v2 : hi2;
+      lo3 = v3 < lo3 ? v3 : lo3; hi3 = hi3 < v3 ? v3 : hi3;
+    }
+    for(; i<n; ++i) {
+      const auto v = first[i];
+      lo0 = v < lo0 ? v : lo0; hi0 = hi0 < v ? v : hi0;
+    }
+    lo0 = lo1 < lo0 ? lo1 : lo0; lo2 = lo3 < lo2 ? lo3 : lo2;
+    hi0 = hi0 < hi1 ? hi1 : hi0; hi2 = hi2 < hi3 ? hi3 : hi2;
+    return {lo2 < lo0 ? lo2 : lo0, hi0 < hi2 ? hi2 : hi0};
+  }
+
+  /// Mean of the most populated of nbins equal bins between the range min and
+  /// max (averaged over ties); ctr_v is caller-owned scratch for the counts
+  template <typename Iter>
+  double BinnedMaxOccurrence(Iter first, Iter last, const size_t nbins, std::vector<size_t>& ctr_v)
+  {
+    if(nbins<1) throw OpticalRecoException("Cannot have 0 binning");
+
+    const auto res = range_minmax(first,last);
+    const double vmin = res.first;
+
+    double bin_width = (res.second - vmin) / ((double)nbins);
+
+    if(nbins==1 || bin_width == 0) return (vmin + bin_width /2.);
+
+    // the maximum sits on the upper edge of the last bin: it is counted in
+    // an extra bin, added to the last one afterwards
+    ctr_v.assign(nbins+1,0);
+    for(; first!=last; ++first)
+      ctr_v[size_t(int((*first - vmin)/bin_width))]++;
+    ctr_v[nbins-1] += ctr_v[nbins];
+    ctr_v.pop_back();
+
+    // Find max occurrence
+    const size_t max_ctr = *std::max_element(std::begin(ctr_v),std::end(ctr_v));
+
+    // Get the mean of max-occurrence bins
+    double mean_max_occurrence = 0;
+    double num_occurrence = 0;
+    for(size_t bin=0; bin<nbins; ++bin) {
+      if(ctr_v[bin] != max_ctr) continue;
+      mean_max_occurrence += (vmin + bin_width / 2. + bin_width * bin);
+      num_occurrence += 1.0;
+    }
+
+    return (mean_max_occurrence / num_occurrence);
+  }
+
+  /// Center of the first most populated bin of a histogram with bins equal
+  /// bins spanning [min,max) of the range, as BinnedMaxTH1D but without ROOT
+  /// (values equal to the maximum fall in the overflow, as in TH1)
+  template <typename Iter>
+  double BinnedMaxHistogram(Iter first, Iter last, int bins, std::vector<size_t>& ctr_v)
+  {
+    const auto res = range_minmax(first,last);
+    const double xmin = res.first, xmax = res.second;
+    if(bins<1) bins = 1;
+    if(!(xmax > xmin)) return xmin;
+
+    ctr_v.assign(bins,0);
+    for(; first!=last; ++first) {
+      const double x = *first;
+      if(x >= xmax) continue;
+      ctr_v[int(bins*(x-xmin)/(xmax-xmin))]++;
+    }
+
+    const size_t bin = std::max_element(std::begin(ctr_v),std::end(ctr_v)) - std::begin(ctr_v);
+    const double bin_width = (xmax - xmin) / double(bins);
+    return xmin + bin * bin_width + 0.5*bin_width;
+  }
+
 }
 
 #endif
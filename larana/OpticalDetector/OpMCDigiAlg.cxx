@@ -0,0 +1,159 @@
+/*!
+ * Title:   OpMCDigi Algorithms
+ *
+ * Description: Waveform building for OpMCDigi.
+*/
+
+#include "OpMCDigiAlg.h"
+
+#include "CLHEP/Random/RandExponential.h"
+#include "CLHEP/Random/RandFlat.h"
+#include "CLHEP/Random/RandPoisson.h"
+
+#include <algorithm>
+
+opdet::OpMCDigiAlg::OpMCDigiAlg(std::vector<double> const& SinglePEWaveform, float SaturationScale, short Baseline)
+  : fSinglePEWaveform(SinglePEWaveform)
+  , fSaturationScale(SaturationScale)
+  , fBaseline(Baseline)
+{}
+
+void opdet::OpMCDigiAlg::Reset(int NChannels, int NSamples)
+{
+  fNSamples = NSamples;
+  fStride   = NSamples + fSinglePEWaveform.size();
+  fBuffer.assign(NChannels*fStride, 0.0);
+  fLengths.assign(NChannels, NSamples);
+}
+
+void opdet::OpMCDigiAlg::AddTimedWaveform(int channel, int binTime)
+{
+  // pulses starting after the window would be cut away entirely
+  if(binTime<0 || binTime>=fNSamples) return;
+
+  double* wf = &fBuffer[channel*fStride + binTime];
+  double const* spe = fSinglePEWaveform.data();
+  const size_t n = fSinglePEWaveform.size();
+  for(size_t i=0; i<n; ++i)
+    wf[i] += spe[i];
+}
+
+void opdet::OpMCDigiAlg::AddDarkNoise(int channel,
+				      double MeanDarkPulses,
+				      float WindowLength,
+				      float SampleFreq,
+				      CLHEP::RandPoisson& poisson,
+				      CLHEP::RandFlat& flat)
+{
+  // the waveform is cut to the window first
+  double* wf = &fBuffer[channel*fStride];
+  std::fill(wf + fNSamples, wf + fStride, 0.0);
+
+  double const* spe = fSinglePEWaveform.data();
+  const int n = fSinglePEWaveform.size();
+  int& length = fLengths[channel];
+
+  unsigned const int NumberOfPulses = poisson.fire(MeanDarkPulses);
+
+  for(size_t i=0; i!=NumberOfPulses; ++i) {
+    double const PulseTime = WindowLength*flat.fire(1.0);
+    int const binTime = static_cast<int>(PulseTime * SampleFreq);
+
+    // the tail past the window is kept, growing the waveform; the padding
+    // holds it for any pulse starting inside the window
+    if(binTime<0 || binTime>fNSamples) continue;
+    for(int j=0; j<n; ++j)
+      wf[binTime+j] += spe[j];
+    length = std::max(length, binTime+n);
+  }
+}
+
+std::vector<short> opdet::OpMCDigiAlg::Digitize(int channel, CLHEP::RandFlat& flat)
+{
+  // one random number per sample, drawn in the same order as sample by sample
+  int const length = fLengths[channel];
+  fRandoms.resize(length);
+  flat.fireArray(length, fRandoms.data());
+
+  double const* wf = Waveform(channel);
+  std::vector<short> shortvec(length);
+  for(int i=0; i<length; ++i) {
+    // Apply saturation for large signals
+    int const ThisSample = std::min(wf[i] + fBaseline, double(fSaturationScale));
+
+    // Throw randoms to fairly sample +ve and -ve side of doubles
+    // (the fractional part is lost in the conversion above, so the sample
+    // is truncated unless the random number is exactly zero)
+    if(ThisSample>0)
+      shortvec[i] = (fRandoms[i] > 0)? ThisSample : ThisSample+1;
+    else
+      shortvec[i] = (fRandoms[i] > 0)? ThisSample : ThisSample-1;
+  }
+  return shortvec;
+}
+
+void opdet::OpMCDigiAlg::ResetSparse(int NChannels, int NSamples)
+{
+  fNSamples = NSamples;
+  fPulseTimes.resize(NChannels);
+  for(auto& times : fPulseTimes) times.clear();
+
+  short const pedestal = std::min(double(fBaseline), double(fSaturationScale));
+  fPedestalBlock.assign(NSamples, pedestal);
+}
+
+void opdet::OpMCDigiAlg::AddPulseTime(int channel, int binTime)
+{
+  // same window as AddTimedWaveform
+  if(binTime<0 || binTime>=fNSamples) return;
+  fPulseTimes[channel].push_back(binTime);
+}
+
+void opdet::OpMCDigiAlg::AddDarkNoiseTimes(int channel, double DarkRate, CLHEP::RandExponential& exponential)
+{
+  // a Poisson process: as many pulses on average as a Poisson number of
+  // uniform times over the window, without drawing the number first
+  if(DarkRate<=0) return;
+  double const MeanGap = 1./DarkRate;
+  std::vector<int>& times = fPulseTimes[channel];
+  for(double t = exponential.fire(MeanGap); t < fNSamples; t += exponential.fire(MeanGap))
+    times.push_back(static_cast<int>(t));
+}
+
+std::vector<short> opdet::OpMCDigiAlg::DigitizeSparse(int channel)
+{
+  std::vector<short> shortvec(fPedestalBlock);
+
+  std::vector<int>& times = fPulseTimes[channel];
+  std::sort(times.begin(), times.end());
+
+  int const n = fSinglePEWaveform.size();
+  double const* spe = fSinglePEWaveform.data();
+
+  // overlapping pulses are summed in one segment, which ends where the
+  // last of its pulses does (or at the end of the window)
+  for(size_t first=0; first<times.size(); ) {
+    int const begin = times[first];
+    int end = begin;
+    size_t last = first;
+    do {
+      end = std::max(end, std::min(times[last]+n, fNSamples));
+      ++last;
+    } while(last<times.size() && times[last]<end);
+
+    fSegment.assign(end-begin+n, 0.0);
+    for(size_t i=first; i<last; ++i) {
+      double* wf = &fSegment[times[i]-begin];
+      for(int j=0; j<n; ++j)
+        wf[j] += spe[j];
+    }
+
+    // as Digitize, without the random number: the fractional part is lost
+    // in the conversion either way
+    for(int i=begin; i<end; ++i)
+      shortvec[i] = int(std::min(fSegment[i-begin] + fBaseline, double(fSaturationScale)));
+
+    first = last;
+  }
+  return shortvec;
+}
@@ -0,0 +1,101 @@
+#ifndef OPMCDIGIALG_H
+#define OPMCDIGIALG_H
+
+/*!
+ * Title:   OpMCDigi Algorithms
+ *
+ * Description: Waveform building for OpMCDigi. All channel waveforms live in
+ *              one contiguous buffer; each channel row is padded by the length
+ *              of the single PE template, so a pulse starting anywhere inside
+ *              the readout window is added without bounds checks. As in the
+ *              original OpMCDigi, the waveform is cut to the window before the
+ *              dark noise is added, and dark pulses near the end of the window
+ *              extend it by up to the template length.
+ *
+ *              The sparse pipeline keeps instead a sorted list of pulse start
+ *              samples per channel. Only the samples covered by a pulse are
+ *              built at digitization; the rest of the channel is copied from
+ *              a pedestal block made once per Reset. Its output is not that
+ *              of the dense pipeline: waveforms are always NSamples long (dark
+ *              pulse tails past the window are dropped), dark pulses come from
+ *              exponential gaps rather than a Poisson count of uniform times,
+ *              and no random number is drawn per sample.
+*/
+
+#include <cstddef>
+#include <vector>
+
+namespace CLHEP {
+  class RandExponential;
+  class RandFlat;
+  class RandPoisson;
+}
+
+namespace opdet{
+
+  class OpMCDigiAlg{
+
+  public:
+    OpMCDigiAlg(std::vector<double> const& SinglePEWaveform, float SaturationScale, short Baseline = 0);
+
+    /// Zero the waveforms of NChannels channels of NSamples samples each
+    void Reset(int NChannels, int NSamples);
+
+    /// Add the single PE waveform to channel starting at sample binTime
+    void AddTimedWaveform(int channel, int binTime);
+
+    /// Add Poisson distributed dark pulses over a window of WindowLength (us);
+    /// once per channel, after its photons: the photon pulse tails past the
+    /// window are dropped, the dark pulse tails are kept
+    void AddDarkNoise(int channel,
+		      double MeanDarkPulses,
+		      float WindowLength,
+		      float SampleFreq,
+		      CLHEP::RandPoisson& poisson,
+		      CLHEP::RandFlat& flat);
+
+    /// Saturate and convert the channel waveform to ADC counts, one random
+    /// number per sample (NSamples, or more with dark pulse tails)
+    std::vector<short> Digitize(int channel, CLHEP::RandFlat& flat);
+
+    /// Empty the pulse lists of NChannels channels of NSamples samples each
+    void ResetSparse(int NChannels, int NSamples);
+
+    /// Add a pulse to the list of channel, starting at sample binTime
+    void AddPulseTime(int channel, int binTime);
+
+    /// Add dark pulses to the list of channel, with exponentially distributed
+    /// gaps for a rate of DarkRate pulses per sample
+    void AddDarkNoiseTimes(int channel, double DarkRate, CLHEP::RandExponential& exponential);
+
+    /// Saturate and convert the pulses of channel to ADC counts; samples
+    /// without pulses are at the baseline. Always NSamples long: pulse tails
+    /// past the window, dark ones included, are dropped
+    std::vector<short> DigitizeSparse(int channel);
+
+    int NSamples() const { return fNSamples; }
+    double const* Waveform(int channel) const { return &fBuffer[channel*fStride]; }
+    /// Samples of the channel waveform for Digitize
+    int Length(int channel) const { return fLengths[channel]; }
+    /// Pulse start samples of channel (sorted once digitized)
+    std::vector<int> const& PulseTimes(int channel) const { return fPulseTimes[channel]; }
+
+  private:
+    std::vector<double> fSinglePEWaveform;
+    float               fSaturationScale;
+    short               fBaseline;
+
+    int                 fNSamples = 0;
+    size_t              fStride   = 0;
+    std::vector<double> fBuffer;
+    std::vector<int>    fLengths;
+    std::vector<double> fRandoms;
+
+    std::vector<std::vector<int>> fPulseTimes;
+    std::vector<short>  fPedestalBlock;
+    std::vector<double> fSegment;
+  };
+
+}
+
+#endif
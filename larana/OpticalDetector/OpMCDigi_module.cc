@@ -23,12 +23,14 @@
 // LArSoft includes
 #include "larana/OpticalDetector/OpDigiProperties.h"
 #include "larana/OpticalDetector/OpDetResponseInterface.h"
+#include "larana/OpticalDetector/OpMCDigiAlg.h"
 #include "larsim/Simulation/SimListUtils.h"
 #include "larsim/Simulation/LArG4Parameters.h"
 #include "lardataobj/Simulation/SimPhotons.h"
 #include "lardataobj/RawData/OpDetPulse.h"
 
 // CLHEP includes
+#include "CLHEP/Random/RandExponential.h"
 #include "CLHEP/Random/RandFlat.h"
 #include "CLHEP/Random/RandPoisson.h"
 
@@ -37,6 +39,7 @@
 
 // C++ language includes
 #include <cstring>
+#include <memory>
 
 namespace opdet {
 
@@ -56,14 +59,15 @@ namespace opdet {
     float fSaturationScale;                // adc count w/ saturation occurs
 
     float fDarkRate;                      // Noise rate in Hz
-
-    std::vector<double> fSinglePEWaveform;
+    bool  fSparseDigitization;            // build only the samples with pulses
+    short fBaseline;                      // adc count of samples without signal
 
     CLHEP::HepRandomEngine& fEngine;
     CLHEP::RandFlat    fFlatRandom;
     CLHEP::RandPoisson fPoissonRandom;
+    CLHEP::RandExponential fExponentialRandom;
 
-    void AddTimedWaveform (int time, std::vector<double>& OldPulse, std::vector<double>& NewPulse);
+    std::unique_ptr<OpMCDigiAlg> fDigiAlg;
   };
 }
 
@@ -79,11 +83,14 @@ namespace opdet {
       //, fQE{pset.get<double>("QE")}
     , fSaturationScale{pset.get<float>("SaturationScale")}
     , fDarkRate{pset.get<float>("DarkRate")}
+    , fSparseDigitization{pset.get<bool>("SparseDigitization", false)}
+    , fBaseline{pset.get<short>("Baseline", 0)}
       // create a default random engine; obtain the random seed from NuRandomService,
       // unless overridden in configuration with key "Seed"
     , fEngine(art::ServiceHandle<rndm::NuRandomService>{}->createEngine(*this, pset, "Seed"))
     , fFlatRandom{fEngine}
     , fPoissonRandom{fEngine}
+    , fExponentialRandom{fEngine}
   {
     produces<std::vector< raw::OpDetPulse> >();
 
@@ -91,23 +98,7 @@ namespace opdet {
     fSampleFreq = odp->SampleFreq();
     fTimeBegin  = odp->TimeBegin();
     fTimeEnd    = odp->TimeEnd();
-    fSinglePEWaveform = odp->SinglePEWaveform();
-  }
-
-  //-------------------------------------------------
-
-
-  void OpMCDigi::AddTimedWaveform (int binTime, std::vector<double>& OldPulse, std::vector<double>& NewPulse)
-  {
-
-    if( (binTime + NewPulse.size() ) > OldPulse.size()) {
-      OldPulse.resize(binTime + NewPulse.size());
-    }
-
-    // Add shifted NewWaveform to Waveform at pointer
-    for(size_t i = 0; i!=NewPulse.size(); ++i) {
-      OldPulse.at(binTime+i) += NewPulse.at(i);
-    }
+    fDigiAlg = std::make_unique<OpMCDigiAlg>(odp->SinglePEWaveform(), fSaturationScale, fBaseline);
   }
 
 
@@ -130,8 +121,14 @@ namespace opdet {
     int const NOpChannels = odresponse->NOpChannels();
 
 
-    // This vector will store all the waveforms we will make
-    std::vector<std::vector<double> > PulsesFromDetPhotons(NOpChannels,std::vector<double>(nSamples,0.0));
+    // This will store all the waveforms (or pulse times) we will make
+    if(fSparseDigitization) fDigiAlg->ResetSparse(NOpChannels, nSamples);
+    else                    fDigiAlg->Reset(NOpChannels, nSamples);
+
+    auto const AddPulse = [this](int channel, int binTime) {
+      if(fSparseDigitization) fDigiAlg->AddPulseTime(channel, binTime);
+      else                    fDigiAlg->AddTimedWaveform(channel, binTime);
+    };
 
     if(!fUseLitePhotons) {
       // Read in the Sim Photons
@@ -156,7 +153,7 @@ namespace opdet {
           // that we have to accommodate for the beginning time
           if((Phot.Time > TimeBegin_ns) && (Phot.Time < TimeEnd_ns)) {
             auto const binTime = static_cast<int>((Phot.Time - TimeBegin_ns) * SampleFreq_ns);
-            AddTimedWaveform( binTime, PulsesFromDetPhotons[readoutCh], fSinglePEWaveform );
+            AddPulse( readoutCh, binTime );
           }
         } // for each Photon in SimPhotons
       }
@@ -180,7 +177,7 @@ namespace opdet {
               // Notice that we have to accommodate for the beginning time
               if((pr.first > TimeBegin_ns) && (pr.first < TimeEnd_ns)) {
                 auto const binTime = static_cast<int>((pr.first - TimeBegin_ns) * SampleFreq_ns);
-                AddTimedWaveform( binTime, PulsesFromDetPhotons[readoutCh], fSinglePEWaveform );
+                AddPulse( readoutCh, binTime );
               }
             } // random QE cut
           }
@@ -191,48 +188,23 @@ namespace opdet {
     // Create vector of output objects, add dark noise and apply
     //  saturation
 
-    std::vector<raw::OpDetPulse*> ThePulses(NOpChannels);
-    for(int iCh=0; iCh!=NOpChannels; ++iCh) {
-      PulsesFromDetPhotons[iCh].resize((TimeEnd_ns - TimeBegin_ns) * SampleFreq_ns);
-
-      // Add dark noise
-      double const MeanDarkPulses = fDarkRate * (fTimeEnd-fTimeBegin) / 1000000;
-      unsigned const int NumberOfPulses = fPoissonRandom.fire(MeanDarkPulses);
-
-      for(size_t i=0; i!=NumberOfPulses; ++i) {
-        double const PulseTime = (fTimeEnd-fTimeBegin)*fFlatRandom.fire(1.0);
-        int const binTime = static_cast<int>(PulseTime * fSampleFreq);
+    double const MeanDarkPulses = fDarkRate * (fTimeEnd-fTimeBegin) / 1000000;
+    double const DarkRatePerSample = fDarkRate / (fSampleFreq * 1000000);
 
-        AddTimedWaveform(binTime, PulsesFromDetPhotons[iCh], fSinglePEWaveform);
-      }
-
-      // Apply saturation for large signals
-      for(size_t i=0; i!=PulsesFromDetPhotons[iCh].size(); ++i) {
-        if(PulsesFromDetPhotons[iCh].at(i)>fSaturationScale) PulsesFromDetPhotons[iCh].at(i) = fSaturationScale;
+    StoragePtr->reserve(NOpChannels);
+    for(int iCh=0; iCh!=NOpChannels; ++iCh) {
+      if(fSparseDigitization) {
+        fDigiAlg->AddDarkNoiseTimes(iCh, DarkRatePerSample, fExponentialRandom);
+        StoragePtr->emplace_back(iCh, fDigiAlg->DigitizeSparse(iCh), 0, fTimeBegin);
+        continue;
       }
 
-      // Produce ADC pulse of integers rather than doubles
-
-      std::vector<short> shortvec;
-
-      for(size_t i=0; i!=PulsesFromDetPhotons[iCh].size(); ++i) {
-        // Throw randoms to fairly sample +ve and -ve side of doubles
-        int ThisSample = PulsesFromDetPhotons[iCh].at(i);
-        if(ThisSample>0) {
-          if(fFlatRandom.fire(1.0) > (ThisSample - int(ThisSample)))
-            shortvec.push_back(int(ThisSample));
-          else
-            shortvec.push_back(int(ThisSample)+1);
-        }
-        else {
-          if(fFlatRandom.fire(1.0) >  (int(ThisSample)-ThisSample))
-            shortvec.push_back(int(ThisSample));
-          else
-            shortvec.push_back(int(ThisSample)-1);
-        }
-      }
+      // Add dark noise
+      fDigiAlg->AddDarkNoise(iCh, MeanDarkPulses, fTimeEnd-fTimeBegin, fSampleFreq,
+                             fPoissonRandom, fFlatRandom);
 
-      StoragePtr->emplace_back(iCh, shortvec ,0, fTimeBegin);
+      // Apply saturation and produce ADC pulse of integers rather than doubles
+      StoragePtr->emplace_back(iCh, fDigiAlg->Digitize(iCh, fFlatRandom), 0, fTimeBegin);
 
     } // for each OpDet in SimPhotonsCollection
 
@@ -0,0 +1,176 @@
+/*!
+ * Title:   OptDetDigitizer Algorithms
+ *
+ * Description: Digitization of one optical channel for OptDetDigitizer.
+*/
+
+#include "OptDetDigitizerAlg.h"
+
+#include "CLHEP/Random/RandFlat.h"
+#include "CLHEP/Random/RandGauss.h"
+#include "CLHEP/Random/RandPoisson.h"
+
+#include "cetlib_except/exception.h"
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+opdet::OptDetDigitizerAlg::OptDetDigitizerAlg(Config config)
+  : fConfig(std::move(config))
+  , fNSamples((fConfig.TimeEnd - fConfig.TimeBegin) * fConfig.SampleFreq)
+{}
+
+//-------------------------------------------------
+long opdet::OptDetDigitizerAlg::ChannelSeed(long eventSeed, optdata::Channel_t ch)
+{
+  // splitmix64 of the pair; HepJamesRandom takes seeds up to 900000000
+  uint64_t z = (uint64_t(eventSeed) << 32) + ch + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z = z ^ (z >> 31);
+  return long(z % 900000000ULL);
+}
+
+//-------------------------------------------------
+optdata::TimeSlice_t opdet::OptDetDigitizerAlg::TimeSlice(double time_ns) const
+{
+  if( time_ns/1.e3 > (fConfig.TimeEnd-fConfig.TimeBegin)) return std::numeric_limits<optdata::TimeSlice_t>::max();
+
+  else return optdata::TimeSlice_t((time_ns/1.e3-fConfig.TimeBegin)*fConfig.SampleFreq);
+}
+
+//-------------------------------------------------
+void opdet::OptDetDigitizerAlg::AddWaveform(optdata::TimeSlice_t time,
+                                            std::vector<double>& wf,
+                                            double factor) const
+{
+  std::vector<double> const& spe = fConfig.SinglePEWaveform;
+  for(size_t i = 0; i<spe.size() && (time+i)<wf.size(); ++i)
+    wf[time+i] += spe[i] * factor;
+}
+
+//-------------------------------------------------
+void opdet::OptDetDigitizerAlg::AddDarkNoise(std::vector<double>& wf,
+                                             double gain,
+                                             CLHEP::RandFlat& flat,
+                                             CLHEP::RandPoisson& poisson) const
+{
+  double MeanDarkPulses = fConfig.DarkRate * (fConfig.TimeEnd-fConfig.TimeBegin) / 1000000;
+
+  unsigned int NumberOfPulses = poisson.fire(MeanDarkPulses);
+  for(size_t i=0; i!=NumberOfPulses; ++i)
+    {
+      double PulseTime_ns = fConfig.TimeBegin*1000 + (fConfig.TimeEnd-fConfig.TimeBegin)*1000*(flat.fire(1.0)); // Should be in ns
+      AddWaveform(TimeSlice(PulseTime_ns), wf, gain);
+    }
+}
+
+//-------------------------------------------------
+void opdet::OptDetDigitizerAlg::Digitize(std::vector<double> const& wf,
+                                         optdata::Channel_t ch,
+                                         CLHEP::RandFlat& flat,
+                                         CLHEP::RandPoisson& poisson,
+                                         optdata::ChannelData& chData) const
+{
+  chData.clear();
+  chData.reserve(wf.size());
+  optdata::ADC_Count_t baseMean(fConfig.PedMeanArray.at(ch));
+  for(optdata::TimeSlice_t time=0; time<wf.size(); ++time)
+    {
+      double thisSample = wf[time];
+
+      optdata::ADC_Count_t thisCount = (optdata::ADC_Count_t)(thisSample)+baseMean;
+
+      // (a) amplitude digitization
+      if(flat.fire(1.0) < (thisSample - int(thisSample)))
+        thisCount+=1;
+
+      // (b) saturation
+      if(thisCount > fConfig.SaturationScale) thisCount = fConfig.SaturationScale;
+
+      chData.push_back(thisCount);
+    }
+
+  // (c) pedestal fluctuation
+  double timeSpan = chData.size() * 1.e-6/fConfig.SampleFreq;
+  unsigned int nFluc = poisson.fire(fConfig.PedFlucRate * timeSpan);
+  for(size_t i=0; i<nFluc; ++i)
+    {
+      optdata::TimeSlice_t pulseTime(flat.fire(0.0,(double)(chData.size())));
+      optdata::ADC_Count_t amp = chData[pulseTime];
+      if( flat.fire(0.,1.) > 0.5)
+        {
+          amp += fConfig.PedFlucAmp;
+          if(amp > fConfig.SaturationScale) amp=fConfig.SaturationScale;
+        }
+      else
+        amp -= fConfig.PedFlucAmp;
+      chData[pulseTime] = amp;
+    }
+}
+
+//-------------------------------------------------
+void opdet::OptDetDigitizerAlg::DigitizeChannel(optdata::Channel_t ch,
+                                                sim::SimPhotons const* photons,
+                                                long eventSeed,
+                                                ChannelScratch& scratch,
+                                                optdata::ChannelData& highGain,
+                                                optdata::ChannelData& lowGain) const
+{
+  if(ch >= fConfig.PedMeanArray.size() || ch >= fConfig.HighGainArray.size() ||
+     ch >= fConfig.LowGainArray.size() || ch >= fConfig.GainSpreadArray.size())
+    throw cet::exception("OptDetDigitizerAlg") << "No gain or pedestal for channel " << ch << "\n";
+
+  // the distributions keep their own state, so nothing is shared between
+  // threads (the static CLHEP shoot() functions cache it per thread)
+  scratch.Engine.setSeed(ChannelSeed(eventSeed, ch), 0);
+  CLHEP::RandFlat    flat(scratch.Engine);
+  CLHEP::RandGauss   gauss(scratch.Engine);
+  CLHEP::RandPoisson poisson(scratch.Engine);
+
+  double const highMean = fConfig.HighGainArray[ch];
+  double const lowMean  = fConfig.LowGainArray[ch];
+  double const spread   = fConfig.GainSpreadArray[ch];
+
+  scratch.HighGainWF.assign(fNSamples, 0.0);
+  scratch.LowGainWF.assign(fNSamples, 0.0);
+
+  // Convert units into ns from us
+  double const timeBegin_ns = fConfig.TimeBegin * 1000;
+  double const timeEnd_ns   = fConfig.TimeEnd   * 1000;
+
+  if(photons) {
+    for(const sim::OnePhoton& Phot: *photons)
+      {
+        // Sample a random subset according to QE
+        if(flat.fire(1.0)>fConfig.QE) continue;
+        if( !(Phot.Time > timeBegin_ns  &&  Phot.Time < timeEnd_ns) ) continue;
+
+        optdata::TimeSlice_t PhotonTime(TimeSlice(Phot.Time));
+        if(fConfig.SimGainSpread)
+          {
+            AddWaveform( PhotonTime, scratch.HighGainWF, gauss.fire(highMean, spread*highMean));
+            AddWaveform( PhotonTime, scratch.LowGainWF, gauss.fire(lowMean, spread*lowMean));
+          }
+        else
+          {
+            AddWaveform( PhotonTime, scratch.HighGainWF, highMean);
+            AddWaveform( PhotonTime, scratch.LowGainWF, lowMean);
+          }
+      }
+  }
+
+  // Add dark noise
+  if(fConfig.SimGainSpread){
+    AddDarkNoise(scratch.LowGainWF, gauss.fire(lowMean, spread*lowMean), flat, poisson);
+    AddDarkNoise(scratch.HighGainWF, gauss.fire(highMean, spread*highMean), flat, poisson);
+  }else{
+    AddDarkNoise(scratch.LowGainWF, lowMean, flat, poisson);
+    AddDarkNoise(scratch.HighGainWF, highMean, flat, poisson);
+  }
+
+  // Apply digitization and make channel data
+  Digitize(scratch.HighGainWF, ch, flat, poisson, highGain);
+  Digitize(scratch.LowGainWF, ch, flat, poisson, lowGain);
+}
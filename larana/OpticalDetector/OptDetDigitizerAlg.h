@@ -0,0 +1,103 @@
+#ifndef OPTDETDIGITIZERALG_H
+#define OPTDETDIGITIZERALG_H
+
+/*!
+ * Title:   OptDetDigitizer Algorithms
+ *
+ * Description: Digitization of one optical channel for OptDetDigitizer:
+ *              QE selection of the photons, SPE waveforms with the high and
+ *              low gains, dark noise, amplitude digitization, saturation and
+ *              pedestal fluctuations. Channels share no state; each draws
+ *              from its own engine, seeded from the event seed and the
+ *              channel number, so the result of a channel does not depend
+ *              on the order (or the thread) in which channels are processed.
+*/
+
+#include "lardataobj/OpticalDetectorData/ChannelData.h"
+#include "lardataobj/OpticalDetectorData/OpticalTypes.h"
+#include "lardataobj/Simulation/SimPhotons.h"
+
+#include "CLHEP/Random/JamesRandom.h"
+
+#include <vector>
+
+namespace CLHEP {
+  class RandFlat;
+  class RandPoisson;
+}
+
+namespace opdet{
+
+  class OptDetDigitizerAlg{
+
+  public:
+
+    struct Config {
+      double SampleFreq;  ///< in MHz
+      double TimeBegin;   ///< in us
+      double TimeEnd;     ///< in us
+      double QE;
+      double DarkRate;    ///< in Hz
+      double PedFlucRate; ///< in Hz
+      optdata::ADC_Count_t PedFlucAmp;
+      optdata::ADC_Count_t SaturationScale;
+      bool SimGainSpread; ///< draw the gain of each pulse, or use the channel mean
+
+      std::vector<double> SinglePEWaveform;
+      std::vector<optdata::ADC_Count_t> PedMeanArray; ///< per channel
+      std::vector<double> HighGainArray;              ///< per channel
+      std::vector<double> LowGainArray;               ///< per channel
+      std::vector<double> GainSpreadArray;            ///< per channel
+    };
+
+    /// Work space of one thread, reused from channel to channel
+    struct ChannelScratch {
+      std::vector<double> HighGainWF;
+      std::vector<double> LowGainWF;
+      CLHEP::HepJamesRandom Engine;
+    };
+
+    OptDetDigitizerAlg(Config config);
+
+    /// Number of samples of the digitized waveforms
+    size_t NSamples() const { return fNSamples; }
+
+    /// Seed of the engine of a channel in an event
+    static long ChannelSeed(long eventSeed, optdata::Channel_t ch);
+
+    /// Digitizes channel ch, from its photons (none if nullptr), into the
+    /// high and low gain waveforms
+    void DigitizeChannel(optdata::Channel_t ch,
+                         sim::SimPhotons const* photons,
+                         long eventSeed,
+                         ChannelScratch& scratch,
+                         optdata::ChannelData& highGain,
+                         optdata::ChannelData& lowGain) const;
+
+  private:
+    Config fConfig;
+    size_t fNSamples;
+
+    /// Time slice of a time in ns from the start of the window
+    optdata::TimeSlice_t TimeSlice(double time_ns) const;
+
+    /// Adds the SPE waveform scaled by factor from sample time on; the part
+    /// past the end of the waveform is dropped
+    void AddWaveform(optdata::TimeSlice_t time, std::vector<double>& wf, double factor) const;
+
+    void AddDarkNoise(std::vector<double>& wf,
+                      double gain,
+                      CLHEP::RandFlat& flat,
+                      CLHEP::RandPoisson& poisson) const;
+
+    /// Amplitude digitization, saturation and pedestal fluctuations
+    void Digitize(std::vector<double> const& wf,
+                  optdata::Channel_t ch,
+                  CLHEP::RandFlat& flat,
+                  CLHEP::RandPoisson& poisson,
+                  optdata::ChannelData& chData) const;
+  };
+
+}
+
+#endif
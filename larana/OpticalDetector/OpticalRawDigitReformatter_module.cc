@@ -4,6 +4,7 @@
 // from the optical system, called Flashes.
 
 // LArSoft includes
+#include "larana/OpticalDetector/OpticalRawDigitSorter.h"
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
 #include "lardataobj/OpticalDetectorData/OpticalRawDigit.h"
 #include "lardataobj/OpticalDetectorData/OpticalTypes.h"
@@ -19,6 +20,7 @@
 
 // C++ Includes
 #include <cstring>
+#include <memory>
 
 namespace opdet {
 
@@ -78,13 +80,6 @@ namespace opdet {
   OpticalRawDigitReformatter::produce(art::Event& evt)
   {
 
-    // These are the storage pointers we will put in the event, one per category
-    std::vector<std::unique_ptr<std::vector<raw::OpDetWaveform>>> RawOpDetVecs;
-    for (unsigned int i = 0; i < CategoryLabels.size(); i++) {
-      std::unique_ptr<std::vector<raw::OpDetWaveform>> tmp(new std::vector<raw::OpDetWaveform>);
-      RawOpDetVecs.push_back(std::move(tmp));
-    }
-
     std::vector<const sim::BeamGateInfo*> beamGateArray;
     try {
       evt.getView(fGenModule, beamGateArray);
@@ -100,24 +95,25 @@ namespace opdet {
 
     auto const clock_data =
       art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(evt);
-
-    for (auto ord : ord_vec) {
-      optdata::Channel_t channel = ord.ChannelNumber();
-      optdata::TimeSlice_t timeSlice = ord.TimeSlice();
-      optdata::Frame_t frame = ord.Frame();
-      optdata::Optical_Category_t category = ord.Category();
-
-      // Use the optical clock to conver timeSlice and frame
-      // to an absolute time
-      double timeStamp = clock_data.OpticalClock().Time(timeSlice, frame);
-
-      RawOpDetVecs[category]->push_back(raw::OpDetWaveform(timeStamp, channel, ord));
-    }
+    auto const opticalClock = clock_data.OpticalClock();
+
+    // One collection per category; use the optical clock to convert
+    // timeSlice and frame to an absolute time
+    std::vector<std::vector<raw::OpDetWaveform>> RawOpDetVecs(CategoryLabels.size());
+    SortByCategory(
+      ord_vec,
+      [&opticalClock](optdata::TimeSlice_t timeSlice, optdata::Frame_t frame) {
+        return opticalClock.Time(timeSlice, frame);
+      },
+      RawOpDetVecs);
 
     // Store results into the event
     for (unsigned int i = 0; i < CategoryLabels.size(); i++) {
       // Only store collections which contain waveforms, assign the label
-      if (RawOpDetVecs[i]->size() > 0) { evt.put(std::move(RawOpDetVecs[i]), CategoryLabels[i]); }
+      if (RawOpDetVecs[i].size() > 0) {
+        evt.put(std::make_unique<std::vector<raw::OpDetWaveform>>(std::move(RawOpDetVecs[i])),
+                CategoryLabels[i]);
+      }
     }
   }
 
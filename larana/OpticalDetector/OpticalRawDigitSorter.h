@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////
+// \file OpticalRawDigitSorter.h
+//
+// \brief conversion of optdata::OpticalRawDigit into raw::OpDetWaveform,
+//        one collection per optical category
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef OPDET_OPTICALRAWDIGITSORTER_H
+#define OPDET_OPTICALRAWDIGITSORTER_H
+
+#include "lardataobj/OpticalDetectorData/OpticalRawDigit.h"
+#include "lardataobj/RawData/OpDetWaveform.h"
+
+#include "cetlib_except/exception.h"
+
+#include <vector>
+
+namespace opdet {
+
+  /// Fills waveforms[category] with the OpDetWaveforms of the digits of each
+  /// category (optdata::Optical_Category_t), in the order of the digits.
+  /// timeOf(timeSlice, frame) gives the time stamp of a digit. The digits
+  /// are counted per category first, so each collection is allocated once
+  /// and the samples are copied once, straight from the digit.
+  template <typename TimeFunc>
+  void SortByCategory(std::vector<optdata::OpticalRawDigit> const& digits,
+                      TimeFunc&& timeOf,
+                      std::vector<std::vector<raw::OpDetWaveform>>& waveforms)
+  {
+    std::vector<size_t> counts(waveforms.size(), 0);
+    for (auto const& ord : digits) {
+      size_t const category = ord.Category();
+      if (category >= counts.size())
+        throw cet::exception("OpticalRawDigitSorter")
+          << "Optical category " << category << " of channel " << ord.ChannelNumber()
+          << " is out of range\n";
+      ++counts[category];
+    }
+
+    for (size_t i = 0; i < waveforms.size(); ++i) {
+      waveforms[i].clear();
+      waveforms[i].reserve(counts[i]);
+    }
+
+    for (auto const& ord : digits)
+      waveforms[ord.Category()].emplace_back(
+        timeOf(ord.TimeSlice(), ord.Frame()), ord.ChannelNumber(), ord);
+  }
+
+} // namespace opdet
+
+#endif
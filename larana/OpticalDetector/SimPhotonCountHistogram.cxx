@@ -0,0 +1,69 @@
+/*!
+ * Title:   SimPhotonCountHistogram Class
+ *
+ * Description: Counts of sim photons per optical channel, arrival time bin
+ *              and wavelength class (ultraviolet or visible), for all the
+ *              photons and for the detected ones.
+*/
+
+#include "SimPhotonCountHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+opdet::SimPhotonCountHistogram::SimPhotonCountHistogram(unsigned int nChannels,
+                                                        float minTime,
+                                                        float timeBinWidth,
+                                                        unsigned int nTimeBins)
+  : fNChannels(nChannels),
+    fMinTime(minTime),
+    fTimeBinWidth(timeBinWidth),
+    fNTimeBins(nTimeBins)
+{
+  if(fNTimeBins == 0 || !(fTimeBinWidth > 0))
+    throw std::runtime_error("ERROR in SimPhotonCountHistogram: Bad time binning.");
+
+  fAll.assign((size_t)fNChannels * fNTimeBins * kNWavelengthClasses, 0);
+  fDetected.assign(fAll.size(), 0);
+}
+
+void opdet::SimPhotonCountHistogram::Clear()
+{
+  std::fill(fAll.begin(), fAll.end(), 0);
+  std::fill(fDetected.begin(), fDetected.end(), 0);
+}
+
+void opdet::SimPhotonCountHistogram::ClassifyWavelengths(std::vector<float> const& wavelengths,
+                                                         std::vector<WavelengthClass_t>& classes)
+{
+  size_t const n = wavelengths.size();
+  classes.resize(n);
+
+  // A plain loop with no branch, which the compiler can vectorize
+  float const* wl = wavelengths.data();
+  WavelengthClass_t* cl = classes.data();
+  for(size_t i=0; i<n; i++)
+    cl[i] = (wl[i] < kVisibleThreshold)? kVUV : kVisible;
+}
+
+unsigned int opdet::SimPhotonCountHistogram::TimeBin(float time) const
+{
+  float const bin = std::floor((time - fMinTime) / fTimeBinWidth);
+  if(!(bin >= 0) || bin >= fNTimeBins) return fNTimeBins; // also takes NaN
+  return (unsigned int)bin;
+}
+
+void opdet::SimPhotonCountHistogram::Add(int channel, float time, WavelengthClass_t wlClass,
+                                         unsigned int nAll, unsigned int nDetected)
+{
+  if(channel < 0 || (unsigned int)channel >= fNChannels)
+    throw std::runtime_error("ERROR in SimPhotonCountHistogram: Channel out of range.");
+
+  unsigned int const bin = TimeBin(time);
+  if(bin == fNTimeBins) return;
+
+  size_t const i = Index(channel, bin, wlClass);
+  fAll[i] += nAll;
+  fDetected[i] += nDetected;
+}
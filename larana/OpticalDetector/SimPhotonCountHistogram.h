@@ -0,0 +1,75 @@
+#ifndef SIMPHOTONCOUNTHISTOGRAM_H
+#define SIMPHOTONCOUNTHISTOGRAM_H
+
+/*!
+ * Title:   SimPhotonCountHistogram Class
+ *
+ * Description: Counts of sim photons per optical channel, arrival time bin
+ *              and wavelength class (ultraviolet or visible), for all the
+ *              photons and for the detected ones. The counts of an event
+ *              are kept in two flat arrays, indexed by
+ *              (channel * NTimeBins() + time bin) * kNWavelengthClasses + class.
+*/
+
+#include <cstddef>
+#include <vector>
+
+namespace opdet{
+
+  class SimPhotonCountHistogram{
+
+  public:
+    enum WavelengthClass_t : unsigned char { kVUV = 0, kVisible = 1, kNWavelengthClasses = 2 };
+
+    /// Threshold used to resolve between visible and ultraviolet light [nm]
+    static constexpr float kVisibleThreshold = 200.0;
+
+    /// Times [ns] from minTime in nTimeBins bins; earlier and later photons
+    /// are not counted
+    SimPhotonCountHistogram(unsigned int nChannels,
+                            float minTime,
+                            float timeBinWidth,
+                            unsigned int nTimeBins);
+
+    void Clear();
+
+    /// Class of each photon from its wavelength [nm], as given by
+    /// OpDetResponseInterface::wavelength()
+    static void ClassifyWavelengths(std::vector<float> const& wavelengths,
+                                    std::vector<WavelengthClass_t>& classes);
+
+    /// Adds nAll photons arrived on the channel at that time, nDetected of
+    /// which detected; nothing if the time is outside the bins
+    void Add(int channel, float time, WavelengthClass_t wlClass,
+             unsigned int nAll, unsigned int nDetected);
+
+    unsigned int NChannels() const { return fNChannels; }
+    unsigned int NTimeBins() const { return fNTimeBins; }
+    /// Bin of the time, NTimeBins() if outside the bins (or not a number)
+    unsigned int TimeBin(float time) const;
+
+    unsigned int All(unsigned int channel, unsigned int bin, WavelengthClass_t wlClass) const
+    { return fAll[Index(channel, bin, wlClass)]; }
+    unsigned int Detected(unsigned int channel, unsigned int bin, WavelengthClass_t wlClass) const
+    { return fDetected[Index(channel, bin, wlClass)]; }
+
+    std::vector<unsigned int> const& AllCounts() const { return fAll; }
+    std::vector<unsigned int> const& DetectedCounts() const { return fDetected; }
+
+  private:
+    unsigned int fNChannels;
+    float fMinTime;
+    float fTimeBinWidth;
+    unsigned int fNTimeBins;
+
+    std::vector<unsigned int> fAll;
+    std::vector<unsigned int> fDetected;
+
+    size_t Index(unsigned int channel, unsigned int bin, WavelengthClass_t wlClass) const
+    { return ((size_t)channel * fNTimeBins + bin) * kNWavelengthClasses + wlClass; }
+
+  };
+
+}
+
+#endif
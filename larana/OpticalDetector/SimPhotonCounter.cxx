@@ -62,7 +62,7 @@ void opdet::SimPhotonCounter::SetTimeRanges(float t_p1, float t_p2, float t_l1,
 
 void opdet::SimPhotonCounter::AddOnePhoton(size_t i_opdet, const sim::OnePhoton& photon)
 {
-  if(i_opdet > GetVectorSize())
+  if(i_opdet >= GetVectorSize())
     throw std::runtime_error("ERROR in SimPhotonCounter: Opdet requested out of range!");
 
   if(Wavelength(photon) < _min_wavelength || Wavelength(photon) > _max_wavelength) return;
@@ -66,8 +66,14 @@ namespace opdet{
 
     void Print();
 
+    /// Wavelength of the photon in nm
+    static float Wavelength(const sim::OnePhoton& ph);
+
   private:
 
+    // keeps the counts of all its counters in one block, and copies them here
+    friend class SimPhotonCounterAlg;
+
     std::vector<float> _photonVector_prompt;
     std::vector<float> _photonVector_late;
 
@@ -80,8 +86,6 @@ namespace opdet{
     float _min_wavelength; //in nm
     float _max_wavelength;
 
-    float Wavelength(const sim::OnePhoton& ph);
-
   };
 
 }
@@ -11,9 +11,13 @@
 
 #include "fhiclcpp/ParameterSet.h"
 
+#include <algorithm>
+#include <cmath>
+
 opdet::SimPhotonCounterAlg::SimPhotonCounterAlg(fhicl::ParameterSet const& p)
 {
   FillAllRanges( p.get< std::vector<fhicl::ParameterSet> >("SimPhotonCounterParams") );
+  BuildCells();
 }
 
 void opdet::SimPhotonCounterAlg::FillAllRanges(std::vector<fhicl::ParameterSet> const& pv)
@@ -52,16 +56,94 @@ void opdet::SimPhotonCounterAlg::FillRanges(fhicl::ParameterSet const& p)
 
 }
 
+void opdet::SimPhotonCounterAlg::BuildCells()
+{
+  size_t const nCounters = fTimeRanges.size();
+
+  // a cell is the boundary value itself (odd index) or the gap below it
+  // (even index); the first and last cells are outside of every range
+  auto cellInside = [](std::vector<float> const& b, size_t cell, auto inPoint, auto inGap){
+    if(cell%2 == 1) return inPoint(b[cell/2]);
+    if(cell == 0 || cell/2 == b.size()) return false;
+    return inGap(b[cell/2-1],b[cell/2]);
+  };
+
+  fTimeBoundaries.clear();
+  for(auto const& r : fTimeRanges)
+    fTimeBoundaries.insert(fTimeBoundaries.end(),r.begin(),r.end());
+  std::sort(fTimeBoundaries.begin(),fTimeBoundaries.end());
+  fTimeBoundaries.erase(std::unique(fTimeBoundaries.begin(),fTimeBoundaries.end()),fTimeBoundaries.end());
+
+  size_t const nTimeCells = 2*fTimeBoundaries.size()+1;
+  fTimeCellOffsets.assign(1,0);
+  fTimeCellEntries.clear();
+  for(size_t cell=0; cell<nTimeCells; cell++){
+    for(size_t i=0; i<nCounters; i++){
+      float const t_p1 = fTimeRanges[i][0], t_p2 = fTimeRanges[i][1];
+      float const t_l1 = fTimeRanges[i][2], t_l2 = fTimeRanges[i][3];
+      // prompt is (t_p1,t_p2], late is (t_l1,t_l2)
+      bool const prompt = cellInside(fTimeBoundaries,cell,
+				     [&](float t){ return t > t_p1 && t <= t_p2; },
+				     [&](float lo, float hi){ return lo >= t_p1 && hi <= t_p2; });
+      bool const late = !prompt &&
+	cellInside(fTimeBoundaries,cell,
+		   [&](float t){ return t > t_l1 && t < t_l2; },
+		   [&](float lo, float hi){ return lo >= t_l1 && hi <= t_l2; });
+      if(prompt) fTimeCellEntries.push_back(i*2);
+      else if(late) fTimeCellEntries.push_back(i*2+1);
+    }
+    fTimeCellOffsets.push_back(fTimeCellEntries.size());
+  }
+
+  fWavelengthBoundaries.clear();
+  for(auto const& r : fWavelengthRanges)
+    fWavelengthBoundaries.insert(fWavelengthBoundaries.end(),r.begin(),r.end());
+  std::sort(fWavelengthBoundaries.begin(),fWavelengthBoundaries.end());
+  fWavelengthBoundaries.erase(std::unique(fWavelengthBoundaries.begin(),fWavelengthBoundaries.end()),
+			      fWavelengthBoundaries.end());
+
+  size_t const nWavelengthCells = 2*fWavelengthBoundaries.size()+1;
+  fWavelengthCellAccepted.assign(nWavelengthCells*nCounters,0);
+  for(size_t cell=0; cell<nWavelengthCells; cell++){
+    for(size_t i=0; i<nCounters; i++){
+      float const min_w = fWavelengthRanges[i][0], max_w = fWavelengthRanges[i][1];
+      fWavelengthCellAccepted[cell*nCounters+i] =
+	cellInside(fWavelengthBoundaries,cell,
+		   [&](float w){ return w >= min_w && w <= max_w; },
+		   [&](float lo, float hi){ return lo >= min_w && hi <= max_w; });
+    }
+  }
+}
+
+size_t opdet::SimPhotonCounterAlg::Cell(std::vector<float> const& boundaries, float x)
+{
+  size_t const k = std::lower_bound(boundaries.begin(),boundaries.end(),x) - boundaries.begin();
+  return (k < boundaries.size() && boundaries[k] == x)? 2*k+1 : 2*k;
+}
+
 void opdet::SimPhotonCounterAlg::InitializeCounters(geo::GeometryCore const& geo,
 						    opdet::OpDigiProperties const& opdigip)
 {
-  fCounters.resize(fTimeRanges.size());
   art::ServiceHandle<opdet::OpDetResponseInterface const> odresponse;
+  InitializeCounters(std::vector<float>(odresponse->NOpChannels(),opdigip.QE()));
+}
+
+void opdet::SimPhotonCounterAlg::InitializeCounters(std::vector<float> const& qeVector)
+{
+  fCounters.resize(fTimeRanges.size());
   for(size_t i=0; i<fCounters.size(); i++)
     fCounters[i] = SimPhotonCounter(fTimeRanges[i][0],fTimeRanges[i][1],
 				    fTimeRanges[i][2],fTimeRanges[i][3],
 				    fWavelengthRanges[i][0],fWavelengthRanges[i][1],
-				    std::vector<float>(odresponse->NOpChannels(),opdigip.QE()));
+				    qeVector);
+
+  fNOpDets = qeVector.size();
+  fPromptCounts.assign(fCounters.size()*fNOpDets,0.0);
+  fLateCounts.assign(fCounters.size()*fNOpDets,0.0);
+  fQE.clear();
+  for(size_t i=0; i<fCounters.size(); i++)
+    fQE.insert(fQE.end(),qeVector.begin(),qeVector.end());
+  fCountersUpToDate = true;
 }
 
 void opdet::SimPhotonCounterAlg::AddSimPhotonCollection(sim::SimPhotonsCollection const& ph_col)
@@ -70,34 +152,104 @@ void opdet::SimPhotonCounterAlg::AddSimPhotonCollection(sim::SimPhotonsCollectio
     throw std::runtime_error("ERROR in SimPhotonCounterAlg: Photon collection size and OpDet size not equal.");
 
   for(auto const& photons : ph_col)
-    for(auto & counter : fCounters)
-      counter.AddSimPhotons(photons.second);
+    AddSimPhotons(photons.second);
 }
 
 void opdet::SimPhotonCounterAlg::AddSimPhotonsVector(std::vector<sim::SimPhotons> const& spv)
 {
   for(auto const& photons : spv)
-    for(auto & counter : fCounters)
-      counter.AddSimPhotons(photons);
+    AddSimPhotons(photons);
+}
+
+void opdet::SimPhotonCounterAlg::AddSimPhotons(sim::SimPhotons const& photons)
+{
+  size_t const nCounters = fCounters.size();
+  if(nCounters == 0 || photons.empty()) return;
+
+  size_t const i_opdet = photons.OpChannel();
+  if(i_opdet >= fNOpDets)
+    throw std::runtime_error("ERROR in SimPhotonCounter: Opdet requested out of range!");
+
+  fCountersUpToDate = false;
+
+  if(nCounters == 1){
+    // a single range: compare directly, as SimPhotonCounter::AddOnePhoton
+    float const min_w = fWavelengthRanges[0][0], max_w = fWavelengthRanges[0][1];
+    float const t_p1 = fTimeRanges[0][0], t_p2 = fTimeRanges[0][1];
+    float const t_l1 = fTimeRanges[0][2], t_l2 = fTimeRanges[0][3];
+    float const qe = fQE[i_opdet];
+    float prompt = fPromptCounts[i_opdet];
+    float late = fLateCounts[i_opdet];
+
+    for(auto const& photon : photons){
+      float const wavelength = SimPhotonCounter::Wavelength(photon);
+      if(wavelength < min_w || wavelength > max_w) continue;
+
+      if(photon.Time > t_p1 && photon.Time <= t_p2)
+	prompt += qe;
+      else if(photon.Time > t_l1 && photon.Time < t_l2)
+	late += qe;
+    }
+
+    fPromptCounts[i_opdet] = prompt;
+    fLateCounts[i_opdet] = late;
+    return;
+  }
+
+  for(auto const& photon : photons){
+    float const wavelength = SimPhotonCounter::Wavelength(photon);
+    // a NaN wavelength is outside of no wavelength range
+    bool const anyWavelength = std::isnan(wavelength);
+    unsigned char const* accepted =
+      &fWavelengthCellAccepted[Cell(fWavelengthBoundaries,wavelength)*nCounters];
+
+    size_t const timeCell = Cell(fTimeBoundaries,photon.Time);
+    for(size_t e=fTimeCellOffsets[timeCell]; e<fTimeCellOffsets[timeCell+1]; e++){
+      unsigned int const entry = fTimeCellEntries[e];
+      unsigned int const i = entry/2;
+      if(!anyWavelength && !accepted[i]) continue;
+      size_t const index = i*fNOpDets + i_opdet;
+      ((entry%2 == 1)? fLateCounts[index] : fPromptCounts[index]) += fQE[index];
+    }
+  }
+}
+
+void opdet::SimPhotonCounterAlg::UpdateCounters()
+{
+  if(fCountersUpToDate) return;
+
+  for(size_t i=0; i<fCounters.size(); i++){
+    std::copy(fPromptCounts.begin() + i*fNOpDets, fPromptCounts.begin() + (i+1)*fNOpDets,
+	      fCounters[i]._photonVector_prompt.begin());
+    std::copy(fLateCounts.begin() + i*fNOpDets, fLateCounts.begin() + (i+1)*fNOpDets,
+	      fCounters[i]._photonVector_late.begin());
+  }
+  fCountersUpToDate = true;
 }
 
 void opdet::SimPhotonCounterAlg::ClearCounters()
 {
+  std::fill(fPromptCounts.begin(),fPromptCounts.end(),0.0);
+  std::fill(fLateCounts.begin(),fLateCounts.end(),0.0);
   for(auto & counter : fCounters)
     counter.ClearVectors();
+  fCountersUpToDate = true;
 }
 
 std::vector<float> const& opdet::SimPhotonCounterAlg::PromptPhotonVector(size_t i)
 {
+  UpdateCounters();
   return fCounters.at(i).PromptPhotonVector();
 }
 
 std::vector<float> const& opdet::SimPhotonCounterAlg::LatePhotonVector(size_t i)
 {
+  UpdateCounters();
   return fCounters.at(i).LatePhotonVector();
 }
 
 opdet::SimPhotonCounter const& opdet::SimPhotonCounterAlg::GetSimPhotonCounter(size_t i)
 {
+  UpdateCounters();
   return fCounters.at(i);
 }
@@ -25,6 +25,8 @@ namespace opdet{
 
     void InitializeCounters(geo::GeometryCore const&,
 			    opdet::OpDigiProperties const&);
+    /// Counters over qeVector.size() OpDets, with those efficiencies
+    void InitializeCounters(std::vector<float> const& qeVector);
 
     void AddSimPhotonCollection(sim::SimPhotonsCollection const&);
     void AddSimPhotonsVector(std::vector<sim::SimPhotons> const&);
@@ -44,6 +46,30 @@ namespace opdet{
     void FillAllRanges(std::vector<fhicl::ParameterSet> const&);
     void FillRanges(fhicl::ParameterSet const&);
 
+    // Each photon is classified once for all the counters. The sorted time
+    // (wavelength) boundaries of all the ranges split that axis in cells:
+    // each boundary value is a cell, and so is each gap between two of
+    // them. A cell is either all inside or all outside any range.
+    std::vector<float>        fTimeBoundaries;
+    std::vector<size_t>       fTimeCellOffsets;  // entries of each time cell
+    std::vector<unsigned int> fTimeCellEntries;  // counter*2 + (1 if late)
+    std::vector<float>        fWavelengthBoundaries;
+    std::vector<unsigned char> fWavelengthCellAccepted; // [cell*counters + counter]
+
+    // Prompt and late counts and QE of all the counters, each in one
+    // [counter x OpDet] block: counter i, OpDet j is at i*fNOpDets + j.
+    // The SimPhotonCounter objects get a copy when they are asked for.
+    size_t                    fNOpDets = 0;
+    std::vector<float>        fPromptCounts;
+    std::vector<float>        fLateCounts;
+    std::vector<float>        fQE;
+    bool                      fCountersUpToDate = true;
+
+    void BuildCells();
+    void AddSimPhotons(sim::SimPhotons const&);
+    void UpdateCounters();
+    static size_t Cell(std::vector<float> const& boundaries, float x);
+
   };
 
 }
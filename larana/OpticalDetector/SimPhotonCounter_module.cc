@@ -11,6 +11,15 @@
 // AllPhotons      - wavelength information for each phot hitting the OpDet face
 // DetectedPhotons - wavelength information for each phot detected
 //
+// and, in counting mode, one more tree:
+//
+// OpDetSummary    - for each event, how many phots hit / were detected in each OpDet,
+//                   per arrival time bin and wavelength class (ultraviolet or visible);
+//                   phots arriving outside the time bins are not counted
+//
+// The two per phot trees are filled once per phot; jobs which only need the counts
+// can switch them off and read the summary instead.
+//
 // The user may supply a quantum efficiency and sensitive wavelength range for the OpDet's.
 // with a QE < 1 and a finite wavelength range, a "detected" phot is one which is
 // in the relevant wavelength range and passes the random sampling condition imposed by
@@ -23,6 +32,10 @@
 // bool    MakeDetectedPhotonsTree
 // bool    MakeOpDetsTree
 // bool    MakeOpDetEventsTree
+// bool    MakeOpDetSummaryTree - counting mode (default false)
+// double  SummaryMinTime       - start of the time bins of the summary [ns] (default 0)
+// double  SummaryTimeBinWidth  - width of the time bins of the summary [ns] (default 10)
+// int32   SummaryNTimeBins     - number of time bins of the summary (default 500)
 // double  QantumEfficiency   - Quantum efficiency of OpDet
 // double  WavelengthCutLow   - Sensitive wavelength range of OpDet
 // double  WavelengthCutHigh
@@ -39,6 +52,8 @@
 
 // LArSoft includes
 #include "larana/OpticalDetector/OpDetResponseInterface.h"
+#include "larana/OpticalDetector/SimPhotonCountHistogram.h"
+#include "larana/OpticalDetector/TrackOpChannelSignals.h"
 #include "larcore/Geometry/Geometry.h"
 #include "larcorealg/Geometry/CryostatGeo.h"
 #include "larcorealg/Geometry/OpDetGeo.h"
@@ -53,6 +68,9 @@
 #include "nug4/ParticleNavigation/ParticleList.h"
 #include "nusimdata/SimulationBase/MCParticle.h"
 
+// CLHEP includes
+#include "CLHEP/Random/Random.h"
+
 // ROOT includes
 #include "RtypesCore.h"
 #include "TH1D.h"
@@ -61,9 +79,12 @@
 #include "TVector3.h"
 
 // C++ language includes
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <cassert>
+#include <memory>
+#include <unordered_map>
 
 namespace opdet {
 
@@ -94,6 +115,7 @@ namespace opdet {
       TTree * fThePhotonTreeDetected;
       TTree * fTheOpDetTree;
       TTree * fTheEventTree;
+      TTree * fTheOpDetSummaryTree;
 
 
       // Parameters to read in
@@ -106,6 +128,11 @@ namespace opdet {
       bool fMakeAllPhotonsTree;      //
       bool fMakeOpDetsTree;         // Switches to turn on or off each output
       bool fMakeOpDetEventsTree;          //
+      bool fMakeOpDetSummaryTree;    //
+
+      float fSummaryMinTime;         // Time binning of the OpDetSummary tree
+      float fSummaryTimeBinWidth;    //
+      unsigned int fSummaryNTimeBins; //
 
     //  float fQE;                     // Quantum efficiency of tube
 
@@ -133,10 +160,19 @@ namespace opdet {
       Int_t fEventID;
       Int_t fOpChannel;
 
+      // Counts of the event, for the summary tree
+      std::unique_ptr<SimPhotonCountHistogram> fPhotonCounts;
+      std::vector<float> fPhotonWavelengths;
+      std::vector<SimPhotonCountHistogram::WavelengthClass_t> fPhotonClasses;
+      std::vector<char> fPhotonDetected;
+      Int_t fSummaryNTimeBinsBranch;
+      std::vector<unsigned int> fSummaryCountAll;
+      std::vector<unsigned int> fSummaryCountDetected;
+
       //for the analysis tree of the light (gamez)
       bool fMakeLightAnalysisTree;
-      std::vector<std::vector<std::vector<double> > > fSignals_vuv;
-      std::vector<std::vector<std::vector<double> > > fSignals_vis;
+      TrackOpChannelSignals fSignals_vuv;
+      TrackOpChannelSignals fSignals_vis;
 
       TTree * fLightAnalysisTree = nullptr;
       int fRun, fTrackID, fpdg, fmotherTrackID;
@@ -188,6 +224,10 @@ namespace opdet {
     fMakeDetectedPhotonsTree=  pset.get<bool>("MakeDetectedPhotonsTree");
     fMakeOpDetsTree=           pset.get<bool>("MakeOpDetsTree");
     fMakeOpDetEventsTree=      pset.get<bool>("MakeOpDetEventsTree");
+    fMakeOpDetSummaryTree=     pset.get<bool>("MakeOpDetSummaryTree", false);
+    fSummaryMinTime=           pset.get<float>("SummaryMinTime", 0.);
+    fSummaryTimeBinWidth=      pset.get<float>("SummaryTimeBinWidth", 10.);
+    fSummaryNTimeBins=         pset.get<unsigned int>("SummaryNTimeBins", 500);
     fMakeLightAnalysisTree=    pset.get<bool>("MakeLightAnalysisTree", false);
     //fQE=                       pset.get<double>("QuantumEfficiency");
     //fWavelengthCutLow=         pset.get<double>("WavelengthCutLow");
@@ -275,6 +315,20 @@ namespace opdet {
 
     }
 
+    if(fMakeOpDetSummaryTree)
+    {
+      fPhotonCounts = std::make_unique<SimPhotonCountHistogram>(
+        geo->NOpChannels(), fSummaryMinTime, fSummaryTimeBinWidth, fSummaryNTimeBins);
+      fSummaryNTimeBinsBranch = fPhotonCounts->NTimeBins();
+
+      fTheOpDetSummaryTree = tfs->make<TTree>("OpDetSummary","OpDetSummary");
+      fTheOpDetSummaryTree->Branch("EventID",       &fEventID,                "EventID/I");
+      fTheOpDetSummaryTree->Branch("NTimeBins",     &fSummaryNTimeBinsBranch, "NTimeBins/I");
+      // indexed by (OpChannel * NTimeBins + time bin) * 2 + (0 for ultraviolet, 1 for visible)
+      fTheOpDetSummaryTree->Branch("CountAll",      &fSummaryCountAll);
+      fTheOpDetSummaryTree->Branch("CountDetected", &fSummaryCountDetected);
+    }
+
     //generating the tree for the light analysis:
     if(fMakeLightAnalysisTree)
     {
@@ -320,23 +374,17 @@ namespace opdet {
     // GEANT4 info on the particles (only used if making light analysis tree)
     std::vector<simb::MCParticle> const* mcpartVec = nullptr;
 
+    if(fPhotonCounts) fPhotonCounts->Clear();
+
     //-------------------------initializing light tree vectors------------------------
-    std::vector<double> totalEnergy_track;
+    std::unordered_map<int, double> totalEnergy_track; // keyed by track ID
     fstepPositions.clear();
     fstepTimes.clear();
     if (fMakeLightAnalysisTree) {
       mcpartVec = evt.getPointerByLabel<std::vector<simb::MCParticle>>("largeant");
 
-      size_t maxNtracks = 1000U; // mcpartVec->size(); --- { to be fixed soon! ]
-      fSignals_vuv.clear();
-      fSignals_vuv.resize(maxNtracks);
-      fSignals_vis.clear();
-      fSignals_vis.resize(maxNtracks);
-      for(size_t itrack=0; itrack!=maxNtracks; itrack++) {
-        fSignals_vuv[itrack].resize(geo->NOpChannels());
-        fSignals_vis[itrack].resize(geo->NOpChannels());
-      }
-      totalEnergy_track.resize(maxNtracks, 0.);
+      fSignals_vuv.Clear();
+      fSignals_vis.Clear();
       //-------------------------stimation of dedx per trackID----------------------
       //get the list of particles from this event
       const sim::ParticleList* plist = pi_serv? &(pi_serv->ParticleList()): nullptr;
@@ -410,13 +458,8 @@ namespace opdet {
           {
             if(fMakeLightAnalysisTree) {
             //resetting the signalt to save in the analysis tree per event
-              const int maxNtracks = 1000;
-              for(size_t itrack=0; itrack!=maxNtracks; itrack++) {
-                for(size_t pmt_i=0; pmt_i!=geo->NOpChannels(); pmt_i++) {
-                  fSignals_vuv[itrack][pmt_i].clear();
-                  fSignals_vis[itrack][pmt_i].clear();
-                }
-              }
+              fSignals_vuv.Clear();
+              fSignals_vis.Clear();
             }
           }
 
@@ -448,14 +491,24 @@ namespace opdet {
               //   if conditions.
 
 
-              for(const sim::OnePhoton& Phot: TheHit)
+              // Calculate wavelengths in nm, then classify all the phots at once
+              fPhotonWavelengths.resize(TheHit.size());
+              for(size_t iPhot = 0; iPhot < TheHit.size(); iPhot++)
+                fPhotonWavelengths[iPhot] = odresponse->wavelength(TheHit[iPhot].Energy);
+              SimPhotonCountHistogram::ClassifyWavelengths(fPhotonWavelengths, fPhotonClasses);
+              odresponse->detectedBatch(fOpChannel, TheHit, fPhotonDetected);
+
+              for(size_t iPhot = 0; iPhot < TheHit.size(); iPhot++)
               {
-                // Calculate wavelength in nm
-                fWavelength= odresponse->wavelength(Phot.Energy);
+                const sim::OnePhoton& Phot = TheHit[iPhot];
+                fWavelength= fPhotonWavelengths[iPhot];
 
                 //Get arrival time from phot
                 fTime= Phot.Time;
 
+                const bool detected = fPhotonDetected[iPhot];
+                if(fPhotonCounts) fPhotonCounts->Add(fOpChannel, fTime, fPhotonClasses[iPhot], 1, detected);
+
                 // special case for LibraryBuildJob: no working "Reflected" handle and all photons stored in single object - must sort using wavelength instead
                 if(fPVS->IsBuildJob() && !Reflected) {
                   // all photons contained in object with Reflected = false flag
@@ -467,7 +520,7 @@ namespace opdet {
                     }
                   }
 
-                  if(odresponse->detected(fOpChannel, Phot))
+                  if(detected)
                   {
                     if(fMakeDetectedPhotonsTree) fThePhotonTreeDetected->Fill();
                     //only store direct direct light
@@ -500,7 +553,7 @@ namespace opdet {
                     }
                   }
 
-                  if(odresponse->detected(fOpChannel, Phot))
+                  if(detected)
                   {
                     if(fMakeDetectedPhotonsTree) fThePhotonTreeDetected->Fill();
                     //only store direct direct light
@@ -578,9 +631,10 @@ namespace opdet {
               fTrackID = pPart.TrackId();
               fpdg = pPart.PdgCode();
               fmotherTrackID = pPart.Mother();
-              fdEdx = totalEnergy_track[fTrackID];
-              fSignalsvuv = fSignals_vuv[fTrackID];
-              fSignalsvis = fSignals_vis[fTrackID];
+              auto const itEnergy = totalEnergy_track.find(fTrackID);
+              fdEdx = (itEnergy == totalEnergy_track.end())? 0. : itEnergy->second;
+              fSignals_vuv.Fill(fTrackID, geo->NOpChannels(), fSignalsvuv);
+              fSignals_vis.Fill(fTrackID, geo->NOpChannels(), fSignalsvis);
               fProcess = pPart.Process();
               //filling the center positions of each step
               for(size_t i_s=1; i_s < pPart.NumberTrajectoryPoints(); i_s++){
@@ -635,7 +689,7 @@ namespace opdet {
             {
               //Get data from HitCollection entry
               fOpChannel=photon.OpChannel;
-              std::map<int, int> PhotonsMap = photon.DetectedPhotons;
+              std::map<int, int> const& PhotonsMap = photon.DetectedPhotons;
 
               //Reset Counters
               fCountOpDetAll=0;
@@ -656,7 +710,17 @@ namespace opdet {
                 fTime= it->first;
                 //std::cout<<"Arrival time: " << fTime<<std::endl;
 
-                for(int i = 0; i < it->second ; i++)
+                unsigned int nDetected = 0;
+                if(!fMakeAllPhotonsTree && !fMakeDetectedPhotonsTree && fVerbosity <= 3)
+                {
+                  // Nothing is done per photon: only count them
+                  int const nPhotons = std::max(it->second, 0);
+                  nDetected = odresponse->detectedLiteCount(fOpChannel, nPhotons, *CLHEP::HepRandom::getTheEngine());
+                  fCountOpDetAll += nPhotons;
+                  if (!Reflected) fCountOpDetDetected += nDetected;
+                  else fCountOpDetReflDetected += nDetected;
+                }
+                else for(int i = 0; i < it->second ; i++)
                 {
                   // Increment per OpDet counters and fill per phot trees
                   fCountOpDetAll++;
@@ -664,6 +728,7 @@ namespace opdet {
 
                   if(odresponse->detectedLite(fOpChannel))
                   {
+                    nDetected++;
                     if(fMakeDetectedPhotonsTree) fThePhotonTreeDetected->Fill();
                     // direct light
                     if (!Reflected){
@@ -681,6 +746,11 @@ namespace opdet {
                     std::cout<<"OpDetResponseInterface PerPhoton : Event "<<fEventID<<" OpChannel " <<fOpChannel << " Wavelength " << fWavelength << " Detected 0 "<<std::endl;
                     }
                 }
+                if(fPhotonCounts && it->second > 0) {
+                  fPhotonCounts->Add(fOpChannel, fTime,
+                                     Reflected? SimPhotonCountHistogram::kVisible : SimPhotonCountHistogram::kVUV,
+                                     it->second, nDetected);
+                }
               }
 
 
@@ -713,6 +783,14 @@ namespace opdet {
         }
       }
     }
+
+    // Fill the summary tree, once per event
+    if(fMakeOpDetSummaryTree)
+    {
+      fSummaryCountAll = fPhotonCounts->AllCounts();
+      fSummaryCountDetected = fPhotonCounts->DetectedCounts();
+      fTheOpDetSummaryTree->Fill();
+    }
   } // SimPhotonCounter::analyze()
 
 
@@ -0,0 +1,63 @@
+#ifndef TRACKOPCHANNELSIGNALS_H
+#define TRACKOPCHANNELSIGNALS_H
+
+/*!
+ * Title:   TrackOpChannelSignals Class
+ *
+ * Description: Photon arrival times per (track, optical channel), stored
+ *              only for the pairs which have some. The times are kept in
+ *              one vector, sorted by track and channel on the first query;
+ *              each track then maps to its range in there.
+*/
+
+#include <algorithm>
+#include <vector>
+
+namespace opdet{
+
+  class TrackOpChannelSignals{
+
+  public:
+    void Clear() { fEntries.clear(); fSorted = true; }
+
+    bool empty() const { return fEntries.empty(); }
+
+    void Add(int trackID, int channel, double time)
+    {
+      fEntries.push_back({trackID, channel, time});
+      fSorted = false;
+    }
+
+    /// Sets signals to the times of the track on each of the nChannels
+    /// channels, in the order they were added
+    void Fill(int trackID, size_t nChannels, std::vector<std::vector<double> >& signals)
+    {
+      signals.assign(nChannels, {});
+      if(!fSorted){
+        std::stable_sort(fEntries.begin(), fEntries.end(),
+                         [](Entry const& a, Entry const& b){
+                           return (a.TrackID != b.TrackID)? (a.TrackID < b.TrackID) : (a.Channel < b.Channel);
+                         });
+        fSorted = true;
+      }
+      auto it = std::lower_bound(fEntries.begin(), fEntries.end(), trackID,
+                                 [](Entry const& e, int id){ return e.TrackID < id; });
+      for(; it != fEntries.end() && it->TrackID == trackID; ++it)
+        if(it->Channel >= 0 && (size_t)it->Channel < nChannels)
+          signals[it->Channel].push_back(it->Time);
+    }
+
+  private:
+    struct Entry{
+      int TrackID;
+      int Channel;
+      double Time;
+    };
+    std::vector<Entry> fEntries;
+    bool fSorted = true;
+
+  };
+
+}
+
+#endif
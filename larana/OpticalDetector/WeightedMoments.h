@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////
+// \file WeightedMoments.h
+//
+// \brief sums of weights, weighted coordinates and weighted squared
+//        coordinates (PE-weighted centroids and widths of flashes)
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef OPDET_WEIGHTEDMOMENTS_H
+#define OPDET_WEIGHTEDMOMENTS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace opdet {
+
+  /// Sum of the weights, and sums of w*x and w*x*x for each of N
+  /// coordinates, accumulated in T (float or double)
+  template <typename T, std::size_t N = 1>
+  struct WeightedMoments {
+    T SumW = 0;
+    std::array<T, N> SumWX{};
+    std::array<T, N> SumWX2{};
+
+    /// Adds one entry of weight w at coordinates x
+    template <typename W, typename X>
+    void Add(W w, std::array<X, N> const& x)
+    {
+      SumW += w;
+      for (std::size_t c = 0; c < N; ++c) {
+        T const wx = T(w) * T(x[c]);
+        SumWX[c] += wx;
+        SumWX2[c] += wx * T(x[c]);
+      }
+    }
+
+    WeightedMoments& operator+=(WeightedMoments const& other)
+    {
+      SumW += other.SumW;
+      for (std::size_t c = 0; c < N; ++c) {
+        SumWX[c] += other.SumWX[c];
+        SumWX2[c] += other.SumWX2[c];
+      }
+      return *this;
+    }
+
+    /// Weighted mean of coordinate c
+    T Mean(std::size_t c = 0) const { return SumWX[c] / SumW; }
+
+    /// Sum of w*(x-mean)^2 of coordinate c; rounding may not make it negative
+    T SumWDev2(std::size_t c = 0) const
+    {
+      return std::max(SumWX2[c] - SumWX[c] * SumWX[c] / SumW, T(0));
+    }
+
+    /// Weighted standard deviation of coordinate c
+    T Width(std::size_t c = 0) const { return std::sqrt(SumWDev2(c) / SumW); }
+  };
+
+  /// Adds n entries to m: weight w[i] at coordinates x[0][i] ... x[N-1][i].
+  /// The sums are split in a few independent lanes, so that the loop does
+  /// not wait on a single chain of additions and can be vectorized; the
+  /// lanes are added together at the end, in a fixed order.
+  template <typename T, std::size_t N, typename W, typename X>
+  void AccumulateMoments(std::size_t n,
+                         W const* w,
+                         std::array<X const*, N> const& x,
+                         WeightedMoments<T, N>& m)
+  {
+    constexpr std::size_t L = 4;
+    T sw[L] = {};
+    T swx[N][L] = {};
+    T swx2[N][L] = {};
+
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+      for (std::size_t l = 0; l < L; ++l)
+        sw[l] += T(w[i + l]);
+      for (std::size_t c = 0; c < N; ++c) {
+        X const* xc = x[c] + i;
+        for (std::size_t l = 0; l < L; ++l) {
+          T const wx = T(w[i + l]) * T(xc[l]);
+          swx[c][l] += wx;
+          swx2[c][l] += wx * T(xc[l]);
+        }
+      }
+    }
+    for (std::size_t l = 0; i < n; ++i, ++l) {
+      sw[l] += T(w[i]);
+      for (std::size_t c = 0; c < N; ++c) {
+        T const wx = T(w[i]) * T(x[c][i]);
+        swx[c][l] += wx;
+        swx2[c][l] += wx * T(x[c][i]);
+      }
+    }
+
+    m.SumW += (sw[0] + sw[1]) + (sw[2] + sw[3]);
+    for (std::size_t c = 0; c < N; ++c) {
+      m.SumWX[c] += (swx[c][0] + swx[c][1]) + (swx[c][2] + swx[c][3]);
+      m.SumWX2[c] += (swx2[c][0] + swx2[c][1]) + (swx2[c][2] + swx2[c][3]);
+    }
+  }
+
+} // namespace opdet
+
+#endif
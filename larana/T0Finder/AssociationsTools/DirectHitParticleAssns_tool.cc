@@ -1,4 +1,5 @@
 #include "larana/T0Finder/AssociationsTools/IHitParticleAssociations.h"
+#include "larana/T0Finder/AssociationsTools/TrackIDEMatching.h"
 
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
@@ -48,11 +49,7 @@ namespace t0 {
     std::vector<art::InputTag> fHitModuleLabelVec;
     art::InputTag fMCParticleModuleLabel;
 
-    struct TrackIDEinfo {
-      float E;
-      float NumElectrons;
-    };
-    std::unordered_map<int, TrackIDEinfo> fTrkIDECollector;
+    HitTrackIDECollector fTrkIDECollector;
   };
 
   //----------------------------------------------------------------------------
@@ -106,6 +103,9 @@ namespace t0 {
     auto const clockData =
       art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(evt);
 
+    // Geant4 track ID -> MCParticle position, built once for all the hits
+    MCParticleIndex const trkid_lookup(*mcpartHandle);
+
     // Loop over input hit producer labels
     for (const auto& inputTag : fHitModuleLabelVec) {
       art::Handle<std::vector<recob::Hit>> hitListHandle;
@@ -117,71 +117,21 @@ namespace t0 {
         continue;
       }
 
-      anab::BackTrackerHitMatchingData bthmd;
-      std::unordered_map<int, int>
-        trkid_lookup; //indexed by geant4trkid, delivers MC particle location
-
       auto const& hitList(*hitListHandle);
-      auto const& mcpartList(*mcpartHandle);
 
       for (size_t i_h = 0; i_h < hitList.size(); ++i_h) {
         art::Ptr<recob::Hit> hitPtr(hitListHandle, i_h);
 
-        auto trkide_list = btService->HitToTrackIDEs(clockData, hitPtr);
-
-        double maxe(-1.);
-        double tote(0.);
-        int maxtrkid(-1);
-        double maxn(-1.);
-        double totn(0.);
-        int maxntrkid(-1);
-
-        fTrkIDECollector.clear();
-
-        //for(auto const& t : trkide_list){
-        for (size_t i_t = 0; i_t < trkide_list.size(); ++i_t) {
-          auto const& t(trkide_list[i_t]);
-          fTrkIDECollector[t.trackID].E += t.energy;
-          tote += t.energy;
-          if (fTrkIDECollector[t.trackID].E > maxe) {
-            maxe = fTrkIDECollector[t.trackID].E;
-            maxtrkid = t.trackID;
-          }
-          fTrkIDECollector[t.trackID].NumElectrons += t.numElectrons;
-          totn += t.numElectrons;
-          if (fTrkIDECollector[t.trackID].NumElectrons > maxn) {
-            maxn = fTrkIDECollector[t.trackID].NumElectrons;
-            maxntrkid = t.trackID;
-          }
-
-          //if not found, find mc particle...
-          if (trkid_lookup.find(t.trackID) == trkid_lookup.end()) {
-            size_t i_p = 0;
-            while (i_p < mcpartList.size()) {
-              if (mcpartList[i_p].TrackId() == abs(t.trackID)) {
-                trkid_lookup[t.trackID] = (int)i_p;
-                break;
-              }
-              ++i_p;
-            }
-            if (i_p == mcpartList.size()) trkid_lookup[t.trackID] = -1;
-          }
-        }
-        //end loop on TrackIDs
+        fTrkIDECollector.Fill(btService->HitToTrackIDEs(clockData, hitPtr));
 
         //now find the mcparticle and loop back through ...
-        for (auto const& t : fTrkIDECollector) {
-          int mcpart_i = trkid_lookup[t.first];
-          if (mcpart_i == -1) continue; //no mcparticle here
-          art::Ptr<simb::MCParticle> mcpartPtr(mcpartHandle, mcpart_i);
-          bthmd.ideFraction = t.second.E / tote;
-          bthmd.isMaxIDE = (t.first == maxtrkid);
-          bthmd.ideNFraction = t.second.NumElectrons / totn;
-          bthmd.isMaxIDEN = (t.first == maxntrkid);
-          bthmd.energy = t.second.E;
-          bthmd.numElectrons = t.second.NumElectrons;
-          hitPartAssns->addSingle(mcpartPtr, hitPtr, bthmd);
-        }
+        fTrkIDECollector.ForEachMatch(
+          [&](int trackID, anab::BackTrackerHitMatchingData const& bthmd) {
+            int mcpart_i = trkid_lookup.Find(abs(trackID));
+            if (mcpart_i == -1) return; //no mcparticle here
+            art::Ptr<simb::MCParticle> mcpartPtr(mcpartHandle, mcpart_i);
+            hitPartAssns->addSingle(mcpartPtr, hitPtr, bthmd);
+          });
 
       } //end loop on hits
     }   // end loop on producers
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////
+///
+/// \file  HitTickIntervals.h
+/// \brief Overlap queries between the tick ranges of hits on one channel
+///
+////////////////////////////////////////////////////////////////////////
+#ifndef HITTICKINTERVALS_H
+#define HITTICKINTERVALS_H
+
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace t0 {
+
+  /// First and last tick covered by a hit extending from lowTime to highTime,
+  /// the ticks visited by `for (TDCtick_t tick = lowTime; tick <= highTime; ++tick)`.
+  /// The range is empty when first > last.
+  inline std::pair<raw::TDCtick_t, raw::TDCtick_t>
+  HitTickRange(float lowTime, float highTime)
+  {
+    return {static_cast<raw::TDCtick_t>(lowTime),
+            static_cast<raw::TDCtick_t>(std::floor(highTime))};
+  }
+
+  /// Tick ranges on one channel, each with a payload, sorted by first tick.
+  /// Each range also records the largest last tick of the ranges up to it,
+  /// so an overlap query starts with a binary search and then only scans
+  /// ranges that can still reach the queried ticks.
+  template <typename Payload>
+  class HitTickIntervals {
+  public:
+    /// Adds the ticks first to last (inclusive); empty ranges are ignored
+    void Add(raw::TDCtick_t first, raw::TDCtick_t last, Payload const& payload)
+    {
+      if (first <= last) fIntervals.push_back({first, last, last, payload});
+    }
+
+    /// Sorts the ranges; call after the last Add() and before any query
+    void Sort()
+    {
+      std::stable_sort(
+        fIntervals.begin(), fIntervals.end(), [](Interval const& a, Interval const& b) {
+          return a.First < b.First;
+        });
+      raw::TDCtick_t maxLast = 0;
+      for (size_t i = 0; i < fIntervals.size(); ++i) {
+        maxLast = (i == 0) ? fIntervals[i].Last : std::max(maxLast, fIntervals[i].Last);
+        fIntervals[i].MaxLast = maxLast;
+      }
+    }
+
+    bool empty() const { return fIntervals.empty(); }
+
+    /// Calls func(payload) for each range sharing at least a tick with first to last
+    template <typename Func>
+    void ForEachOverlap(raw::TDCtick_t first, raw::TDCtick_t last, Func&& func) const
+    {
+      if (first > last) return;
+
+      // ranges before this one all end before the queried ticks
+      auto it = std::partition_point(fIntervals.begin(),
+                                     fIntervals.end(),
+                                     [first](Interval const& i) { return i.MaxLast < first; });
+
+      for (; it != fIntervals.end() && it->First <= last; ++it)
+        if (it->Last >= first) func(it->Data);
+    }
+
+  private:
+    struct Interval {
+      raw::TDCtick_t First;
+      raw::TDCtick_t Last;
+      raw::TDCtick_t MaxLast; ///< largest Last of this and all the earlier ranges
+      Payload Data;
+    };
+    std::vector<Interval> fIntervals;
+  };
+
+} // namespace t0
+
+#endif // HITTICKINTERVALS_H
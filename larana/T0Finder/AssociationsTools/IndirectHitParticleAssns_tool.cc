@@ -1,4 +1,5 @@
 #include "larana/T0Finder/AssociationsTools/IHitParticleAssociations.h"
+#include "larana/T0Finder/AssociationsTools/HitTickIntervals.h"
 
 #include "art/Framework/Principal/Handle.h"
 #include "art/Utilities/ToolMacros.h"
@@ -102,6 +103,30 @@ void IndirectHitParticleAssns::CreateHitParticleAssociations(art::Event& evt, Hi
         throw cet::exception("IndirectHitParticleAssns") << "===>> NO MCParticle <--> Hit associations found for run/subrun/event: " << evt.run() << "/" << evt.subRun() << "/" << evt.id().event();
     }
 
+    // Go through the associations and build out our (hopefully sparse) data structure:
+    // for each channel, the tick ranges of the associated hits with their particle
+    using ParticleDataPair          = std::pair<size_t, const anab::BackTrackerHitMatchingData*>;
+    using ChannelToPartDataRangeMap = std::unordered_map<raw::ChannelID_t, HitTickIntervals<ParticleDataPair>>;
+
+    ChannelToPartDataRangeMap chanToPartDataRangeMap;
+
+    // Build out the maps between hits/particles
+    for(HitParticleAssociations::const_iterator partHitItr = partHitAssnsHandle->begin(); partHitItr != partHitAssnsHandle->end(); ++partHitItr)
+    {
+        const art::Ptr<simb::MCParticle>&       mcParticle = partHitItr->first;
+        const art::Ptr<recob::Hit>&             recoHit    = partHitItr->second;
+        const anab::BackTrackerHitMatchingData* data       = &partHitAssnsHandle->data(partHitItr);
+
+        auto const ticks = HitTickRange(recoHit->PeakTimeMinusRMS(), recoHit->PeakTimePlusRMS());
+
+        chanToPartDataRangeMap[recoHit->Channel()].Add(ticks.first, ticks.second, ParticleDataPair(mcParticle.key(),data));
+    }
+
+    for(auto& chanPartDataRanges : chanToPartDataRangeMap) chanPartDataRanges.second.Sort();
+
+    // Keep track of results, sorted and without duplicates
+    std::vector<ParticleDataPair> particleDataVec;
+
     // Loop over input hit collections
     for(const auto& inputTag : fHitModuleLabelVec)
     {
@@ -114,58 +139,30 @@ void IndirectHitParticleAssns::CreateHitParticleAssociations(art::Event& evt, Hi
             continue;
         }
 
-        // Go through the associations and build out our (hopefully sparse) data structure
-        using ParticleDataPair         = std::pair<size_t, const anab::BackTrackerHitMatchingData*>;
-        using MCParticleDataSet        = std::set<ParticleDataPair>;
-        using TickToPartDataMap        = std::unordered_map<raw::TDCtick_t,   MCParticleDataSet>;
-        using ChannelToTickPartDataMap = std::unordered_map<raw::ChannelID_t, TickToPartDataMap>;
-        
-        ChannelToTickPartDataMap chanToTickPartDataMap;
-        
-        // Build out the maps between hits/particles
-        for(HitParticleAssociations::const_iterator partHitItr = partHitAssnsHandle->begin(); partHitItr != partHitAssnsHandle->end(); ++partHitItr)
-        {
-            const art::Ptr<simb::MCParticle>&       mcParticle = partHitItr->first;
-            const art::Ptr<recob::Hit>&             recoHit    = partHitItr->second;
-            const anab::BackTrackerHitMatchingData* data       = &partHitAssnsHandle->data(partHitItr);
-            
-            TickToPartDataMap& tickToPartDataMap = chanToTickPartDataMap[recoHit->Channel()];
-            
-            for(raw::TDCtick_t tick = recoHit->PeakTimeMinusRMS(); tick <= recoHit->PeakTimePlusRMS(); tick++)
-            {
-                tickToPartDataMap[tick].insert(ParticleDataPair(mcParticle.key(),data));
-            }
-        }
-        
         // Armed with the map, process the hit list
         for(size_t hitIdx = 0; hitIdx < hitListHandle->size(); hitIdx++)
         {
             art::Ptr<recob::Hit> hit(hitListHandle,hitIdx);
-            
-            TickToPartDataMap& tickToPartDataMap = chanToTickPartDataMap[hit->Channel()];
-            
-            if (tickToPartDataMap.empty())
+
+            ChannelToPartDataRangeMap::const_iterator chanItr = chanToPartDataRangeMap.find(hit->Channel());
+
+            if (chanItr == chanToPartDataRangeMap.end() || chanItr->second.empty())
             {
                 mf::LogInfo("IndirectHitParticleAssns") << "No channel information found for hit " << hit << "\n";
                 continue;
             }
-            
-            // Keep track of results
-            MCParticleDataSet particleDataSet;
-            
-            // Go through the ticks in this hit and recover associations
-            for(raw::TDCtick_t tick = hit->PeakTimeMinusRMS(); tick <= hit->PeakTimePlusRMS(); tick++)
-            {
-                TickToPartDataMap::iterator hitInfoItr = tickToPartDataMap.find(tick);
-                
-                if (hitInfoItr != tickToPartDataMap.end())
-                {
-                    for(const auto& partData : hitInfoItr->second) particleDataSet.insert(partData);
-                }
-            }
-            
+
+            // Recover the associations of the hits sharing a tick with this one
+            auto const ticks = HitTickRange(hit->PeakTimeMinusRMS(), hit->PeakTimePlusRMS());
+
+            particleDataVec.clear();
+            chanItr->second.ForEachOverlap(ticks.first, ticks.second, [&particleDataVec](const ParticleDataPair& partData){particleDataVec.push_back(partData);});
+
+            std::sort(particleDataVec.begin(), particleDataVec.end());
+            particleDataVec.erase(std::unique(particleDataVec.begin(), particleDataVec.end()), particleDataVec.end());
+
             // Now create new associations for the hit in question
-            for(const auto& partData : particleDataSet)
+            for(const auto& partData : particleDataVec)
                 hitPartAssns->addSingle(art::Ptr<simb::MCParticle>(mcParticleHandle, partData.first), hit, *partData.second);
         }
     }
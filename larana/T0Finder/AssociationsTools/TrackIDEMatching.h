@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////
+///
+/// \file  TrackIDEMatching.h
+/// \brief Helpers turning the TrackIDEs of a hit into hit <--> MCParticle
+///        matching data, independent of art and of the BackTracker
+///
+////////////////////////////////////////////////////////////////////////
+#ifndef TRACKIDEMATCHING_H
+#define TRACKIDEMATCHING_H
+
+#include "lardataobj/AnalysisBase/BackTrackerMatchingData.h"
+#include "lardataobj/Simulation/SimChannel.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace t0 {
+
+  /// Geant4 track ID --> position of the first MCParticle with that ID.
+  /// Track IDs are usually compact, so the table is a plain vector indexed
+  /// from the smallest ID; sparse IDs use a hash map instead.
+  class MCParticleIndex {
+  public:
+    /// Builds the table from any sequence of objects with a TrackId() method
+    template <typename ParticleList>
+    explicit MCParticleIndex(ParticleList const& mcpartList);
+
+    /// Returns the position of the particle for this track ID, -1 if none
+    int Find(int id) const
+    {
+      if (!fDense) {
+        auto const it = fSparseIndex.find(id);
+        return (it == fSparseIndex.end()) ? -1 : it->second;
+      }
+      // the offset may not fit an int when the smallest track ID is negative
+      long long const offset = static_cast<long long>(id) - fMinTrackID;
+      if (offset < 0 || offset >= static_cast<long long>(fDenseIndex.size())) return -1;
+      return fDenseIndex[offset];
+    }
+
+  private:
+    bool fDense = true;
+    int fMinTrackID = 0;
+    std::vector<int> fDenseIndex;
+    std::unordered_map<int, int> fSparseIndex;
+  };
+
+  template <typename ParticleList>
+  MCParticleIndex::MCParticleIndex(ParticleList const& mcpartList)
+  {
+    if (mcpartList.empty()) return;
+
+    int minID = mcpartList.begin()->TrackId();
+    int maxID = minID;
+    for (auto const& part : mcpartList) {
+      minID = std::min(minID, part.TrackId());
+      maxID = std::max(maxID, part.TrackId());
+    }
+
+    size_t const range = (size_t)((long long)maxID - minID) + 1;
+    fDense = (range <= 4 * mcpartList.size() + 1024);
+
+    int i_p = 0;
+    if (fDense) {
+      fMinTrackID = minID;
+      fDenseIndex.assign(range, -1);
+      for (auto const& part : mcpartList) {
+        int& index = fDenseIndex[part.TrackId() - minID];
+        if (index == -1) index = i_p;
+        ++i_p;
+      }
+    }
+    else {
+      fSparseIndex.reserve(mcpartList.size());
+      for (auto const& part : mcpartList)
+        fSparseIndex.emplace(part.TrackId(), i_p++); // keeps the first one
+    }
+  }
+
+  /// Sums the deposits of one hit per Geant4 track ID and produces the
+  /// BackTrackerHitMatchingData of each of those tracks
+  class HitTrackIDECollector {
+  public:
+    /// Resets the collector with the TrackIDEs of a new hit
+    template <typename TrackIDEList>
+    void Fill(TrackIDEList const& trkide_list);
+
+    /// Puts the track IDs of the hit in increasing order, as a
+    /// std::map<int, ...> keyed by track ID would have them
+    void SortByTrackID()
+    {
+      std::sort(fTrackIDEs.begin(),
+                fTrackIDEs.end(),
+                [](TrackIDEinfo const& a, TrackIDEinfo const& b) { return a.TrackID < b.TrackID; });
+    }
+
+    /// Calls func(trackID, matchData) for each track ID of the hit,
+    /// in order of first appearance in the TrackIDE list (or of track ID,
+    /// after SortByTrackID())
+    template <typename Func>
+    void ForEachMatch(Func&& func) const;
+
+  private:
+    struct TrackIDEinfo {
+      int TrackID;
+      float E;
+      float NumElectrons;
+    };
+    std::vector<TrackIDEinfo> fTrackIDEs;
+
+    double fTotE = 0.;
+    double fTotN = 0.;
+    int fMaxTrkID = -1;
+    int fMaxNTrkID = -1;
+  };
+
+  template <typename TrackIDEList>
+  void
+  HitTrackIDECollector::Fill(TrackIDEList const& trkide_list)
+  {
+    fTrackIDEs.clear();
+    fTotE = 0.;
+    fTotN = 0.;
+    fMaxTrkID = -1;
+    fMaxNTrkID = -1;
+
+    double maxe(-1.);
+    double maxn(-1.);
+
+    for (auto const& t : trkide_list) {
+      // a hit sees few tracks, so a linear search beats hashing
+      auto it = std::find_if(fTrackIDEs.begin(), fTrackIDEs.end(), [&t](TrackIDEinfo const& info) {
+        return info.TrackID == t.trackID;
+      });
+      if (it == fTrackIDEs.end()) it = fTrackIDEs.insert(it, TrackIDEinfo{t.trackID, 0.f, 0.f});
+
+      it->E += t.energy;
+      fTotE += t.energy;
+      if (it->E > maxe) {
+        maxe = it->E;
+        fMaxTrkID = t.trackID;
+      }
+      it->NumElectrons += t.numElectrons;
+      fTotN += t.numElectrons;
+      if (it->NumElectrons > maxn) {
+        maxn = it->NumElectrons;
+        fMaxNTrkID = t.trackID;
+      }
+    }
+  }
+
+  template <typename Func>
+  void
+  HitTrackIDECollector::ForEachMatch(Func&& func) const
+  {
+    anab::BackTrackerHitMatchingData bthmd;
+    for (auto const& t : fTrackIDEs) {
+      bthmd.ideFraction = t.E / fTotE;
+      bthmd.isMaxIDE = (t.TrackID == fMaxTrkID);
+      bthmd.ideNFraction = t.NumElectrons / fTotN;
+      bthmd.isMaxIDEN = (t.TrackID == fMaxNTrkID);
+      bthmd.energy = t.E;
+      bthmd.numElectrons = t.NumElectrons;
+      func(t.TrackID, bthmd);
+    }
+  }
+
+  /// TrackIDEs of the hits of an event, each hit backtracked only the first
+  /// time it is asked for. The lists are stored back to back in one vector.
+  template <typename Key>
+  class HitTrackIDECache {
+  public:
+    /// View of the TrackIDEs of one hit, valid until the next Get()
+    struct TrackIDERange {
+      sim::TrackIDE const* First;
+      sim::TrackIDE const* Last;
+      sim::TrackIDE const* begin() const { return First; }
+      sim::TrackIDE const* end() const { return Last; }
+    };
+
+    /// Returns the TrackIDEs of the hit, from backtrack() if not known yet
+    template <typename BackTrackFunc>
+    TrackIDERange Get(Key const& hitKey, BackTrackFunc&& backtrack)
+    {
+      auto it = fOffsets.find(hitKey);
+      if (it == fOffsets.end()) {
+        auto const& trkide_list = backtrack();
+        size_t const first = fTrackIDEs.size();
+        fTrackIDEs.insert(fTrackIDEs.end(), trkide_list.begin(), trkide_list.end());
+        it = fOffsets.emplace(hitKey, std::make_pair(first, fTrackIDEs.size())).first;
+      }
+      return {fTrackIDEs.data() + it->second.first, fTrackIDEs.data() + it->second.second};
+    }
+
+    size_t NHits() const { return fOffsets.size(); }
+
+  private:
+    std::unordered_map<Key, std::pair<size_t, size_t>> fOffsets;
+    std::vector<sim::TrackIDE> fTrackIDEs;
+  };
+
+  /// Sums the energy per Geant4 track ID over the hits of a reconstructed
+  /// object, to find the track which deposited the most. Energies are summed
+  /// per track in the order they are added, and the total in increasing
+  /// track ID order, as a std::map<int, double> would do.
+  class TrackEnergyAccumulator {
+  public:
+    void Clear()
+    {
+      fSums.clear();
+      fIndex.clear();
+    }
+
+    template <typename TrackIDEList>
+    void Add(TrackIDEList const& trkide_list)
+    {
+      for (auto const& t : trkide_list) {
+        auto const it = fIndex.try_emplace(t.trackID, fSums.size()).first;
+        if (it->second == fSums.size()) fSums.emplace_back(t.trackID, 0.);
+        fSums[it->second].second += t.energy;
+      }
+    }
+
+    /// Returns the track ID with the most energy (the lowest one among
+    /// equals, 0 if there is none) and sets its share of the total energy
+    int DominantTrackID(double& cleanliness)
+    {
+      // one entry per track: sort only to sum the total in track ID order
+      std::sort(fSums.begin(), fSums.end());
+
+      int trackID = 0;
+      double maxe = -1;
+      double tote = 0;
+      for (auto const& sum : fSums) {
+        tote += sum.second;
+        if (sum.second > maxe) {
+          maxe = sum.second;
+          trackID = sum.first;
+        }
+      }
+      cleanliness = maxe / tote;
+      return trackID;
+    }
+
+  private:
+    std::vector<std::pair<int, double>> fSums; ///< energy per track ID
+    std::unordered_map<int, size_t> fIndex;    ///< track ID -> position in fSums
+  };
+
+} // namespace t0
+
+#endif // TRACKIDEMATCHING_H
@@ -51,12 +51,13 @@
 #include "canvas/Utilities/InputTag.h"
 #include "fhiclcpp/ParameterSet.h"
 
+#include <cstdint>
 #include <iostream>
 #include <iterator>
-#include <map>
 #include <memory>
 
 // LArSoft
+#include "larana/T0Finder/AssociationsTools/TrackIDEMatching.h"
 #include "larcore/Geometry/Geometry.h"
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
 #include "lardata/Utilities/AssociationUtil.h"
@@ -226,16 +227,24 @@ t0::MCTruthT0Matching::produce(art::Event& evt)
   std::unique_ptr<art::Assns<recob::Hit, simb::MCParticle, anab::BackTrackerHitMatchingData>>
     MCPartHitassn(new art::Assns<recob::Hit, simb::MCParticle, anab::BackTrackerHitMatchingData>);
 
-  double maxe = -1;
-  double tote = 0;
-  // int    trkid = -1;
-  int maxtrkid = -1;
-  double maxn = -1;
-  double totn = 0;
-  int maxntrkid = -1;
-  anab::BackTrackerHitMatchingData bthmd;
+  // Geant4 track ID -> MCParticle position in the "largeant" collection
+  MCParticleIndex const trkid_lookup(*mcpartHandle);
 
-  std::unordered_map<int, int> trkid_lookup; //indexed by geant4trkid, delivers MC particle location
+  // Each hit is backtracked once, however many objects share it
+  HitTrackIDECache<std::uint64_t> hitTrackIDEs;
+  auto backtrackHit = [&](art::Ptr<recob::Hit> const& hit) {
+    std::uint64_t const hitKey = (std::uint64_t(hit.id().value()) << 32) | hit.key();
+    return hitTrackIDEs.Get(hitKey, [&]() { return bt_serv->HitToTrackIDEs(clockData, hit); });
+  };
+
+  // Position of the particle for a track ID. A track ID missing from the
+  // collection gives the last particle, as the linear search used to do.
+  auto findParticle = [&](int trackID) {
+    int const mcpart_i = trkid_lookup.Find(trackID);
+    return (mcpart_i == -1) ? (int)mcpartHandle->size() - 1 : mcpart_i;
+  };
+
+  TrackEnergyAccumulator trkide;
 
   //if we want to make per-hit assns
   if (fMakeHitAssns) {
@@ -246,61 +255,26 @@ t0::MCTruthT0Matching::produce(art::Event& evt)
     if (hitListHandle.isValid()) {
 
       auto const& hitList(*hitListHandle);
-      auto const& mcpartList(*mcpartHandle);
+      HitTrackIDECollector trkide_collector;
       for (size_t i_h = 0; i_h < hitList.size(); ++i_h) {
         art::Ptr<recob::Hit> hitPtr(hitListHandle, i_h);
-        auto trkide_list = bt_serv->HitToTrackIDEs(clockData, hitPtr);
-        struct TrackIDEinfo {
-          float E;
-          float NumElectrons;
-        };
-        std::map<int, TrackIDEinfo> trkide_collector;
-        maxe = -1;
-        tote = 0;
-        maxtrkid = -1;
-        maxn = -1;
-        totn = 0;
-        maxntrkid = -1;
-        for (auto const& t : trkide_list) {
-          trkide_collector[t.trackID].E += t.energy;
-          tote += t.energy;
-          if (trkide_collector[t.trackID].E > maxe) {
-            maxe = trkide_collector[t.trackID].E;
-            maxtrkid = t.trackID;
-          }
-          trkide_collector[t.trackID].NumElectrons += t.numElectrons;
-          totn += t.numElectrons;
-          if (trkide_collector[t.trackID].NumElectrons > maxn) {
-            maxn = trkide_collector[t.trackID].NumElectrons;
-            maxntrkid = t.trackID;
-          }
-
-          //if not found, find mc particle...
-          if (trkid_lookup.find(t.trackID) == trkid_lookup.end()) {
-            size_t i_p = 0;
-            while (i_p < mcpartList.size()) {
-              if (mcpartList[i_p].TrackId() == t.trackID) {
-                trkid_lookup[t.trackID] = (int)i_p;
-                break;
-              }
-              ++i_p;
-            }
-            if (i_p == mcpartList.size()) trkid_lookup[t.trackID] = -1;
-          }
-
-        } //end loop on TrackIDs
+        trkide_collector.Fill(backtrackHit(hitPtr));
+        trkide_collector.SortByTrackID();
 
         //now find the mcparticle and loop back through ...
-        for (auto const& t : trkide_collector) {
-          int mcpart_i = trkid_lookup[t.first];
-          if (mcpart_i == -1) continue; //no mcparticle here
-          art::Ptr<simb::MCParticle> mcpartPtr(mcpartHandle, mcpart_i);
-          bthmd.ideFraction = t.second.E / tote;
-          bthmd.isMaxIDE = (t.first == maxtrkid);
-          bthmd.ideNFraction = t.second.NumElectrons / totn;
-          bthmd.isMaxIDEN = (t.first == maxntrkid);
-          MCPartHitassn->addSingle(hitPtr, mcpartPtr, bthmd);
-        }
+        trkide_collector.ForEachMatch(
+          [&](int trackID, anab::BackTrackerHitMatchingData const& match) {
+            int mcpart_i = trkid_lookup.Find(trackID);
+            if (mcpart_i == -1) return; //no mcparticle here
+            art::Ptr<simb::MCParticle> mcpartPtr(mcpartHandle, mcpart_i);
+            //energy and numElectrons are left at their defaults
+            anab::BackTrackerHitMatchingData bthmd;
+            bthmd.ideFraction = match.ideFraction;
+            bthmd.isMaxIDE = match.isMaxIDE;
+            bthmd.ideNFraction = match.ideNFraction;
+            bthmd.isMaxIDEN = match.isMaxIDEN;
+            MCPartHitassn->addSingle(hitPtr, mcpartPtr, bthmd);
+          });
 
       } //end loop on hits
 
@@ -322,39 +296,20 @@ t0::MCTruthT0Matching::produce(art::Event& evt)
       anab::BackTrackerMatchingData btdata;
       std::vector<art::Ptr<recob::Hit>> allHits = fmtht.at(iTrk);
 
-      std::map<int, double> trkide;
-      for (size_t h = 0; h < allHits.size(); ++h) {
-        art::Ptr<recob::Hit> hit = allHits[h];
-        std::vector<sim::IDE> ides;
-        std::vector<sim::TrackIDE> TrackIDs = bt_serv->HitToTrackIDEs(clockData, hit);
-
-        for (size_t e = 0; e < TrackIDs.size(); ++e) {
-          trkide[TrackIDs[e].trackID] += TrackIDs[e].energy;
-        }
-      }
+      trkide.Clear();
+      for (auto const& hit : allHits)
+        trkide.Add(backtrackHit(hit));
       // Work out which IDE despoited the most charge in the hit if there was more than one.
-      maxe = -1;
-      tote = 0;
-      for (std::map<int, double>::iterator ii = trkide.begin(); ii != trkide.end(); ++ii) {
-        tote += ii->second;
-        if ((ii->second) > maxe) {
-          maxe = ii->second;
-          TrackID = ii->first;
-        }
-      }
-      btdata.cleanliness = maxe / tote;
+      double cleanliness = 0;
+      TrackID = trkide.DominantTrackID(cleanliness);
+      btdata.cleanliness = cleanliness;
 
       // Now have trackID, so get PdG code and T0 etc.
       const simb::MCParticle* tmpParticle = pi_serv->TrackIdToParticle_P(TrackID);
       if (!tmpParticle)
         continue; // Retain this check that the BackTracker can find the right particle
-      // Now, loop through the MCParticle's myself to find the correct match
-      int mcpart_i(-1);
-      for (auto const particle : *mcpartHandle) {
-        mcpart_i++;
-        if (TrackID == particle.TrackId()) { break; }
-      }
-      const simb::MCParticle particle = mcpartHandle.product()->at(mcpart_i);
+      int mcpart_i = findParticle(TrackID);
+      const simb::MCParticle& particle = mcpartHandle.product()->at(mcpart_i);
       TrueTrackT0 = particle.T();
       TrueTrackID = particle.TrackId();
       TrueTriggerType = 2; // Using MCTruth as trigger, so tigger type is 2.
@@ -386,39 +341,20 @@ t0::MCTruthT0Matching::produce(art::Event& evt)
       std::vector<art::Ptr<recob::Hit>> allHits = fmsht.at(Shower);
       anab::BackTrackerMatchingData btdata;
 
-      std::map<int, double> showeride;
-      for (size_t h = 0; h < allHits.size(); ++h) {
-        art::Ptr<recob::Hit> hit = allHits[h];
-        std::vector<sim::IDE> ides;
-        std::vector<sim::TrackIDE> TrackIDs = bt_serv->HitToTrackIDEs(clockData, hit);
-
-        for (size_t e = 0; e < TrackIDs.size(); ++e) {
-          showeride[TrackIDs[e].trackID] += TrackIDs[e].energy;
-        }
-      }
+      trkide.Clear();
+      for (auto const& hit : allHits)
+        trkide.Add(backtrackHit(hit));
       // Work out which IDE despoited the most charge in the hit if there was more than one.
-      maxe = -1;
-      tote = 0;
-      for (std::map<int, double>::iterator ii = showeride.begin(); ii != showeride.end(); ++ii) {
-        tote += ii->second;
-        if ((ii->second) > maxe) {
-          maxe = ii->second;
-          ShowerID = ii->first;
-        }
-      }
-      btdata.cleanliness = maxe / tote;
+      double cleanliness = 0;
+      ShowerID = trkide.DominantTrackID(cleanliness);
+      btdata.cleanliness = cleanliness;
 
       // Now have MCParticle trackID corresponding to shower, so get PdG code and T0 etc.
       const simb::MCParticle* tmpParticle = pi_serv->TrackIdToParticle_P(ShowerID);
       if (!tmpParticle)
         continue; // Retain this check that the BackTracker can find the right particle
-      // Now, loop through the MCParticle's myself to find the correct match
-      int mcpart_i(-1);
-      for (auto const particle : *mcpartHandle) {
-        mcpart_i++;
-        if (ShowerID == particle.TrackId()) { break; }
-      }
-      const simb::MCParticle particle = mcpartHandle.product()->at(mcpart_i);
+      int mcpart_i = findParticle(ShowerID);
+      const simb::MCParticle& particle = mcpartHandle.product()->at(mcpart_i);
       ShowerT0 = particle.T();
       ShowerID = particle.TrackId();
       ShowerTriggerType = 2; // Using MCTruth as trigger, so tigger type is 2.
@@ -458,39 +394,20 @@ t0::MCTruthT0Matching::produce(art::Event& evt)
         allHits.insert(allHits.end(), hits.begin(), hits.end());
       }
 
-      std::map<int, double> trkide;
-      for (size_t h = 0; h < allHits.size(); ++h) {
-        art::Ptr<recob::Hit> hit = allHits[h];
-        std::vector<sim::IDE> ides;
-        std::vector<sim::TrackIDE> TrackIDs = bt_serv->HitToTrackIDEs(clockData, hit);
-
-        for (size_t e = 0; e < TrackIDs.size(); ++e) {
-          trkide[TrackIDs[e].trackID] += TrackIDs[e].energy;
-        }
-      }
+      trkide.Clear();
+      for (auto const& hit : allHits)
+        trkide.Add(backtrackHit(hit));
       // Work out which IDE despoited the most charge in the hit if there was more than one.
-      double maxe = -1;
-      double tote = 0;
-      for (std::map<int, double>::iterator ii = trkide.begin(); ii != trkide.end(); ++ii) {
-        tote += ii->second;
-        if ((ii->second) > maxe) {
-          maxe = ii->second;
-          TrackID = ii->first;
-        }
-      }
-      btdata.cleanliness = maxe / tote;
+      double cleanliness = 0;
+      TrackID = trkide.DominantTrackID(cleanliness);
+      btdata.cleanliness = cleanliness;
 
       // Now have trackID, so get PdG code and T0 etc.
       const simb::MCParticle* tmpParticle = pi_serv->TrackIdToParticle_P(TrackID);
       if (!tmpParticle)
         continue; // Retain this check that the BackTracker can find the right particle
-      // Now, loop through the MCParticle's myself to find the correct match
-      int mcpart_i(-1);
-      for (auto const particle : *mcpartHandle) {
-        mcpart_i++;
-        if (TrackID == particle.TrackId()) { break; }
-      }
-      const simb::MCParticle particle = mcpartHandle.product()->at(mcpart_i);
+      int mcpart_i = findParticle(TrackID);
+      const simb::MCParticle& particle = mcpartHandle.product()->at(mcpart_i);
       TrueTrackT0 = particle.T();
       TrueTrackID = particle.TrackId();
       TrueTriggerType = 2; // Using MCTruth as trigger, so tigger type is 2.
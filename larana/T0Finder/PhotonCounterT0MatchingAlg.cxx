@@ -0,0 +1,177 @@
+#include "PhotonCounterT0MatchingAlg.h"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <algorithm>
+#include <cmath>
+
+lbne::PhotonCounterT0MatchingAlg::PhotonCounterT0MatchingAlg(fhicl::ParameterSet const& p)
+  : fPredictedXConstant(p.get<double>("PredictedXConstant"))
+  , fPredictedExpConstant(p.get<double>("PredictedExpConstant"))
+  , fPredictedExpGradient(p.get<double>("PredictedExpGradient"))
+  , fWeightOfDeltaYZ(p.get<double>("WeightOfDeltaYZ"))
+  , fMatchCriteria(p.get<double>("MatchCriteria"))
+  , fPEThreshold(p.get<double>("PEThreshold"))
+{}
+
+// ----------------------------------------------------------------------------
+void
+lbne::PhotonCounterT0MatchingAlg::SetFlashes(std::vector<Flash> const& flashes,
+                                             double driftWindow,
+                                             double driftVelocity)
+{
+  fDriftWindow = driftWindow;
+  fDriftVelocity = driftVelocity;
+
+  fFlashes.clear();
+  for (size_t iFlash = 0; iFlash < flashes.size(); ++iFlash) {
+    Flash const& flash = flashes[iFlash];
+
+    // Check flash has enough PE's to satisfy our threshold
+    if (flash.TotalPE < fPEThreshold) continue;
+
+    // PredictedX = ( A / x^n ) + exp ( B + Cx )
+    double const PredictedX = (fPredictedXConstant / pow(flash.TotalPE, fPredictedXPower)) +
+                              (exp(fPredictedExpConstant + (fPredictedExpGradient * flash.TotalPE)));
+    fFlashes.push_back({flash.Time, PredictedX, flash.YCenter, flash.ZCenter, (int)iFlash});
+  }
+
+  std::stable_sort(fFlashes.begin(), fFlashes.end(), [](IndexedFlash const& a, IndexedFlash const& b) {
+    return a.Time < b.Time;
+  });
+}
+
+// ----------------------------------------------------------------------------
+lbne::PhotonCounterT0MatchingAlg::Match
+lbne::PhotonCounterT0MatchingAlg::BestMatch(double trkTimeCentre,
+                                            std::vector<YZPoint> const& trajectory) const
+{
+  Match best;
+
+  bool const useYZ = (fMatchCriteria == 0 || fMatchCriteria == 1);
+  bool const useX = (fMatchCriteria == 0 || fMatchCriteria == 2);
+  if (!useYZ && !useX) return best; // no fit parameter, no match
+
+  // Flashes within one drift window before the track. The time range is
+  // widened a little and the exact condition applied to each flash.
+  double const margin = 1e-9 * (std::abs(trkTimeCentre) + std::abs(fDriftWindow) + 1.);
+  auto first = std::lower_bound(fFlashes.begin(),
+                                fFlashes.end(),
+                                trkTimeCentre - fDriftWindow - margin,
+                                [](IndexedFlash const& f, double t) { return f.Time < t; });
+  auto last = std::upper_bound(first,
+                               fFlashes.end(),
+                               trkTimeCentre + margin,
+                               [](double t, IndexedFlash const& f) { return t < f.Time; });
+
+  fCandidates.clear();
+  for (auto it = first; it != last; ++it) {
+    double const TimeSep = trkTimeCentre - it->Time; // Time in us!
+    if (TimeSep < 0 || TimeSep > fDriftWindow) continue;
+
+    double const TimeSepPredX = TimeSep * fDriftVelocity; // us * cm/us = cm!
+    double const DeltaPredX = fabs(TimeSepPredX - it->PredictedX);
+
+    // Lower bound of the fit parameter, from the X separation alone: the
+    // YZ term can only add to it (unless it is negatively weighted)
+    double Bound = 0;
+    if (fMatchCriteria == 2)
+      Bound = DeltaPredX;
+    else if (fMatchCriteria == 0 && fWeightOfDeltaYZ >= 0)
+      Bound = pow(DeltaPredX * DeltaPredX, 0.5);
+    if (std::isnan(Bound)) continue; // its fit parameter is NaN too, never the best
+
+    fCandidates.push_back({Bound, TimeSep, TimeSepPredX, DeltaPredX, &*it});
+  }
+
+  std::sort(fCandidates.begin(), fCandidates.end(), [](Candidate const& a, Candidate const& b) {
+    return (a.Bound != b.Bound) ? (a.Bound < b.Bound) : (a.Flash->Index < b.Flash->Index);
+  });
+
+  for (auto const& candidate : fCandidates) {
+
+    // The bound may be off by rounding in pow(); with a little slack,
+    // nothing from here on can beat the best flash
+    if (candidate.Bound > best.FitParam * (1. + 1e-12)) break;
+
+    double const minYZSep =
+      useYZ ? MinYZSeparation(trajectory, candidate.Flash->YCenter, candidate.Flash->ZCenter) :
+              9999;
+    double const FitParam = this->FitParam(candidate.DeltaPredX, minYZSep);
+
+    // Lowest fit parameter wins, the first flash among equals
+    bool const better =
+      (FitParam < best.FitParam) ||
+      (best.Flash != -1 && FitParam == best.FitParam && candidate.Flash->Index < best.Flash);
+    if (!better) continue;
+
+    best.Flash = candidate.Flash->Index;
+    best.FitParam = FitParam;
+    best.FlashTime = candidate.Flash->Time;
+    best.TimeSep = candidate.TimeSep;
+    best.PredictedX = candidate.Flash->PredictedX;
+    best.TimeSepPredX = candidate.TimeSepPredX;
+    best.DeltaPredX = candidate.DeltaPredX;
+    best.MinYZSep = minYZSep;
+  }
+
+  // The YZ separation is reported even when it is not part of the fit
+  if (best.Flash != -1 && !useYZ) {
+    auto const bestFlash =
+      std::find_if(fFlashes.begin(), fFlashes.end(), [&best](IndexedFlash const& f) {
+        return f.Index == best.Flash;
+      });
+    best.MinYZSep = MinYZSeparation(trajectory, bestFlash->YCenter, bestFlash->ZCenter);
+  }
+
+  return best;
+}
+
+// ----------------------------------------------------------------------------
+double
+lbne::PhotonCounterT0MatchingAlg::FitParam(double DeltaPredX, double MinYZSep) const
+{
+  // Determine how well matched this track is......
+  if (fMatchCriteria == 0)
+    return pow(((DeltaPredX * DeltaPredX) + (MinYZSep * MinYZSep * fWeightOfDeltaYZ)), 0.5);
+  else if (fMatchCriteria == 1)
+    return MinYZSep;
+  else if (fMatchCriteria == 2)
+    return DeltaPredX;
+  return 9999;
+}
+
+// ----------------------------------------------------------------------------
+double
+lbne::PhotonCounterT0MatchingAlg::MinYZSeparation(std::vector<YZPoint> const& trajectory,
+                                                  double PointY,
+                                                  double PointZ)
+{
+  double minYZSep = 9999;
+  // Dependant on each point...
+  for (size_t Point = 1; Point < trajectory.size(); ++Point) {
+    YZPoint const& NewPoint = trajectory[Point];
+    YZPoint const& PrevPoint = trajectory[Point - 1];
+    double const YZSep =
+      DistFromPoint(NewPoint.Y, PrevPoint.Y, NewPoint.Z, PrevPoint.Z, PointY, PointZ);
+    if (Point == 1) minYZSep = YZSep;
+    if (YZSep < minYZSep) minYZSep = YZSep;
+  }
+  return minYZSep;
+}
+
+// ----------------------------------------------------------------------------
+double
+lbne::PhotonCounterT0MatchingAlg::DistFromPoint(double StartY,
+                                                double EndY,
+                                                double StartZ,
+                                                double EndZ,
+                                                double PointY,
+                                                double PointZ)
+{
+  ///Calculate the distance between the centre of the flash and the centre of a line connecting two adjacent space points.
+  double Length = hypot(fabs(EndY - StartY), fabs(EndZ - StartZ));
+  double distance =
+    ((PointZ - StartZ) * (EndY - StartY) - (PointY - StartY) * (EndZ - StartZ)) / Length;
+  return fabs(distance);
+}
@@ -0,0 +1,117 @@
+#ifndef PHOTONCOUNTERT0MATCHINGALG_H
+#define PHOTONCOUNTERT0MATCHINGALG_H
+/*!
+ * Title:   Photon Counter Flash<-->Track Match Algorithm Class
+ *
+ * Description: Finds, for a track, the flash within one drift window before
+ *              it which best agrees with it, comparing the X position
+ *              predicted from the flash PE with the one from the time
+ *              separation, and the distance of the flash centre from the
+ *              track in YZ. Used by PhotonCounterT0Matching.
+ *
+ *              Flashes are indexed by time, so a track only looks at the
+ *              flashes in its drift window. Within the window the flashes
+ *              are visited in order of a lower bound on their fit parameter
+ *              which needs no YZ computation, and the visit stops as soon as
+ *              no remaining flash can do better. The result is the same as
+ *              comparing with every flash in turn: the lowest fit parameter,
+ *              the first flash among equals.
+ * Input:       flash time/PE/YZ centre, track time and trajectory
+ * Output:      best flash and the matching quantities
+*/
+
+#include "fhiclcpp/fwd.h"
+
+#include <vector>
+
+namespace lbne {
+  class PhotonCounterT0MatchingAlg;
+}
+
+class lbne::PhotonCounterT0MatchingAlg {
+public:
+  struct Flash {
+    double Time; ///< in us
+    double TotalPE;
+    double YCenter;
+    double ZCenter;
+  };
+
+  struct YZPoint {
+    double Y;
+    double Z;
+  };
+
+  /// Best flash for a track; Flash is -1 when no flash matches
+  struct Match {
+    int Flash = -1;
+    double FitParam = 9999;
+    double FlashTime = 9999;
+    double TimeSep = 9999;
+    double PredictedX = 9999;
+    double TimeSepPredX = 9999;
+    double DeltaPredX = 9999;
+    double MinYZSep = 9999;
+  };
+
+  PhotonCounterT0MatchingAlg(fhicl::ParameterSet const& p);
+
+  /// Sets the flashes of the event, with the drift window (us) and
+  /// drift velocity (cm/us) to use
+  void SetFlashes(std::vector<Flash> const& flashes, double driftWindow, double driftVelocity);
+
+  /// Finds the best flash for a track with the given time centre (us) and
+  /// trajectory points
+  Match BestMatch(double trkTimeCentre, std::vector<YZPoint> const& trajectory) const;
+
+  /// Distance in YZ of a point from the line through two track points
+  static double DistFromPoint(double StartY,
+                              double EndY,
+                              double StartZ,
+                              double EndZ,
+                              double PointY,
+                              double PointZ);
+
+  /// Smallest distance of a point from the lines through consecutive
+  /// trajectory points; 9999 with fewer than two points
+  static double MinYZSeparation(std::vector<YZPoint> const& trajectory,
+                                double PointY,
+                                double PointZ);
+
+private:
+  double fPredictedXConstant;
+  double fPredictedXPower = 1;
+  double fPredictedExpConstant;
+  double fPredictedExpGradient;
+  double fWeightOfDeltaYZ;
+  double fMatchCriteria;
+  double fPEThreshold;
+
+  double fDriftWindow = 0;
+  double fDriftVelocity = 0;
+
+  /// Flashes above the PE threshold, in time order
+  struct IndexedFlash {
+    double Time;
+    double PredictedX; ///< X predicted from the PE
+    double YCenter;
+    double ZCenter;
+    int Index; ///< position in the event flash list
+  };
+  std::vector<IndexedFlash> fFlashes;
+
+  /// Flash of the current track window, with the bound on its fit parameter
+  struct Candidate {
+    double Bound;
+    double TimeSep;
+    double TimeSepPredX;
+    double DeltaPredX;
+    IndexedFlash const* Flash;
+  };
+  mutable std::vector<Candidate> fCandidates;
+
+  /// Fit parameter given the X and YZ separations
+  double FitParam(double DeltaPredX, double MinYZSep) const;
+};
+
+#endif
@@ -43,6 +43,7 @@
 #include <memory>
 
 // LArSoft
+#include "larana/T0Finder/PhotonCounterT0MatchingAlg.h"
 #include "larcore/Geometry/Geometry.h"
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
@@ -99,12 +100,8 @@ private:
                  double& trkTimeLengh,
                  double& trkTimeCentre,
                  double& TrackLength);
-  double DistFromPoint(double StartY,
-                       double EndY,
-                       double StartZ,
-                       double EndZ,
-                       double PointY,
-                       double PointZ);
+
+  PhotonCounterT0MatchingAlg fMatchAlg;
 
   // Params got from fcl file.......
   std::string fTrackModuleLabel;
@@ -112,14 +109,7 @@ private:
   std::string fHitsModuleLabel;
   std::string fFlashModuleLabel;
   std::string fTruthT0ModuleLabel;
-  double fPredictedXConstant;
-  double fPredictedXPower = 1;
-  double fPredictedExpConstant;
-  double fPredictedExpGradient;
   double fDriftWindowSize;
-  double fWeightOfDeltaYZ;
-  double fMatchCriteria;
-  double fPEThreshold;
   bool fVerbosity;
 
   // Variables used in module.......
@@ -130,17 +120,17 @@ private:
 
   double trkTimeCentre, BesttrkTimeCentre;
   double TrackLength, BestTrackLength;
-  double PredictedX, BestPredictedX;
-  double TimeSepPredX, BestTimeSepPredX;
-  double DeltaPredX, BestDeltaPredX;
-  double minYZSep, BestminYZSep;
-  double FitParam, BestFitParam;
-  double FlashTime, BestFlashTime;
-  double TimeSep, BestTimeSep;
+  double BestPredictedX;
+  double BestTimeSepPredX;
+  double BestDeltaPredX;
+  double BestminYZSep;
+  double BestFitParam;
+  double BestFlashTime;
+  double BestTimeSep;
   int BestFlash;
   int FlashTriggerType = 1;
 
-  double YZSep, MCTruthT0;
+  double MCTruthT0;
   // Histograms in TFS branches
   TTree* fTree;
   TH2D* hPredX_T;
@@ -154,7 +144,8 @@ private:
   TH1D* hT0_diff_zoom;
 };
 
-lbne::PhotonCounterT0Matching::PhotonCounterT0Matching(fhicl::ParameterSet const& p) : EDProducer{p}
+lbne::PhotonCounterT0Matching::PhotonCounterT0Matching(fhicl::ParameterSet const& p)
+  : EDProducer{p}, fMatchAlg(p)
 {
   // Call appropriate produces<>() functions here.
   produces<std::vector<anab::T0>>();
@@ -167,14 +158,7 @@ lbne::PhotonCounterT0Matching::PhotonCounterT0Matching(fhicl::ParameterSet const
   fFlashModuleLabel = (p.get<std::string>("FlashModuleLabel"));
   fTruthT0ModuleLabel = (p.get<std::string>("TruthT0ModuleLabel"));
 
-  fPredictedXConstant = (p.get<double>("PredictedXConstant"));
-  fPredictedExpConstant = (p.get<double>("PredictedExpConstant"));
-  fPredictedExpGradient = (p.get<double>("PredictedExpGradient"));
-
   fDriftWindowSize = (p.get<double>("DriftWindowSize"));
-  fWeightOfDeltaYZ = (p.get<double>("WeightOfDeltaYZ"));
-  fMatchCriteria = (p.get<double>("MatchCriteria"));
-  fPEThreshold = (p.get<double>("PEThreshold"));
 
   fVerbosity = (p.get<bool>("Verbose", false));
 }
@@ -326,6 +310,17 @@ lbne::PhotonCounterT0Matching::produce(art::Event& evt)
       std::cout << "There were " << NTracks << " tracks and " << NFlashes
                 << " flashes in this event." << std::endl;
 
+    // Index the flashes by time for the matching
+    std::vector<PhotonCounterT0MatchingAlg::Flash> flashes;
+    flashes.reserve(NFlashes);
+    for (auto const& flash : flashlist)
+      flashes.push_back({flash->Time(), flash->TotalPE(), flash->YCenter(), flash->ZCenter()});
+    fMatchAlg.SetFlashes(flashes,
+                         fDriftWindowSize / clock_data.TPCClock().Frequency(), // in us
+                         detprop.DriftVelocity());
+
+    std::vector<PhotonCounterT0MatchingAlg::YZPoint> trajectory;
+
     // Now to access PhotonCounter for each track...
     for (size_t iTrk = 0; iTrk < NTracks; ++iTrk) {
       if (fVerbosity) std::cout << "\n New Track " << (int)iTrk << std::endl;
@@ -372,73 +367,35 @@ lbne::PhotonCounterT0Matching::produce(art::Event& evt)
                   << trkTimeStart << " " << trkTimeEnd << " " << trkTimeLengh << " "
                   << trkTimeCentre << std::endl;
       }
-      // ----- Loop over flashes ------
-      for (size_t iFlash = 0; iFlash < NFlashes; ++iFlash) {
-        //Reset some flash specific quantities
-        YZSep = minYZSep = 9999;
-        FlashTime = TimeSep = 9999;
-        PredictedX = TimeSepPredX = DeltaPredX = FitParam = 9999;
-        // Check flash could be caused by track...
-        FlashTime = flashlist[iFlash]->Time(); // Got in us!
-        TimeSep = trkTimeCentre - FlashTime;   // Time in us!
-        if (TimeSep < 0 || TimeSep > (fDriftWindowSize / clock_data.TPCClock().Frequency()))
-          continue; // Times compared in us!
-
-        // Check flash has enough PE's to satisfy our threshold
-        if (flashlist[iFlash]->TotalPE() < fPEThreshold) continue;
-
-        // Work out some quantities for this flash...
-        // PredictedX = ( A / x^n ) + exp ( B + Cx )
-        PredictedX =
-          (fPredictedXConstant / pow(flashlist[iFlash]->TotalPE(), fPredictedXPower)) +
-          (exp(fPredictedExpConstant + (fPredictedExpGradient * flashlist[iFlash]->TotalPE())));
-        TimeSepPredX = TimeSep * detprop.DriftVelocity(); // us * cm/us = cm!
-        DeltaPredX = fabs(TimeSepPredX - PredictedX);
-        // Dependant on each point...
-        for (size_t Point = 1; Point < tracklist[iTrk]->NumberTrajectoryPoints(); ++Point) {
-          auto NewPoint = tracklist[iTrk]->LocationAtPoint(Point);
-          auto PrevPoint = tracklist[iTrk]->LocationAtPoint(Point - 1);
-          YZSep = DistFromPoint(NewPoint.Y(),
-                                PrevPoint.Y(),
-                                NewPoint.Z(),
-                                PrevPoint.Z(),
-                                flashlist[iFlash]->YCenter(),
-                                flashlist[iFlash]->ZCenter());
-          if (Point == 1) minYZSep = YZSep;
-          if (YZSep < minYZSep) minYZSep = YZSep;
-        }
-
-        // Determine how well matched this track is......
-        if (fMatchCriteria == 0)
-          FitParam =
-            pow(((DeltaPredX * DeltaPredX) + (minYZSep * minYZSep * fWeightOfDeltaYZ)), 0.5);
-        else if (fMatchCriteria == 1)
-          FitParam = minYZSep;
-        else if (fMatchCriteria == 2)
-          FitParam = DeltaPredX;
+      // ----- Find the best flash ------
+      trajectory.clear();
+      for (size_t Point = 0; Point < tracklist[iTrk]->NumberTrajectoryPoints(); ++Point) {
+        auto const& Location = tracklist[iTrk]->LocationAtPoint(Point);
+        trajectory.push_back({Location.Y(), Location.Z()});
+      }
+      PhotonCounterT0MatchingAlg::Match const best = fMatchAlg.BestMatch(trkTimeCentre, trajectory);
+
+      if (best.Flash != -1) {
+        ValidTrack = true;
+        BestFlash = best.Flash;
+        BestFitParam = best.FitParam;
+        BestTrackCentre_X = TrackCentre_X;
+        BestTrackLength = TrackLength;
+        BesttrkTimeCentre = trkTimeCentre;
+        BestTimeSepPredX = best.TimeSepPredX;
+        BestPredictedX = best.PredictedX;
+        BestDeltaPredX = best.DeltaPredX;
+        BestminYZSep = best.MinYZSep;
+        BestFlashTime = best.FlashTime;
+        BestTimeSep = best.TimeSep;
 
         //----FLASH INFO-----
         if (fVerbosity) {
-          std::cout << "\nFlash " << (int)iFlash << " " << TrackCentre_X << ", " << TimeSepPredX
-                    << " - " << PredictedX << " = " << DeltaPredX << ", " << minYZSep << " -> "
-                    << FitParam << std::endl;
+          std::cout << "\nBest flash " << BestFlash << " " << TrackCentre_X << ", "
+                    << BestTimeSepPredX << " - " << BestPredictedX << " = " << BestDeltaPredX
+                    << ", " << BestminYZSep << " -> " << BestFitParam << std::endl;
         }
-        //----Select best flash------
-        if (FitParam < BestFitParam) {
-          ValidTrack = true;
-          BestFlash = (int)iFlash;
-          BestFitParam = FitParam;
-          BestTrackCentre_X = TrackCentre_X;
-          BestTrackLength = TrackLength;
-          BesttrkTimeCentre = trkTimeCentre;
-          BestTimeSepPredX = TimeSepPredX;
-          BestPredictedX = PredictedX;
-          BestDeltaPredX = DeltaPredX;
-          BestminYZSep = minYZSep;
-          BestFlashTime = FlashTime;
-          BestTimeSep = TimeSep;
-        } // Find best Flash
-      }   // Loop over Flashes
+      }
 
       // ---- Now Make association and fill TTree/Histos with the best matched flash.....
       if (ValidTrack) {
@@ -523,19 +480,4 @@ lbne::PhotonCounterT0Matching::TrackProp(double TrackStart_X,
   return;
 }
 // ----------------------------------------------------------------------------------------------------------------------------
-double
-lbne::PhotonCounterT0Matching::DistFromPoint(double StartY,
-                                             double EndY,
-                                             double StartZ,
-                                             double EndZ,
-                                             double PointY,
-                                             double PointZ)
-{
-  ///Calculate the distance between the centre of the flash and the centre of a line connecting two adjacent space points.
-  double Length = hypot(fabs(EndY - StartY), fabs(EndZ - StartZ));
-  double distance =
-    ((PointZ - StartZ) * (EndY - StartY) - (PointY - StartY) * (EndZ - StartZ)) / Length;
-  return fabs(distance);
-}
-// ----------------------------------------------------------------------------------------------------------------------------
 DEFINE_ART_MODULE(lbne::PhotonCounterT0Matching)
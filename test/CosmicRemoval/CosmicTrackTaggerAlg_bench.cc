@@ -0,0 +1,293 @@
+// Tagging an event of 5000 tracks of 50 hits each, a third of them short
+// stubs: the loops CosmicTrackTagger ran (tick range and boundary checks per
+// track, end point vectors, then each untagged track compared with every
+// track of the event, dereferencing both again) against per-track summaries
+// and CosmicTrackTaggerAlg. Tracks and hits are plain structs here, so the
+// art::Ptr and FindManyP lookups of the module are not timed.
+// Built with the tests, not run by them.
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/CosmicRemoval/CosmicTrackTaggerAlg.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using Alg = cosmic::CosmicTrackTaggerAlg;
+
+namespace {
+
+  const size_t NTracks = 5000;
+  const size_t NHitsPerTrack = 50;
+  const size_t NEvents = 10;
+
+  // microboone-like detector
+  const float DetHalfHeight = 116.5;
+  const float DetWidth = 256.35;
+  const float DetLength = 1036.8;
+  const int MinTickDrift = 3200;
+  const int MaxTickDrift = 3200 + 4600 + 50;
+  const float TPCXBoundary = 5, TPCYBoundary = 5, TPCZBoundary = 5;
+
+  struct Vector {
+    double x, y, z;
+    double X() const { return x; }
+    double Y() const { return y; }
+    double Z() const { return z; }
+    Vector operator-(Vector const& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vector Cross(Vector const& o) const
+    {
+      return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x};
+    }
+    double R() const { return std::sqrt(x * x + y * y + z * z); }
+  };
+
+  struct Hit {
+    float peak, rms;
+    float PeakTimeMinusRMS() const { return peak - rms; }
+    float PeakTimePlusRMS() const { return peak + rms; }
+  };
+
+  struct Track {
+    Vector fVertex, fEnd;
+    double fLength;
+    Vector const& Vertex() const { return fVertex; }
+    Vector const& End() const { return fEnd; }
+    double Length() const { return fLength; }
+  };
+
+  /// Tagging as CosmicTrackTagger::produce did it
+  std::vector<anab::CosmicTag> OldTags(std::vector<Track> const& TrkVec,
+                                       std::vector<std::vector<Hit const*>> const& hitsSpill)
+  {
+    std::vector<anab::CosmicTag> cosmicTagTrackVector;
+
+    for (unsigned int iTrack = 0; iTrack < TrkVec.size(); iTrack++) {
+
+      int isCosmic = 0;
+      anab::CosmicTagID_t tag_id = anab::CosmicTagID_t::kNotTagged;
+
+      Track const* tTrack = &TrkVec.at(iTrack);
+      std::vector<Hit const*> HitVec = hitsSpill.at(iTrack);
+
+      auto tVector1 = tTrack->Vertex();
+      auto tVector2 = tTrack->End();
+
+      float trackEndPt1_X = tVector1.X();
+      float trackEndPt1_Y = tVector1.Y();
+      float trackEndPt1_Z = tVector1.Z();
+      float trackEndPt2_X = tVector2.X();
+      float trackEndPt2_Y = tVector2.Y();
+      float trackEndPt2_Z = tVector2.Z();
+
+      if (trackEndPt1_X != trackEndPt1_X || trackEndPt1_Y != trackEndPt1_Y ||
+          trackEndPt1_Z != trackEndPt1_Z || trackEndPt2_X != trackEndPt2_X ||
+          trackEndPt2_Y != trackEndPt2_Y || trackEndPt2_Z != trackEndPt2_Z) {
+        std::vector<float> tempPt1, tempPt2;
+        tempPt1.push_back(-999);
+        tempPt1.push_back(-999);
+        tempPt1.push_back(-999);
+        tempPt2.push_back(-999);
+        tempPt2.push_back(-999);
+        tempPt2.push_back(-999);
+        cosmicTagTrackVector.emplace_back(tempPt1, tempPt2, -999, tag_id);
+        continue;
+      }
+
+      float tick1 = 9999;
+      float tick2 = -9999;
+      for (unsigned int p = 0; p < HitVec.size(); p++) {
+        if (HitVec[p]->PeakTimeMinusRMS() < tick1) tick1 = HitVec[p]->PeakTimeMinusRMS();
+        if (HitVec[p]->PeakTimePlusRMS() > tick2) tick2 = HitVec[p]->PeakTimePlusRMS();
+      }
+
+      if (tick1 < MinTickDrift || tick2 > MaxTickDrift) {
+        isCosmic = 1;
+        tag_id = anab::CosmicTagID_t::kOutsideDrift_Partial;
+      }
+
+      int nBdY = 0, nBdZ = 0;
+      if (isCosmic == 0) {
+        if (fabs(DetHalfHeight + trackEndPt1_Y) < TPCYBoundary ||
+            fabs(DetHalfHeight + trackEndPt2_Y) < TPCYBoundary || trackEndPt1_Y < -DetHalfHeight ||
+            trackEndPt2_Y < -DetHalfHeight)
+          nBdY++;
+        if (fabs(DetHalfHeight - trackEndPt1_Y) < TPCYBoundary ||
+            fabs(DetHalfHeight - trackEndPt2_Y) < TPCYBoundary || trackEndPt1_Y > DetHalfHeight ||
+            trackEndPt2_Y > DetHalfHeight)
+          nBdY++;
+        if (fabs(trackEndPt1_Z - DetLength) < TPCZBoundary ||
+            fabs(trackEndPt2_Z - DetLength) < TPCZBoundary)
+          nBdZ++;
+        if (fabs(trackEndPt1_Z) < TPCZBoundary || fabs(trackEndPt2_Z) < TPCZBoundary) nBdZ++;
+        if ((nBdY + nBdZ) > 1) {
+          isCosmic = 2;
+          if (nBdY > 1)
+            tag_id = anab::CosmicTagID_t::kGeometry_YY;
+          else if (nBdZ > 1)
+            tag_id = anab::CosmicTagID_t::kGeometry_ZZ;
+          else
+            tag_id = anab::CosmicTagID_t::kGeometry_YZ;
+        }
+        else if ((nBdY + nBdZ) == 1) {
+          isCosmic = 3;
+          if (nBdY == 1)
+            tag_id = anab::CosmicTagID_t::kGeometry_Y;
+          else if (nBdZ == 1)
+            tag_id = anab::CosmicTagID_t::kGeometry_Z;
+        }
+      }
+
+      std::vector<float> endPt1;
+      std::vector<float> endPt2;
+      endPt1.push_back(trackEndPt1_X);
+      endPt1.push_back(trackEndPt1_Y);
+      endPt1.push_back(trackEndPt1_Z);
+      endPt2.push_back(trackEndPt2_X);
+      endPt2.push_back(trackEndPt2_Y);
+      endPt2.push_back(trackEndPt2_Z);
+
+      float cosmicScore = isCosmic > 0 ? 1 : 0;
+      if (isCosmic == 3) cosmicScore = 0.5;
+
+      if (fabs(trackEndPt1_X - trackEndPt2_X) > DetWidth - TPCXBoundary) {
+        cosmicScore = 1;
+        isCosmic = 4;
+        tag_id = anab::CosmicTagID_t::kGeometry_XX;
+      }
+
+      cosmicTagTrackVector.emplace_back(endPt1, endPt2, cosmicScore, tag_id);
+    }
+
+    float dE = 0, dS = 0, temp = 0, IScore = 0;
+    unsigned int IndexE = 0, iTrk1 = 0, iTrk = 0;
+    anab::CosmicTagID_t IType = anab::CosmicTagID_t::kNotTagged;
+
+    for (iTrk = 0; iTrk < TrkVec.size(); iTrk++) {
+      Track const* tTrk = &TrkVec.at(iTrk);
+      if (cosmicTagTrackVector[iTrk].CosmicScore() == 0) {
+        auto tStart = tTrk->Vertex();
+        auto tEnd = tTrk->End();
+        unsigned int l = 0;
+        for (iTrk1 = 0; iTrk1 < TrkVec.size(); iTrk1++) {
+          Track const* tTrk1 = &TrkVec.at(iTrk1);
+          float getScore = cosmicTagTrackVector[iTrk1].CosmicScore();
+          if (getScore == 1 || getScore == 0.5) {
+            anab::CosmicTagID_t getType = cosmicTagTrackVector[iTrk1].CosmicType();
+            auto tStart1 = tTrk1->Vertex();
+            auto tEnd1 = tTrk1->End();
+            auto NumE = (tEnd - tStart1).Cross(tEnd - tEnd1);
+            auto DenE = tEnd1 - tStart1;
+            dE = NumE.R() / DenE.R();
+            if (l == 0) {
+              temp = dE;
+              IndexE = iTrk1;
+              IScore = getScore;
+              IType = getType;
+            }
+            if (dE < temp) {
+              temp = dE;
+              IndexE = iTrk1;
+              IScore = getScore;
+              IType = getType;
+            }
+            l++;
+          }
+        }
+        Track const* tTrkI = &TrkVec.at(IndexE);
+        auto tStartI = tTrkI->Vertex();
+        auto tEndI = tTrkI->End();
+        auto NumS = (tStart - tStartI).Cross(tStart - tEndI);
+        auto DenS = tEndI - tStartI;
+        dS = NumS.R() / DenS.R();
+        if (((dS < 5 && temp < 5) || (dS < temp && dS < 5)) && (tTrk->Length() < 60)) {
+          cosmicTagTrackVector[iTrk].CosmicScore() = IScore - 0.05;
+          cosmicTagTrackVector[iTrk].CosmicType() = IType;
+        }
+      }
+    }
+    return cosmicTagTrackVector;
+  }
+
+  std::vector<anab::CosmicTag> NewTags(Alg const& alg,
+                                       std::vector<Track> const& TrkVec,
+                                       std::vector<std::vector<Hit const*>> const& hitsSpill)
+  {
+    std::vector<Alg::TrackSummary> summaries(TrkVec.size());
+    for (size_t iTrack = 0; iTrack < TrkVec.size(); ++iTrack) {
+      Track const& track = TrkVec[iTrack];
+      summaries[iTrack] =
+        Alg::MakeSummary(track.Vertex(), track.End(), track.Length(), hitsSpill[iTrack]);
+    }
+    std::vector<anab::CosmicTag> cosmicTags;
+    alg.MakeTags(summaries, cosmicTags);
+    return cosmicTags;
+  }
+
+  template <typename F>
+  double TimeEvents(F f, std::vector<anab::CosmicTag>& tags)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t e = 0; e < NEvents; ++e) tags = f();
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/NEvents;
+  }
+
+  bool SameTags(std::vector<anab::CosmicTag> const& a, std::vector<anab::CosmicTag> const& b)
+  {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (a[i].CosmicScore() != b[i].CosmicScore() || a[i].CosmicType() != b[i].CosmicType() ||
+          a[i].endPt1 != b[i].endPt1 || a[i].endPt2 != b[i].endPt2)
+        return false;
+    }
+    return true;
+  }
+
+}
+
+int main()
+{
+  std::mt19937 gen(40);
+  std::uniform_real_distribution<double> flat(0., 1.);
+
+  // long tracks, some reaching the borders or out of time, and short stubs
+  std::vector<Track> tracks;
+  std::vector<Hit> hits;
+  for (size_t i = 0; i < NTracks; ++i) {
+    Vector const start{DetWidth * flat(gen),
+                       2 * DetHalfHeight * flat(gen) - DetHalfHeight,
+                       DetLength * flat(gen)};
+    double const scale = (i % 3 == 0) ? 30. : 300.;
+    Vector const end{start.x + scale * (flat(gen) - 0.5),
+                     start.y + scale * (flat(gen) - 0.5),
+                     start.z + scale * (flat(gen) - 0.5)};
+    tracks.push_back({start, end, (end - start).R()});
+    float const peak = MinTickDrift - 200 + 5000 * flat(gen);
+    for (size_t h = 0; h < NHitsPerTrack; ++h)
+      hits.push_back({peak + (float)(100. * flat(gen)), 5.f});
+  }
+  std::vector<std::vector<Hit const*>> hitsSpill(NTracks);
+  for (size_t i = 0; i < NTracks; ++i)
+    for (size_t h = 0; h < NHitsPerTrack; ++h)
+      hitsSpill[i].push_back(&hits[i * NHitsPerTrack + h]);
+
+  fhicl::ParameterSet pset;
+  Alg alg(pset);
+  alg.SetDetector(DetHalfHeight, DetWidth, DetLength, MinTickDrift, MaxTickDrift);
+
+  std::vector<anab::CosmicTag> old_tags, tags;
+  double const t_old = TimeEvents([&]() { return OldTags(tracks, hitsSpill); }, old_tags);
+  double const t_new = TimeEvents([&]() { return NewTags(alg, tracks, hitsSpill); }, tags);
+
+  size_t nTagged = 0;
+  for (auto const& tag : tags)
+    if (tag.CosmicScore() != 0) ++nTagged;
+
+  std::printf("%zu tracks (%zu tagged): track by track %7.2f ms/event, summaries %6.2f ms/event (%s)\n",
+              NTracks, nTagged, t_old, t_new,
+              SameTags(old_tags, tags) ? "same tags" : "TAGS DIFFER");
+  return 0;
+}
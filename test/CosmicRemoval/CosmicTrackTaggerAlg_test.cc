@@ -0,0 +1,230 @@
+#define BOOST_TEST_MODULE ( CosmicTrackTaggerAlg_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/CosmicRemoval/CosmicTrackTaggerAlg.h"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using Alg = cosmic::CosmicTrackTaggerAlg;
+
+namespace {
+
+  struct Point {
+    double x, y, z;
+    double X() const { return x; }
+    double Y() const { return y; }
+    double Z() const { return z; }
+  };
+
+  struct Hit {
+    float peak, rms;
+    float PeakTimeMinusRMS() const { return peak - rms; }
+    float PeakTimePlusRMS() const { return peak + rms; }
+  };
+
+  // microboone-like detector
+  float const DetHalfHeight = 116.5;
+  float const DetWidth = 256.35;
+  float const DetLength = 1036.8;
+  int const MinTickDrift = 3200;
+  int const MaxTickDrift = 3200 + 4600 + 50;
+
+  Alg MakeAlg()
+  {
+    fhicl::ParameterSet pset;
+    Alg alg(pset);
+    alg.SetDetector(DetHalfHeight, DetWidth, DetLength, MinTickDrift, MaxTickDrift);
+    return alg;
+  }
+
+  double DistFromLine(std::array<double, 3> const& p, Alg::TrackSummary const& line)
+  {
+    std::array<double, 3> a, b, d;
+    for (size_t i = 0; i < 3; ++i) {
+      a[i] = p[i] - line.Start[i];
+      b[i] = p[i] - line.End[i];
+      d[i] = line.End[i] - line.Start[i];
+    }
+    double const cx = a[1] * b[2] - b[1] * a[2];
+    double const cy = a[2] * b[0] - b[2] * a[0];
+    double const cz = a[0] * b[1] - b[0] * a[1];
+    return std::sqrt(cx * cx + cy * cy + cz * cz) /
+           std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+  }
+
+  /// Delta-ray tagging as CosmicTrackTagger used to do, comparing every
+  /// untagged track with every tagged one
+  void ReferenceDeltaRays(std::vector<Alg::TrackSummary> const& tracks,
+                          std::vector<anab::CosmicTag>& tags)
+  {
+    float dE = 0, dS = 0, temp = 0, IScore = 0;
+    unsigned int IndexE = 0;
+    anab::CosmicTagID_t IType = anab::CosmicTagID_t::kNotTagged;
+    for (size_t iTrk = 0; iTrk < tracks.size(); iTrk++) {
+      if (tags[iTrk].CosmicScore() != 0) continue;
+      unsigned int l = 0;
+      for (size_t iTrk1 = 0; iTrk1 < tracks.size(); iTrk1++) {
+        float getScore = tags[iTrk1].CosmicScore();
+        if (getScore == 1 || getScore == 0.5) {
+          dE = DistFromLine(tracks[iTrk].End, tracks[iTrk1]);
+          if (l == 0 || dE < temp) {
+            temp = dE;
+            IndexE = iTrk1;
+            IScore = getScore;
+            IType = tags[iTrk1].CosmicType();
+          }
+          l++;
+        }
+      }
+      dS = DistFromLine(tracks[iTrk].Start, tracks[IndexE]);
+      if (((dS < 5 && temp < 5) || (dS < temp && dS < 5)) && (tracks[iTrk].Length < 60)) {
+        tags[iTrk].CosmicScore() = IScore - 0.05;
+        tags[iTrk].CosmicType() = IType;
+      }
+    }
+  }
+
+  Alg::TrackSummary MakeTrack(Point const& start, Point const& end, std::vector<Hit> const& hits)
+  {
+    std::vector<Hit const*> hitPtrs;
+    for (auto const& hit : hits)
+      hitPtrs.push_back(&hit);
+    double const length =
+      std::hypot(end.x - start.x, end.y - start.y, end.z - start.z);
+    return Alg::MakeSummary(start, end, length, hitPtrs);
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(CosmicTrackTaggerAlg_test)
+
+BOOST_AUTO_TEST_CASE(checkSummary)
+{
+  auto const track =
+    MakeTrack({1., 2., 3.}, {4., 5., 6.}, {{4000., 5.}, {3990., 20.}, {4100., 1.}});
+  BOOST_CHECK_EQUAL(track.Start[1], 2.);
+  BOOST_CHECK_EQUAL(track.End[2], 6.);
+  BOOST_CHECK_EQUAL(track.MinTick, 3970.f);
+  BOOST_CHECK_EQUAL(track.MaxTick, 4101.f);
+  BOOST_CHECK(Alg::HasValidEndPoints(track));
+
+  double const nan = std::numeric_limits<double>::quiet_NaN();
+  BOOST_CHECK(!Alg::HasValidEndPoints(MakeTrack({1., nan, 3.}, {4., 5., 6.}, {})));
+}
+
+BOOST_AUTO_TEST_CASE(checkTrackTags)
+{
+  Alg const alg = MakeAlg();
+  double const nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<Hit> const inTime = {{5000., 10.}};
+
+  std::vector<Alg::TrackSummary> const tracks = {
+    MakeTrack({100., 0., 500.}, {120., 10., 520.}, inTime),            // contained
+    MakeTrack({200., 0., 800.}, {220., 10., 820.}, {{3100., 10.}}),    // before the drift window
+    MakeTrack({100., 115., 500.}, {120., -115., 520.}, inTime),        // top to bottom
+    MakeTrack({100., 115., 500.}, {120., 10., 520.}, inTime),          // from the top
+    MakeTrack({100., 115., 2.}, {120., 10., 520.}, inTime),            // from the top and front
+    MakeTrack({1., 0., 500.}, {255., 10., 520.}, inTime),              // through the X faces
+    MakeTrack({nan, 0., 500.}, {120., 10., 520.}, inTime),             // broken
+  };
+  std::vector<anab::CosmicTag> tags;
+  alg.MakeTags(tracks, tags);
+  BOOST_REQUIRE_EQUAL(tags.size(), tracks.size());
+
+  BOOST_CHECK_EQUAL(tags[0].CosmicScore(), 0.f);
+  BOOST_CHECK_EQUAL(tags[0].CosmicType(), anab::CosmicTagID_t::kNotTagged);
+  BOOST_CHECK_EQUAL(tags[1].CosmicScore(), 1.f);
+  BOOST_CHECK_EQUAL(tags[1].CosmicType(), anab::CosmicTagID_t::kOutsideDrift_Partial);
+  BOOST_CHECK_EQUAL(tags[2].CosmicScore(), 1.f);
+  BOOST_CHECK_EQUAL(tags[2].CosmicType(), anab::CosmicTagID_t::kGeometry_YY);
+  BOOST_CHECK_EQUAL(tags[3].CosmicScore(), 0.5f);
+  BOOST_CHECK_EQUAL(tags[3].CosmicType(), anab::CosmicTagID_t::kGeometry_Y);
+  BOOST_CHECK_EQUAL(tags[4].CosmicScore(), 1.f);
+  BOOST_CHECK_EQUAL(tags[4].CosmicType(), anab::CosmicTagID_t::kGeometry_YZ);
+  BOOST_CHECK_EQUAL(tags[5].CosmicScore(), 1.f);
+  BOOST_CHECK_EQUAL(tags[5].CosmicType(), anab::CosmicTagID_t::kGeometry_XX);
+  BOOST_CHECK_EQUAL(tags[6].CosmicScore(), -999.f);
+  BOOST_CHECK_EQUAL(tags[6].endPt1[0], -999.f);
+}
+
+BOOST_AUTO_TEST_CASE(checkDeltaRay)
+{
+  Alg const alg = MakeAlg();
+  std::vector<Hit> const inTime = {{5000., 10.}};
+
+  std::vector<Alg::TrackSummary> const tracks = {
+    MakeTrack({100., 116., 500.}, {100., -116., 500.}, inTime), // vertical cosmic ray
+    MakeTrack({101., 20., 501.}, {110., 25., 510.}, inTime),    // delta ray off it
+    MakeTrack({150., 20., 500.}, {160., 25., 510.}, inTime),    // far from it
+  };
+  std::vector<anab::CosmicTag> tags;
+  alg.MakeTags(tracks, tags);
+
+  BOOST_CHECK_EQUAL(tags[0].CosmicType(), anab::CosmicTagID_t::kGeometry_YY);
+  BOOST_CHECK_CLOSE(tags[1].CosmicScore(), 0.95f, 1e-4);
+  BOOST_CHECK_EQUAL(tags[1].CosmicType(), anab::CosmicTagID_t::kGeometry_YY);
+  BOOST_CHECK_EQUAL(tags[2].CosmicScore(), 0.f);
+}
+
+BOOST_AUTO_TEST_CASE(checkAgainstReference)
+{
+  Alg const alg = MakeAlg();
+  std::mt19937 gen(2718);
+  std::uniform_real_distribution<double> flat(0., 1.);
+
+  for (int trial = 0; trial < 40; ++trial) {
+    std::vector<Alg::TrackSummary> tracks;
+    size_t const nTracks = (trial == 0) ? 1 : (size_t)(200 * flat(gen));
+    for (size_t i = 0; i < nTracks; ++i) {
+      Point const start{DetWidth * flat(gen),
+                        2 * DetHalfHeight * flat(gen) - DetHalfHeight,
+                        DetLength * flat(gen)};
+      // short stubs and long tracks, some of them reaching the borders
+      double const scale = (flat(gen) < 0.6) ? 30. : 300.;
+      Point end{start.x + scale * (flat(gen) - 0.5),
+                start.y + scale * (flat(gen) - 0.5),
+                start.z + scale * (flat(gen) - 0.5)};
+      if (flat(gen) < 0.02) end = start; // a point-like track
+      std::vector<Hit> const hits = {{(float)(MinTickDrift - 200 + 5000 * flat(gen)), 10.f}};
+      tracks.push_back(MakeTrack(start, end, hits));
+    }
+
+    // trials without any tagged track: every track contained and in time
+    if (trial % 10 == 1) {
+      for (auto& track : tracks) {
+        track.Start = {100., 0., 500.};
+        track.End = {100. + 10. * flat(gen), 10. * flat(gen), 500. + 10. * flat(gen)};
+        track.MinTick = track.MaxTick = 5000.;
+      }
+    }
+
+    std::vector<anab::CosmicTag> tags;
+    alg.MakeTags(tracks, tags);
+    BOOST_REQUIRE_EQUAL(tags.size(), tracks.size());
+
+    // tags before the delta-ray search, one track at a time: a long track
+    // is never re-tagged
+    std::vector<anab::CosmicTag> expected;
+    for (auto track : tracks) {
+      std::vector<anab::CosmicTag> single;
+      track.Length = 1000.;
+      alg.MakeTags({track}, single);
+      expected.push_back(single.front());
+    }
+    ReferenceDeltaRays(tracks, expected);
+
+    for (size_t i = 0; i < tracks.size(); ++i) {
+      BOOST_CHECK_EQUAL(tags[i].CosmicScore(), expected[i].CosmicScore());
+      BOOST_CHECK_EQUAL(tags[i].CosmicType(), expected[i].CosmicType());
+      BOOST_CHECK(tags[i].endPt1 == expected[i].endPt1);
+      BOOST_CHECK(tags[i].endPt2 == expected[i].endPt2);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,192 @@
+// AlgoCFD pulse finding against the implementation it replaced: CFD trace
+// stored with push_back, crossings collected in a std::map and duplicate
+// pulses removed through two std::unordered_map passes.
+// Built with the tests, not run by them.
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoCFD.h"
+#include "larana/OpticalDetector/OpHitFinder/UtilFunc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  const float  Fraction    = 0.9;
+  const int    Delay       = 2;
+  const double PeakThresh  = 7.5;
+  const double StartThresh = 5.;
+  const double EndThresh   = 1.5;
+
+  // previous implementation
+  std::map<unsigned,double> OldLinearZeroPointX(const std::vector<double>& trace)
+  {
+    std::map<unsigned,double> crossing;
+    for ( unsigned i = 0; i < trace.size() - 1; ++i) {
+      auto si = ::pmtana::sign(trace.at(i));
+      auto sf = ::pmtana::sign(trace.at(i+1));
+      if ( si == sf ) continue;
+      if ( sf < si ) continue;
+      crossing[i] = (double) i - trace.at(i) * ( 1.0 / ( trace.at(i+1) - trace.at(i) ) );
+    }
+    return crossing;
+  }
+
+  pmtana::pulse_param_array OldRecoPulse(const pmtana::Waveform_t& wf,
+					 const pmtana::PedestalMean_t& mean_v,
+					 const pmtana::PedestalSigma_t& sigma_v)
+  {
+    pmtana::pulse_param_array pulse_v;
+    pmtana::pulse_param pulse;
+
+    std::vector<double> cfd; cfd.reserve(wf.size());
+    for (unsigned int k = 0; k < wf.size(); ++k)  {
+      auto delayed = -1.0 * Fraction *  ( (float) wf.at(k) - mean_v.at(k) );
+      if ((int)k < Delay)
+	cfd.push_back( delayed );
+      else
+	cfd.push_back(delayed +  ( (float) wf.at(k - Delay) - mean_v.at(k) ) );
+    }
+
+    auto crossings = OldLinearZeroPointX(cfd);
+
+    auto in_peak = [&wf,&sigma_v,&mean_v](int i, float thresh) -> bool
+      { return wf.at(i) > sigma_v.at(i) * thresh +  mean_v.at(i); };
+
+    for(const auto& cross : crossings) {
+      if( !in_peak( cross.first, PeakThresh) ) continue;
+      pulse.reset_param();
+      int i = cross.first;
+      while ( in_peak(i, StartThresh) ){
+	i--;
+	if ( i < 0 ) { i = 0; break; }
+      }
+      pulse.t_start = i;
+      i = pulse.t_start + 1;
+      while ( in_peak(i,EndThresh) ) {
+	i++;
+	if ( i > (int)(wf.size()) - 1 ) { i = (int)(wf.size()) - 1; break; }
+      }
+      pulse.t_end = i;
+
+      auto start_ped = mean_v.at(pulse.t_start);
+      auto end_ped   = mean_v.at(pulse.t_end);
+      pulse.ped_mean = start_ped <= end_ped ? start_ped : end_ped;
+      if(wf.size() < 50) pulse.ped_mean = mean_v.front();
+
+      auto it = std::max_element(std::begin(wf) + pulse.t_start, std::begin(wf) + pulse.t_end);
+      pulse.t_max      =  it - std::begin(wf);
+      pulse.peak       = *it - pulse.ped_mean;
+      pulse.t_cfdcross =  cross.second;
+      for(auto k = pulse.t_start; k <= pulse.t_end; ++k) {
+	auto a = wf.at(k) - pulse.ped_mean;
+	if ( a > 0 ) pulse.area += a;
+      }
+      pulse_v.push_back(pulse);
+    }
+
+    for(int pass = 0; pass < 2; ++pass) {
+      auto pulses_copy = pulse_v;
+      pulse_v.clear();
+      std::unordered_map<unsigned,pmtana::pulse_param> delta;
+      for( const auto& p : pulses_copy )  {
+	unsigned key = pass==0? p.t_start : p.t_end;
+	if ( delta.count(key) )  {
+	  if (  (p.t_end - p.t_start) > (delta[key].t_end - delta[key].t_start) )
+	    delta[key] = p;
+	  else
+	    continue;
+	}
+	else {
+	  delta[key] = p;
+	}
+      }
+      for(const auto & p : delta)
+	pulse_v.push_back(p.second);
+    }
+    return pulse_v;
+  }
+
+  /// 2000 ADC baseline with bursts of piled-up exponential pulses
+  pmtana::Waveform_t MakeWaveform(size_t n, size_t seed)
+  {
+    pmtana::Waveform_t wf(n);
+    for(size_t i=0; i<n; ++i)
+      wf[i] = 2000 + (short)(((i+seed)*7)%5) - 2;
+    for(size_t t0 = 50 + seed%40; t0+80 < n; t0 += 150 + (t0*13+seed)%100) {
+      for(size_t dt : {size_t(0), 3 + seed%5, 9 + seed%7})
+	for(size_t i=t0+dt; i<t0+dt+40 && i<n; ++i)
+	  wf[i] += (short)(60.*std::exp(-(double)(i-t0-dt)/5.));
+    }
+    return wf;
+  }
+
+  bool SameOrdered(pmtana::pulse_param_array a, pmtana::pulse_param_array b)
+  {
+    if(a.size() != b.size()) return false;
+    auto by_time = [](const pmtana::pulse_param& x, const pmtana::pulse_param& y)
+      { return x.t_start != y.t_start? x.t_start < y.t_start : x.t_end < y.t_end; };
+    std::sort(a.begin(),a.end(),by_time);
+    std::sort(b.begin(),b.end(),by_time);
+    for(size_t i=0; i<a.size(); ++i) {
+      if(a[i].t_start != b[i].t_start || a[i].t_end != b[i].t_end ||
+	 a[i].t_max != b[i].t_max || a[i].peak != b[i].peak ||
+	 a[i].area != b[i].area || a[i].ped_mean != b[i].ped_mean ||
+	 a[i].t_cfdcross != b[i].t_cfdcross) return false;
+    }
+    return true;
+  }
+
+}
+
+int main()
+{
+  const size_t NWaveforms = 2000;
+
+  fhicl::ParameterSet cfd_pset;
+  cfd_pset.put("Fraction",Fraction);
+  cfd_pset.put("Delay",Delay);
+  cfd_pset.put("PeakThresh",PeakThresh);
+  cfd_pset.put("StartThresh",StartThresh);
+  cfd_pset.put("EndThresh",EndThresh);
+  pmtana::AlgoCFD algo(cfd_pset);
+
+  for(size_t nsamples : {1500, 20000}){
+    std::vector<pmtana::Waveform_t> wfs;
+    for(size_t i=0; i<NWaveforms*1500/nsamples; ++i) wfs.push_back(MakeWaveform(nsamples,i));
+    pmtana::PedestalMean_t  mean_v (nsamples,2000.);
+    pmtana::PedestalSigma_t sigma_v(nsamples,2.);
+
+    std::vector<pmtana::pulse_param_array> old_pulses, new_pulses;
+    old_pulses.reserve(wfs.size()); new_pulses.reserve(wfs.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for(auto const& wf : wfs) old_pulses.push_back(OldRecoPulse(wf,mean_v,sigma_v));
+    auto stop = std::chrono::steady_clock::now();
+    double const t_old = std::chrono::duration<double,std::nano>(stop-start).count()/wfs.size();
+
+    start = std::chrono::steady_clock::now();
+    for(auto const& wf : wfs) {
+      algo.Reconstruct(wf,mean_v,sigma_v);
+      new_pulses.push_back(algo.GetPulses());
+    }
+    stop = std::chrono::steady_clock::now();
+    double const t_new = std::chrono::duration<double,std::nano>(stop-start).count()/wfs.size();
+
+    size_t npulses = 0;
+    bool same = true;
+    for(size_t i=0; i<wfs.size(); ++i) {
+      npulses += new_pulses[i].size();
+      same = same && SameOrdered(old_pulses[i],new_pulses[i]);
+    }
+    std::printf("%5zu samples, %5.1f pulses/waveform: old %8.0f ns/waveform, new %8.0f ns/waveform (%s)\n",
+		nsamples,(double)npulses/wfs.size(),t_old,t_new,
+		same? "same pulses" : "PULSES DIFFER");
+  }
+  return 0;
+}
@@ -0,0 +1,197 @@
+// AlgoSlidingWindow pulse finding against the state machine it replaced,
+// which derived the start, tail and end thresholds from sigma at every
+// sample. Waveforms of 1k to 50k samples with sparse pulses, constant and
+// per-sample pedestals.
+// Built with the tests, not run by them.
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoSlidingWindow.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  const bool   Positive     = true;
+  const float  ADCThres     = 5, TailADCThres = 5, EndADCThres = 2;
+  const float  NSigma       = 3, TailNSigma   = 3, EndNSigma   = 1;
+  const size_t NumPreSample = 3, NumPostSample = 2, MinWidth = 0;
+
+  // previous implementation (verbosity output removed)
+  template <typename MeanArray, typename SigmaArray>
+  pmtana::pulse_param_array OldRecoPulse(const pmtana::Waveform_t& wf,
+					 const MeanArray& mean_v,
+					 const SigmaArray& sigma_v)
+  {
+    pmtana::pulse_param_array pulse_v;
+    pmtana::pulse_param pulse;
+    bool fire = false, in_tail = false, in_post = false;
+    double pulse_tail_threshold = 0, pulse_end_threshold = 0, pulse_start_baseline = 0;
+    int post_integration = 0;
+
+    for (size_t i = 0; i < wf.size(); ++i) {
+
+      double value = 0.;
+      if (Positive) value = ((double)(wf[i])) - mean_v[i];
+      else          value = mean_v[i] - ((double)(wf[i]));
+
+      float start_threshold = 0.;
+      float tail_threshold = 0.;
+      if (sigma_v[i] * NSigma < ADCThres) start_threshold = ADCThres;
+      else start_threshold = sigma_v[i] * NSigma;
+      if (sigma_v[i] * TailNSigma < TailADCThres) tail_threshold = TailADCThres;
+      else tail_threshold = sigma_v[i] * TailNSigma;
+
+      if ((!fire || in_tail || in_post) && ((double)value > start_threshold)) {
+	if (in_tail) {
+	  pulse.t_end = i - 1;
+	  if ((pulse.t_end - pulse.t_start) >= MinWidth) pulse_v.push_back(pulse);
+	  pulse.reset_param();
+	}
+	pulse_tail_threshold = tail_threshold;
+	pulse_start_baseline = mean_v[i];
+	pulse_end_threshold = 0.;
+	if (sigma_v[i] * EndNSigma < EndADCThres) pulse_end_threshold = EndADCThres;
+	else pulse_end_threshold = sigma_v[i] * EndNSigma;
+
+	int buffer_num_index = 0;
+	if (pulse_v.size()) buffer_num_index = (int)i - pulse_v.back().t_end - 1;
+	else buffer_num_index = std::min(NumPreSample, i);
+	if (buffer_num_index > (int)NumPreSample) buffer_num_index = NumPreSample;
+
+	if (in_post) {
+	  pulse.t_end = static_cast<int>(i) - buffer_num_index;
+	  if (pulse.t_end > 0) --pulse.t_end;
+	  if ((pulse.t_end - pulse.t_start) >= MinWidth) pulse_v.push_back(pulse);
+	  pulse.reset_param();
+	}
+
+	pulse.t_start = i - buffer_num_index;
+	pulse.ped_mean = pulse_start_baseline;
+	pulse.ped_sigma = sigma_v[i];
+	for (size_t pre_index = pulse.t_start; pre_index < i; ++pre_index) {
+	  double pre_adc = wf[pre_index];
+	  if (Positive) pre_adc -= pulse_start_baseline;
+	  else pre_adc = pulse_start_baseline - pre_adc;
+	  if (pre_adc > 0.) pulse.area += pre_adc;
+	}
+	fire = true; in_tail = false; in_post = false;
+      }
+
+      if (fire && value < pulse_tail_threshold) {
+	fire = false; in_tail = true; in_post = false;
+      }
+      if ((fire || in_tail) && value < pulse_end_threshold) {
+	in_post = true; fire = in_tail = false;
+	post_integration = NumPostSample;
+      }
+      if (in_post && post_integration < 1) {
+	pulse.t_end = i - 1;
+	if ((pulse.t_end - pulse.t_start) >= MinWidth) pulse_v.push_back(pulse);
+	pulse.reset_param();
+	fire = in_tail = in_post = false;
+      }
+      if (fire || in_tail || in_post) {
+	pulse.area += value;
+	if (pulse.peak < value) { pulse.peak = value; pulse.t_max = i; }
+	if (in_post) --post_integration;
+      }
+    }
+
+    if (fire || in_tail || in_post) {
+      pulse.t_end = wf.size() - 1;
+      if ((pulse.t_end - pulse.t_start) >= MinWidth) pulse_v.push_back(pulse);
+    }
+    return pulse_v;
+  }
+
+  /// noisy 2000 ADC baseline with 10 pulses
+  pmtana::Waveform_t MakeWaveform(size_t n, size_t seed)
+  {
+    pmtana::Waveform_t wf(n);
+    for(size_t i=0; i<n; ++i)
+      wf[i] = 2000 + (short)(((i+seed)*7919)%5) - 2;
+    for(size_t p=0; p<10; ++p) {
+      const size_t t0 = (p*n)/10 + (seed*31)%(n/20);
+      for(size_t i=t0; i<t0+40 && i<n; ++i)
+	wf[i] += (short)(80.*std::exp(-(double)(i-t0)/6.));
+    }
+    return wf;
+  }
+
+  bool SamePulses(const pmtana::pulse_param_array& a, const pmtana::pulse_param_array& b)
+  {
+    if(a.size() != b.size()) return false;
+    for(size_t i=0; i<a.size(); ++i) {
+      if(a[i].t_start != b[i].t_start || a[i].t_end != b[i].t_end ||
+	 a[i].t_max != b[i].t_max || a[i].peak != b[i].peak ||
+	 a[i].area != b[i].area || a[i].ped_mean != b[i].ped_mean ||
+	 a[i].ped_sigma != b[i].ped_sigma) return false;
+    }
+    return true;
+  }
+
+}
+
+int main()
+{
+  const size_t TotalSamples = 20000000;
+
+  fhicl::ParameterSet pset;
+  pset.put("PositivePolarity",Positive);
+  pset.put("ADCThreshold",ADCThres);
+  pset.put("TailADCThreshold",TailADCThres);
+  pset.put("EndADCThreshold",EndADCThres);
+  pset.put("NSigmaThreshold",NSigma);
+  pset.put("TailNSigma",TailNSigma);
+  pset.put("EndNSigmaThreshold",EndNSigma);
+  pset.put("Verbosity",false);
+  pset.put("NumPreSample",NumPreSample);
+  pset.put("NumPostSample",NumPostSample);
+  pset.put("MinPulseWidth",MinWidth);
+  pmtana::AlgoSlidingWindow algo(pset);
+
+  for(size_t nsamples : {1000, 5000, 20000, 50000}){
+    std::vector<pmtana::Waveform_t> wfs;
+    for(size_t i=0; i<TotalSamples/nsamples; ++i) wfs.push_back(MakeWaveform(nsamples,i));
+
+    for(bool constant : {true, false}){
+      pmtana::PedestalMean_t  mean_v (constant? 1 : nsamples,2000.);
+      pmtana::PedestalSigma_t sigma_v(constant? 1 : nsamples,1.5);
+      if(!constant)
+	for(size_t i=0; i<nsamples; ++i) sigma_v[i] = 1.5 + 0.3*std::cos(0.02*i);
+
+      std::vector<pmtana::pulse_param_array> old_pulses, new_pulses;
+      old_pulses.reserve(wfs.size()); new_pulses.reserve(wfs.size());
+
+      auto start = std::chrono::steady_clock::now();
+      for(auto const& wf : wfs) {
+	if(constant)
+	  old_pulses.push_back(OldRecoPulse(wf,pmtana::ConstantPedestal_t{mean_v.front()},
+					    pmtana::ConstantPedestal_t{sigma_v.front()}));
+	else
+	  old_pulses.push_back(OldRecoPulse(wf,mean_v,sigma_v));
+      }
+      auto stop = std::chrono::steady_clock::now();
+      double const t_old = std::chrono::duration<double,std::nano>(stop-start).count()/TotalSamples;
+
+      start = std::chrono::steady_clock::now();
+      for(auto const& wf : wfs) {
+	algo.Reconstruct(wf,mean_v,sigma_v);
+	new_pulses.push_back(algo.GetPulses());
+      }
+      stop = std::chrono::steady_clock::now();
+      double const t_new = std::chrono::duration<double,std::nano>(stop-start).count()/TotalSamples;
+
+      bool same = true;
+      for(size_t i=0; i<wfs.size(); ++i) same = same && SamePulses(old_pulses[i],new_pulses[i]);
+      std::printf("%5zu samples, %-9s pedestal: old %5.2f ns/sample, new %5.2f ns/sample (%s)\n",
+		  nsamples,constant? "constant" : "per-sample",t_old,t_new,
+		  same? "same pulses" : "PULSES DIFFER");
+    }
+  }
+  return 0;
+}
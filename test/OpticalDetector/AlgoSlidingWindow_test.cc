@@ -0,0 +1,293 @@
+#define BOOST_TEST_MODULE ( AlgoSlidingWindow_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoSlidingWindow.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+  struct SlidingWindowParams {
+    bool positive = true;
+    float adc_thres = 5, tail_adc_thres = 5, end_adc_thres = 2;
+    float nsigma = 3, tail_nsigma = 3, end_nsigma = 1;
+    size_t num_presample = 3, num_postsample = 2, min_width = 0;
+
+    fhicl::ParameterSet PSet() const
+    {
+      fhicl::ParameterSet pset;
+      pset.put("PositivePolarity",positive);
+      pset.put("ADCThreshold",adc_thres);
+      pset.put("TailADCThreshold",tail_adc_thres);
+      pset.put("EndADCThreshold",end_adc_thres);
+      pset.put("NSigmaThreshold",nsigma);
+      pset.put("TailNSigma",tail_nsigma);
+      pset.put("EndNSigmaThreshold",end_nsigma);
+      pset.put("Verbosity",false);
+      pset.put("NumPreSample",num_presample);
+      pset.put("NumPostSample",num_postsample);
+      pset.put("MinPulseWidth",min_width);
+      return pset;
+    }
+  };
+
+  /// Straightforward per-sample state machine the algorithm must reproduce
+  pmtana::pulse_param_array ReferenceSlidingWindow(const SlidingWindowParams& par,
+						   const pmtana::Waveform_t& wf,
+						   const pmtana::PedestalMean_t& mean_v,
+						   const pmtana::PedestalSigma_t& sigma_v)
+  {
+    // same arithmetic as the original code: product in double, start and
+    // tail thresholds rounded to float, end threshold kept in double
+    auto threshold = [](double sigma, float nsigma, float adc) -> double
+      { return (sigma * nsigma < adc) ? adc : sigma * nsigma; };
+
+    pmtana::pulse_param_array pulse_v;
+    pmtana::pulse_param pulse;
+    bool fire = false, in_tail = false, in_post = false;
+    double pulse_tail_threshold = 0, pulse_end_threshold = 0, pulse_start_baseline = 0;
+    int post_integration = 0;
+
+    for(size_t i=0; i<wf.size(); ++i) {
+
+      double value = par.positive ? ((double)(wf[i])) - mean_v[i] : mean_v[i] - ((double)(wf[i]));
+      float start_threshold = threshold(sigma_v[i],par.nsigma,par.adc_thres);
+
+      if((!fire || in_tail || in_post) && value > start_threshold) {
+
+	if(in_tail) {
+	  pulse.t_end = i - 1;
+	  if((pulse.t_end - pulse.t_start) >= par.min_width) pulse_v.push_back(pulse);
+	  pulse.reset_param();
+	}
+
+	pulse_tail_threshold = (float) threshold(sigma_v[i],par.tail_nsigma,par.tail_adc_thres);
+	pulse_end_threshold  = threshold(sigma_v[i],par.end_nsigma,par.end_adc_thres);
+	pulse_start_baseline = mean_v[i];
+
+	int buffer_num_index = pulse_v.size() ? (int)i - pulse_v.back().t_end - 1 : std::min(par.num_presample,i);
+	if(buffer_num_index > (int)par.num_presample) buffer_num_index = par.num_presample;
+
+	if(in_post) {
+	  pulse.t_end = static_cast<int>(i) - buffer_num_index;
+	  if(pulse.t_end > 0) --pulse.t_end;
+	  if((pulse.t_end - pulse.t_start) >= par.min_width) pulse_v.push_back(pulse);
+	  pulse.reset_param();
+	}
+
+	pulse.t_start   = i - buffer_num_index;
+	pulse.ped_mean  = pulse_start_baseline;
+	pulse.ped_sigma = sigma_v[i];
+
+	for(size_t pre_index = pulse.t_start; pre_index < i; ++pre_index) {
+	  double pre_adc = par.positive ? wf[pre_index] - pulse_start_baseline : pulse_start_baseline - wf[pre_index];
+	  if(pre_adc > 0.) pulse.area += pre_adc;
+	}
+
+	fire = true; in_tail = false; in_post = false;
+      }
+
+      if(fire && value < pulse_tail_threshold) {
+	fire = false; in_tail = true; in_post = false;
+      }
+
+      if((fire || in_tail) && value < pulse_end_threshold) {
+	in_post = true; fire = in_tail = false;
+	post_integration = par.num_postsample;
+      }
+
+      if(in_post && post_integration < 1) {
+	pulse.t_end = i - 1;
+	if((pulse.t_end - pulse.t_start) >= par.min_width) pulse_v.push_back(pulse);
+	pulse.reset_param();
+	fire = in_tail = in_post = false;
+      }
+
+      if(fire || in_tail || in_post) {
+	pulse.area += value;
+	if(pulse.peak < value) { pulse.peak = value; pulse.t_max = i; }
+	if(in_post) --post_integration;
+      }
+    }
+
+    if(fire || in_tail || in_post) {
+      pulse.t_end = wf.size() - 1;
+      if((pulse.t_end - pulse.t_start) >= par.min_width) pulse_v.push_back(pulse);
+    }
+
+    return pulse_v;
+  }
+
+  void CheckSamePulses(const pmtana::pulse_param_array& result,
+		       const pmtana::pulse_param_array& expected)
+  {
+    BOOST_REQUIRE_EQUAL(result.size(),expected.size());
+    for(size_t i=0; i<result.size(); ++i) {
+      BOOST_CHECK_EQUAL(result[i].t_start,  expected[i].t_start);
+      BOOST_CHECK_EQUAL(result[i].t_max,    expected[i].t_max);
+      BOOST_CHECK_EQUAL(result[i].t_end,    expected[i].t_end);
+      BOOST_CHECK_EQUAL(result[i].area,     expected[i].area);
+      BOOST_CHECK_EQUAL(result[i].peak,     expected[i].peak);
+      BOOST_CHECK_EQUAL(result[i].ped_mean, expected[i].ped_mean);
+      BOOST_CHECK_EQUAL(result[i].ped_sigma,expected[i].ped_sigma);
+    }
+  }
+
+  /// Runs the algorithm with the given pedestal and compares with the reference
+  void CheckAgainstReference(const SlidingWindowParams& par,
+			     const pmtana::Waveform_t& wf,
+			     const pmtana::PedestalMean_t& mean_v,
+			     const pmtana::PedestalSigma_t& sigma_v)
+  {
+    pmtana::AlgoSlidingWindow algo(par.PSet());
+    BOOST_REQUIRE(algo.Reconstruct(wf,mean_v,sigma_v));
+
+    pmtana::PedestalMean_t  full_mean_v  = mean_v;
+    pmtana::PedestalSigma_t full_sigma_v = sigma_v;
+    if(mean_v.size() == 1) {
+      full_mean_v.assign(wf.size(),mean_v.front());
+      full_sigma_v.assign(wf.size(),sigma_v.front());
+    }
+
+    CheckSamePulses(algo.GetPulses(),ReferenceSlidingWindow(par,wf,full_mean_v,full_sigma_v));
+  }
+
+  /// Adds an exponential pulse of the given polarity, clipped to the 12-bit ADC range
+  void AddPulse(pmtana::Waveform_t& wf, size_t t0, double amplitude, double tau)
+  {
+    for(size_t i=t0; i<t0+60 && i<wf.size(); ++i) {
+      int adc = wf[i] + (int)(amplitude*std::exp(-(double)(i-t0)/tau));
+      wf[i] = std::min(4095,std::max(0,adc));
+    }
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(AlgoSlidingWindow_test)
+
+BOOST_AUTO_TEST_CASE(checkEdgeCases)
+{
+  SlidingWindowParams par;
+  pmtana::PedestalMean_t  mean_v (1,2000.);
+  pmtana::PedestalSigma_t sigma_v(1,1.);
+
+  // empty and single-sample waveforms
+  CheckAgainstReference(par,pmtana::Waveform_t(),mean_v,sigma_v);
+  CheckAgainstReference(par,pmtana::Waveform_t(1,2100),mean_v,sigma_v);
+
+  // pulses at both boundaries
+  pmtana::Waveform_t wf(300,2000);
+  AddPulse(wf,0,50.,4.);
+  AddPulse(wf,290,50.,4.);
+  CheckAgainstReference(par,wf,mean_v,sigma_v);
+
+  // back-to-back pulses, with and without pre/post samples
+  wf.assign(300,2000);
+  for(size_t t0 : {100, 106, 112, 113})
+    AddPulse(wf,t0,40.,1.5);
+  CheckAgainstReference(par,wf,mean_v,sigma_v);
+  par.num_presample = 0;
+  par.num_postsample = 0;
+  CheckAgainstReference(par,wf,mean_v,sigma_v);
+
+  // saturated pulse
+  wf.assign(300,2000);
+  AddPulse(wf,150,5000.,10.);
+  BOOST_CHECK_EQUAL(wf[150],4095);
+  CheckAgainstReference(par,wf,mean_v,sigma_v);
+
+  // exactly on the start threshold is not a pulse
+  wf.assign(50,2000);
+  wf[20] = 2005;
+  CheckAgainstReference(par,wf,mean_v,sigma_v);
+  pmtana::AlgoSlidingWindow algo(par.PSet());
+  algo.Reconstruct(wf,mean_v,sigma_v);
+  BOOST_CHECK_EQUAL(algo.GetNPulse(),0ul);
+  wf[20] = 2006;
+  algo.Reconstruct(wf,mean_v,sigma_v);
+  BOOST_CHECK_EQUAL(algo.GetNPulse(),1ul);
+}
+
+BOOST_AUTO_TEST_CASE(checkThresholdRounding)
+{
+  // sigma = 1.1 is not a float: the thresholds come from the double product
+  // (3.3 rounded to float for start and tail, 1.1 kept in double for the
+  // end), not from float(1.1) times nsigma
+  SlidingWindowParams par;
+  par.adc_thres = par.tail_adc_thres = par.end_adc_thres = 0.5;
+  par.num_presample = par.num_postsample = 0;
+
+  // 2004 - 2000.7 is just above float(3.3) and below float(1.1)*3
+  pmtana::PedestalMean_t  mean_v (1,2000.7);
+  pmtana::PedestalSigma_t sigma_v(1,1.1);
+  pmtana::Waveform_t wf(50,2001);
+  wf[20] = 2004;
+  CheckAgainstReference(par,wf,mean_v,sigma_v);
+  pmtana::AlgoSlidingWindow algo(par.PSet());
+  algo.Reconstruct(wf,mean_v,sigma_v);
+  BOOST_CHECK_EQUAL(algo.GetNPulse(),1ul);
+  CheckAgainstReference(par,wf,pmtana::PedestalMean_t(50,2000.7),pmtana::PedestalSigma_t(50,1.1));
+
+  // 2002 - 2000.89999999 is just above 1.1 and below float(1.1): the pulse
+  // stays in its tail instead of ending
+  mean_v.assign(1,2000.89999999);
+  wf.assign(50,2001);
+  wf[20] = 2010;
+  wf[21] = wf[22] = 2002;
+  CheckAgainstReference(par,wf,mean_v,sigma_v);
+  algo.Reconstruct(wf,mean_v,sigma_v);
+  BOOST_REQUIRE_EQUAL(algo.GetNPulse(),1ul);
+  BOOST_CHECK_EQUAL(algo.GetPulses().front().t_end,22.);
+  CheckAgainstReference(par,wf,pmtana::PedestalMean_t(50,2000.89999999),pmtana::PedestalSigma_t(50,1.1));
+}
+
+BOOST_AUTO_TEST_CASE(checkRandomWaveforms)
+{
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> flat(0.,1.);
+
+  for(int trial=0; trial<400; ++trial) {
+
+    SlidingWindowParams par;
+    par.positive       = (trial % 3 != 0);
+    par.adc_thres      = 2. + 10.*flat(gen);
+    par.tail_adc_thres = 1. + 5.*flat(gen);
+    par.end_adc_thres  = 1. + 3.*flat(gen);
+    par.nsigma         = 1. + 4.*flat(gen);
+    par.tail_nsigma    = 1. + 2.*flat(gen);
+    par.end_nsigma     = 0.5 + flat(gen);
+    par.num_presample  = (size_t)(6*flat(gen));
+    par.num_postsample = (size_t)(6*flat(gen));
+    par.min_width      = (size_t)(4*flat(gen));
+
+    const size_t nsamples = 1 + (size_t)(2000*flat(gen));
+    const double polarity = par.positive ? 1. : -1.;
+
+    std::normal_distribution<double> noise(0.,1.5);
+    pmtana::Waveform_t wf(nsamples);
+    for(auto& adc : wf) adc = 2000 + (short)std::lround(noise(gen));
+
+    const size_t npulses = 1 + (size_t)(flat(gen)*nsamples/20);
+    for(size_t i=0; i<npulses; ++i)
+      AddPulse(wf,(size_t)(flat(gen)*nsamples),polarity*300.*flat(gen),1.+10.*flat(gen));
+
+    // constant pedestal
+    pmtana::PedestalMean_t  mean_v (1,2000. + flat(gen));
+    pmtana::PedestalSigma_t sigma_v(1,1. + flat(gen));
+    CheckAgainstReference(par,wf,mean_v,sigma_v);
+
+    // per-sample pedestal
+    mean_v.resize(nsamples);
+    sigma_v.resize(nsamples);
+    for(size_t i=0; i<nsamples; ++i) {
+      mean_v[i]  = 2000. + 0.5*std::sin(0.01*i);
+      sigma_v[i] = 1.5 + 0.3*std::cos(0.02*i);
+    }
+    CheckAgainstReference(par,wf,mean_v,sigma_v);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+// Building the flash-hit associations of an event with 4000 flashes and
+// 10^5 hits: a temporary pointer vector per flash, copied into the
+// associations as OpFlashFinder did through util::CreateAssn, against
+// adding each pair as ForEachFlashHit hands it over. art::Ptr and
+// art::Assns are stood in by plain structs, so this measures the index
+// expansion and the temporaries, not the product lookups of art.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/OpFlashAlg.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  const size_t NFlashes = 4000;
+  const size_t NHits = 100000;
+  const size_t NEvents = 100;
+
+  struct Ptr_t {
+    unsigned int productID;
+    size_t key;
+  };
+
+  struct Assns_t {
+    std::vector<std::pair<Ptr_t, Ptr_t>> pairs;
+    void addSingle(Ptr_t const& a, Ptr_t const& b) { pairs.emplace_back(a, b); }
+  };
+
+  const unsigned int FlashID = 1, HitID = 2;
+
+  void PerFlashVector(std::vector<std::vector<int>> const& AssocList, Assns_t& assns)
+  {
+    for (size_t i = 0; i != AssocList.size(); ++i) {
+      std::vector<Ptr_t> opHitPtrVector;
+      for (size_t const hitIndex : AssocList.at(i))
+        opHitPtrVector.push_back({HitID, hitIndex});
+
+      Ptr_t const flashPtr{FlashID, i};
+      for (auto const& hitPtr : opHitPtrVector)
+        assns.addSingle(flashPtr, hitPtr);
+    }
+  }
+
+  void Direct(std::vector<std::vector<int>> const& AssocList, Assns_t& assns)
+  {
+    opdet::ForEachFlashHit(AssocList, [&](size_t const flashIndex, size_t const hitIndex) {
+      assns.addSingle({FlashID, flashIndex}, {HitID, hitIndex});
+    });
+  }
+
+  template <typename F>
+  double TimeEvents(F f, std::vector<std::vector<int>> const& AssocList, Assns_t& assns)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t e = 0; e < NEvents; ++e) {
+      assns = Assns_t();
+      f(AssocList, assns);
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/NEvents;
+  }
+
+  bool SamePairs(Assns_t const& a, Assns_t const& b)
+  {
+    if (a.pairs.size() != b.pairs.size()) return false;
+    for (size_t i = 0; i < a.pairs.size(); ++i)
+      if (a.pairs[i].first.key != b.pairs[i].first.key || a.pairs[i].second.key != b.pairs[i].second.key)
+        return false;
+    return true;
+  }
+
+}
+
+int main()
+{
+  // flashes of 1 to 49 hits, hit indices scattered over the event
+  std::vector<std::vector<int>> AssocList(NFlashes);
+  size_t hit = 0;
+  for (size_t i = 0; i < NFlashes; ++i)
+    for (size_t j = 0; j < 1 + (i * 37) % 49; ++j, ++hit)
+      AssocList[i].push_back((hit * 7919) % NHits);
+
+  Assns_t per_flash, direct;
+  double const t_per_flash = TimeEvents(PerFlashVector, AssocList, per_flash);
+  double const t_direct = TimeEvents(Direct, AssocList, direct);
+
+  std::printf("%zu flashes, %zu hits: pointer vector per flash %6.3f ms/event, direct %6.3f ms/event (%s)\n",
+              NFlashes, hit, t_per_flash, t_direct,
+              SamePairs(per_flash, direct) ? "same associations" : "ASSOCIATIONS DIFFER");
+  return 0;
+}
@@ -0,0 +1,91 @@
+// Filling a segment hypothesis from library visibilities, plain arrays and
+// behind an OpDet mapping (util::MappedContainer, as the photon library
+// returns them): the bounds-checked per-OpDet fill and copying the mapped
+// visibilities into a buffer before the fill loop, as FillFlashHypothesis
+// did, against reading them in the loop.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/FlashHypothesisCalculator.h"
+#include "lardataalg/Utilities/MappedContainer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  using Mapped_t = util::MappedContainer<float const*, std::vector<std::size_t>>;
+
+  const size_t NVoxels = 1000;
+  const size_t NFills = 1000000;
+
+  template <typename VisVector>
+  void PerOpDetFill(float total_yield, std::vector<float> const& qe_vector,
+		    VisVector const& vis_vector, opdet::FlashHypothesis& hyp)
+  {
+    for(size_t i=0; i<hyp.GetVectorSize(); i++)
+      hyp.SetHypothesisAndError(i,total_yield*vis_vector[i]*qe_vector[i]);
+  }
+
+  template <typename VisVector>
+  void BufferedFill(float total_yield, std::vector<float> const& qe_vector,
+		    VisVector const& vis_vector, std::vector<float>& buffer,
+		    opdet::FlashHypothesis& hyp)
+  {
+    const size_t n = hyp.GetVectorSize();
+    buffer.resize(n);
+    for(size_t i=0; i<n; i++) buffer[i] = vis_vector[i];
+    opdet::FlashHypothesisCalculator::FillHypothesisArrays(n,total_yield,buffer.data(),qe_vector.data(),
+							   hyp.HypothesisData(),hyp.HypothesisErrorData());
+  }
+
+  template <typename F>
+  double TimeFills(F fill, opdet::FlashHypothesis const& hyp, double& check)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for(size_t k=0; k<NFills; k++){
+      fill(k);
+      check += hyp.GetHypothesisError(k%hyp.GetVectorSize());
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count();
+  }
+
+}
+
+int main()
+{
+  for(size_t nOpDets : {32, 300}){
+    //library channel of OpDet i is nOpDets-1-i; one OpDet outside the library
+    std::vector<float> table(NVoxels*nOpDets);
+    for(size_t i=0; i<table.size(); i++) table[i] = 1e-4*(1 + (i*7919)%1000);
+    std::vector<std::size_t> mapping(nOpDets);
+    for(size_t i=0; i<nOpDets; i++) mapping[i] = nOpDets-1-i;
+    mapping[nOpDets/2] = Mapped_t::InvalidIndex;
+
+    std::vector<Mapped_t> mapped;
+    for(size_t v=0; v<NVoxels; v++)
+      mapped.emplace_back(&table[v*nOpDets],mapping,nOpDets,0.f);
+
+    std::vector<float> const qe_vector(nOpDets,0.01);
+    std::vector<float> buffer;
+    opdet::FlashHypothesisCalculator calc;
+    opdet::FlashHypothesis hyp(nOpDets);
+    double check_per_opdet = 0, check_buffered = 0, check_direct = 0, check_plain = 0;
+
+    double const t_per_opdet = TimeFills([&](size_t k)
+      { PerOpDetFill(7200.f*(1+k%7),qe_vector,mapped[k%NVoxels],hyp); }, hyp, check_per_opdet);
+    double const t_buffered = TimeFills([&](size_t k)
+      { BufferedFill(7200.f*(1+k%7),qe_vector,mapped[k%NVoxels],buffer,hyp); }, hyp, check_buffered);
+    double const t_direct = TimeFills([&](size_t k)
+      { calc.FillFlashHypothesis(7200.f*(1+k%7),qe_vector,mapped[k%NVoxels],hyp); }, hyp, check_direct);
+    double const t_plain = TimeFills([&](size_t k)
+      { calc.FillFlashHypothesis(7200.f*(1+k%7),qe_vector,&table[(k%NVoxels)*nOpDets],hyp); }, hyp, check_plain);
+
+    std::printf("%3zu OpDets, %zu fills of mapped visibilities: per OpDet %6.1f ms, copied %6.1f ms, read in loop %6.1f ms (%s); plain array %6.1f ms\n",
+		nOpDets,NFills,t_per_opdet,t_buffered,t_direct,
+		(check_per_opdet==check_direct && check_buffered==check_direct)? "same hypotheses" : "HYPOTHESES DIFFER",
+		t_plain);
+  }
+  return 0;
+}
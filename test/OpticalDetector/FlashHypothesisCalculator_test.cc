@@ -0,0 +1,239 @@
+#define BOOST_TEST_MODULE ( FlashHypothesisCalculator_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/FlashHypothesisCalculator.h"
+
+#include <array>
+#include <cmath>
+
+const size_t NOpDets = 32;
+const float Yield = 24000*0.3;
+const float PromptFraction = 0.3;
+const float QE = 0.01;
+const double tolerance = 1e-3; // percent
+
+namespace {
+
+  // Visibility table on a regular grid of cubic voxels covering
+  // [0,VoxelsPerSide*VoxelSize) in each coordinate; null outside.
+  class MockVisibility{
+
+  public:
+    static constexpr int VoxelsPerSide = 20;
+    static constexpr double VoxelSize = 5.; // cm
+
+    explicit MockVisibility(bool merge=true)
+      : _merge(merge), _table(VoxelsPerSide*VoxelsPerSide*VoxelsPerSide*NOpDets)
+    {
+      for(size_t i=0; i<_table.size(); i++)
+	_table[i] = 1e-4*(1 + (i*7919)%1000);
+    }
+
+    int VoxelID(double const* xyz) const
+    { return _merge? FindVoxel(xyz) : -1; }
+
+    float const* GetAllVisibilities(double const* xyz) const
+    {
+      ++_n_lookups;
+      const int voxel = FindVoxel(xyz);
+      return (voxel<0)? nullptr : &_table[voxel*NOpDets];
+    }
+
+    size_t NLookups() const { return _n_lookups; }
+
+  private:
+    bool _merge;
+    std::vector<float> _table;
+    mutable size_t _n_lookups = 0;
+
+    int FindVoxel(double const* xyz) const
+    {
+      int id=0;
+      for(int i=0; i<3; i++){
+	const int bin = std::floor(xyz[i]/VoxelSize);
+	if(bin<0 || bin>=VoxelsPerSide) return -1;
+	id = id*VoxelsPerSide + bin;
+      }
+      return id;
+    }
+  };
+
+  //straight line with constant step, partially leaving the table volume
+  std::vector<TVector3> MakeTrajectory(double step)
+  {
+    std::vector<TVector3> traj;
+    for(double s=0; s<120.; s+=step)
+      traj.emplace_back(10.+0.5*s, 2.+0.6*s, 3.+0.62*s);
+    return traj;
+  }
+
+  void CheckClose(opdet::FlashHypothesis const& a, opdet::FlashHypothesis const& b)
+  {
+    BOOST_CHECK_EQUAL(a.GetVectorSize(),b.GetVectorSize());
+    for(size_t i=0; i<a.GetVectorSize(); i++){
+      BOOST_CHECK_CLOSE(a.GetHypothesis(i),b.GetHypothesis(i),tolerance);
+      BOOST_CHECK_CLOSE(a.GetHypothesisError(i),b.GetHypothesisError(i),tolerance);
+    }
+  }
+
+  //one lookup and one hypothesis per segment
+  opdet::FlashHypothesisCollection PerSegment(std::vector<TVector3> const& traj,
+					      std::vector<float> const& dEdxVector,
+					      MockVisibility const& vis)
+  {
+    opdet::FlashHypothesisCalculator calc;
+    std::vector<float> qe_vector(NOpDets,QE);
+    opdet::FlashHypothesisCollection fhc(NOpDets), seg_fhc;
+    opdet::FlashHypothesis prompt_hyp(NOpDets);
+    for(size_t pt=1; pt<traj.size(); pt++){
+      const std::array<double,3> xyz = calc.SegmentMidpointArray(traj[pt-1],traj[pt]);
+      float const* vis_vector = vis.GetAllVisibilities(xyz.data());
+      if(!vis_vector) continue;
+      calc.FillFlashHypothesis(Yield*dEdxVector[pt-1]*(traj[pt]-traj[pt-1]).Mag(),
+			       qe_vector,vis_vector,prompt_hyp);
+      seg_fhc.SetPromptHypAndPromptFraction(prompt_hyp,PromptFraction);
+      fhc += seg_fhc;
+    }
+    return fhc;
+  }
+
+  //visibilities behind an opdet to library channel map, not contiguous
+  struct MappedVisibility{
+    float const* table;
+    std::vector<size_t> map;
+    float operator[](size_t i) const { return table[map[i]]; }
+    explicit operator bool() const { return table; }
+  };
+
+  //per-opdet fill, as FillFlashHypothesis did with SetHypothesisAndError
+  opdet::FlashHypothesis PerOpDet(float total_yield,
+				  std::vector<float> const& qe_vector,
+				  float const* vis_vector)
+  {
+    opdet::FlashHypothesis hyp(qe_vector.size());
+    for(size_t i=0; i<qe_vector.size(); i++)
+      hyp.SetHypothesisAndError(i,total_yield*vis_vector[i]*qe_vector[i]);
+    return hyp;
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(FlashHypothesisCalculator_test)
+
+BOOST_AUTO_TEST_CASE(AccumulateTrajectory_checkNoMergeIdenticalToPerSegment)
+{
+  std::vector<TVector3> traj = MakeTrajectory(1.);
+  std::vector<float> dEdxVector(traj.size()-1,2.1);
+  std::vector<float> qe_vector(NOpDets,QE);
+
+  MockVisibility vis(false);
+  opdet::FlashHypothesisCollection fhc(NOpDets);
+  opdet::FlashHypothesisCalculator().AccumulateTrajectory(traj,dEdxVector,false,Yield,PromptFraction,
+							   qe_vector,vis,0,fhc);
+  BOOST_CHECK_EQUAL(vis.NLookups(),traj.size()-1);
+
+  MockVisibility ref_vis;
+  opdet::FlashHypothesisCollection ref = PerSegment(traj,dEdxVector,ref_vis);
+  for(size_t i=0; i<NOpDets; i++){
+    BOOST_CHECK_EQUAL(fhc.GetTotalHypothesis().GetHypothesis(i),ref.GetTotalHypothesis().GetHypothesis(i));
+    BOOST_CHECK_EQUAL(fhc.GetTotalHypothesis().GetHypothesisError(i),ref.GetTotalHypothesis().GetHypothesisError(i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AccumulateTrajectory_checkMergedMatchesPerSegment)
+{
+  //dense muon-like stepping: many consecutive midpoints per voxel
+  std::vector<TVector3> traj = MakeTrajectory(0.3);
+  std::vector<float> dEdxVector(traj.size()-1);
+  for(size_t i=0; i<dEdxVector.size(); i++)
+    dEdxVector[i] = 2.1 + 0.1*std::sin(0.05*i);
+  std::vector<float> qe_vector(NOpDets,QE);
+
+  MockVisibility vis;
+  opdet::FlashHypothesisCollection fhc(NOpDets);
+  opdet::FlashHypothesisCalculator().AccumulateTrajectory(traj,dEdxVector,false,Yield,PromptFraction,
+							   qe_vector,vis,0,fhc);
+
+  MockVisibility ref_vis;
+  opdet::FlashHypothesisCollection ref = PerSegment(traj,dEdxVector,ref_vis);
+
+  BOOST_CHECK_LT(vis.NLookups()*5,ref_vis.NLookups());
+  CheckClose(fhc.GetPromptHypothesis(),ref.GetPromptHypothesis());
+  CheckClose(fhc.GetLateHypothesis(),ref.GetLateHypothesis());
+  CheckClose(fhc.GetTotalHypothesis(),ref.GetTotalHypothesis());
+  BOOST_CHECK_CLOSE(fhc.GetPromptFraction(),ref.GetPromptFraction(),tolerance);
+}
+
+BOOST_AUTO_TEST_CASE(AccumulateTrajectory_checkInterpolatedEdx)
+{
+  std::vector<TVector3> traj = MakeTrajectory(0.3);
+  std::vector<float> dEdxVector(traj.size(),2.);
+  dEdxVector.back() = 4.;
+  std::vector<float> qe_vector(NOpDets,QE);
+
+  MockVisibility vis;
+  opdet::FlashHypothesisCollection fhc(NOpDets);
+  opdet::FlashHypothesisCalculator().AccumulateTrajectory(traj,dEdxVector,true,Yield,PromptFraction,
+							   qe_vector,vis,0,fhc);
+
+  std::vector<float> segment_dEdx(traj.size()-1,2.);
+  segment_dEdx.back() = 3.;
+  MockVisibility ref_vis;
+  opdet::FlashHypothesisCollection ref = PerSegment(traj,segment_dEdx,ref_vis);
+  CheckClose(fhc.GetTotalHypothesis(),ref.GetTotalHypothesis());
+}
+
+BOOST_AUTO_TEST_CASE(SegmentMidpoint_checkValues)
+{
+  opdet::FlashHypothesisCalculator calc;
+  const std::array<double,3> xyz = calc.SegmentMidpointArray(TVector3(1.,-2.,3.),TVector3(4.,6.,-8.),0.5);
+  BOOST_CHECK_EQUAL(xyz[0],3.);
+  BOOST_CHECK_EQUAL(xyz[1],2.);
+  BOOST_CHECK_EQUAL(xyz[2],-2.5);
+  const std::vector<double> xyz_vector = calc.SegmentMidpoint(TVector3(1.,-2.,3.),TVector3(4.,6.,-8.),0.5);
+  BOOST_CHECK(xyz_vector==std::vector<double>(xyz.begin(),xyz.end()));
+}
+
+BOOST_AUTO_TEST_CASE(FillFlashHypothesis_checkIdenticalToPerOpDet)
+{
+  std::vector<float> table(NOpDets);
+  std::vector<float> qe_vector(NOpDets);
+  for(size_t i=0; i<NOpDets; i++){
+    table[i] = (i%9==2)? 0. : 1e-4*(1 + (i*7919)%1000);
+    qe_vector[i] = QE*(1 + 0.01*i);
+  }
+
+  opdet::FlashHypothesisCalculator calc;
+  for(float total_yield : {0.f, 1.f, 2.1f*Yield, 3e6f}){
+    opdet::FlashHypothesis const ref = PerOpDet(total_yield,qe_vector,table.data());
+
+    //a previous fill is overwritten
+    opdet::FlashHypothesis hyp(NOpDets);
+    hyp.SetHypothesisAndError(3,7.,9.);
+    calc.FillFlashHypothesis(total_yield,qe_vector,table.data(),hyp);
+    BOOST_CHECK(hyp.GetHypothesisVector()==ref.GetHypothesisVector());
+    BOOST_CHECK(hyp.GetHypothesisErrorVector()==ref.GetHypothesisErrorVector());
+
+    //non-contiguous visibilities: opdet i is channel NOpDets-1-i
+    std::vector<float> reversed(table.rbegin(),table.rend());
+    MappedVisibility mapped{reversed.data(),std::vector<size_t>(NOpDets)};
+    for(size_t i=0; i<NOpDets; i++) mapped.map[i] = NOpDets-1-i;
+    opdet::FlashHypothesis mapped_hyp(NOpDets);
+    calc.FillFlashHypothesis(total_yield,qe_vector,mapped,mapped_hyp);
+    BOOST_CHECK(mapped_hyp.GetHypothesisVector()==ref.GetHypothesisVector());
+    BOOST_CHECK(mapped_hyp.GetHypothesisErrorVector()==ref.GetHypothesisErrorVector());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FillFlashHypothesis_checkSizeMismatch)
+{
+  std::vector<float> table(NOpDets,1e-3);
+  opdet::FlashHypothesisCalculator calc;
+  opdet::FlashHypothesis hyp(NOpDets);
+  BOOST_CHECK_THROW(calc.FillFlashHypothesis(Yield,std::vector<float>(NOpDets-1,QE),table.data(),hyp),
+		    std::runtime_error);
+  BOOST_CHECK_THROW(calc.FillFlashHypothesis(Yield,std::vector<float>(NOpDets,QE),(float const*)nullptr,hyp),
+		    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
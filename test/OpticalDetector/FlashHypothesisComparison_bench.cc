@@ -0,0 +1,197 @@
+// 10^5 flash hypothesis comparisons of 300 opdets, computation only (the
+// tree and histograms need ROOT): the twelve GetPosition and three
+// CompareByError calls RunComparison made, with GetPosition as it was then
+// (two passes), against one FlashHypothesisComparison::Compare() call.
+// Totals and comparison values must be the same; positions and widths come
+// from double moments and agree to about 1e-5.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/FlashHypothesisComparison.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using Comparison = opdet::FlashHypothesisComparison;
+
+namespace {
+
+  const size_t NOpDets = 300;
+  const int NInputs = 10;
+  const int NComparisons = 100000;
+
+  /// FlashUtilities::GetPosition before the weighted-moments kernel
+  void OldGetPosition(const std::vector<float>& pe_vector,
+		      const std::vector<float>& pos_vector,
+		      float& mean, float& rms)
+  {
+    float sum = std::accumulate(pe_vector.begin(),pe_vector.end(),0.0);
+
+    if(sum < std::numeric_limits<float>::epsilon()){
+      mean=0; rms=0; return;
+    }
+
+    mean = std::inner_product(pe_vector.begin(),pe_vector.end(),pos_vector.begin(),0.0) / sum;
+
+    rms=0;
+    for(size_t i=0; i<pe_vector.size(); i++)
+      rms += pe_vector[i]*(pos_vector[i] - mean)*(pos_vector[i] - mean);
+
+    rms = std::sqrt(rms)/sum;
+  }
+
+  /// The Fill*Info() calls of RunComparison, into the same arrays as Compare()
+  void OldCompare(opdet::FlashUtilities& util,
+		  const opdet::FlashHypothesisCollection& fhc,
+		  const opdet::SimPhotonCounter& spc,
+		  const std::vector<float>& posY,
+		  const std::vector<float>& posZ,
+		  Comparison::Values_t& values,
+		  float* compare)
+  {
+    opdet::FlashHypothesis const* hyp[] =
+      { &fhc.GetPromptHypothesis(), &fhc.GetLateHypothesis(), &fhc.GetTotalHypothesis() };
+    for(int w=0; w<Comparison::kNWindows; w++){
+      float* v = values.value[w];
+      v[Comparison::kHypPEs] = hyp[w]->GetTotalPEs();
+      v[Comparison::kHypPEsError] = hyp[w]->GetTotalPEsError();
+      OldGetPosition(hyp[w]->GetHypothesisVector(),posY,v[Comparison::kHypY],v[Comparison::kHypRMSY]);
+      OldGetPosition(hyp[w]->GetHypothesisVector(),posZ,v[Comparison::kHypZ],v[Comparison::kHypRMSZ]);
+    }
+
+    float* v = values.value[Comparison::kPrompt];
+    v[Comparison::kSimPEs] = spc.PromptPhotonTotal();
+    OldGetPosition(spc.PromptPhotonVector(),posY,v[Comparison::kSimY],v[Comparison::kSimRMSY]);
+    OldGetPosition(spc.PromptPhotonVector(),posZ,v[Comparison::kSimZ],v[Comparison::kSimRMSZ]);
+
+    v = values.value[Comparison::kLate];
+    v[Comparison::kSimPEs] = spc.LatePhotonTotal();
+    OldGetPosition(spc.LatePhotonVector(),posY,v[Comparison::kSimY],v[Comparison::kSimRMSY]);
+    OldGetPosition(spc.LatePhotonVector(),posZ,v[Comparison::kSimZ],v[Comparison::kSimRMSZ]);
+
+    v = values.value[Comparison::kTotal];
+    v[Comparison::kSimPEs] = values.value[Comparison::kPrompt][Comparison::kSimPEs]
+      + values.value[Comparison::kLate][Comparison::kSimPEs];
+    OldGetPosition(spc.TotalPhotonVector(),posY,v[Comparison::kSimY],v[Comparison::kSimRMSY]);
+    OldGetPosition(spc.TotalPhotonVector(),posZ,v[Comparison::kSimZ],v[Comparison::kSimRMSZ]);
+
+    std::vector<float> result_p,result_l,result_t;
+    values.value[Comparison::kPrompt][Comparison::kCompare] =
+      util.CompareByError(fhc.GetPromptHypothesis(),spc.PromptPhotonVector(),result_p);
+    values.value[Comparison::kLate][Comparison::kCompare] =
+      util.CompareByError(fhc.GetLateHypothesis(),spc.LatePhotonVector(),result_l);
+    values.value[Comparison::kTotal][Comparison::kCompare] =
+      util.CompareByError(fhc.GetTotalHypothesis(),spc.TotalPhotonVector(),result_t);
+
+    for(size_t i=0; i<result_p.size(); i++){
+      compare[i] = result_p[i];
+      compare[NOpDets+i] = result_l[i];
+      compare[2*NOpDets+i] = result_t[i];
+    }
+  }
+
+  opdet::FlashHypothesisCollection MakeHypothesis(int seed)
+  {
+    std::srand(seed);
+    opdet::FlashHypothesis prompt(NOpDets), late(NOpDets);
+    for(size_t i=0; i<NOpDets; i++){
+      if(i%7==3) continue;
+      prompt.SetHypothesisAndError(i, 50.*std::rand()/RAND_MAX, (i%5==1)? 0. : 5.*std::rand()/RAND_MAX);
+      late.SetHypothesisAndError(i, 20.*std::rand()/RAND_MAX, 2.*std::rand()/RAND_MAX);
+    }
+    return opdet::FlashHypothesisCollection(prompt,late);
+  }
+
+  opdet::SimPhotonCounter MakeCounter(int seed)
+  {
+    std::vector<float> qe(NOpDets);
+    for(size_t i=0; i<NOpDets; i++) qe[i] = 0.5 + 0.001*i;
+    opdet::SimPhotonCounter spc(0., 10., 10., 1000., 0., 1e6, qe);
+
+    std::srand(seed+1000);
+    sim::OnePhoton ph;
+    ph.Energy = 1e-5; // 124 nm
+    for(size_t i=0; i<NOpDets; i++){
+      if(i%11==5) continue;
+      int const nPrompt = std::rand()%100;
+      int const nLate = std::rand()%40;
+      ph.Time = 5.;
+      for(int n=0; n<nPrompt; n++) spc.AddOnePhoton(i,ph);
+      ph.Time = 100.;
+      for(int n=0; n<nLate; n++) spc.AddOnePhoton(i,ph);
+    }
+    return spc;
+  }
+
+  std::vector<float> Positions(float offset, float step)
+  {
+    std::vector<float> pos(NOpDets);
+    for(size_t i=0; i<NOpDets; i++) pos[i] = offset + step*((i*13)%NOpDets);
+    return pos;
+  }
+
+  bool Close(float value, float expected)
+  {
+    return std::abs(value-expected) <= 1e-5*std::max(1.f,std::abs(expected));
+  }
+
+  double Since(std::chrono::steady_clock::time_point start)
+  {
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count();
+  }
+
+}
+
+int main()
+{
+  std::vector<opdet::FlashHypothesisCollection> hypotheses;
+  std::vector<opdet::SimPhotonCounter> counters;
+  for(int i=0; i<NInputs; i++){
+    hypotheses.push_back(MakeHypothesis(i+1));
+    counters.push_back(MakeCounter(i+1));
+  }
+  auto const posY = Positions(-100., 0.75);
+  auto const posZ = Positions(20., 3.3);
+
+  opdet::FlashUtilities util;
+  Comparison::Values_t old_values, values;
+  std::vector<float> old_compare(Comparison::kNWindows*NOpDets), compare(old_compare.size());
+
+  // the same totals and comparisons, close positions and widths
+  bool same = true, close = true;
+  for(int i=0; i<NInputs; i++){
+    OldCompare(util,hypotheses[i],counters[i],posY,posZ,old_values,old_compare.data());
+    Comparison::Compare(hypotheses[i],counters[i],posY,posZ,values,compare.data());
+    same = same && (old_compare == compare);
+    for(int w=0; w<Comparison::kNWindows; w++)
+      for(int q=0; q<Comparison::kNQuantities; q++){
+	float const old_value = old_values.value[w][q], value = values.value[w][q];
+	bool const exact = (q==Comparison::kHypPEs || q==Comparison::kHypPEsError ||
+			    q==Comparison::kSimPEs || q==Comparison::kCompare);
+	if(exact) same = same && (old_value == value);
+	else      close = close && Close(value,old_value);
+      }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for(int n=0; n<NComparisons; n++)
+    OldCompare(util,hypotheses[n%NInputs],counters[n%NInputs],posY,posZ,old_values,old_compare.data());
+  double const t_separate = Since(start);
+
+  start = std::chrono::steady_clock::now();
+  for(int n=0; n<NComparisons; n++)
+    Comparison::Compare(hypotheses[n%NInputs],counters[n%NInputs],posY,posZ,values,compare.data());
+  double const t_fused = Since(start);
+
+  std::printf("%d comparisons of %zu opdets: separate FlashUtilities calls %7.1f ms, fused Compare() %7.1f ms (%s, %s)\n",
+	      NComparisons, NOpDets, t_separate, t_fused,
+	      same ? "same totals and comparisons" : "TOTALS OR COMPARISONS DIFFER",
+	      close ? "positions within 1e-5" : "POSITIONS DIFFER");
+  return 0;
+}
@@ -0,0 +1,273 @@
+#define BOOST_TEST_MODULE ( FlashHypothesisComparison_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/FlashHypothesisComparison.h"
+
+#include "TH1F.h"
+#include "TTree.h"
+
+#include <cstdlib>
+#include <string>
+
+using Comparison = opdet::FlashHypothesisComparison;
+
+const size_t NOpDets = 32;
+
+namespace {
+
+  //deterministic pseudo-random hypothesis; some opdets have no light, some
+  //no error
+  opdet::FlashHypothesisCollection MakeHypothesis(size_t seed)
+  {
+    std::srand(seed);
+    opdet::FlashHypothesis prompt(NOpDets), late(NOpDets);
+    for(size_t i=0; i<NOpDets; i++){
+      if(i%7==3) continue;
+      prompt.SetHypothesisAndError(i, 50.*std::rand()/RAND_MAX, (i%5==1)? 0. : 5.*std::rand()/RAND_MAX);
+      late.SetHypothesisAndError(i, 20.*std::rand()/RAND_MAX, 2.*std::rand()/RAND_MAX);
+    }
+    //same as the sim photons below
+    prompt.SetHypothesisAndError(0, 3.*0.5, 1.);
+    return opdet::FlashHypothesisCollection(prompt,late);
+  }
+
+  opdet::SimPhotonCounter MakeCounter(size_t seed)
+  {
+    std::vector<float> qe(NOpDets);
+    for(size_t i=0; i<NOpDets; i++) qe[i] = 0.5 + 0.01*i;
+    opdet::SimPhotonCounter spc(0., 10., 10., 1000., 0., 1e6, qe);
+
+    std::srand(seed+1000);
+    sim::OnePhoton ph;
+    ph.Energy = 1e-5; // 124 nm
+    for(size_t i=0; i<NOpDets; i++){
+      if(i%11==5) continue;
+      int const nPrompt = (i==0)? 3 : std::rand()%100;
+      int const nLate = (i==0)? 0 : std::rand()%40;
+      ph.Time = 5.;
+      for(int n=0; n<nPrompt; n++) spc.AddOnePhoton(i,ph);
+      ph.Time = 100.;
+      for(int n=0; n<nLate; n++) spc.AddOnePhoton(i,ph);
+    }
+    return spc;
+  }
+
+  std::vector<float> Positions(float offset, float step)
+  {
+    std::vector<float> pos(NOpDets);
+    for(size_t i=0; i<NOpDets; i++) pos[i] = offset + step*((i*13)%NOpDets);
+    return pos;
+  }
+
+  void CheckClose(float value, float expected)
+  {
+    if(std::abs(expected) < 1e-3) BOOST_CHECK_SMALL(value, 1e-3f);
+    else                          BOOST_CHECK_CLOSE(value, expected, 1e-3);
+  }
+
+  //quantities of each window as computed before, with FlashUtilities
+  void CheckValues(opdet::FlashHypothesisCollection const& fhc,
+		   opdet::SimPhotonCounter const& spc,
+		   std::vector<float> const& posY,
+		   std::vector<float> const& posZ,
+		   Comparison::Values_t const& values,
+		   float const* compare)
+  {
+    opdet::FlashUtilities util;
+    opdet::FlashHypothesis const* hyp[] =
+      { &fhc.GetPromptHypothesis(), &fhc.GetLateHypothesis(), &fhc.GetTotalHypothesis() };
+    std::vector<float> const sim[] =
+      { spc.PromptPhotonVector(), spc.LatePhotonVector(), spc.TotalPhotonVector() };
+    float const simPEs[] = { spc.PromptPhotonTotal(), spc.LatePhotonTotal(), spc.PhotonTotal() };
+
+    for(int w=0; w<Comparison::kNWindows; w++){
+      float const* v = values.value[w];
+      float y, rmsY, z, rmsZ;
+
+      BOOST_CHECK_EQUAL(v[Comparison::kHypPEs], hyp[w]->GetTotalPEs());
+      BOOST_CHECK_EQUAL(v[Comparison::kHypPEsError], hyp[w]->GetTotalPEsError());
+      BOOST_CHECK_EQUAL(v[Comparison::kSimPEs], simPEs[w]);
+
+      util.GetPosition(hyp[w]->GetHypothesisVector(),posY,y,rmsY);
+      util.GetPosition(hyp[w]->GetHypothesisVector(),posZ,z,rmsZ);
+      CheckClose(v[Comparison::kHypY], y);
+      CheckClose(v[Comparison::kHypRMSY], rmsY);
+      CheckClose(v[Comparison::kHypZ], z);
+      CheckClose(v[Comparison::kHypRMSZ], rmsZ);
+
+      util.GetPosition(sim[w],posY,y,rmsY);
+      util.GetPosition(sim[w],posZ,z,rmsZ);
+      CheckClose(v[Comparison::kSimY], y);
+      CheckClose(v[Comparison::kSimRMSY], rmsY);
+      CheckClose(v[Comparison::kSimZ], z);
+      CheckClose(v[Comparison::kSimRMSZ], rmsZ);
+
+      std::vector<float> result;
+      BOOST_CHECK_EQUAL(v[Comparison::kCompare], util.CompareByError(*hyp[w],sim[w],result));
+      BOOST_CHECK_EQUAL_COLLECTIONS(compare + w*NOpDets, compare + (w+1)*NOpDets,
+				    result.begin(), result.end());
+    }
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(FlashHypothesisComparison_test)
+
+BOOST_AUTO_TEST_CASE(Compare_checkSameAsFlashUtilities)
+{
+  for(size_t seed : {1, 2, 3}){
+    auto const fhc = MakeHypothesis(seed);
+    auto const spc = MakeCounter(seed);
+    auto const posY = Positions(-100., 7.5);
+    auto const posZ = Positions(20., 33.);
+
+    Comparison::Values_t values;
+    std::vector<float> compare(Comparison::kNWindows*NOpDets);
+    Comparison::Compare(fhc,spc,posY,posZ,values,compare.data());
+    CheckValues(fhc,spc,posY,posZ,values,compare.data());
+
+    //the per-opdet comparison is optional
+    Comparison::Values_t values2;
+    Comparison::Compare(fhc,spc,posY,posZ,values2);
+    for(int w=0; w<Comparison::kNWindows; w++)
+      for(int q=0; q<Comparison::kNQuantities; q++)
+	BOOST_CHECK_EQUAL(values2.value[w][q],values.value[w][q]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Compare_checkNoLight)
+{
+  opdet::FlashHypothesisCollection fhc(NOpDets);
+  opdet::SimPhotonCounter spc(NOpDets, 0., 10., 10., 1000.);
+  auto const pos = Positions(0., 1.);
+
+  Comparison::Values_t values;
+  std::vector<float> compare(Comparison::kNWindows*NOpDets, -1.);
+  Comparison::Compare(fhc,spc,pos,pos,values,compare.data());
+  for(int w=0; w<Comparison::kNWindows; w++)
+    for(int q=0; q<Comparison::kNQuantities; q++)
+      BOOST_CHECK_EQUAL(values.value[w][q],0.);
+  for(float c : compare) BOOST_CHECK_EQUAL(c,0.);
+}
+
+BOOST_AUTO_TEST_CASE(Compare_checkSizeMismatch)
+{
+  auto const fhc = MakeHypothesis(1);
+  auto const spc = MakeCounter(1);
+  Comparison::Values_t values;
+  BOOST_CHECK_THROW(Comparison::Compare(fhc,spc,Positions(0.,1.),std::vector<float>(NOpDets-1),values),
+		    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(RunComparison_checkBufferedTree)
+{
+  const unsigned int BufferSize = 4;
+  const unsigned int NComparisons = 10;
+  auto const posY = Positions(-100., 7.5);
+  auto const posZ = Positions(20., 33.);
+
+  TTree tree("tree","tree");
+  std::vector<TH1F> hists(9);
+  Comparison comparison;
+  comparison.SetOutputObjects(&tree,
+			      &hists[0],&hists[1],&hists[2],
+			      &hists[3],&hists[4],&hists[5],
+			      &hists[6],&hists[7],&hists[8],
+			      NOpDets,true,BufferSize);
+
+  std::vector<Comparison::Values_t> expected(NComparisons);
+  for(unsigned int i=0; i<NComparisons; i++){
+    auto const fhc = MakeHypothesis(i);
+    auto const spc = MakeCounter(i);
+    comparison.RunComparison(7,100+i,fhc,spc,posY,posZ);
+    Comparison::Compare(fhc,spc,posY,posZ,expected[i]);
+
+    BOOST_CHECK_EQUAL(tree.GetEntries(),(i+1)/BufferSize*BufferSize);
+    BOOST_CHECK_EQUAL(comparison.NBuffered(),(i+1)%BufferSize);
+  }
+  comparison.Flush();
+  BOOST_CHECK_EQUAL(tree.GetEntries(),NComparisons);
+  BOOST_CHECK_EQUAL(comparison.NBuffered(),0u);
+
+  //histograms of the last comparison; the total is prompt plus late
+  auto const fhc = MakeHypothesis(NComparisons-1);
+  auto const spc = MakeCounter(NComparisons-1);
+  for(size_t i=0; i<NOpDets; i++){
+    BOOST_CHECK_EQUAL(hists[0].GetBinContent(i+1),fhc.GetPromptHypothesis().GetHypothesis(i));
+    BOOST_CHECK_EQUAL(hists[4].GetBinContent(i+1),spc.LatePhotonVector(i));
+    BOOST_CHECK_EQUAL(hists[6].GetBinContent(i+1),fhc.GetTotalHypothesis().GetHypothesis(i));
+    BOOST_CHECK_EQUAL(hists[7].GetBinContent(i+1),spc.TotalPhotonVector(i));
+  }
+  BOOST_CHECK_EQUAL(std::string(hists[8].GetName()),"hCompareHist_t");
+
+  //tree entries in order
+  unsigned int event;
+  float hypPEs_p, simY_l, compare_t;
+  tree.SetBranchAddress("event",&event);
+  tree.SetBranchAddress("hyp_PEs_p",&hypPEs_p);
+  tree.SetBranchAddress("sim_Y_l",&simY_l);
+  tree.SetBranchAddress("comp_total_t",&compare_t);
+  for(unsigned int i=0; i<NComparisons; i++){
+    tree.GetEntry(i);
+    BOOST_CHECK_EQUAL(event,100+i);
+    BOOST_CHECK_EQUAL(hypPEs_p,expected[i].value[Comparison::kPrompt][Comparison::kHypPEs]);
+    BOOST_CHECK_EQUAL(simY_l,expected[i].value[Comparison::kLate][Comparison::kSimY]);
+    BOOST_CHECK_EQUAL(compare_t,expected[i].value[Comparison::kTotal][Comparison::kCompare]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RunComparison_checkFlushOnDestruction)
+{
+  //rows left in the buffer are written when the comparison goes away
+  TTree tree("tree","tree");
+  std::vector<TH1F> hists(9);
+  auto const pos = Positions(0., 1.);
+  {
+    Comparison comparison;
+    comparison.SetOutputObjects(&tree,
+				&hists[0],&hists[1],&hists[2],
+				&hists[3],&hists[4],&hists[5],
+				&hists[6],&hists[7],&hists[8],
+				NOpDets,true,8);
+    for(unsigned int i=0; i<3; i++)
+      comparison.RunComparison(1,i,MakeHypothesis(i),MakeCounter(i),pos,pos);
+    BOOST_CHECK_EQUAL(tree.GetEntries(),0);
+    BOOST_CHECK_EQUAL(comparison.NBuffered(),3u);
+  }
+  BOOST_CHECK_EQUAL(tree.GetEntries(),3);
+
+  unsigned int event;
+  tree.SetBranchAddress("event",&event);
+  for(unsigned int i=0; i<3; i++){
+    tree.GetEntry(i);
+    BOOST_CHECK_EQUAL(event,i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RunComparison_checkNoFill)
+{
+  //the owner of the tree fills it: nothing is buffered
+  TTree tree("tree","tree");
+  std::vector<TH1F> hists(9);
+  Comparison comparison;
+  comparison.SetOutputObjects(&tree,
+			      &hists[0],&hists[1],&hists[2],
+			      &hists[3],&hists[4],&hists[5],
+			      &hists[6],&hists[7],&hists[8],
+			      NOpDets,false,16);
+
+  auto const fhc = MakeHypothesis(5);
+  auto const spc = MakeCounter(5);
+  auto const pos = Positions(0., 1.);
+  comparison.RunComparison(1,2,fhc,spc,pos,pos);
+  BOOST_CHECK_EQUAL(comparison.NBuffered(),0u);
+  comparison.Flush();
+  BOOST_CHECK_EQUAL(tree.GetEntries(),0);
+  for(size_t i=0; i<NOpDets; i++)
+    BOOST_CHECK_EQUAL(hists[1].GetBinContent(i+1),spc.PromptPhotonVector(i));
+
+  BOOST_CHECK_THROW(comparison.RunComparison(1,2,fhc,spc,pos,std::vector<float>(3)),
+		    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,143 @@
+// Flash hypothesis of a dense muon trajectory (0.3 cm steps through 5 cm
+// visibility voxels): one visibility lookup and one hypothesis per segment,
+// as FlashHypothesisCreator did, against AccumulateTrajectory merging the
+// consecutive segments of each voxel.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/FlashHypothesisCalculator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  const float Yield = 24000*0.3;
+  const float PromptFraction = 0.3;
+  const double Step = 0.3; // cm
+  const size_t NTracks = 20;
+
+  // Regular grid of cubic voxels over a 250 x 250 x 1000 cm volume; the
+  // table rows repeat every NRows voxels, to keep the table small
+  class GridVisibility{
+
+  public:
+    static constexpr double VoxelSize = 5.; // cm
+    static constexpr int NX = 50, NY = 50, NZ = 200;
+    static constexpr int NRows = 8192;
+
+    explicit GridVisibility(size_t nOpDets)
+      : _nOpDets(nOpDets), _table(NRows*nOpDets)
+    {
+      for(size_t i=0; i<_table.size(); i++)
+	_table[i] = 1e-4*(1 + (i*7919)%1000);
+    }
+
+    int VoxelID(double const* xyz) const { return FindVoxel(xyz); }
+
+    float const* GetAllVisibilities(double const* xyz) const
+    {
+      const int voxel = FindVoxel(xyz);
+      return (voxel<0)? nullptr : &_table[(voxel%NRows)*_nOpDets];
+    }
+
+  private:
+    size_t _nOpDets;
+    std::vector<float> _table;
+
+    int FindVoxel(double const* xyz) const
+    {
+      const int n[3] = { NX, NY, NZ };
+      int id=0;
+      for(int i=0; i<3; i++){
+	const int bin = std::floor(xyz[i]/VoxelSize);
+	if(bin<0 || bin>=n[i]) return -1;
+	id = id*n[i] + bin;
+      }
+      return id;
+    }
+  };
+
+  //through-going muon, downwards and along the beam
+  std::vector<TVector3> MakeTrajectory(size_t track)
+  {
+    std::vector<TVector3> traj;
+    const double x0 = 20. + 10.*track, z0 = 50. + 30.*track;
+    for(double s=0; s<600.; s+=Step)
+      traj.emplace_back(x0 + 0.2*s, 245. - 0.35*s, z0 + 0.91*s);
+    return traj;
+  }
+
+  //one lookup and one hypothesis per segment
+  void PerSegment(std::vector<TVector3> const& traj, std::vector<float> const& dEdxVector,
+		  std::vector<float> const& qe_vector, GridVisibility const& vis,
+		  opdet::FlashHypothesisCollection& fhc)
+  {
+    opdet::FlashHypothesisCalculator calc;
+    opdet::FlashHypothesisCollection seg_fhc;
+    opdet::FlashHypothesis prompt_hyp(qe_vector.size());
+    for(size_t pt=1; pt<traj.size(); pt++){
+      const std::array<double,3> xyz = calc.SegmentMidpointArray(traj[pt-1],traj[pt]);
+      float const* vis_vector = vis.GetAllVisibilities(xyz.data());
+      if(!vis_vector) continue;
+      calc.FillFlashHypothesis(Yield*dEdxVector[pt-1]*(traj[pt]-traj[pt-1]).Mag(),
+			       qe_vector,vis_vector,prompt_hyp);
+      seg_fhc.SetPromptHypAndPromptFraction(prompt_hyp,PromptFraction);
+      fhc += seg_fhc;
+    }
+  }
+
+  void Merged(std::vector<TVector3> const& traj, std::vector<float> const& dEdxVector,
+	      std::vector<float> const& qe_vector, GridVisibility const& vis,
+	      opdet::FlashHypothesisCollection& fhc)
+  {
+    opdet::FlashHypothesisCalculator().AccumulateTrajectory(traj,dEdxVector,false,Yield,PromptFraction,
+							    qe_vector,vis,0.,fhc);
+  }
+
+  template <typename F>
+  double TimeTracks(F f, std::vector<std::vector<TVector3>> const& trajs,
+		    std::vector<float> const& dEdxVector, std::vector<float> const& qe_vector,
+		    GridVisibility const& vis, std::vector<opdet::FlashHypothesisCollection>& fhcs)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for(size_t t=0; t<trajs.size(); t++)
+      f(trajs[t],dEdxVector,qe_vector,vis,fhcs[t]);
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count();
+  }
+
+}
+
+int main()
+{
+  std::vector<std::vector<TVector3>> trajs;
+  for(size_t t=0; t<NTracks; t++) trajs.push_back(MakeTrajectory(t));
+  std::vector<float> const dEdxVector(trajs.front().size(),2.1);
+
+  for(size_t nOpDets : {32, 300}){
+    GridVisibility const vis(nOpDets);
+    std::vector<float> const qe_vector(nOpDets,0.01);
+    std::vector<opdet::FlashHypothesisCollection> per_segment(NTracks,opdet::FlashHypothesisCollection(nOpDets));
+    std::vector<opdet::FlashHypothesisCollection> merged(NTracks,opdet::FlashHypothesisCollection(nOpDets));
+
+    double const t_per_segment = TimeTracks(PerSegment,trajs,dEdxVector,qe_vector,vis,per_segment);
+    double const t_merged = TimeTracks(Merged,trajs,dEdxVector,qe_vector,vis,merged);
+
+    //merged yields are summed before the multiplication: equal up to rounding
+    double max_rel_diff = 0;
+    for(size_t t=0; t<NTracks; t++){
+      auto const& a = per_segment[t].GetTotalHypothesis();
+      auto const& b = merged[t].GetTotalHypothesis();
+      for(size_t i=0; i<nOpDets; i++)
+	max_rel_diff = std::max(max_rel_diff,
+				std::abs((double)a.GetHypothesis(i)-b.GetHypothesis(i))/a.GetHypothesis(i));
+    }
+
+    std::printf("%3zu opdets, %zu tracks of %zu points: per segment %7.1f ms, merged voxel runs %7.1f ms (largest relative difference %.1e)\n",
+		nOpDets,NTracks,trajs.front().size(),t_per_segment,t_merged,max_rel_diff);
+  }
+  return 0;
+}
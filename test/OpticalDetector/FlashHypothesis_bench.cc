@@ -0,0 +1,71 @@
+// Accumulating the per-segment hypotheses of a trajectory: rebuilding the
+// sum for every segment (fhc = fhc + segment, with fresh segment objects)
+// against adding into the sum and reusing the segment objects.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/FlashHypothesis.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+  const float PromptFraction = 0.25;
+
+  void FillSegment(size_t seg, opdet::FlashHypothesis& prompt)
+  {
+    for(size_t i=0; i<prompt.GetVectorSize(); i++)
+      prompt.SetHypothesisAndError(i, 1e-3*((seg*7919 + i*104729)%1000));
+  }
+
+  double Rebuild(size_t nOpDets, size_t nSegments)
+  {
+    opdet::FlashHypothesisCollection fhc(nOpDets);
+    for(size_t seg=0; seg<nSegments; seg++){
+      opdet::FlashHypothesis prompt(nOpDets);
+      FillSegment(seg,prompt);
+      opdet::FlashHypothesisCollection seg_fhc(nOpDets);
+      seg_fhc.SetPromptHypAndPromptFraction(prompt,PromptFraction);
+      fhc = fhc + seg_fhc;
+    }
+    return fhc.GetTotalHypothesis().GetTotalPEs();
+  }
+
+  double InPlace(size_t nOpDets, size_t nSegments)
+  {
+    opdet::FlashHypothesisCollection fhc(nOpDets), seg_fhc;
+    opdet::FlashHypothesis prompt(nOpDets);
+    for(size_t seg=0; seg<nSegments; seg++){
+      FillSegment(seg,prompt);
+      seg_fhc.SetPromptHypAndPromptFraction(prompt,PromptFraction);
+      fhc += seg_fhc;
+    }
+    return fhc.GetTotalHypothesis().GetTotalPEs();
+  }
+
+  template <typename F>
+  double TimePerSegment(F f, size_t nOpDets, size_t nSegments, size_t nTracks, double& check)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for(size_t t=0; t<nTracks; t++) check += f(nOpDets,nSegments);
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::nano>(stop-start).count()/(nTracks*nSegments);
+  }
+
+}
+
+int main()
+{
+  //10 trajectories of 10^4 points, 300 opdets
+  const size_t nOpDets = 300;
+  const size_t nSegments = 9999;
+  const size_t nTracks = 10;
+
+  double check_rebuild = 0, check_inplace = 0;
+  double const t_rebuild = TimePerSegment(Rebuild,nOpDets,nSegments,nTracks,check_rebuild);
+  double const t_inplace = TimePerSegment(InPlace,nOpDets,nSegments,nTracks,check_inplace);
+  std::printf("%zu opdets, %zu tracks of %zu points: rebuild %7.0f ns/segment, in place %7.0f ns/segment (%s)\n",
+	      nOpDets,nTracks,nSegments+1,t_rebuild,t_inplace,
+	      (check_rebuild==check_inplace)? "same sums" : "SUMS DIFFER");
+  return 0;
+}
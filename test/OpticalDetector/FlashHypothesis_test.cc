@@ -0,0 +1,88 @@
+#define BOOST_TEST_MODULE ( FlashHypothesis_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/FlashHypothesis.h"
+
+#include <cstdlib>
+
+const size_t NOpDets = 300;
+const size_t NSegments = 50;
+const float PromptFraction = 0.25;
+
+namespace {
+
+  //deterministic pseudo-random hypothesis, one per segment
+  opdet::FlashHypothesisCollection MakeSegmentHypothesis(size_t seed)
+  {
+    std::srand(seed);
+    opdet::FlashHypothesis prompt(NOpDets);
+    for(size_t i=0; i<NOpDets; i++)
+      prompt.SetHypothesisAndError(i, 100.*std::rand()/RAND_MAX);
+    opdet::FlashHypothesisCollection fhc;
+    fhc.SetPromptHypAndPromptFraction(prompt,PromptFraction);
+    return fhc;
+  }
+
+  void CheckIdentical(opdet::FlashHypothesis const& a, opdet::FlashHypothesis const& b)
+  {
+    BOOST_CHECK_EQUAL(a.GetVectorSize(),b.GetVectorSize());
+    for(size_t i=0; i<a.GetVectorSize(); i++){
+      BOOST_CHECK_EQUAL(a.GetHypothesis(i),b.GetHypothesis(i));
+      BOOST_CHECK_EQUAL(a.GetHypothesisError(i),b.GetHypothesisError(i));
+    }
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(FlashHypothesis_test)
+
+BOOST_AUTO_TEST_CASE(AddInPlace_checkQuadratureErrors)
+{
+  opdet::FlashHypothesis fh1(std::vector<float>{1.,4.},std::vector<float>{3.,6.});
+  opdet::FlashHypothesis fh2(std::vector<float>{2.,5.},std::vector<float>{4.,8.});
+
+  fh1 += fh2;
+
+  BOOST_CHECK_EQUAL(fh1.GetHypothesis(0),3.);
+  BOOST_CHECK_EQUAL(fh1.GetHypothesis(1),9.);
+  BOOST_CHECK_EQUAL(fh1.GetHypothesisError(0),5.);
+  BOOST_CHECK_EQUAL(fh1.GetHypothesisError(1),10.);
+}
+
+BOOST_AUTO_TEST_CASE(AddInPlace_checkSizeMismatch)
+{
+  opdet::FlashHypothesis fh1(2), fh2(3);
+  BOOST_CHECK_THROW(fh1 += fh2, std::runtime_error);
+
+  opdet::FlashHypothesisCollection fhc1(2), fhc2(3);
+  BOOST_CHECK_THROW(fhc1 += fhc2, std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(AddInPlace_checkSameAsOperatorPlus)
+{
+  opdet::FlashHypothesis fh_plus(NOpDets), fh_inplace(NOpDets);
+  for(size_t i_seg=0; i_seg<NSegments; i_seg++){
+    opdet::FlashHypothesis seg = MakeSegmentHypothesis(i_seg).GetPromptHypothesis();
+    fh_plus = fh_plus + seg;
+    fh_inplace += seg;
+  }
+  CheckIdentical(fh_plus,fh_inplace);
+}
+
+BOOST_AUTO_TEST_CASE(CollectionAddInPlace_checkSameAsOperatorPlus)
+{
+  opdet::FlashHypothesisCollection fhc_plus(NOpDets), fhc_inplace(NOpDets);
+  for(size_t i_seg=0; i_seg<NSegments; i_seg++){
+    opdet::FlashHypothesisCollection seg = MakeSegmentHypothesis(i_seg);
+    fhc_plus = fhc_plus + seg;
+    fhc_inplace.AddInPlace(seg);
+  }
+
+  CheckIdentical(fhc_plus.GetPromptHypothesis(),fhc_inplace.GetPromptHypothesis());
+  CheckIdentical(fhc_plus.GetLateHypothesis(),fhc_inplace.GetLateHypothesis());
+  CheckIdentical(fhc_plus.GetTotalHypothesis(),fhc_inplace.GetTotalHypothesis());
+  BOOST_CHECK_EQUAL(fhc_plus.GetPromptFraction(),fhc_inplace.GetPromptFraction());
+  BOOST_CHECK_CLOSE(fhc_inplace.GetPromptFraction(),PromptFraction,1e-3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
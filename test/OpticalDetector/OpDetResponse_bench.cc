@@ -0,0 +1,81 @@
+// 10^8 photon detection decisions with MicrobooneOpDetResponse, called
+// through the OpDetResponseInterface as through a ServiceHandle: full
+// photons one detected() call at a time against detectedBatch() on
+// channels of 10^4 photons, and lite photons one detectedLite() call at a
+// time against detectedLiteCount().
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/MicrobooneOpDetResponse.h"
+
+#include "CLHEP/Random/JamesRandom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  const int NPhotonsPerChannel = 10000;
+  const int NChannels = 10000; // 10^8 photons
+
+  double Since(std::chrono::steady_clock::time_point start)
+  {
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count();
+  }
+
+}
+
+int main()
+{
+  fhicl::ParameterSet pset;
+  pset.put("QuantumEfficiency", 0.2);
+  pset.put("WavelengthCutLow", 128.);
+  pset.put("WavelengthCutHigh", 380.);
+  opdet::MicrobooneOpDetResponse const microboone(pset);
+  opdet::OpDetResponseInterface const& response = microboone;
+
+  // wavelengths from 100 to 500 nm, about 70% in the acceptance
+  std::vector<sim::OnePhoton> photons(NPhotonsPerChannel);
+  for (int i = 0; i < NPhotonsPerChannel; i++)
+    photons[i].Energy = (2.0*3.142)*0.000197/(100. + (i*7919 % 400));
+
+  // full photons
+  long nSingle = 0, nBatch = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int ch = 0; ch < NChannels; ch++)
+    for (auto const& photon : photons)
+      if (response.detected(ch % 32, photon)) ++nSingle;
+  double const t_single = Since(start);
+
+  std::vector<char> detected;
+  start = std::chrono::steady_clock::now();
+  for (int ch = 0; ch < NChannels; ch++) {
+    response.detectedBatch(ch % 32, photons, detected);
+    for (char const d : detected) nBatch += d;
+  }
+  double const t_batch = Since(start);
+
+  std::printf("%d full photons: detected() %7.1f ms, detectedBatch() %7.1f ms (%s)\n",
+              NPhotonsPerChannel*NChannels, t_single, t_batch,
+              (nSingle == nBatch)? "same detected photons" : "DETECTED PHOTONS DIFFER");
+
+  // lite photons
+  CLHEP::HepJamesRandom engine(46);
+  long nLiteSingle = 0, nLiteCount = 0;
+  start = std::chrono::steady_clock::now();
+  for (int ch = 0; ch < NChannels; ch++)
+    for (int i = 0; i < NPhotonsPerChannel; i++)
+      if (response.detectedLite(ch % 32)) ++nLiteSingle;
+  double const t_lite_single = Since(start);
+
+  start = std::chrono::steady_clock::now();
+  for (int ch = 0; ch < NChannels; ch++)
+    nLiteCount += response.detectedLiteCount(ch % 32, NPhotonsPerChannel, engine);
+  double const t_lite_count = Since(start);
+
+  std::printf("%d lite photons: detectedLite() %7.1f ms, detectedLiteCount() %7.1f ms (%s)\n",
+              NPhotonsPerChannel*NChannels, t_lite_single, t_lite_count,
+              (nLiteSingle == nLiteCount)? "same detected photons" : "DETECTED PHOTONS DIFFER");
+  return 0;
+}
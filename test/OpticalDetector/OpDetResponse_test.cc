@@ -0,0 +1,172 @@
+#define BOOST_TEST_MODULE ( OpDetResponse_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/MicrobooneOpDetResponse.h"
+
+#include "CLHEP/Random/JamesRandom.h"
+#include "CLHEP/Random/RandFlat.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+  // a response with a quantum efficiency and nothing else
+  class QEResponse : public opdet::OpDetResponseInterface {
+  public:
+    QEResponse(double QE, long seed) : fQE(QE), fEngine(seed) {}
+    mutable int NChannelCalls = 0;
+
+  private:
+    double fQE;
+    mutable CLHEP::HepJamesRandom fEngine;
+
+    void doReconfigure(fhicl::ParameterSet const&) override {}
+    int doNOpChannels() const override { ++NChannelCalls; return 32; }
+
+    bool doDetected(int OpChannel, const sim::OnePhoton&, int& newOpChannel) const override
+    {
+      newOpChannel = OpChannel;
+      return CLHEP::RandFlat::shoot(&fEngine, 1.0) <= fQE;
+    }
+    bool doDetectedLite(int OpChannel, int& newOpChannel) const override
+    {
+      newOpChannel = OpChannel;
+      return CLHEP::RandFlat::shoot(&fEngine, 1.0) <= fQE;
+    }
+  };
+
+  // the same, counting the photons of the lite case in one draw
+  class SampledQEResponse : public QEResponse {
+  public:
+    SampledQEResponse(double QE, long seed) : QEResponse(QE, seed), fQE(QE) {}
+
+  private:
+    double fQE;
+
+    int doDetectedLiteCount(int, int n, CLHEP::HepRandomEngine& engine) const override
+    {
+      return sampleDetectedCount(n, fQE, engine);
+    }
+  };
+
+  std::vector<sim::OnePhoton> MakePhotons(float low, float high)
+  {
+    // photon energies in MeV, wavelengths in nm
+    auto const energy = [](double wavel) { return (2.0*3.142)*0.000197/wavel; };
+    std::vector<sim::OnePhoton> photons;
+    for (double wavel : {1., 100., 127., 128., 200., 379.9, 380., 430., 600., 1e5}) {
+      sim::OnePhoton ph;
+      ph.Energy = energy(wavel);
+      photons.push_back(ph);
+      ph.Energy = std::nextafter(ph.Energy, 1.f);
+      photons.push_back(ph);
+      ph.Energy = std::nextafter(ph.Energy, 0.f);
+      ph.Energy = std::nextafter(ph.Energy, 0.f);
+      photons.push_back(ph);
+    }
+    // wavelengths just at the cuts, as the response computes them
+    for (float cut : {low, high}) {
+      sim::OnePhoton ph;
+      ph.Energy = energy(cut);
+      for (int i = 0; i < 8; i++) {
+        photons.push_back(ph);
+        ph.Energy = std::nextafter(ph.Energy, (i < 4)? 1.f : 0.f);
+      }
+    }
+    for (float e : {0.f, -1e-6f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()}) {
+      sim::OnePhoton ph;
+      ph.Energy = e;
+      photons.push_back(ph);
+    }
+    return photons;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(MicrobooneResponse_SameAsPerPhoton)
+{
+  fhicl::ParameterSet pset;
+  pset.put("QuantumEfficiency", 0.2);
+  pset.put("WavelengthCutLow", 128.);
+  pset.put("WavelengthCutHigh", 380.);
+  opdet::MicrobooneOpDetResponse const response(pset);
+
+  auto const photons = MakePhotons(128., 380.);
+  std::vector<char> detected(3, 1);
+  response.detectedBatch(5, photons, detected);
+
+  BOOST_REQUIRE_EQUAL(detected.size(), photons.size());
+  int nDetected = 0;
+  for (size_t i = 0; i < photons.size(); i++) {
+    BOOST_CHECK_EQUAL(bool(detected[i]), response.detected(5, photons[i]));
+    nDetected += detected[i];
+  }
+  BOOST_CHECK(nDetected > 0);
+  BOOST_CHECK(nDetected < (int)photons.size());
+
+  // every photon is detected in the lite case
+  CLHEP::HepJamesRandom engine(1);
+  for (int n : {0, 1, 7, 100000})
+    BOOST_CHECK_EQUAL(response.detectedLiteCount(5, n, engine), n);
+}
+
+BOOST_AUTO_TEST_CASE(DefaultBatch_SameAsPerPhoton)
+{
+  // without overrides, the batch functions take the photons one by one
+  QEResponse const batch(0.3, 17);
+  QEResponse const single(0.3, 17);
+  CLHEP::HepJamesRandom engine(1);
+
+  for (int n : {0, 1, 10, 1000}) {
+    int nDetected = 0;
+    for (int i = 0; i < n; i++)
+      if (single.detectedLite(2)) ++nDetected;
+    BOOST_CHECK_EQUAL(batch.detectedLiteCount(2, n, engine), nDetected);
+  }
+
+  std::vector<sim::OnePhoton> const photons(500);
+  std::vector<char> detected;
+  batch.detectedBatch(2, photons, detected);
+  for (size_t i = 0; i < photons.size(); i++)
+    BOOST_CHECK_EQUAL(bool(detected[i]), single.detected(2, photons[i]));
+}
+
+BOOST_AUTO_TEST_CASE(SampledCount_SameDistribution)
+{
+  // binomial count against one draw per photon
+  double const QE = 0.23;
+  int const n = 40, nTrials = 20000;
+  SampledQEResponse const sampled(QE, 3);
+  QEResponse const perPhoton(QE, 5);
+  CLHEP::HepJamesRandom engine(7);
+
+  double sum = 0, sum2 = 0, sumRef = 0;
+  for (int t = 0; t < nTrials; t++) {
+    int const k = sampled.detectedLiteCount(1, n, engine);
+    BOOST_REQUIRE(k >= 0 && k <= n);
+    sum += k;
+    sum2 += double(k)*k;
+    sumRef += perPhoton.detectedLiteCount(1, n, engine);
+  }
+  double const mean = sum/nTrials, variance = sum2/nTrials - mean*mean;
+  double const sigma = std::sqrt(n*QE*(1-QE)/nTrials);
+  BOOST_CHECK_SMALL(mean - n*QE, 5*sigma);
+  BOOST_CHECK_SMALL(sumRef/nTrials - n*QE, 5*sigma);
+  BOOST_CHECK_CLOSE(variance, n*QE*(1-QE), 5.);
+
+  BOOST_CHECK_EQUAL(sampled.detectedLiteCount(1, 0, engine), 0);
+  BOOST_CHECK_EQUAL(sampled.detectedLiteCount(1, -3, engine), 0);
+}
+
+BOOST_AUTO_TEST_CASE(NOpChannels_Cached)
+{
+  QEResponse response(0.5, 1);
+  BOOST_CHECK_EQUAL(response.NOpChannels(), 32);
+  BOOST_CHECK_EQUAL(response.NOpChannels(), 32);
+  BOOST_CHECK_EQUAL(response.NChannelCalls, 1);
+
+  response.reconfigure(fhicl::ParameterSet());
+  BOOST_CHECK_EQUAL(response.NOpChannels(), 32);
+  BOOST_CHECK_EQUAL(response.NChannelCalls, 2);
+}
@@ -0,0 +1,132 @@
+// OpDigiProperties start-up and gain draws. SPE waveform files of 10^3 and
+// 10^6 lines: the getline()/strtod() loop GenEmpiricalWF used, against
+// ReadTextFile and ParseValueLines, and against a template already in the
+// OpDigiTemplateCache (a later instance of the service with the same
+// settings). Then the gains of 1000 photons on each of 32 channels: one
+// HighGain(ch) call per photon drawing from the global engine, against one
+// HighGains(ch, engine, gains) call per channel. The service needs art,
+// so the bodies of the gain draws are copied here.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/OpDigiTemplateCache.h"
+
+#include "CLHEP/Random/JamesRandom.h"
+#include "CLHEP/Random/RandGauss.h"
+#include "CLHEP/Random/Random.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+  const int NRepeat = 20;
+  const long Seed = 43;
+
+  /// Waveform template as GenEmpiricalWF made it before the cache
+  std::vector<double> GetlineTemplate(std::string const& path, int maxSamples)
+  {
+    std::ifstream WaveformFile(path.c_str());
+    std::string line;
+    std::vector<double> PEWaveform;
+    if(!WaveformFile.is_open()) throw std::runtime_error("Unable to open file");
+    double MaxAmp=0;
+    int NSample=0;
+    while(WaveformFile.good() && NSample<maxSamples){
+      getline(WaveformFile, line);
+      double Amp=strtod(line.c_str(),NULL);
+      PEWaveform.push_back(Amp);
+      if(Amp>MaxAmp) MaxAmp=Amp;
+      NSample++;
+    }
+    for(unsigned int i=0; i<PEWaveform.size(); i++){ PEWaveform[i]=PEWaveform[i]/MaxAmp; }
+    return PEWaveform;
+  }
+
+  /// Waveform template as GenEmpiricalWF makes it now, on a cache miss
+  std::vector<double> BulkTemplate(std::string const& path, int maxSamples)
+  {
+    std::string text;
+    if(!opdet::ReadTextFile(path, text)) throw std::runtime_error("Unable to open file");
+    std::vector<double> PEWaveform = opdet::ParseValueLines(std::move(text), maxSamples);
+    double MaxAmp=0;
+    for(double Amp : PEWaveform) if(Amp>MaxAmp) MaxAmp=Amp;
+    for(size_t i=0; i<PEWaveform.size(); i++){ PEWaveform[i]=PEWaveform[i]/MaxAmp; }
+    return PEWaveform;
+  }
+
+  template <typename F>
+  double TimeRepeat(F f)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for(int i=0; i<NRepeat; i++) f();
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/NRepeat;
+  }
+
+}
+
+int main()
+{
+  std::string const path = "OpDigiTemplateCache_bench_wf.txt";
+
+  for(int nLines : {1000, 1000000}){
+    {
+      std::ofstream file(path);
+      for(int i=0; i<nLines; i++)
+	file << 12.3*(i/8.)*std::exp(-(i/8.)) << "\n";
+    }
+
+    opdet::OpDigiTemplateCache cache;
+    opdet::OpDigiTemplateCache::Key const key{path, {double(nLines), 0.}};
+    std::vector<double> old_wf, wf, cached_wf;
+
+    double const t_getline = TimeRepeat([&](){ old_wf = GetlineTemplate(path, nLines); });
+    double const t_bulk = TimeRepeat([&](){ wf = BulkTemplate(path, nLines); });
+    cache.Get(key, [&](){ return BulkTemplate(path, nLines); });
+    double const t_cached = TimeRepeat([&](){
+	cached_wf = cache.Get(key, [&](){ return BulkTemplate(path, nLines); });
+      });
+
+    std::printf("%7d line waveform file: getline %8.3f ms, bulk read %8.3f ms, cached %8.3f ms (%s)\n",
+		nLines,t_getline,t_bulk,t_cached,
+		(old_wf==wf && wf==cached_wf)? "same templates" : "TEMPLATES DIFFER");
+  }
+  std::remove(path.c_str());
+
+  // gains of a few hundred PE per channel, 10% spread
+  const int nChannels = 32, nPhotons = 1000;
+  std::vector<double> HighGainArray, GainSpreadArray;
+  for(int ch=0; ch<nChannels; ch++){
+    HighGainArray.push_back(20. + 0.1*ch);
+    GainSpreadArray.push_back(0.1);
+  }
+
+  CLHEP::HepJamesRandom global_engine(Seed), engine(Seed);
+  CLHEP::HepRandom::setTheEngine(&global_engine);
+  std::vector<std::vector<double>> old_gains(nChannels), gains(nChannels);
+
+  double const t_per_photon = TimeRepeat([&](){
+      for(int ch=0; ch<nChannels; ch++){
+	old_gains[ch].clear();
+	for(int i=0; i<nPhotons; i++)
+	  old_gains[ch].push_back(CLHEP::RandGauss::shoot(HighGainArray[ch],GainSpreadArray[ch]*HighGainArray[ch]));
+      }
+    });
+  double const t_batch = TimeRepeat([&](){
+      for(int ch=0; ch<nChannels; ch++){
+	gains[ch].resize(nPhotons);
+	CLHEP::RandGauss::shootArray(&engine,int(gains[ch].size()),gains[ch].data(),
+				     HighGainArray[ch],GainSpreadArray[ch]*HighGainArray[ch]);
+      }
+    });
+
+  std::printf("%d channels x %d photons: gain per photon %6.3f ms/event, batch per channel %6.3f ms/event (%s)\n",
+	      nChannels,nPhotons,t_per_photon,t_batch,
+	      (old_gains==gains)? "same gains" : "GAINS DIFFER");
+  return 0;
+}
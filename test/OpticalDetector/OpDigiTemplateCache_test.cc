@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE ( OpDigiTemplateCache_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/OpDigiTemplateCache.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+  // the line by line reading previously used in OpDigiProperties
+  std::vector<double> ReadLines(std::string const& text, int maxValues = 1000000)
+  {
+    std::istringstream file(text);
+    std::string line;
+    std::vector<double> values;
+    int n = 0;
+    while( file.good() && n<maxValues ){
+      getline(file, line);
+      values.push_back(strtod(line.c_str(),NULL));
+      n++;
+    }
+    return values;
+  }
+
+  void CheckSame(std::vector<double> const& a, std::vector<double> const& b)
+  {
+    BOOST_REQUIRE_EQUAL(a.size(), b.size());
+    for(size_t i=0; i<a.size(); i++){
+      if(std::isnan(a[i])) BOOST_CHECK(std::isnan(b[i]));
+      else BOOST_CHECK_EQUAL(a[i], b[i]);
+    }
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(ParseValueLines_EdgeCases)
+{
+  std::vector<std::string> const texts = {
+    "",
+    "\n",
+    "\n\n",
+    "1.5",
+    "1.5\n",
+    "1.5\n-2e-3\n7\n",
+    "  3.25\n\t-4\n",                 // leading blanks
+    "1\r\n2\r\n",                     // DOS line ends
+    "abc\n5 6\n0x10\n1e400\n-inf\nnan\n.5\n",
+    "\n\n8\n\n9",                     // empty lines give 0, not the next value
+    std::string("4\0\n5", 4),         // embedded null
+  };
+
+  for(auto const& text : texts){
+    CheckSame(opdet::ParseValueLines(text), ReadLines(text));
+    for(int maxValues : {0, 1, 2, 3})
+      CheckSame(opdet::ParseValueLines(text, maxValues), ReadLines(text, maxValues));
+  }
+
+  auto const values = opdet::ParseValueLines("1\n2\n");
+  BOOST_REQUIRE_EQUAL(values.size(), 3U);
+  BOOST_CHECK_EQUAL(values[2], 0.);
+}
+
+BOOST_AUTO_TEST_CASE(ParseValueLines_Waveform)
+{
+  std::ostringstream text;
+  text.precision(17);
+  for(int i=0; i<5000; i++)
+    text << -12.3*(i/8.)*std::exp(-(i/8.)) + 1e-7*(i%13) << "\n";
+
+  CheckSame(opdet::ParseValueLines(text.str()), ReadLines(text.str()));
+  CheckSame(opdet::ParseValueLines(text.str(), 1500), ReadLines(text.str(), 1500));
+}
+
+BOOST_AUTO_TEST_CASE(ReadTextFile)
+{
+  std::string const path = "OpDigiTemplateCache_test.txt";
+  std::string const content = std::string("1\n2\r\n\0x\n3", 9);
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+  }
+  std::string text;
+  BOOST_CHECK(opdet::ReadTextFile(path, text));
+  BOOST_CHECK(text == content);
+  std::remove(path.c_str());
+
+  BOOST_CHECK(!opdet::ReadTextFile(path, text));
+}
+
+BOOST_AUTO_TEST_CASE(TemplateCache)
+{
+  opdet::OpDigiTemplateCache cache;
+  int nMade = 0;
+  auto make = [&nMade]() { ++nMade; return std::vector<double>{1., 0.5}; };
+
+  auto const& wf = cache.Get({"spe.txt", {1., 0.}}, make);
+  BOOST_CHECK_EQUAL(nMade, 1);
+  BOOST_CHECK_EQUAL(wf.size(), 2U);
+
+  // same file and parameters: not made again
+  BOOST_CHECK_EQUAL(&cache.Get({"spe.txt", {1., 0.}}, make), &wf);
+  BOOST_CHECK_EQUAL(nMade, 1);
+
+  // other parameters, or other file
+  cache.Get({"spe.txt", {1., 1.}}, make);
+  cache.Get({"spe.txt", {2.}}, make);
+  cache.Get({"other.txt", {1., 0.}}, make);
+  BOOST_CHECK_EQUAL(nMade, 4);
+  BOOST_CHECK_EQUAL(cache.NTemplates(), 4U);
+
+  // a failure is not stored
+  BOOST_CHECK_THROW(cache.Get({"missing.txt", {}},
+                              []() -> std::vector<double> { throw std::runtime_error("no file"); }),
+                    std::runtime_error);
+  BOOST_CHECK_EQUAL(cache.NTemplates(), 4U);
+  BOOST_CHECK_EQUAL(cache.Get({"missing.txt", {}}, make).size(), 2U);
+}
@@ -0,0 +1,260 @@
+// Binning the hits of an event into the two flash accumulators and
+// assigning them to flashes over 1, 10 and 100 ms readouts: the dense
+// accumulators RunFlashFinder used (6400 bins to start with, extended as
+// needed, one contributor vector per bin) against the sparse
+// FlashAccumulator. Then, at 10^5 hits, the sparse accumulators as first
+// written (binned with std::sort, flash candidates walked through the
+// nested FlashesBySize map, hit lists copied) against the counting sort and
+// the flat sorted candidate array.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/OpFlashAlg.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+  const float FlashThreshold = 50;
+  const double BinWidth = 1.; // us
+
+  // flashes of 1 to 30 hits every 20 us on average, on top of single PE
+  // noise at 0.5 hits/us, over a readout of Window us
+  std::vector<recob::OpHit> MakeHits(double Window, std::mt19937& gen)
+  {
+    std::uniform_real_distribution<double> flat(0.,1.);
+    std::vector<recob::OpHit> HitVector;
+    for (int flash = 0; flash < Window/20.; ++flash) {
+      double const t0 = Window * flat(gen);
+      int const NHits = 1 + 30 * flat(gen);
+      for (int hit = 0; hit < NHits; ++hit)
+        HitVector.emplace_back(0,t0 + 0.3*flat(gen),0,0,0.1,0,0,std::round(20*flat(gen)),0);
+    }
+    for (int noise = 0; noise < Window*0.5; ++noise)
+      HitVector.emplace_back(0,Window*flat(gen),0,0,0.1,0,0,1,0);
+    std::shuffle(HitVector.begin(),HitVector.end(),gen);
+    return HitVector;
+  }
+
+  double MinPeakTime(std::vector<recob::OpHit> const& HitVector)
+  {
+    double MinTime = std::numeric_limits<float>::max();
+    for (auto const& hit : HitVector)
+      if (hit.PeakTime() < MinTime) MinTime = hit.PeakTime();
+    return MinTime;
+  }
+
+  // the dense accumulators and flash assignment of RunFlashFinder before
+  void DenseFillAccumulator(unsigned int AccumIndex, unsigned int HitIndex, double PE,
+                            std::vector<double>& Binned,
+                            std::vector<std::vector<int>>& Contributors,
+                            std::vector<int>& FlashesInAccumulator)
+  {
+    Contributors.at(AccumIndex).push_back(HitIndex);
+    Binned.at(AccumIndex) += PE;
+    if (Binned.at(AccumIndex) >= FlashThreshold && (Binned.at(AccumIndex) - PE) < FlashThreshold)
+      FlashesInAccumulator.push_back(AccumIndex);
+  }
+
+  void DenseFillFlashesBySizeMap(
+    std::vector<int> const& FlashesInAccumulator,
+    std::vector<double> const& BinnedPE,
+    int Accumulator,
+    std::map<double, std::map<int, std::vector<int>>, std::greater<double>>& FlashesBySize)
+  {
+    for (auto const& flash : FlashesInAccumulator)
+      FlashesBySize[BinnedPE.at(flash)][Accumulator].push_back(flash);
+  }
+
+  void DenseClaimHits(std::vector<recob::OpHit> const& HitVector,
+                      std::vector<int> const& HitsThisFlash,
+                      std::vector<std::vector<int>>& HitsPerFlash,
+                      std::vector<int>& HitClaimedByFlash)
+  {
+    double PE = 0;
+    for (auto const& Hit : HitsThisFlash)
+      PE += HitVector.at(Hit).PE();
+    if (PE < FlashThreshold) return;
+    HitsPerFlash.push_back(HitsThisFlash);
+    for (auto const& Hit : HitsThisFlash)
+      if (HitClaimedByFlash.at(Hit) == -1) HitClaimedByFlash.at(Hit) = HitsPerFlash.size() - 1;
+  }
+
+  std::vector<std::vector<int>> Dense(std::vector<recob::OpHit> const& HitVector)
+  {
+    int initialsize = 6400;
+    std::vector<double> Binned1(initialsize);
+    std::vector<double> Binned2(initialsize);
+    std::vector<std::vector<int>> Contributors1(initialsize);
+    std::vector<std::vector<int>> Contributors2(initialsize);
+    std::vector<int> FlashesInAccumulator1;
+    std::vector<int> FlashesInAccumulator2;
+
+    double const minTime = MinPeakTime(HitVector);
+    for (auto const& hit : HitVector) {
+      double peakTime = hit.PeakTime();
+      unsigned int AccumIndex1 = opdet::GetAccumIndex(peakTime, minTime, BinWidth, 0.0);
+      unsigned int AccumIndex2 = opdet::GetAccumIndex(peakTime, minTime, BinWidth, BinWidth / 2.0);
+      // printed on std::cout by RunFlashFinder; kept out of the bench output
+      if (AccumIndex2 >= Binned1.size()) {
+        std::cerr << "Extending vectors to " << AccumIndex2 * 1.2 << std::endl;
+        Binned1.resize(AccumIndex2 * 1.2);
+        Binned2.resize(AccumIndex2 * 1.2);
+        Contributors1.resize(AccumIndex2 * 1.2);
+        Contributors2.resize(AccumIndex2 * 1.2);
+      }
+      size_t const hitIndex = &hit - &HitVector[0];
+      DenseFillAccumulator(AccumIndex1, hitIndex, hit.PE(), Binned1, Contributors1, FlashesInAccumulator1);
+      DenseFillAccumulator(AccumIndex2, hitIndex, hit.PE(), Binned2, Contributors2, FlashesInAccumulator2);
+    }
+
+    std::map<double, std::map<int, std::vector<int>>, std::greater<double>> FlashesBySize;
+    DenseFillFlashesBySizeMap(FlashesInAccumulator1, Binned1, 1, FlashesBySize);
+    DenseFillFlashesBySizeMap(FlashesInAccumulator2, Binned2, 2, FlashesBySize);
+
+    std::vector<std::vector<int>> HitsPerFlash;
+    std::vector<int> HitClaimedByFlash(HitVector.size(), -1);
+    for (auto const& itFlash : FlashesBySize)
+      for (auto const& itAcc : itFlash.second)
+        for (auto const& Bin : itAcc.second) {
+          auto const& Contributors = (itAcc.first == 1) ? Contributors1 : Contributors2;
+          std::vector<int> HitsThisFlash;
+          for (auto const& HitIndex : Contributors.at(Bin))
+            if (HitClaimedByFlash.at(HitIndex) == -1) HitsThisFlash.push_back(HitIndex);
+          DenseClaimHits(HitVector, HitsThisFlash, HitsPerFlash, HitClaimedByFlash);
+        }
+    return HitsPerFlash;
+  }
+
+  std::vector<std::vector<int>> Sparse(std::vector<recob::OpHit> const& HitVector)
+  {
+    double const MinTime = MinPeakTime(HitVector);
+    opdet::FlashAccumulator Accumulator1, Accumulator2;
+    opdet::FillAccumulator(HitVector, MinTime, BinWidth, 0., FlashThreshold, Accumulator1);
+    opdet::FillAccumulator(HitVector, MinTime, BinWidth, BinWidth / 2., FlashThreshold, Accumulator2);
+    std::vector<std::vector<int>> HitsPerFlash;
+    opdet::AssignHitsToFlash(Accumulator1, Accumulator2, HitVector, HitsPerFlash, FlashThreshold);
+    return HitsPerFlash;
+  }
+
+  // the sparse accumulators and map-based flash assignment as first written
+  void MapFillAccumulator(std::vector<recob::OpHit> const& HitVector,
+                          double MinTime,
+                          double BinOffset,
+                          opdet::FlashAccumulator& Accumulator)
+  {
+    Accumulator = opdet::FlashAccumulator();
+
+    std::vector<std::pair<unsigned int, int>> BinAndHit(HitVector.size());
+    for (size_t HitIndex = 0; HitIndex < HitVector.size(); ++HitIndex)
+      BinAndHit[HitIndex] = {
+        opdet::GetAccumIndex(HitVector[HitIndex].PeakTime(), MinTime, BinWidth, BinOffset),
+        static_cast<int>(HitIndex)};
+    std::sort(BinAndHit.begin(), BinAndHit.end());
+
+    std::vector<std::pair<int, int>> Crossings;
+    Accumulator.Hits.reserve(HitVector.size());
+    for (auto const& [Bin, HitIndex] : BinAndHit) {
+      if (Accumulator.Bins.empty() || Accumulator.Bins.back() != Bin) {
+        Accumulator.Bins.push_back(Bin);
+        Accumulator.BinnedPE.push_back(0.0);
+        Accumulator.HitOffsets.push_back(Accumulator.Hits.size());
+      }
+      Accumulator.Hits.push_back(HitIndex);
+      double const PE = HitVector[HitIndex].PE();
+      double& BinnedPE = Accumulator.BinnedPE.back();
+      BinnedPE += PE;
+      if (BinnedPE >= FlashThreshold && (BinnedPE - PE) < FlashThreshold)
+        Crossings.emplace_back(HitIndex, Accumulator.Bins.size() - 1);
+    }
+    Accumulator.HitOffsets.push_back(Accumulator.Hits.size());
+
+    std::sort(Crossings.begin(), Crossings.end());
+    for (auto const& Crossing : Crossings)
+      Accumulator.Flashes.push_back(Crossing.second);
+  }
+
+  std::vector<std::vector<int>> Map(std::vector<recob::OpHit> const& HitVector)
+  {
+    double const MinTime = MinPeakTime(HitVector);
+    opdet::FlashAccumulator Accumulator1, Accumulator2;
+    MapFillAccumulator(HitVector, MinTime, 0., Accumulator1);
+    MapFillAccumulator(HitVector, MinTime, BinWidth / 2., Accumulator2);
+
+    std::map<double, std::map<int, std::vector<int>>, std::greater<double>> FlashesBySize;
+    for (auto const& flash : Accumulator1.Flashes)
+      FlashesBySize[Accumulator1.BinnedPE[flash]][1].push_back(flash);
+    for (auto const& flash : Accumulator2.Flashes)
+      FlashesBySize[Accumulator2.BinnedPE[flash]][2].push_back(flash);
+
+    std::vector<std::vector<int>> HitsPerFlash;
+    std::vector<int> HitClaimedByFlash(HitVector.size(), -1);
+    for (auto const& itFlash : FlashesBySize)
+      for (auto const& itAcc : itFlash.second) {
+        opdet::FlashAccumulator const& Accumulator = (itAcc.first == 1) ? Accumulator1 : Accumulator2;
+        for (auto const& Position : itAcc.second) {
+          std::vector<int> HitsThisFlash;
+          for (unsigned int i = Accumulator.HitOffsets[Position];
+               i != Accumulator.HitOffsets[Position + 1];
+               ++i)
+            if (HitClaimedByFlash[Accumulator.Hits[i]] == -1)
+              HitsThisFlash.push_back(Accumulator.Hits[i]);
+          DenseClaimHits(HitVector, HitsThisFlash, HitsPerFlash, HitClaimedByFlash);
+        }
+      }
+    return HitsPerFlash;
+  }
+
+  template <typename F>
+  double TimeEvents(F f, std::vector<std::vector<recob::OpHit>> const& events,
+                    std::vector<std::vector<std::vector<int>>>& out)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t e = 0; e < events.size(); ++e)
+      out[e] = f(events[e]);
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/events.size();
+  }
+
+}
+
+int main()
+{
+  std::mt19937 gen(2024);
+  const size_t NEvents = 10;
+
+  for (double Window : {1000., 10000., 100000.}) {
+    std::vector<std::vector<recob::OpHit>> events;
+    for (size_t e = 0; e < NEvents; ++e) events.push_back(MakeHits(Window,gen));
+
+    std::vector<std::vector<std::vector<int>>> dense(NEvents), sparse(NEvents);
+    double const t_dense = TimeEvents(Dense,events,dense);
+    double const t_sparse = TimeEvents(Sparse,events,sparse);
+
+    std::printf("%5.0f ms readout, %6zu hits, %5zu flashes: dense accumulators %8.3f ms/event, sparse %8.3f ms/event (%s)\n",
+                Window/1000.,events.front().size(),dense.front().size(),t_dense,t_sparse,
+                (dense==sparse)? "same flashes" : "FLASHES DIFFER");
+  }
+
+  // the first 10^5 hits of 100 ms readouts
+  std::vector<std::vector<recob::OpHit>> events;
+  for (size_t e = 0; e < NEvents; ++e) {
+    events.push_back(MakeHits(100000.,gen));
+    events.back().erase(events.back().begin() + 100000, events.back().end());
+  }
+  std::vector<std::vector<std::vector<int>>> map(NEvents), flat(NEvents);
+  double const t_map = TimeEvents(Map,events,map);
+  double const t_flat = TimeEvents(Sparse,events,flat);
+  std::printf("%6zu hits, %5zu flashes: flash size map %8.3f ms/event, sorted candidate array %8.3f ms/event (%s)\n",
+              events.front().size(),map.front().size(),t_map,t_flat,
+              (map==flat)? "same flashes" : "FLASHES DIFFER");
+  return 0;
+}
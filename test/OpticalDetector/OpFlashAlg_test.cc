@@ -3,6 +3,11 @@
 
 #include "larana/OpticalDetector/OpFlashAlg.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
 // const float HitThreshold = 3;
 const float FlashThreshold = 50;
 const double WidthTolerance = 0.5;
@@ -1503,4 +1508,149 @@ BOOST_AUTO_TEST_CASE(RemoveFlashesFromVectors_NoFlashes)
 }
 
 
+BOOST_AUTO_TEST_CASE(FillSparseAccumulator_checkBinsAndContributors)
+{
+  std::vector<recob::OpHit> HitVector;
+  HitVector.emplace_back(0,  12.5,0,0,0,0,0,30,0); // bin 12, flash when hit 3 arrives
+  HitVector.emplace_back(0,1000.2,0,0,0,0,0,60,0); // bin 1000, flash right away
+  HitVector.emplace_back(0,   0.1,0,0,0,0,0, 5,0); // bin 0
+  HitVector.emplace_back(0,  12.9,0,0,0,0,0,25,0); // bin 12
+
+  opdet::FlashAccumulator Accumulator;
+  opdet::FillAccumulator(HitVector,0.,1.,0.,FlashThreshold,Accumulator);
+
+  std::vector<unsigned int> const Bins { 0, 12, 1000 };
+  std::vector<unsigned int> const HitOffsets { 0, 1, 3, 4 };
+  std::vector<int> const Hits { 2, 0, 3, 1 };
+  std::vector<int> const Flashes { 2, 1 }; // positions, in the order bins became flashes
+  BOOST_CHECK(Accumulator.Bins == Bins);
+  BOOST_CHECK(Accumulator.HitOffsets == HitOffsets);
+  BOOST_CHECK(Accumulator.Hits == Hits);
+  BOOST_CHECK(Accumulator.Flashes == Flashes);
+  BOOST_REQUIRE_EQUAL( Accumulator.BinnedPE.size() , 3U );
+  BOOST_CHECK_EQUAL( Accumulator.BinnedPE[0] , 5 );
+  BOOST_CHECK_EQUAL( Accumulator.BinnedPE[1] , 55 );
+  BOOST_CHECK_EQUAL( Accumulator.BinnedPE[2] , 60 );
+
+  // half-bin offset moves the second bin 12 hit over to bin 13
+  opdet::FillAccumulator(HitVector,0.,1.,0.5,FlashThreshold,Accumulator);
+  std::vector<unsigned int> const OffsetBins { 0, 13, 1000 };
+  BOOST_CHECK(Accumulator.Bins == OffsetBins);
+  BOOST_CHECK_EQUAL( Accumulator.Flashes.size() , 2U );
+
+  auto const BinHits = Accumulator.BinHits(1);
+  std::vector<int> const HitsThisBin(BinHits.begin(),BinHits.end());
+  std::vector<int> const ExpectedHits { 0, 3 };
+  BOOST_CHECK(HitsThisBin == ExpectedHits);
+}
+
+BOOST_AUTO_TEST_CASE(FillSparseAccumulator_checkEmpty)
+{
+  std::vector<recob::OpHit> HitVector;
+  opdet::FlashAccumulator Accumulator;
+  opdet::FillAccumulator(HitVector,0.,1.,0.,FlashThreshold,Accumulator);
+
+  BOOST_CHECK( Accumulator.Bins.empty() );
+  BOOST_CHECK( Accumulator.Flashes.empty() );
+  BOOST_REQUIRE_EQUAL( Accumulator.HitOffsets.size() , 1U );
+  BOOST_CHECK_EQUAL( Accumulator.HitOffsets[0] , 0U );
+}
+
+BOOST_AUTO_TEST_CASE(AssignHitsToFlash_SparseMatchesDense)
+{
+  std::mt19937 gen(2024);
+  std::uniform_real_distribution<double> flat(0.,1.);
+
+  for (int trial = 0; trial < 50; ++trial) {
+
+    // clusters of hits on top of single-PE noise, over 1 to 100 ms readouts
+    double const Window = 1000. * (1 + trial % 3 * 49);
+    std::vector<recob::OpHit> HitVector;
+    for (int flash = 0; flash < 1 + trial; ++flash) {
+      double const t0 = Window * flat(gen);
+      int const NHits = 1 + 15 * flat(gen);
+      for (int hit = 0; hit < NHits; ++hit)
+        HitVector.emplace_back(0,t0 + 0.3*flat(gen),0,0,0.1,0,0,std::round(60*flat(gen)),0);
+    }
+    for (int noise = 0; noise < 10*trial; ++noise)
+      HitVector.emplace_back(0,Window*flat(gen),0,0,0.1,0,0,1 + (trial+noise) % 3,0);
+    std::shuffle(HitVector.begin(),HitVector.end(),gen);
+
+    double const BinWidth = 1.;
+    double MinTime = std::numeric_limits<float>::max();
+    for (auto const& hit : HitVector) MinTime = std::min(MinTime,hit.PeakTime());
+
+    // dense accumulators, filled hit by hit
+    size_t const NBins = (Window + BinWidth) / BinWidth + 2;
+    std::vector<double> Binned1(NBins), Binned2(NBins);
+    std::vector<std::vector<int>> Contributors1(NBins), Contributors2(NBins);
+    std::vector<int> FlashesInAccumulator1, FlashesInAccumulator2;
+    for (size_t HitIndex = 0; HitIndex < HitVector.size(); ++HitIndex) {
+      double const PeakTime = HitVector[HitIndex].PeakTime();
+      opdet::FillAccumulator(opdet::GetAccumIndex(PeakTime,MinTime,BinWidth,0.),HitIndex,
+                             HitVector[HitIndex].PE(),FlashThreshold,
+                             Binned1,Contributors1,FlashesInAccumulator1);
+      opdet::FillAccumulator(opdet::GetAccumIndex(PeakTime,MinTime,BinWidth,BinWidth/2.),HitIndex,
+                             HitVector[HitIndex].PE(),FlashThreshold,
+                             Binned2,Contributors2,FlashesInAccumulator2);
+    }
+    std::vector<std::vector<int>> DenseHitsPerFlash;
+    opdet::AssignHitsToFlash(FlashesInAccumulator1,FlashesInAccumulator2,
+                             Binned1,Binned2,Contributors1,Contributors2,
+                             HitVector,DenseHitsPerFlash,FlashThreshold);
+
+    opdet::FlashAccumulator Accumulator1, Accumulator2;
+    opdet::FillAccumulator(HitVector,MinTime,BinWidth,0.,FlashThreshold,Accumulator1);
+    opdet::FillAccumulator(HitVector,MinTime,BinWidth,BinWidth/2.,FlashThreshold,Accumulator2);
+    BOOST_CHECK_EQUAL( Accumulator1.Flashes.size() , FlashesInAccumulator1.size() );
+    BOOST_CHECK_EQUAL( Accumulator2.Flashes.size() , FlashesInAccumulator2.size() );
+
+    std::vector<std::vector<int>> SparseHitsPerFlash;
+    opdet::AssignHitsToFlash(Accumulator1,Accumulator2,HitVector,SparseHitsPerFlash,FlashThreshold);
+
+    BOOST_CHECK(SparseHitsPerFlash == DenseHitsPerFlash);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AssignHitsToFlash_SparseEqualSizeTieBreak)
+{
+  // Two flashes of the same size: the one in the first accumulator is
+  // taken first, and claims the hit it shares with the other
+  std::vector<recob::OpHit> HitVector;
+  HitVector.emplace_back(0,1.7,0,0,0.1,0,0,60,0);
+  HitVector.emplace_back(0,2.2,0,0,0.1,0,0,60,0);
+  HitVector.emplace_back(0,2.6,0,0,0.1,0,0,60,0);
+
+  opdet::FlashAccumulator Accumulator1, Accumulator2;
+  opdet::FillAccumulator(HitVector,0.,1.,0.,FlashThreshold,Accumulator1);
+  opdet::FillAccumulator(HitVector,0.,1.,0.5,FlashThreshold,Accumulator2);
+  BOOST_REQUIRE_EQUAL( Accumulator1.Flashes.size() , 2ul );
+  BOOST_REQUIRE_EQUAL( Accumulator2.Flashes.size() , 2ul );
+
+  std::vector<std::vector<int>> HitsPerFlash;
+  opdet::AssignHitsToFlash(Accumulator1,Accumulator2,HitVector,HitsPerFlash,FlashThreshold);
+
+  // Accumulator1 bins: {0}, {1,2}; Accumulator2 bins: {0,1}, {2}
+  std::vector<std::vector<int>> const Expected = {{1,2},{0}};
+  BOOST_CHECK(HitsPerFlash == Expected);
+}
+
+BOOST_AUTO_TEST_CASE(ForEachFlashHit_checkPairs)
+{
+  std::vector<std::vector<int>> const AssocList = {{4,0,7},{},{2},{1,3}};
+
+  std::vector<std::pair<size_t,size_t>> Pairs;
+  opdet::ForEachFlashHit(AssocList,[&](size_t FlashIndex, size_t HitIndex)
+                         { Pairs.emplace_back(FlashIndex,HitIndex); });
+
+  std::vector<std::pair<size_t,size_t>> const Expected =
+    {{0,4},{0,0},{0,7},{2,2},{3,1},{3,3}};
+  BOOST_CHECK(Pairs == Expected);
+
+  Pairs.clear();
+  opdet::ForEachFlashHit(std::vector<std::vector<int>>(),[&](size_t FlashIndex, size_t HitIndex)
+                         { Pairs.emplace_back(FlashIndex,HitIndex); });
+  BOOST_CHECK(Pairs.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,228 @@
+// OpMCDigi waveform building, channels x photons per channel: the
+// sample-by-sample pipeline OpMCDigi used (one growing vector per channel,
+// bounds-checked adds, then separate dark noise, saturation and rounding
+// passes with one random number per sample) against OpMCDigiAlg (one padded
+// buffer, unchecked adds, one final pass). Same seed for both. Then mostly
+// dark channels, 256 of 102400 samples with a 10 kHz dark rate and a
+// 128-sample template, none or 8 of them lit: the dense pipeline against
+// the sparse pulse lists. Their dark noise is drawn differently, so the
+// waveforms are compared with the dark noise off.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/OpMCDigiAlg.h"
+
+#include "CLHEP/Random/JamesRandom.h"
+#include "CLHEP/Random/RandExponential.h"
+#include "CLHEP/Random/RandFlat.h"
+#include "CLHEP/Random/RandPoisson.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  const int NSamples = 3000;
+  const float SampleFreq = 64;           // MHz
+  const float WindowLength = NSamples/SampleFreq; // us
+  const float SaturationScale = 300;
+  const double MeanDarkPulses = 2.5;
+  const long Seed = 12345;
+  const int NEvents = 5;
+
+  std::vector<double> SinglePEWaveform()
+  {
+    std::vector<double> spe(60);
+    for(size_t i=0; i<spe.size(); i++)
+      spe[i] = -12.3*(i/8.)*std::exp(-(i/8.));
+    return spe;
+  }
+
+  std::vector<std::vector<int>> PhotonTimes(int nChannels, int nPhotons)
+  {
+    std::vector<std::vector<int>> times(nChannels);
+    for(int ch=0; ch<nChannels; ch++)
+      for(int i=0; i<nPhotons; i++)
+	times[ch].push_back( (ch*131 + i*i*17 + (i%7)*333) % NSamples );
+    return times;
+  }
+
+  void AddTimedWaveformOld(int binTime, std::vector<double>& OldPulse, std::vector<double> const& NewPulse)
+  {
+    if( (binTime + NewPulse.size() ) > OldPulse.size())
+      OldPulse.resize(binTime + NewPulse.size());
+    for(size_t i = 0; i!=NewPulse.size(); ++i)
+      OldPulse.at(binTime+i) += NewPulse.at(i);
+  }
+
+  std::vector<std::vector<short>> DigitizeOld(std::vector<std::vector<int>> const& times,
+					      std::vector<double> const& spe,
+					      CLHEP::HepRandomEngine& engine)
+  {
+    CLHEP::RandFlat flat(engine);
+    CLHEP::RandPoisson poisson(engine);
+    const int nChannels = times.size();
+
+    std::vector<std::vector<double>> pulses(nChannels,std::vector<double>(NSamples,0.0));
+    for(int ch=0; ch<nChannels; ch++)
+      for(int t : times[ch])
+	AddTimedWaveformOld(t,pulses[ch],spe);
+
+    std::vector<std::vector<short>> out;
+    for(int ch=0; ch<nChannels; ch++){
+      pulses[ch].resize(NSamples);
+
+      unsigned const int NumberOfPulses = poisson.fire(MeanDarkPulses);
+      for(size_t i=0; i!=NumberOfPulses; ++i){
+	double const PulseTime = WindowLength*flat.fire(1.0);
+	AddTimedWaveformOld(static_cast<int>(PulseTime * SampleFreq),pulses[ch],spe);
+      }
+
+      for(size_t i=0; i!=pulses[ch].size(); ++i)
+	if(pulses[ch].at(i)>SaturationScale) pulses[ch].at(i) = SaturationScale;
+
+      std::vector<short> shortvec;
+      for(size_t i=0; i!=pulses[ch].size(); ++i){
+	int ThisSample = pulses[ch].at(i);
+	if(ThisSample>0){
+	  if(flat.fire(1.0) > (ThisSample - int(ThisSample))) shortvec.push_back(int(ThisSample));
+	  else shortvec.push_back(int(ThisSample)+1);
+	}
+	else{
+	  if(flat.fire(1.0) > (int(ThisSample)-ThisSample)) shortvec.push_back(int(ThisSample));
+	  else shortvec.push_back(int(ThisSample)-1);
+	}
+      }
+      out.push_back(shortvec);
+    }
+    return out;
+  }
+
+  std::vector<std::vector<short>> DigitizeAlg(std::vector<std::vector<int>> const& times,
+					      opdet::OpMCDigiAlg& alg,
+					      CLHEP::HepRandomEngine& engine)
+  {
+    CLHEP::RandFlat flat(engine);
+    CLHEP::RandPoisson poisson(engine);
+    const int nChannels = times.size();
+
+    alg.Reset(nChannels,NSamples);
+    for(int ch=0; ch<nChannels; ch++)
+      for(int t : times[ch])
+	alg.AddTimedWaveform(ch,t);
+
+    std::vector<std::vector<short>> out;
+    for(int ch=0; ch<nChannels; ch++){
+      alg.AddDarkNoise(ch,MeanDarkPulses,WindowLength,SampleFreq,poisson,flat);
+      out.push_back(alg.Digitize(ch,flat));
+    }
+    return out;
+  }
+
+  // mostly dark channels
+  const int DarkNChannels = 256;
+  const int DarkNSamples = 102400;
+  const double DarkRate = 10000; // Hz
+
+  std::vector<std::vector<short>> DigitizeDense(std::vector<std::vector<int>> const& times,
+						opdet::OpMCDigiAlg& alg,
+						double darkRate,
+						CLHEP::HepRandomEngine& engine)
+  {
+    CLHEP::RandFlat flat(engine);
+    CLHEP::RandPoisson poisson(engine);
+    const int nChannels = times.size();
+    float const windowLength = DarkNSamples/SampleFreq;
+
+    alg.Reset(nChannels,DarkNSamples);
+    for(int ch=0; ch<nChannels; ch++)
+      for(int t : times[ch])
+	alg.AddTimedWaveform(ch,t);
+
+    std::vector<std::vector<short>> out;
+    for(int ch=0; ch<nChannels; ch++){
+      alg.AddDarkNoise(ch,darkRate*windowLength/1000000,windowLength,SampleFreq,poisson,flat);
+      out.push_back(alg.Digitize(ch,flat));
+    }
+    return out;
+  }
+
+  std::vector<std::vector<short>> DigitizeSparse(std::vector<std::vector<int>> const& times,
+						 opdet::OpMCDigiAlg& alg,
+						 double darkRate,
+						 CLHEP::HepRandomEngine& engine)
+  {
+    CLHEP::RandExponential exponential(engine);
+    const int nChannels = times.size();
+
+    alg.ResetSparse(nChannels,DarkNSamples);
+    for(int ch=0; ch<nChannels; ch++)
+      for(int t : times[ch])
+	alg.AddPulseTime(ch,t);
+
+    std::vector<std::vector<short>> out;
+    for(int ch=0; ch<nChannels; ch++){
+      if(darkRate > 0) alg.AddDarkNoiseTimes(ch,darkRate/(SampleFreq*1000000),exponential);
+      out.push_back(alg.DigitizeSparse(ch));
+    }
+    return out;
+  }
+
+  template <typename F>
+  double TimeEvents(F f, std::vector<std::vector<short>>& out)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for(int e=0; e<NEvents; e++) out = f();
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/NEvents;
+  }
+
+}
+
+int main()
+{
+  std::vector<double> const spe = SinglePEWaveform();
+  opdet::OpMCDigiAlg alg(spe,SaturationScale);
+
+  for(int nChannels : {32, 300}){
+    for(int nPhotons : {10, 100, 1000}){
+      auto const times = PhotonTimes(nChannels,nPhotons);
+      CLHEP::HepJamesRandom old_engine(Seed), engine(Seed);
+      std::vector<std::vector<short>> old_wfs, wfs;
+
+      double const t_old = TimeEvents([&](){ return DigitizeOld(times,spe,old_engine); }, old_wfs);
+      double const t_alg = TimeEvents([&](){ return DigitizeAlg(times,alg,engine); }, wfs);
+
+      std::printf("%3d channels, %4d photons/channel: sample by sample %7.2f ms/event, padded buffer %7.2f ms/event (%s)\n",
+		  nChannels,nPhotons,t_old,t_alg,(old_wfs==wfs)? "same waveforms" : "WAVEFORMS DIFFER");
+    }
+  }
+
+  std::vector<double> spe128(128);
+  for(size_t i=0; i<spe128.size(); i++)
+    spe128[i] = 12.3*(i/16.)*std::exp(-(i/16.));
+  opdet::OpMCDigiAlg dark_alg(spe128,SaturationScale);
+
+  for(int nLit : {0, 8}){
+    // 1000 photons in each lit channel
+    std::vector<std::vector<int>> times(DarkNChannels);
+    for(int ch=0; ch<nLit; ch++)
+      for(int i=0; i<1000; i++)
+	times[ch*(DarkNChannels/8)].push_back( (ch*131 + i*i*17 + (i%7)*333) % DarkNSamples );
+
+    CLHEP::HepJamesRandom engine(Seed);
+    std::vector<std::vector<short>> dense, sparse;
+    double const t_dense = TimeEvents([&](){ return DigitizeDense(times,dark_alg,DarkRate,engine); }, dense);
+    double const t_sparse = TimeEvents([&](){ return DigitizeSparse(times,dark_alg,DarkRate,engine); }, sparse);
+
+    // the same pulses without dark noise give the same samples
+    dense = DigitizeDense(times,dark_alg,0,engine);
+    sparse = DigitizeSparse(times,dark_alg,0,engine);
+
+    std::printf("%3d channels of %d samples, %d lit, %.0f kHz dark rate: dense %7.2f ms/event, sparse %7.2f ms/event (%s)\n",
+		DarkNChannels,DarkNSamples,nLit,DarkRate/1000,t_dense,t_sparse,
+		(dense==sparse)? "same waveforms without dark noise" : "WAVEFORMS DIFFER");
+  }
+  return 0;
+}
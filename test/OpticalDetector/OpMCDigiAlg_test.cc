@@ -0,0 +1,314 @@
+#define BOOST_TEST_MODULE ( OpMCDigiAlg_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/OpMCDigiAlg.h"
+
+#include "CLHEP/Random/JamesRandom.h"
+#include "CLHEP/Random/RandExponential.h"
+#include "CLHEP/Random/RandFlat.h"
+#include "CLHEP/Random/RandPoisson.h"
+
+#include <cmath>
+
+const int NChannels = 16;
+const int NSamples = 3000;
+const float SampleFreq = 64;           // MHz
+const float WindowLength = NSamples/SampleFreq; // us
+const float SaturationScale = 300;
+const double MeanDarkPulses = 2.5;
+const long Seed = 12345;
+
+namespace {
+
+  std::vector<double> SinglePEWaveform()
+  {
+    std::vector<double> spe(60);
+    for(size_t i=0; i<spe.size(); i++)
+      spe[i] = -12.3*(i/8.)*std::exp(-(i/8.));
+    return spe;
+  }
+
+  // photon arrival samples for one channel, including pulses running
+  // past the end of the readout window
+  std::vector<int> PhotonTimes(int ch, int n)
+  {
+    std::vector<int> times;
+    for(int i=0; i<n; i++)
+      times.push_back( (ch*131 + i*i*17 + (i%7)*333) % NSamples );
+    return times;
+  }
+
+  // the sample-by-sample pipeline previously used in OpMCDigi
+  void AddTimedWaveformRef(int binTime, std::vector<double>& OldPulse, std::vector<double> const& NewPulse)
+  {
+    if( (binTime + NewPulse.size() ) > OldPulse.size())
+      OldPulse.resize(binTime + NewPulse.size());
+    for(size_t i = 0; i!=NewPulse.size(); ++i)
+      OldPulse.at(binTime+i) += NewPulse.at(i);
+  }
+
+  std::vector<std::vector<short>> DigitizeRef(int nPhotons, double meanDarkPulses,
+					      CLHEP::HepRandomEngine& engine)
+  {
+    CLHEP::RandFlat flat(engine);
+    CLHEP::RandPoisson poisson(engine);
+    std::vector<double> const spe = SinglePEWaveform();
+
+    std::vector<std::vector<double>> pulses(NChannels,std::vector<double>(NSamples,0.0));
+    for(int ch=0; ch<NChannels; ch++)
+      for(int t : PhotonTimes(ch,nPhotons))
+	AddTimedWaveformRef(t,pulses[ch],spe);
+
+    std::vector<std::vector<short>> out;
+    for(int ch=0; ch<NChannels; ch++){
+      pulses[ch].resize(NSamples);
+
+      unsigned const int NumberOfPulses = poisson.fire(meanDarkPulses);
+      for(size_t i=0; i!=NumberOfPulses; ++i){
+	double const PulseTime = WindowLength*flat.fire(1.0);
+	AddTimedWaveformRef(static_cast<int>(PulseTime * SampleFreq),pulses[ch],spe);
+      }
+
+      for(size_t i=0; i!=pulses[ch].size(); ++i)
+	if(pulses[ch].at(i)>SaturationScale) pulses[ch].at(i) = SaturationScale;
+
+      std::vector<short> shortvec;
+      for(size_t i=0; i!=pulses[ch].size(); ++i){
+	int ThisSample = pulses[ch].at(i);
+	if(ThisSample>0){
+	  if(flat.fire(1.0) > (ThisSample - int(ThisSample))) shortvec.push_back(int(ThisSample));
+	  else shortvec.push_back(int(ThisSample)+1);
+	}
+	else{
+	  if(flat.fire(1.0) > (int(ThisSample)-ThisSample)) shortvec.push_back(int(ThisSample));
+	  else shortvec.push_back(int(ThisSample)-1);
+	}
+      }
+      out.push_back(shortvec);
+    }
+    return out;
+  }
+
+  std::vector<std::vector<short>> DigitizeAlg(opdet::OpMCDigiAlg& alg, int nPhotons,
+					      double meanDarkPulses,
+					      CLHEP::HepRandomEngine& engine)
+  {
+    CLHEP::RandFlat flat(engine);
+    CLHEP::RandPoisson poisson(engine);
+
+    alg.Reset(NChannels,NSamples);
+    for(int ch=0; ch<NChannels; ch++)
+      for(int t : PhotonTimes(ch,nPhotons))
+	alg.AddTimedWaveform(ch,t);
+
+    std::vector<std::vector<short>> out;
+    for(int ch=0; ch<NChannels; ch++){
+      alg.AddDarkNoise(ch,meanDarkPulses,WindowLength,SampleFreq,poisson,flat);
+      out.push_back(alg.Digitize(ch,flat));
+    }
+    return out;
+  }
+
+  void CheckSameAsReference(int nPhotons, double meanDarkPulses=MeanDarkPulses)
+  {
+    CLHEP::HepJamesRandom ref_engine(Seed), engine(Seed);
+    opdet::OpMCDigiAlg alg(SinglePEWaveform(),SaturationScale);
+
+    auto const ref = DigitizeRef(nPhotons,meanDarkPulses,ref_engine);
+    auto const res = DigitizeAlg(alg,nPhotons,meanDarkPulses,engine);
+
+    BOOST_CHECK_EQUAL(res.size(),ref.size());
+    for(size_t ch=0; ch<ref.size(); ch++)
+      BOOST_CHECK_EQUAL_COLLECTIONS(res[ch].begin(),res[ch].end(),ref[ch].begin(),ref[ch].end());
+
+    //both pipelines consumed the same random numbers
+    BOOST_CHECK_EQUAL(engine.flat(),ref_engine.flat());
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(OpMCDigiAlg_test)
+
+BOOST_AUTO_TEST_CASE(Digitize_checkDarkNoiseOnly)
+{
+  CheckSameAsReference(0);
+}
+
+BOOST_AUTO_TEST_CASE(Digitize_checkFewPhotons)
+{
+  CheckSameAsReference(20);
+}
+
+BOOST_AUTO_TEST_CASE(Digitize_checkSaturatedPhotons)
+{
+  //saturation only clips positive samples, so flip the template
+  CLHEP::HepJamesRandom engine(Seed);
+  CLHEP::RandFlat flat(engine);
+  std::vector<double> spe(SinglePEWaveform());
+  for(auto& s : spe) s = -s;
+
+  opdet::OpMCDigiAlg alg(spe,SaturationScale);
+  alg.Reset(1,NSamples);
+  for(int i=0; i<100; i++) alg.AddTimedWaveform(0,1000);
+  std::vector<short> const wf = alg.Digitize(0,flat);
+
+  BOOST_CHECK_EQUAL(wf.size(),size_t(NSamples));
+  BOOST_CHECK_EQUAL(wf[999],0);
+  BOOST_CHECK_EQUAL(wf[1008],short(SaturationScale));
+}
+
+BOOST_AUTO_TEST_CASE(Digitize_checkManyPhotons)
+{
+  CheckSameAsReference(500);
+}
+
+BOOST_AUTO_TEST_CASE(Digitize_checkManyDarkPulses)
+{
+  //dark pulses at the end of the window of most channels
+  CheckSameAsReference(20,300.);
+}
+
+BOOST_AUTO_TEST_CASE(AddDarkNoise_checkEndOfWindow)
+{
+  //enough dark pulses that some start in the last template length of the
+  //window: their tails grow the waveform, photon pulse tails do not
+  CLHEP::HepJamesRandom engine(Seed);
+  CLHEP::RandFlat flat(engine);
+  CLHEP::RandPoisson poisson(engine);
+  std::vector<double> const spe(SinglePEWaveform());
+  const int n = spe.size();
+
+  opdet::OpMCDigiAlg alg(spe,SaturationScale);
+  alg.Reset(1,NSamples);
+  alg.AddTimedWaveform(0,NSamples-1);
+  alg.AddDarkNoise(0,2000.,WindowLength,SampleFreq,poisson,flat);
+  BOOST_CHECK_GT(alg.Length(0),NSamples);
+  BOOST_CHECK_LE(alg.Length(0),NSamples+n-1);
+
+  //the photon pulse tail is not in the extension: all of it is dark pulses
+  CLHEP::HepJamesRandom dark_engine(Seed);
+  CLHEP::RandFlat dark_flat(dark_engine);
+  CLHEP::RandPoisson dark_poisson(dark_engine);
+  opdet::OpMCDigiAlg dark(spe,SaturationScale);
+  dark.Reset(1,NSamples);
+  dark.AddDarkNoise(0,2000.,WindowLength,SampleFreq,dark_poisson,dark_flat);
+  BOOST_CHECK_EQUAL(dark.Length(0),alg.Length(0));
+  for(int i=NSamples; i<alg.Length(0); i++)
+    BOOST_CHECK_EQUAL(alg.Waveform(0)[i],dark.Waveform(0)[i]);
+  BOOST_CHECK_EQUAL(alg.Waveform(0)[NSamples-1],dark.Waveform(0)[NSamples-1]+spe[0]);
+
+  //one random number per sample of the grown waveform
+  std::vector<short> const wf = alg.Digitize(0,flat);
+  BOOST_CHECK_EQUAL(wf.size(),size_t(alg.Length(0)));
+  dark.Digitize(0,dark_flat);
+  BOOST_CHECK_EQUAL(engine.flat(),dark_engine.flat());
+
+  //without dark noise the waveform is the window
+  alg.Reset(1,NSamples);
+  alg.AddTimedWaveform(0,NSamples-1);
+  alg.AddDarkNoise(0,0.,WindowLength,SampleFreq,poisson,flat);
+  BOOST_CHECK_EQUAL(alg.Length(0),NSamples);
+  BOOST_CHECK_EQUAL(alg.Digitize(0,flat).size(),size_t(NSamples));
+}
+
+BOOST_AUTO_TEST_CASE(Reset_checkReuse)
+{
+  CLHEP::HepJamesRandom engine(Seed);
+  CLHEP::RandFlat flat(engine);
+  opdet::OpMCDigiAlg alg(SinglePEWaveform(),SaturationScale);
+
+  alg.Reset(2,NSamples);
+  alg.AddTimedWaveform(1,10);
+  alg.Reset(2,NSamples/2);
+  std::vector<short> const wf = alg.Digitize(1,flat);
+  BOOST_CHECK_EQUAL(wf.size(),size_t(NSamples/2));
+  for(short s : wf) BOOST_CHECK_EQUAL(s,0);
+}
+
+BOOST_AUTO_TEST_CASE(DigitizeSparse_checkSameAsDense)
+{
+  //same pulses, including overlapping ones and pulses running past the window
+  const short Baseline = 7;
+  CLHEP::HepJamesRandom engine(Seed);
+  CLHEP::RandFlat flat(engine);
+  std::vector<double> spe(SinglePEWaveform());
+  for(auto& s : spe) s = -s/4;
+
+  opdet::OpMCDigiAlg dense(spe,SaturationScale,Baseline), sparse(spe,SaturationScale,Baseline);
+  for(int nPhotons : {0, 1, 20, 500}){
+    dense.Reset(NChannels,NSamples);
+    sparse.ResetSparse(NChannels,NSamples);
+    for(int ch=0; ch<NChannels; ch++){
+      //reversed, the sparse pipeline sorts them
+      auto const times = PhotonTimes(ch,nPhotons);
+      for(auto t=times.rbegin(); t!=times.rend(); ++t){
+	dense.AddTimedWaveform(ch,*t);
+	sparse.AddPulseTime(ch,*t);
+      }
+      for(int t : {-5, NSamples-1, NSamples, 20*ch}){
+	dense.AddTimedWaveform(ch,t);
+	sparse.AddPulseTime(ch,t);
+      }
+    }
+    for(int ch=0; ch<NChannels; ch++){
+      std::vector<short> const ref = dense.Digitize(ch,flat);
+      std::vector<short> const res = sparse.DigitizeSparse(ch);
+      BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(),res.end(),ref.begin(),ref.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DigitizeSparse_checkQuietChannel)
+{
+  opdet::OpMCDigiAlg alg(SinglePEWaveform(),SaturationScale,12);
+  alg.ResetSparse(2,NSamples);
+  alg.AddPulseTime(0,100);
+  std::vector<short> const wf = alg.DigitizeSparse(1);
+  BOOST_CHECK_EQUAL(wf.size(),size_t(NSamples));
+  for(short s : wf) BOOST_CHECK_EQUAL(s,12);
+
+  //the baseline saturates too
+  opdet::OpMCDigiAlg high(SinglePEWaveform(),SaturationScale,1000);
+  high.ResetSparse(1,NSamples/2);
+  std::vector<short> const wfHigh = high.DigitizeSparse(0);
+  BOOST_CHECK_EQUAL(wfHigh.size(),size_t(NSamples/2));
+  for(short s : wfHigh) BOOST_CHECK_EQUAL(s,short(SaturationScale));
+}
+
+BOOST_AUTO_TEST_CASE(AddDarkNoiseTimes_checkRate)
+{
+  //same mean and variance of the number of pulses as AddDarkNoise, and
+  //times uniform over the window
+  const int NTrials = 20000;
+  const double DarkRate = MeanDarkPulses/NSamples;
+  CLHEP::HepJamesRandom engine(Seed);
+  CLHEP::RandExponential exponential(engine);
+  opdet::OpMCDigiAlg alg(SinglePEWaveform(),SaturationScale);
+
+  double sum = 0, sum2 = 0, sumTime = 0, nEarly = 0;
+  alg.ResetSparse(NTrials,NSamples);
+  for(int i=0; i<NTrials; i++){
+    alg.AddDarkNoiseTimes(i,DarkRate,exponential);
+    std::vector<int> const& times = alg.PulseTimes(i);
+    sum += times.size();
+    sum2 += times.size()*times.size();
+    for(int t : times){
+      BOOST_CHECK(t>=0 && t<NSamples);
+      sumTime += t;
+      if(t<NSamples/4) nEarly++;
+    }
+  }
+  double const mean = sum/NTrials;
+  double const variance = sum2/NTrials - mean*mean;
+  BOOST_CHECK_SMALL(mean-MeanDarkPulses, 5*std::sqrt(MeanDarkPulses/NTrials));
+  BOOST_CHECK_CLOSE(variance, MeanDarkPulses, 5.);
+  BOOST_CHECK_CLOSE(sumTime/sum, NSamples/2., 1.);
+  BOOST_CHECK_CLOSE(nEarly/sum, 0.25, 2.);
+
+  //no rate, no pulses
+  alg.ResetSparse(1,NSamples);
+  alg.AddDarkNoiseTimes(0,0.,exponential);
+  BOOST_CHECK(alg.PulseTimes(0).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+// OptDetDigitizer channel scaling: 32, 128 and 1000 channels with 2000
+// photons each and 1500 samples, digitized by OptDetDigitizerAlg under
+// tbb::parallel_for as the module does, on one thread and on all the
+// hardware threads. The output must not depend on the thread count.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/OptDetDigitizerAlg.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  const int NPhotons = 2000;
+  const long EventSeed = 45;
+  const int NEvents = 5;
+
+  opdet::OptDetDigitizerAlg::Config MakeConfig(unsigned int nChannels)
+  {
+    opdet::OptDetDigitizerAlg::Config config;
+    config.SampleFreq      = 64;     // MHz
+    config.TimeBegin       = 0;      // us
+    config.TimeEnd         = 23.4375; // us: 1500 samples
+    config.QE              = 0.3;
+    config.DarkRate        = 1e5;    // Hz
+    config.PedFlucRate     = 1e5;    // Hz
+    config.PedFlucAmp      = 2;
+    config.SaturationScale = 4095;
+    config.SimGainSpread   = true;
+    for(size_t i=0; i<60; i++)
+      config.SinglePEWaveform.push_back((i/8.)*std::exp(-(i/8.)));
+    for(unsigned int ch=0; ch<nChannels; ch++){
+      config.PedMeanArray.push_back(2048 + ch%5);
+      config.HighGainArray.push_back(20. + ch%7);
+      config.LowGainArray.push_back(2. + 0.1*(ch%7));
+      config.GainSpreadArray.push_back(0.05);
+    }
+    return config;
+  }
+
+  std::vector<sim::SimPhotons> MakePhotons(unsigned int nChannels)
+  {
+    std::vector<sim::SimPhotons> photons;
+    for(unsigned int ch=0; ch<nChannels; ch++){
+      sim::SimPhotons ph(ch);
+      for(int i=0; i<NPhotons; i++){
+        sim::OnePhoton p;
+        p.Time = (i*7919 + ch*104729) % 23000; // ns
+        ph.push_back(p);
+      }
+      photons.push_back(ph);
+    }
+    return photons;
+  }
+
+  struct Output {
+    std::vector<optdata::ChannelData> High, Low;
+  };
+
+  /// Time per event (ms) on nThreads threads
+  double TimeEvents(opdet::OptDetDigitizerAlg const& alg,
+                    std::vector<sim::SimPhotons> const& photons,
+                    int nThreads,
+                    Output& out)
+  {
+    unsigned int const nChannels = photons.size();
+    tbb::task_arena arena(nThreads);
+    auto const start = std::chrono::steady_clock::now();
+    for(int e=0; e<NEvents; e++){
+      out.High.assign(nChannels, optdata::ChannelData());
+      out.Low.assign(nChannels, optdata::ChannelData());
+      arena.execute([&]() {
+          tbb::parallel_for(tbb::blocked_range<unsigned int>(0, nChannels),
+            [&](tbb::blocked_range<unsigned int> const& range) {
+              opdet::OptDetDigitizerAlg::ChannelScratch scratch;
+              for(unsigned int ch = range.begin(); ch != range.end(); ++ch)
+                alg.DigitizeChannel(ch, &photons[ch], EventSeed, scratch, out.High[ch], out.Low[ch]);
+            });
+        });
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count()/NEvents;
+  }
+
+}
+
+int main()
+{
+  int const nThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned int nChannels : {32, 128, 1000}){
+    opdet::OptDetDigitizerAlg alg(MakeConfig(nChannels));
+    auto const photons = MakePhotons(nChannels);
+
+    Output serial, parallel;
+    double const t_serial = TimeEvents(alg, photons, 1, serial);
+    double const t_parallel = TimeEvents(alg, photons, nThreads, parallel);
+
+    bool const same = (serial.High == parallel.High) && (serial.Low == parallel.Low);
+    std::printf("%4u channels x %d photons, %zu samples: 1 thread %7.1f ms/event, %d threads %7.1f ms/event (%s)\n",
+                nChannels, NPhotons, alg.NSamples(), t_serial, nThreads, t_parallel,
+                same ? "same output" : "OUTPUT DIFFERS");
+  }
+  return 0;
+}
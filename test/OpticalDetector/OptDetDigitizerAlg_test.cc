@@ -0,0 +1,159 @@
+#define BOOST_TEST_MODULE ( OptDetDigitizerAlg_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/OptDetDigitizerAlg.h"
+
+#include "cetlib_except/exception.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <cmath>
+
+const unsigned int NChannels = 40;
+const long EventSeed = 12345;
+
+namespace {
+
+  opdet::OptDetDigitizerAlg::Config MakeConfig(bool noise)
+  {
+    opdet::OptDetDigitizerAlg::Config config;
+    config.SampleFreq      = 64;    // MHz
+    config.TimeBegin       = 0;     // us
+    config.TimeEnd         = 16;    // us
+    config.QE              = noise? 0.3 : 1.0;
+    config.DarkRate        = noise? 1e6 : 0; // Hz
+    config.PedFlucRate     = noise? 1e6 : 0; // Hz
+    config.PedFlucAmp      = 2;
+    config.SaturationScale = 4095;
+    config.SimGainSpread   = noise;
+    for(size_t i=0; i<60; i++)
+      config.SinglePEWaveform.push_back((i/8.)*std::exp(-(i/8.)));
+    for(unsigned int ch=0; ch<NChannels; ch++){
+      config.PedMeanArray.push_back(2048 + ch%5);
+      config.HighGainArray.push_back(20. + ch%7);
+      config.LowGainArray.push_back(2. + 0.1*(ch%7));
+      config.GainSpreadArray.push_back(0.05);
+    }
+    return config;
+  }
+
+  // photons of each channel, a few channels have none
+  std::vector<sim::SimPhotons> MakePhotons()
+  {
+    std::vector<sim::SimPhotons> photons;
+    for(unsigned int ch=0; ch<NChannels; ch++){
+      sim::SimPhotons ph(ch);
+      if(ch%9 != 4){
+        for(int i=0; i<(int)(ch*13)%200; i++){
+          sim::OnePhoton p;
+          p.Time = (i*7919 + ch*104729) % 17000 - 500.; // ns, some outside the window
+          ph.push_back(p);
+        }
+      }
+      photons.push_back(ph);
+    }
+    return photons;
+  }
+
+  struct Output {
+    std::vector<optdata::ChannelData> High, Low;
+  };
+
+  Output Digitize(opdet::OptDetDigitizerAlg const& alg,
+                  std::vector<sim::SimPhotons> const& photons,
+                  int nThreads,
+                  size_t grainSize)
+  {
+    Output out;
+    out.High.resize(NChannels);
+    out.Low.resize(NChannels);
+    tbb::task_arena arena(nThreads);
+    arena.execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, NChannels, grainSize),
+          [&](tbb::blocked_range<unsigned int> const& range) {
+            opdet::OptDetDigitizerAlg::ChannelScratch scratch;
+            for(unsigned int ch = range.begin(); ch != range.end(); ++ch){
+              sim::SimPhotons const* ph = photons[ch].empty()? nullptr : &photons[ch];
+              alg.DigitizeChannel(ch, ph, EventSeed, scratch, out.High[ch], out.Low[ch]);
+            }
+          });
+      });
+    return out;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(DigitizeChannel_SameForAnyThreads)
+{
+  opdet::OptDetDigitizerAlg alg(MakeConfig(true));
+  auto const photons = MakePhotons();
+
+  Output const serial = Digitize(alg, photons, 1, NChannels);
+  BOOST_REQUIRE_EQUAL(serial.High[0].size(), alg.NSamples());
+
+  for(int nThreads : {1, 2, 4, 8}){
+    for(size_t grainSize : {1, 3, 16}){
+      Output const out = Digitize(alg, photons, nThreads, grainSize);
+      for(unsigned int ch=0; ch<NChannels; ch++){
+        BOOST_CHECK(out.High[ch] == serial.High[ch]);
+        BOOST_CHECK(out.Low[ch] == serial.Low[ch]);
+      }
+    }
+  }
+
+  // channels in reverse order, sharing one scratch
+  opdet::OptDetDigitizerAlg::ChannelScratch scratch;
+  for(unsigned int ch=NChannels; ch-- > 0; ){
+    optdata::ChannelData high, low;
+    sim::SimPhotons const* ph = photons[ch].empty()? nullptr : &photons[ch];
+    alg.DigitizeChannel(ch, ph, EventSeed, scratch, high, low);
+    BOOST_CHECK(high == serial.High[ch]);
+    BOOST_CHECK(low == serial.Low[ch]);
+  }
+
+  // another event gives other noise
+  optdata::ChannelData high, low;
+  alg.DigitizeChannel(0, &photons[0], EventSeed+1, scratch, high, low);
+  BOOST_CHECK(high != serial.High[0]);
+}
+
+BOOST_AUTO_TEST_CASE(DigitizeChannel_Waveform)
+{
+  // no noise, all photons detected, no gain spread: each sample is the sum
+  // of the SPE waveforms, rounded either way, on top of the pedestal
+  auto const config = MakeConfig(false);
+  opdet::OptDetDigitizerAlg alg(config);
+  auto const photons = MakePhotons();
+  Output const out = Digitize(alg, photons, 4, 1);
+
+  for(unsigned int ch=0; ch<NChannels; ch++){
+    std::vector<double> high(alg.NSamples(), 0.), low(alg.NSamples(), 0.);
+    for(auto const& p : photons[ch]){
+      if(p.Time <= 0 || p.Time >= 16000) continue;
+      size_t const t = p.Time/1e3*config.SampleFreq;
+      for(size_t i=0; i<config.SinglePEWaveform.size() && t+i<high.size(); i++){
+        high[t+i] += config.SinglePEWaveform[i]*config.HighGainArray[ch];
+        low[t+i] += config.SinglePEWaveform[i]*config.LowGainArray[ch];
+      }
+    }
+
+    BOOST_REQUIRE_EQUAL(out.High[ch].size(), alg.NSamples());
+    BOOST_REQUIRE_EQUAL(out.Low[ch].size(), alg.NSamples());
+    for(size_t t=0; t<alg.NSamples(); t++){
+      int const base = config.PedMeanArray[ch];
+      BOOST_CHECK(out.High[ch][t] == base + int(high[t]) || out.High[ch][t] == base + int(high[t]) + 1);
+      BOOST_CHECK(out.Low[ch][t] == base + int(low[t]) || out.Low[ch][t] == base + int(low[t]) + 1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DigitizeChannel_UnknownChannel)
+{
+  opdet::OptDetDigitizerAlg alg(MakeConfig(true));
+  opdet::OptDetDigitizerAlg::ChannelScratch scratch;
+  optdata::ChannelData high, low;
+  BOOST_CHECK_THROW(alg.DigitizeChannel(NChannels, nullptr, EventSeed, scratch, high, low),
+                    cet::exception);
+}
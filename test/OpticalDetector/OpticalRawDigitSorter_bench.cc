@@ -0,0 +1,144 @@
+// Converting 10^4 OpticalRawDigits of 1500 samples, in 12 categories, into
+// OpDetWaveforms: the loop OpticalRawDigitReformatter ran (a copy of each
+// digit, a temporary waveform, growing category vectors) against
+// SortByCategory. Time per event, and the peak resident memory on top of
+// the input, read from /proc/self (Linux; reported as 0 elsewhere). Each
+// method runs in its own child process.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/OpticalRawDigitSorter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+  const size_t NDigits = 10000;
+  const size_t NSamples = 1500;
+  const size_t NCategories = 12;
+  const int NEvents = 20;
+
+  double TimeOf(optdata::TimeSlice_t timeSlice, optdata::Frame_t frame)
+  {
+    return frame*1600. + timeSlice*0.015625;
+  }
+
+  void Reformat(std::vector<optdata::OpticalRawDigit> const& ord_vec,
+		std::vector<std::vector<raw::OpDetWaveform>>& RawOpDetVecs)
+  {
+    RawOpDetVecs.assign(NCategories, std::vector<raw::OpDetWaveform>());
+    for(auto ord : ord_vec){
+      optdata::Channel_t channel = ord.ChannelNumber();
+      optdata::TimeSlice_t timeSlice = ord.TimeSlice();
+      optdata::Frame_t frame = ord.Frame();
+      optdata::Optical_Category_t category = ord.Category();
+      double timeStamp = TimeOf(timeSlice, frame);
+      RawOpDetVecs[category].push_back(raw::OpDetWaveform(timeStamp, channel, ord));
+    }
+  }
+
+  void Sort(std::vector<optdata::OpticalRawDigit> const& ord_vec,
+	    std::vector<std::vector<raw::OpDetWaveform>>& RawOpDetVecs)
+  {
+    RawOpDetVecs.assign(NCategories, std::vector<raw::OpDetWaveform>());
+    opdet::SortByCategory(ord_vec, TimeOf, RawOpDetVecs);
+  }
+
+  /// Value in kB of a field of /proc/self/status, 0 if not available
+  long StatusKB(std::string const& field)
+  {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line))
+      if(line.compare(0, field.size(), field) == 0) return std::stol(line.substr(field.size()+1));
+    return 0;
+  }
+
+  /// Channels, time stamps and samples of the waveforms, in order
+  double Checksum(std::vector<std::vector<raw::OpDetWaveform>> const& waveforms)
+  {
+    double sum = 0;
+    size_t n = 0;
+    for(auto const& wfs : waveforms)
+      for(auto const& wf : wfs){
+	double wfSum = 0;
+	for(auto const adc : wf) wfSum += adc;
+	sum += (++n)*(wf.ChannelNumber() + wf.TimeStamp() + wfSum);
+      }
+    return sum;
+  }
+
+  struct Result {
+    double ms; ///< time per event
+    double checksum;
+    long peakKB; ///< peak resident memory above the memory in use before
+  };
+
+  /// Runs the events in a child process, so that each method starts from
+  /// the same heap and its peak memory is its own. The heap is not trimmed:
+  /// the freed output of an event would often be handed back to the system
+  /// and faulted in again at the next one, and that would be timed instead
+  /// of the conversion.
+  template <typename F>
+  Result RunEvents(F f, std::vector<optdata::OpticalRawDigit> const& digits)
+  {
+    Result result{0, 0, 0};
+    int fd[2];
+    if(pipe(fd) != 0) return result;
+    pid_t const pid = fork();
+    if(pid == 0){
+      close(fd[0]);
+#ifdef __GLIBC__
+      mallopt(M_TRIM_THRESHOLD, 1 << 30);
+#endif
+      std::vector<std::vector<raw::OpDetWaveform>> waveforms;
+      long const before = StatusKB("VmRSS");
+      std::ofstream("/proc/self/clear_refs") << "5"; // resets the peak
+      auto const start = std::chrono::steady_clock::now();
+      for(int e=0; e<NEvents; e++) f(digits, waveforms);
+      auto const stop = std::chrono::steady_clock::now();
+      result.peakKB = StatusKB("VmHWM") - before;
+      result.checksum = Checksum(waveforms);
+      result.ms = std::chrono::duration<double,std::milli>(stop-start).count()/NEvents;
+      ssize_t const written = write(fd[1], &result, sizeof(result));
+      _exit(written == sizeof(result)? 0 : 1);
+    }
+    close(fd[1]);
+    if(pid > 0){
+      if(read(fd[0], &result, sizeof(result)) != sizeof(result)) result = Result{0, 0, 0};
+      waitpid(pid, nullptr, 0);
+    }
+    close(fd[0]);
+    return result;
+  }
+
+}
+
+int main()
+{
+  std::vector<optdata::OpticalRawDigit> digits;
+  for(size_t i=0; i<NDigits; i++){
+    auto const category = optdata::Optical_Category_t((i*7 + i/12) % NCategories);
+    optdata::OpticalRawDigit ord(category, (i*131)%102400, i/40, i%32, NSamples);
+    for(size_t s=0; s<ord.size(); s++)
+      ord[s] = optdata::ADC_Count_t(2048 + (i*s)%300);
+    digits.push_back(ord);
+  }
+
+  Result const old_result = RunEvents(Reformat, digits);
+  Result const result = RunEvents(Sort, digits);
+
+  std::printf("%zu digits x %zu samples: copying loop %6.2f ms/event (peak +%ld MB), counting sort %6.2f ms/event (peak +%ld MB) (%s)\n",
+	      NDigits, NSamples, old_result.ms, old_result.peakKB/1024, result.ms, result.peakKB/1024,
+	      (old_result.checksum == result.checksum)? "same waveforms" : "WAVEFORMS DIFFER");
+  return 0;
+}
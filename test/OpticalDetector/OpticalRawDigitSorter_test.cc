@@ -0,0 +1,82 @@
+#define BOOST_TEST_MODULE ( OpticalRawDigitSorter_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/OpticalRawDigitSorter.h"
+
+const size_t NCategories = 12;
+
+namespace {
+
+  double TimeOf(optdata::TimeSlice_t timeSlice, optdata::Frame_t frame)
+  {
+    return frame*1600. + timeSlice*0.015625;
+  }
+
+  // digits of all the categories, mixed, with different lengths
+  std::vector<optdata::OpticalRawDigit> MakeDigits(size_t n)
+  {
+    std::vector<optdata::OpticalRawDigit> digits;
+    for(size_t i=0; i<n; i++){
+      auto const category = optdata::Optical_Category_t((i*7 + i/12) % NCategories);
+      optdata::OpticalRawDigit ord(category, (i*131)%102400, i/40, i%32, (i*37)%200);
+      for(size_t s=0; s<ord.size(); s++)
+        ord[s] = optdata::ADC_Count_t(2048 + (i*s)%300);
+      digits.push_back(ord);
+    }
+    return digits;
+  }
+
+  // the conversion previously done in OpticalRawDigitReformatter
+  std::vector<std::vector<raw::OpDetWaveform>>
+  Reference(std::vector<optdata::OpticalRawDigit> const& digits)
+  {
+    std::vector<std::vector<raw::OpDetWaveform>> waveforms(NCategories);
+    for(auto ord : digits){
+      double timeStamp = TimeOf(ord.TimeSlice(), ord.Frame());
+      waveforms[ord.Category()].push_back(raw::OpDetWaveform(timeStamp, ord.ChannelNumber(), ord));
+    }
+    return waveforms;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(SortByCategory_SameAsReference)
+{
+  auto const digits = MakeDigits(1000);
+  auto const expected = Reference(digits);
+
+  // left over content is replaced
+  std::vector<std::vector<raw::OpDetWaveform>> waveforms(NCategories);
+  waveforms[3].emplace_back(1., 2, std::vector<optdata::ADC_Count_t>(5, 1));
+
+  opdet::SortByCategory(digits, TimeOf, waveforms);
+
+  BOOST_REQUIRE_EQUAL(waveforms.size(), NCategories);
+  for(size_t c=0; c<NCategories; c++){
+    BOOST_CHECK(!waveforms[c].empty());
+    BOOST_CHECK_EQUAL(waveforms[c].capacity(), waveforms[c].size());
+    BOOST_REQUIRE_EQUAL(waveforms[c].size(), expected[c].size());
+    for(size_t i=0; i<waveforms[c].size(); i++){
+      BOOST_CHECK_EQUAL(waveforms[c][i].ChannelNumber(), expected[c][i].ChannelNumber());
+      BOOST_CHECK_EQUAL(waveforms[c][i].TimeStamp(), expected[c][i].TimeStamp());
+      BOOST_CHECK(waveforms[c][i] == expected[c][i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SortByCategory_Empty)
+{
+  std::vector<std::vector<raw::OpDetWaveform>> waveforms(NCategories);
+  opdet::SortByCategory(std::vector<optdata::OpticalRawDigit>(), TimeOf, waveforms);
+  for(auto const& wfs : waveforms) BOOST_CHECK(wfs.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SortByCategory_CategoryOutOfRange)
+{
+  std::vector<optdata::OpticalRawDigit> digits;
+  digits.emplace_back(optdata::kHighGain, 0, 0, 1, 10);
+  digits.emplace_back(optdata::kHEADER, 0, 0, 2, 10);
+
+  std::vector<std::vector<raw::OpDetWaveform>> waveforms(NCategories);
+  BOOST_CHECK_THROW(opdet::SortByCategory(digits, TimeOf, waveforms), cet::exception);
+}
@@ -0,0 +1,102 @@
+// Pedestal storage: pulse finding with a constant pedestal stored as one
+// value (PedAlgoEdges now) against the same pedestal expanded to one value
+// per sample (as all pedestal algorithms stored it before), and the memory
+// each form takes per waveform.
+// Built with the tests, not run by them.
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoSlidingWindow.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoThreshold.h"
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoEdges.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+  pmtana::Waveform_t MakeWaveform(size_t n, size_t seed)
+  {
+    pmtana::Waveform_t wf(n);
+    for(size_t i=0; i<n; ++i)
+      wf[i] = 2000 + (short)(((i+seed)*7)%5) - 2;
+    for(size_t t0 = 100 + seed%50; t0+60 < n; t0 += 400)
+      for(size_t i=t0; i<t0+60; ++i)
+	wf[i] += (short)(80.*std::exp(-(double)(i-t0)/8.));
+    return wf;
+  }
+
+  /// ns per waveform of pedestal evaluation and pulse finding
+  double Run(std::vector<pmtana::Waveform_t> const& wfs,
+	     pmtana::PMTPedestalBase& ped_algo,
+	     pmtana::PMTPulseRecoBase& algo,
+	     bool expand, size_t& npulses)
+  {
+    pmtana::PedestalMean_t mean_v;
+    pmtana::PedestalSigma_t sigma_v;
+    auto const start = std::chrono::steady_clock::now();
+    for(auto const& wf : wfs){
+      ped_algo.Evaluate(wf);
+      if(expand){
+	mean_v.assign(wf.size(),ped_algo.CompactMean().front());
+	sigma_v.assign(wf.size(),ped_algo.CompactSigma().front());
+	algo.Reconstruct(wf,mean_v,sigma_v);
+      }
+      else
+	algo.Reconstruct(wf,ped_algo.CompactMean(),ped_algo.CompactSigma());
+      npulses += algo.GetPulses().size();
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::nano>(stop-start).count()/wfs.size();
+  }
+
+}
+
+int main()
+{
+  const size_t NWaveforms = 5000;
+
+  fhicl::ParameterSet ped_pset;
+  ped_pset.put("NumSampleFront",size_t(50));
+  ped_pset.put("NumSampleTail",size_t(50));
+  ped_pset.put("Method",0);
+  pmtana::PedAlgoEdges ped_algo(ped_pset);
+
+  fhicl::ParameterSet sliding_pset;
+  sliding_pset.put("ADCThreshold",5.);
+  sliding_pset.put("EndADCThreshold",2.);
+  sliding_pset.put("NSigmaThreshold",3.);
+  sliding_pset.put("EndNSigmaThreshold",1.);
+  sliding_pset.put("Verbosity",false);
+  sliding_pset.put("NumPreSample",3);
+  sliding_pset.put("NumPostSample",2);
+  pmtana::AlgoSlidingWindow sliding(sliding_pset);
+
+  fhicl::ParameterSet threshold_pset;
+  threshold_pset.put("StartADCThreshold",5.);
+  threshold_pset.put("EndADCThreshold",2.);
+  threshold_pset.put("NSigmaThresholdStart",3.);
+  threshold_pset.put("NSigmaThresholdEnd",1.);
+  pmtana::AlgoThreshold threshold(threshold_pset);
+
+  for(size_t nsamples : {1500, 20000}){
+    std::vector<pmtana::Waveform_t> wfs;
+    for(size_t i=0; i<NWaveforms*1500/nsamples; ++i) wfs.push_back(MakeWaveform(nsamples,i));
+
+    std::printf("%zu samples: pedestal storage %zu B expanded, %zu B constant\n",
+		nsamples,2*nsamples*sizeof(double),2*sizeof(double));
+
+    struct { const char* name; pmtana::PMTPulseRecoBase* algo; } const algos[] =
+      { {"AlgoSlidingWindow",&sliding}, {"AlgoThreshold",&threshold} };
+    for(auto const& a : algos){
+      size_t n_expanded = 0, n_constant = 0;
+      double const t_expanded = Run(wfs,ped_algo,*a.algo,true,n_expanded);
+      double const t_constant = Run(wfs,ped_algo,*a.algo,false,n_constant);
+      std::printf("  %-17s expanded %8.0f ns/waveform, constant %8.0f ns/waveform (%s)\n",
+		  a.name,t_expanded,t_constant,
+		  (n_expanded==n_constant)? "same pulses" : "PULSES DIFFER");
+    }
+  }
+  return 0;
+}
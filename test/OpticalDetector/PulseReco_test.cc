@@ -0,0 +1,219 @@
+#define BOOST_TEST_MODULE ( PulseReco_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoCFD.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoSlidingWindow.h"
+#include "larana/OpticalDetector/OpHitFinder/AlgoThreshold.h"
+#include "larana/OpticalDetector/OpHitFinder/PedAlgoEdges.h"
+
+#include <cmath>
+#include <memory>
+
+namespace {
+
+  /// Pulse algorithm relying on the base class to expand constant pedestals
+  class PedestalSizeRecorder : public pmtana::PMTPulseRecoBase {
+  public:
+    size_t mean_size = 0;
+    size_t sigma_size = 0;
+    double mean_back = 0;
+  protected:
+    bool RecoPulse(const pmtana::Waveform_t&,
+		   const pmtana::PedestalMean_t& mean_v,
+		   const pmtana::PedestalSigma_t& sigma_v)
+    {
+      mean_size  = mean_v.size();
+      sigma_size = sigma_v.size();
+      mean_back  = mean_v.back();
+      return true;
+    }
+  };
+
+}
+
+struct PulseRecoFixture{
+
+  PulseRecoFixture()
+  {
+    // flat baseline with a small deterministic ripple and three pulses,
+    // the first two piled up
+    wf.resize(2000);
+    for(size_t i=0; i<wf.size(); ++i)
+      wf[i] = 2000 + (short)((i*7)%5) - 2;
+    for(size_t t0 : {300, 318, 1200}) {
+      for(size_t i=t0; i<t0+60 && i<wf.size(); ++i)
+	wf[i] += (short)(80.*std::exp(-(double)(i-t0)/8.));
+    }
+
+    fhicl::ParameterSet ped_pset;
+    ped_pset.put("NumSampleFront",size_t(50));
+    ped_pset.put("NumSampleTail",size_t(50));
+    ped_pset.put("Method",0);
+    ped_algo = std::make_unique<pmtana::PedAlgoEdges>(ped_pset);
+
+    sliding_pset.put("ADCThreshold",5.);
+    sliding_pset.put("EndADCThreshold",2.);
+    sliding_pset.put("NSigmaThreshold",3.);
+    sliding_pset.put("EndNSigmaThreshold",1.);
+    sliding_pset.put("Verbosity",false);
+    sliding_pset.put("NumPreSample",3);
+    sliding_pset.put("NumPostSample",2);
+
+    threshold_pset.put("StartADCThreshold",5.);
+    threshold_pset.put("EndADCThreshold",2.);
+    threshold_pset.put("NSigmaThresholdStart",3.);
+    threshold_pset.put("NSigmaThresholdEnd",1.);
+
+    cfd_pset.put("Fraction",0.9);
+    cfd_pset.put("Delay",2);
+    cfd_pset.put("PeakThresh",7.5);
+    cfd_pset.put("StartThresh",5.);
+    cfd_pset.put("EndThresh",1.5);
+  }
+
+  /// Runs the algorithm once with compact and once with per-sample pedestal arrays
+  void CheckCompactMatchesExpanded(pmtana::PMTPulseRecoBase& algo)
+  {
+    BOOST_REQUIRE(ped_algo->Evaluate(wf));
+    BOOST_REQUIRE(ped_algo->IsConstant());
+
+    auto const& mean_v  = ped_algo->CompactMean();
+    auto const& sigma_v = ped_algo->CompactSigma();
+    BOOST_REQUIRE_EQUAL(mean_v.size(),1ul);
+
+    BOOST_REQUIRE(algo.Reconstruct(wf,mean_v,sigma_v));
+    auto const compact = algo.GetPulses();
+
+    pmtana::PedestalMean_t  full_mean_v (wf.size(),mean_v.front());
+    pmtana::PedestalSigma_t full_sigma_v(wf.size(),sigma_v.front());
+    BOOST_REQUIRE(algo.Reconstruct(wf,full_mean_v,full_sigma_v));
+    auto const& expanded = algo.GetPulses();
+
+    BOOST_CHECK(!compact.empty());
+    BOOST_REQUIRE_EQUAL(compact.size(),expanded.size());
+    for(size_t i=0; i<compact.size(); ++i) {
+      BOOST_CHECK_EQUAL(compact[i].t_start,expanded[i].t_start);
+      BOOST_CHECK_EQUAL(compact[i].t_max,  expanded[i].t_max);
+      BOOST_CHECK_EQUAL(compact[i].t_end,  expanded[i].t_end);
+      BOOST_CHECK_CLOSE(compact[i].area,    expanded[i].area,    tolerance);
+      BOOST_CHECK_CLOSE(compact[i].peak,    expanded[i].peak,    tolerance);
+      BOOST_CHECK_CLOSE(compact[i].ped_mean,expanded[i].ped_mean,tolerance);
+    }
+  }
+
+  pmtana::Waveform_t wf;
+  std::unique_ptr<pmtana::PedAlgoEdges> ped_algo;
+  fhicl::ParameterSet sliding_pset, threshold_pset, cfd_pset;
+
+  static constexpr double tolerance = 1e-4; // percent
+};
+
+BOOST_FIXTURE_TEST_SUITE(PulseReco_test, PulseRecoFixture)
+
+BOOST_AUTO_TEST_CASE(checkConstantPedestal)
+{
+  BOOST_REQUIRE(ped_algo->Evaluate(wf));
+  BOOST_CHECK(ped_algo->IsConstant());
+  BOOST_CHECK_EQUAL(ped_algo->CompactMean().size(),1ul);
+  BOOST_CHECK_EQUAL(ped_algo->CompactSigma().size(),1ul);
+
+  // per-sample access keeps working on the compact representation
+  BOOST_CHECK_EQUAL(ped_algo->Mean(0),ped_algo->Mean(wf.size()-1));
+  BOOST_CHECK_EQUAL(ped_algo->Sigma(0),ped_algo->Sigma(wf.size()-1));
+  BOOST_CHECK_CLOSE(ped_algo->Mean(0),2000.,0.01);
+}
+
+BOOST_AUTO_TEST_CASE(checkFullLengthArrays)
+{
+  // the array getters keep one value per sample for a constant pedestal
+  BOOST_REQUIRE(ped_algo->Evaluate(wf));
+  BOOST_REQUIRE(ped_algo->IsConstant());
+  BOOST_REQUIRE_EQUAL(ped_algo->Mean().size(),wf.size());
+  BOOST_REQUIRE_EQUAL(ped_algo->Sigma().size(),wf.size());
+  for(size_t i=0; i<wf.size(); ++i) {
+    BOOST_CHECK_EQUAL(ped_algo->Mean()[i],ped_algo->CompactMean().front());
+    BOOST_CHECK_EQUAL(ped_algo->Sigma()[i],ped_algo->CompactSigma().front());
+  }
+
+  // and follow the next waveform evaluated
+  pmtana::Waveform_t const short_wf(500,1500);
+  BOOST_REQUIRE(ped_algo->Evaluate(short_wf));
+  BOOST_CHECK_EQUAL(ped_algo->Mean().size(),short_wf.size());
+  BOOST_CHECK_EQUAL(ped_algo->Sigma().size(),short_wf.size());
+  BOOST_CHECK_EQUAL(ped_algo->Mean().back(),1500.);
+  BOOST_CHECK_EQUAL(ped_algo->Sigma().back(),0.);
+}
+
+BOOST_AUTO_TEST_CASE(checkBaseExpandsConstantPedestal)
+{
+  BOOST_REQUIRE(ped_algo->Evaluate(wf));
+
+  PedestalSizeRecorder algo;
+  BOOST_REQUIRE(algo.Reconstruct(wf,ped_algo->CompactMean(),ped_algo->CompactSigma()));
+  BOOST_CHECK_EQUAL(algo.mean_size,wf.size());
+  BOOST_CHECK_EQUAL(algo.sigma_size,wf.size());
+  BOOST_CHECK_EQUAL(algo.mean_back,ped_algo->Mean(0));
+}
+
+BOOST_AUTO_TEST_CASE(checkSlidingWindow)
+{
+  pmtana::AlgoSlidingWindow algo(sliding_pset);
+  CheckCompactMatchesExpanded(algo);
+}
+
+BOOST_AUTO_TEST_CASE(checkThreshold)
+{
+  pmtana::AlgoThreshold algo(threshold_pset);
+  CheckCompactMatchesExpanded(algo);
+}
+
+BOOST_AUTO_TEST_CASE(checkCFD)
+{
+  pmtana::AlgoCFD algo(cfd_pset);
+  CheckCompactMatchesExpanded(algo);
+}
+
+BOOST_AUTO_TEST_CASE(checkCFDPileUp)
+{
+  // three piled-up pulses with several CFD crossings, then two close but
+  // separated pulses
+  pmtana::Waveform_t cfd_wf(400,2000);
+  for(size_t t0 : {100, 104, 112}) {
+    for(size_t i=t0; i<t0+40; ++i)
+      cfd_wf[i] += (short)(60.*std::exp(-(double)(i-t0)/5.));
+  }
+  for(size_t t0 : {300, 310}) {
+    for(size_t i=t0; i<t0+20; ++i)
+      cfd_wf[i] += (short)(40.*std::exp(-(double)(i-t0)/2.));
+  }
+
+  pmtana::AlgoCFD algo(cfd_pset);
+  pmtana::PedestalMean_t  mean_v (1,2000.);
+  pmtana::PedestalSigma_t sigma_v(1,1.);
+
+  // same content and order on repeated calls
+  for(int trial=0; trial<2; ++trial) {
+    BOOST_REQUIRE(algo.Reconstruct(cfd_wf,mean_v,sigma_v));
+
+    auto const& pulses = algo.GetPulses();
+    BOOST_REQUIRE_EQUAL(pulses.size(),3ul);
+
+    double const t_start[] = {  99, 299, 309 };
+    double const t_max[]   = { 104, 300, 310 };
+    double const t_end[]   = { 130, 306, 316 };
+    double const area[]    = { 949,  95,  95 };
+    double const peak[]    = {  86,  40,  40 };
+    for(size_t i=0; i<pulses.size(); ++i) {
+      BOOST_CHECK_EQUAL(pulses[i].t_start,t_start[i]);
+      BOOST_CHECK_EQUAL(pulses[i].t_max,  t_max[i]);
+      BOOST_CHECK_EQUAL(pulses[i].t_end,  t_end[i]);
+      BOOST_CHECK_CLOSE(pulses[i].area,   area[i],tolerance);
+      BOOST_CHECK_CLOSE(pulses[i].peak,   peak[i],tolerance);
+      BOOST_CHECK_GT(pulses[i].t_cfdcross,t_start[i]);
+      BOOST_CHECK_LT(pulses[i].t_cfdcross,t_end[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
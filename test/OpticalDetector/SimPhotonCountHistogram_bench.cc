@@ -0,0 +1,53 @@
+// Counting mode of SimPhotonCounter: 10^7 photons of one event over 100
+// channels, classified by wavelength and added to a SimPhotonCountHistogram.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/SimPhotonCountHistogram.h"
+#include "lardataobj/Simulation/SimPhotons.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using opdet::SimPhotonCountHistogram;
+
+int main()
+{
+  const unsigned int NChannels = 100;
+  const size_t NPhotons = 10000000;
+
+  std::vector<sim::SimPhotons> photons;
+  for(unsigned int ch=0; ch<NChannels; ch++){
+    sim::SimPhotons ph(ch);
+    for(size_t i=0; i<NPhotons/NChannels; i++){
+      sim::OnePhoton phot;
+      phot.Energy = (i%3 == 0)? 2.9e-6 : 9.7e-6;
+      phot.Time = (i*7919 + ch*13) % 5000;
+      ph.push_back(phot);
+    }
+    photons.push_back(ph);
+  }
+
+  SimPhotonCountHistogram counts(NChannels, 0., 10., 500);
+  std::vector<float> wavelengths;
+  std::vector<SimPhotonCountHistogram::WavelengthClass_t> classes;
+
+  auto const start = std::chrono::steady_clock::now();
+  counts.Clear();
+  for(auto const& ph : photons){
+    wavelengths.resize(ph.size());
+    for(size_t i=0; i<ph.size(); i++)
+      wavelengths[i] = (2.0*3.142)*0.000197/ph[i].Energy; // OpDetResponseInterface::wavelength()
+    SimPhotonCountHistogram::ClassifyWavelengths(wavelengths, classes);
+    for(size_t i=0; i<ph.size(); i++)
+      counts.Add(ph.OpChannel(), ph[i].Time, classes[i], 1, i%4 != 0);
+  }
+  auto const stop = std::chrono::steady_clock::now();
+
+  size_t total = 0;
+  for(auto n : counts.AllCounts()) total += n;
+  std::printf("%zu photons over %u channels: %.0f ms (%zu counted)\n",
+              NPhotons, NChannels,
+              std::chrono::duration<double,std::milli>(stop-start).count(), total);
+  return 0;
+}
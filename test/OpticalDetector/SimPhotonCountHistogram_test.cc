@@ -0,0 +1,198 @@
+#define BOOST_TEST_MODULE ( SimPhotonCountHistogram_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/SimPhotonCountHistogram.h"
+#include "larana/OpticalDetector/TrackOpChannelSignals.h"
+#include "lardataobj/Simulation/SimPhotons.h"
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+using opdet::SimPhotonCountHistogram;
+
+const unsigned int NChannels = 8;
+const float MinTime = -50.;     // ns
+const float TimeBinWidth = 10.; // ns
+const unsigned int NTimeBins = 40;
+
+namespace {
+
+  // 9.7 eV (128 nm) scintillation light, and 2.9 eV (430 nm) shifted light
+  const float VUVEnergy = 9.7e-6;   // GeV
+  const float VisibleEnergy = 2.9e-6; // GeV
+
+  std::vector<sim::SimPhotons> MakePhotons()
+  {
+    std::vector<sim::SimPhotons> photons;
+    for(unsigned int ch=0; ch<NChannels; ch++){
+      sim::SimPhotons ph(ch);
+      for(int i=0; i<(int)(37*ch+5); i++){
+        sim::OnePhoton phot;
+        phot.Energy = (i%3 == 0)? VisibleEnergy : VUVEnergy;
+        phot.Time = -80. + (i*i*7 + ch*13) % 600; // including out of range times
+        ph.push_back(phot);
+      }
+      photons.push_back(ph);
+    }
+    return photons;
+  }
+
+  // as OpDetResponseInterface::wavelength() [nm]
+  float Wavelength(double energy) { return (2.0*3.142)*0.000197/energy; }
+
+  std::vector<float> Wavelengths(sim::SimPhotons const& ph)
+  {
+    std::vector<float> wavelengths;
+    for(auto const& phot : ph) wavelengths.push_back(Wavelength(phot.Energy));
+    return wavelengths;
+  }
+
+  // photons "detected" in a deterministic pattern
+  bool Detected(unsigned int ch, size_t i) { return (i + ch) % 4 != 0; }
+
+}
+
+BOOST_AUTO_TEST_CASE(ClassifyWavelengths_checkClasses)
+{
+  sim::SimPhotons ph(0);
+  for(float e : {VUVEnergy, VisibleEnergy, 6.2e-6f, 6.1e-6f}){ // 199.7 and 202.9 nm
+    sim::OnePhoton phot;
+    phot.Energy = e;
+    ph.push_back(phot);
+  }
+
+  std::vector<float> const wavelengths = Wavelengths(ph);
+  std::vector<SimPhotonCountHistogram::WavelengthClass_t> classes;
+  SimPhotonCountHistogram::ClassifyWavelengths(wavelengths, classes);
+
+  BOOST_REQUIRE_EQUAL(classes.size(), ph.size());
+  for(size_t i=0; i<ph.size(); i++)
+    BOOST_CHECK_EQUAL(classes[i], (wavelengths[i] < 200.)? SimPhotonCountHistogram::kVUV : SimPhotonCountHistogram::kVisible);
+  BOOST_CHECK_EQUAL(classes[0], SimPhotonCountHistogram::kVUV);
+  BOOST_CHECK_EQUAL(classes[1], SimPhotonCountHistogram::kVisible);
+  BOOST_CHECK_EQUAL(classes[2], SimPhotonCountHistogram::kVUV);
+  BOOST_CHECK_EQUAL(classes[3], SimPhotonCountHistogram::kVisible);
+}
+
+BOOST_AUTO_TEST_CASE(TimeBin_checkRange)
+{
+  SimPhotonCountHistogram counts(NChannels, MinTime, TimeBinWidth, NTimeBins);
+  BOOST_CHECK_EQUAL(counts.TimeBin(-1000.), NTimeBins);
+  BOOST_CHECK_EQUAL(counts.TimeBin(-50.1), NTimeBins);
+  BOOST_CHECK_EQUAL(counts.TimeBin(-50.), 0U);
+  BOOST_CHECK_EQUAL(counts.TimeBin(-40.), 1U);
+  BOOST_CHECK_EQUAL(counts.TimeBin(349.9), NTimeBins-1);
+  BOOST_CHECK_EQUAL(counts.TimeBin(350.), NTimeBins);
+  BOOST_CHECK_EQUAL(counts.TimeBin(1e9), NTimeBins);
+  BOOST_CHECK_EQUAL(counts.TimeBin(std::nanf("")), NTimeBins);
+
+  // photons outside the bins are dropped, not piled up in the edge bins
+  counts.Add(1, -1000., SimPhotonCountHistogram::kVUV, 5, 5);
+  counts.Add(1, 1e9, SimPhotonCountHistogram::kVUV, 5, 5);
+  counts.Add(1, std::nanf(""), SimPhotonCountHistogram::kVUV, 5, 5);
+  for(unsigned int n : counts.AllCounts()) BOOST_CHECK_EQUAL(n, 0U);
+  for(unsigned int n : counts.DetectedCounts()) BOOST_CHECK_EQUAL(n, 0U);
+
+  BOOST_CHECK_THROW(counts.Add(NChannels, 0., SimPhotonCountHistogram::kVUV, 1, 1), std::runtime_error);
+  BOOST_CHECK_THROW(SimPhotonCountHistogram(NChannels, 0., 0., 10), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(Add_checkCounts)
+{
+  auto const photons = MakePhotons();
+
+  // the expected counts, one photon at a time
+  std::map<std::tuple<unsigned int, unsigned int, int>, std::pair<unsigned int, unsigned int> > expected;
+  for(auto const& ph : photons){
+    for(size_t i=0; i<ph.size(); i++){
+      float const wl = Wavelength(ph[i].Energy);
+      int const wlClass = (wl < 200.)? 0 : 1;
+      int const bin = (int)std::floor((ph[i].Time - MinTime) / TimeBinWidth);
+      if(bin < 0 || bin >= (int)NTimeBins) continue;
+      auto& count = expected[std::make_tuple((unsigned int)ph.OpChannel(), (unsigned int)bin, wlClass)];
+      count.first++;
+      if(Detected(ph.OpChannel(), i)) count.second++;
+    }
+  }
+
+  SimPhotonCountHistogram counts(NChannels, MinTime, TimeBinWidth, NTimeBins);
+  std::vector<SimPhotonCountHistogram::WavelengthClass_t> classes;
+  for(int pass=0; pass<2; pass++){ // the second time, after a Clear()
+    counts.Clear();
+    for(auto const& ph : photons){
+      SimPhotonCountHistogram::ClassifyWavelengths(Wavelengths(ph), classes);
+      for(size_t i=0; i<ph.size(); i++)
+        counts.Add(ph.OpChannel(), ph[i].Time, classes[i], 1, Detected(ph.OpChannel(), i));
+    }
+
+    unsigned int total = 0;
+    for(unsigned int ch=0; ch<NChannels; ch++){
+      for(unsigned int bin=0; bin<NTimeBins; bin++){
+        for(int wlClass=0; wlClass<2; wlClass++){
+          auto const cl = (SimPhotonCountHistogram::WavelengthClass_t)wlClass;
+          auto const it = expected.find(std::make_tuple(ch, bin, wlClass));
+          unsigned int const nAll = (it == expected.end())? 0 : it->second.first;
+          unsigned int const nDet = (it == expected.end())? 0 : it->second.second;
+          BOOST_CHECK_EQUAL(counts.All(ch, bin, cl), nAll);
+          BOOST_CHECK_EQUAL(counts.Detected(ch, bin, cl), nDet);
+          BOOST_CHECK_EQUAL(counts.AllCounts()[(ch*NTimeBins + bin)*2 + wlClass], nAll);
+          total += counts.All(ch, bin, cl);
+        }
+      }
+    }
+    unsigned int nPhotons = 0, nInRange = 0;
+    for(auto const& ph : photons) nPhotons += ph.size();
+    for(auto const& count : expected) nInRange += count.second.first;
+    BOOST_CHECK_EQUAL(total, nInRange);
+    BOOST_CHECK(nInRange < nPhotons); // some are out of range
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Add_checkLitePhotons)
+{
+  // SimPhotonsLite: many photons at the same time, added in one go
+  sim::SimPhotonsLite lite(3);
+  lite.DetectedPhotons[12] = 5;
+  lite.DetectedPhotons[17] = 2;
+  lite.DetectedPhotons[200] = 4;
+
+  SimPhotonCountHistogram counts(NChannels, MinTime, TimeBinWidth, NTimeBins);
+  for(auto const& entry : lite.DetectedPhotons)
+    counts.Add(lite.OpChannel, entry.first, SimPhotonCountHistogram::kVisible, entry.second, entry.second/2);
+
+  BOOST_CHECK_EQUAL(counts.All(3, counts.TimeBin(12.), SimPhotonCountHistogram::kVisible), 7U);
+  BOOST_CHECK_EQUAL(counts.Detected(3, counts.TimeBin(12.), SimPhotonCountHistogram::kVisible), 3U);
+  BOOST_CHECK_EQUAL(counts.All(3, counts.TimeBin(200.), SimPhotonCountHistogram::kVisible), 4U);
+  BOOST_CHECK_EQUAL(counts.All(3, counts.TimeBin(200.), SimPhotonCountHistogram::kVUV), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(TrackOpChannelSignals_checkFill)
+{
+  opdet::TrackOpChannelSignals signals;
+  signals.Add(7, 2, 10.);
+  signals.Add(1000000, 0, 5.); // track IDs are not limited
+  signals.Add(7, 0, 3.);
+  signals.Add(7, 2, 1.);
+
+  std::vector<std::vector<double> > trackSignals;
+  signals.Fill(7, 4, trackSignals);
+  BOOST_REQUIRE_EQUAL(trackSignals.size(), 4U);
+  BOOST_CHECK(trackSignals[0] == std::vector<double>({3.}));
+  BOOST_CHECK(trackSignals[1].empty());
+  BOOST_CHECK(trackSignals[2] == std::vector<double>({10., 1.}));
+
+  signals.Fill(1000000, 4, trackSignals);
+  BOOST_CHECK(trackSignals[0] == std::vector<double>({5.}));
+  BOOST_CHECK(trackSignals[2].empty());
+
+  signals.Fill(8, 4, trackSignals);
+  BOOST_CHECK_EQUAL(trackSignals.size(), 4U);
+  for(auto const& s : trackSignals) BOOST_CHECK(s.empty());
+
+  signals.Clear();
+  BOOST_CHECK(signals.empty());
+  signals.Fill(7, 4, trackSignals);
+  BOOST_CHECK(trackSignals[2].empty());
+}
@@ -0,0 +1,75 @@
+// SimPhotonCounterAlg against its counters filled one at a time, photon by
+// photon (as the algorithm did before), for 1 to 32 ranges.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/SimPhotonCounterAlg.h"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+int main()
+{
+  const size_t NOpDets = 32;
+  const size_t NPhotons = 30000; // per OpDet
+
+  std::vector<float> const qe(NOpDets,0.02);
+
+  std::vector<sim::SimPhotons> photons;
+  for(size_t ch=0; ch<NOpDets; ch++){
+    sim::SimPhotons ph(ch);
+    for(size_t i=0; i<NPhotons; i++){
+      sim::OnePhoton phot;
+      phot.Time = -100. + (i*7919 + ch*13) % 8000;
+      phot.Energy = 0.00124/(100. + (i*31 + ch) % 400);
+      ph.push_back(phot);
+    }
+    photons.push_back(ph);
+  }
+
+  for(size_t nRanges : {1, 4, 16, 32}){
+    std::vector<fhicl::ParameterSet> psets;
+    std::vector<opdet::SimPhotonCounter> counters;
+    for(size_t r=0; r<nRanges; r++){
+      float const t_p2 = 50. + 20.*r, t_l2 = 1000. + 200.*r;
+      float const min_w = 100. + 5.*r, max_w = 200. + 10.*r;
+      fhicl::ParameterSet p;
+      p.put("MinPromptTime",-10.f);
+      p.put("MaxPromptTime",t_p2);
+      p.put("MinLateTime",t_p2);
+      p.put("MaxLateTime",t_l2);
+      p.put("MinWavelength",min_w);
+      p.put("MaxWavelength",max_w);
+      psets.push_back(p);
+      counters.emplace_back(-10.f,t_p2,t_p2,t_l2,min_w,max_w,qe);
+    }
+    fhicl::ParameterSet pset;
+    pset.put("SimPhotonCounterParams",psets);
+    opdet::SimPhotonCounterAlg alg(pset);
+    alg.InitializeCounters(qe);
+
+    auto start = std::chrono::steady_clock::now();
+    for(auto& counter : counters)
+      for(auto const& ph : photons)
+        counter.AddSimPhotons(ph);
+    auto stop = std::chrono::steady_clock::now();
+    double const t_counters = std::chrono::duration<double,std::milli>(stop-start).count();
+
+    start = std::chrono::steady_clock::now();
+    alg.AddSimPhotonsVector(photons);
+    float total = 0;
+    for(size_t r=0; r<nRanges; r++) total += alg.GetSimPhotonCounter(r).PhotonTotal();
+    stop = std::chrono::steady_clock::now();
+    double const t_alg = std::chrono::duration<double,std::milli>(stop-start).count();
+
+    bool same = true;
+    for(size_t r=0; r<nRanges; r++)
+      same = same && (alg.PromptPhotonVector(r) == counters[r].PromptPhotonVector())
+        && (alg.LatePhotonVector(r) == counters[r].LatePhotonVector());
+    std::printf("%2zu ranges, %zu OpDets x %zu photons: per counter %6.1f ms, SimPhotonCounterAlg %6.1f ms (%s, total %g)\n",
+                nRanges,NOpDets,NPhotons,t_counters,t_alg,same? "same counts" : "COUNTS DIFFER",total);
+  }
+  return 0;
+}
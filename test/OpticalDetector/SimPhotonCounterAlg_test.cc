@@ -0,0 +1,195 @@
+#define BOOST_TEST_MODULE ( SimPhotonCounterAlg_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/SimPhotonCounterAlg.h"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <cmath>
+#include <limits>
+
+const size_t NOpDets = 12;
+
+namespace {
+
+  struct Range {
+    float t_p1, t_p2, t_l1, t_l2, min_w, max_w;
+  };
+
+  fhicl::ParameterSet MakeParameterSet(std::vector<Range> const& ranges)
+  {
+    std::vector<fhicl::ParameterSet> psets;
+    for(auto const& r : ranges){
+      fhicl::ParameterSet p;
+      p.put("MinPromptTime",r.t_p1);
+      p.put("MaxPromptTime",r.t_p2);
+      p.put("MinLateTime",r.t_l1);
+      p.put("MaxLateTime",r.t_l2);
+      p.put("MinWavelength",r.min_w);
+      p.put("MaxWavelength",r.max_w);
+      psets.push_back(p);
+    }
+    fhicl::ParameterSet pset;
+    pset.put("SimPhotonCounterParams",psets);
+    return pset;
+  }
+
+  std::vector<float> QEVector()
+  {
+    std::vector<float> qe(NOpDets);
+    for(size_t i=0; i<NOpDets; i++) qe[i] = 0.01 + 0.003*i;
+    return qe;
+  }
+
+  sim::OnePhoton Photon(float time, float energy)
+  {
+    sim::OnePhoton ph;
+    ph.Time = time;
+    ph.Energy = energy;
+    return ph;
+  }
+
+  // photons at times and wavelengths on and around all the range boundaries
+  std::vector<sim::SimPhotons> MakePhotons(std::vector<Range> const& ranges)
+  {
+    std::vector<float> times = { -1e10, 0., 1e10, std::numeric_limits<float>::quiet_NaN() };
+    std::vector<float> wavelengths = { 1., 128., 430., 5e3 };
+    for(auto const& r : ranges){
+      for(float t : {r.t_p1, r.t_p2, r.t_l1, r.t_l2}){
+        times.push_back(t);
+        times.push_back(std::nextafter(t,-1e30f));
+        times.push_back(std::nextafter(t,1e30f));
+      }
+      for(float w : {r.min_w, r.max_w}){
+        wavelengths.push_back(w);
+        wavelengths.push_back(std::nextafter(w,-1e30f));
+        wavelengths.push_back(std::nextafter(w,1e30f));
+      }
+    }
+
+    std::vector<sim::SimPhotons> photons;
+    for(size_t ch=0; ch<NOpDets; ch++){
+      sim::SimPhotons ph(ch);
+      for(size_t i=0; i<times.size(); i++){
+        // with no wavelength, only the time counts
+        if(i%5 == ch%5) ph.push_back(Photon(times[i],std::numeric_limits<float>::quiet_NaN()));
+        for(size_t j=(i+ch)%3; j<wavelengths.size(); j+=3){
+          sim::OnePhoton phot = Photon(times[i],0.00124/wavelengths[j]);
+          if(phot.Energy < std::numeric_limits<float>::epsilon()) continue; // not allowed
+          ph.push_back(phot);
+          // make a photon right at the boundary, as computed from its energy
+          float const w = opdet::SimPhotonCounter::Wavelength(phot);
+          if(w != wavelengths[j]) ph.push_back(Photon(times[i],0.00124/w));
+        }
+      }
+      photons.push_back(ph);
+    }
+    return photons;
+  }
+
+  // every counter on its own, photon by photon
+  void CheckAgainstCounters(std::vector<Range> const& ranges)
+  {
+    opdet::SimPhotonCounterAlg alg(MakeParameterSet(ranges));
+    alg.InitializeCounters(QEVector());
+
+    std::vector<opdet::SimPhotonCounter> counters;
+    for(auto const& r : ranges)
+      counters.emplace_back(r.t_p1,r.t_p2,r.t_l1,r.t_l2,r.min_w,r.max_w,QEVector());
+
+    auto const photons = MakePhotons(ranges);
+    for(int pass=0; pass<2; pass++){ // twice, to add to non-empty counters
+      alg.AddSimPhotonsVector(photons);
+      for(auto& counter : counters)
+        for(auto const& ph : photons)
+          counter.AddSimPhotons(ph);
+
+      for(size_t i=0; i<ranges.size(); i++){
+        BOOST_CHECK(alg.PromptPhotonVector(i) == counters[i].PromptPhotonVector());
+        BOOST_CHECK(alg.LatePhotonVector(i) == counters[i].LatePhotonVector());
+        BOOST_CHECK_EQUAL(&alg.GetSimPhotonCounter(i).PromptPhotonVector(), &alg.PromptPhotonVector(i));
+      }
+    }
+
+    // some photons were counted, but not all of them
+    float prompt = 0, late = 0;
+    for(size_t i=0; i<ranges.size(); i++){
+      prompt += counters[i].PromptPhotonTotal();
+      late += counters[i].LatePhotonTotal();
+    }
+    BOOST_CHECK(prompt > 0);
+    BOOST_CHECK(late > 0);
+
+    alg.ClearCounters();
+    for(size_t i=0; i<ranges.size(); i++)
+      BOOST_CHECK_EQUAL(alg.GetSimPhotonCounter(i).PhotonTotal(), 0.);
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(SimPhotonCounterAlg_singleRange)
+{
+  CheckAgainstCounters({ {-9e9, 100., 100., 9e9, 0., 1e6} });
+}
+
+BOOST_AUTO_TEST_CASE(SimPhotonCounterAlg_overlappingRanges)
+{
+  CheckAgainstCounters({
+      {-9e9, 100., 100., 9e9, 0., 1e6},
+      {-10., 50., 60., 2000., 100., 200.},
+      {0., 0., 0., 100., 120., 140.},      // empty prompt window
+      {-10., 50., 50., 50., 128., 430.},   // empty late window
+      {20., 30., 1000., 1500., 200., 1e5},
+      {-10., 50., 60., 2000., 100., 200.}, // same as another one
+      {-5e3, -100., -100., 75., 0.5, 129.},
+    });
+}
+
+BOOST_AUTO_TEST_CASE(SimPhotonCounterAlg_AddSimPhotonCollection)
+{
+  std::vector<Range> const ranges = { {-9e9, 100., 100., 9e9, 0., 1e6}, {0., 10., 20., 30., 100., 200.} };
+  opdet::SimPhotonCounterAlg alg(MakeParameterSet(ranges));
+  alg.InitializeCounters(QEVector());
+
+  sim::SimPhotonsCollection col;
+  for(size_t ch=0; ch<NOpDets; ch++){
+    col[ch].SetChannel(ch);
+    for(int i=0; i<(int)ch; i++) col[ch].push_back(Photon(5.*i, 0.00124/128.));
+  }
+  alg.AddSimPhotonCollection(col);
+
+  for(size_t ch=0; ch<NOpDets; ch++){
+    float const qe = QEVector()[ch];
+    float prompt = 0, late = 0;
+    for(int i=0; i<(int)ch; i++){
+      if(5.*i > 0. && 5.*i <= 10.) prompt += qe;
+      else if(5.*i > 20. && 5.*i < 30.) late += qe;
+    }
+    BOOST_CHECK_EQUAL(alg.PromptPhotonVector(1)[ch], prompt);
+    BOOST_CHECK_EQUAL(alg.LatePhotonVector(1)[ch], late);
+  }
+
+  // wrong number of OpDets, OpDet out of range, zero energy
+  col.erase(0);
+  BOOST_CHECK_THROW(alg.AddSimPhotonCollection(col), std::runtime_error);
+
+  sim::SimPhotons outOfRange(NOpDets);
+  outOfRange.push_back(Photon(1., 1e-5));
+  BOOST_CHECK_THROW(alg.AddSimPhotonsVector({outOfRange}), std::runtime_error);
+
+  sim::SimPhotons zeroEnergy(0);
+  zeroEnergy.push_back(Photon(1., 0.));
+  BOOST_CHECK_THROW(alg.AddSimPhotonsVector({zeroEnergy}), std::runtime_error);
+
+  // the same with a single range
+  opdet::SimPhotonCounterAlg singleAlg(MakeParameterSet({ranges[0]}));
+  singleAlg.InitializeCounters(QEVector());
+  BOOST_CHECK_THROW(singleAlg.AddSimPhotonsVector({outOfRange}), std::runtime_error);
+  BOOST_CHECK_THROW(singleAlg.AddSimPhotonsVector({zeroEnergy}), std::runtime_error);
+
+  // and photon by photon
+  opdet::SimPhotonCounter counter(NOpDets, 0., 10., 20., 30.);
+  BOOST_CHECK_THROW(counter.AddOnePhoton(NOpDets, Photon(1., 1e-5)), std::runtime_error);
+  counter.AddOnePhoton(NOpDets-1, Photon(1., 1e-5));
+  BOOST_CHECK_EQUAL(counter.PromptPhotonVector(NOpDets-1), 1.);
+}
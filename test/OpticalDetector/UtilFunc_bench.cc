@@ -0,0 +1,121 @@
+// Waveform statistics of UtilFunc against the loops they replaced: the
+// sliding mean and std of PedAlgoRmsSlider, and the pedestal mode search of
+// PedAlgoRollingMean (BinnedMaxOccurrence).
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/OpHitFinder/UtilFunc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+namespace {
+
+  // previous implementations
+  double OldMean(const std::vector<short>& wf, size_t start, size_t nsample)
+  {
+    return std::accumulate(wf.begin()+start,wf.begin()+start+nsample,0.0) / ((double)nsample);
+  }
+
+  double OldStd(const std::vector<short>& wf, const double ped_mean, size_t start, size_t nsample)
+  {
+    double sigma = 0;
+    for(size_t index=start; index < (start+nsample); ++index)
+      sigma += pow( (wf[index] - ped_mean), 2 );
+    return sqrt(sigma/((double)(nsample)));
+  }
+
+  double OldBinnedMaxOccurrence(const std::vector<double>& mean_v, const size_t nbins)
+  {
+    auto res = std::minmax_element(std::begin(mean_v),std::end(mean_v));
+    double bin_width = ((*res.second) - (*res.first)) / ((double)nbins);
+    if(nbins==1 || bin_width == 0) return ((*res.first) + bin_width /2.);
+
+    // one more bin than before: the maximum used to be counted past the end
+    static std::vector<size_t> ctr_v(nbins+1,0);
+    for(auto& v : ctr_v) v=0;
+    for(auto const& v : mean_v) ctr_v[int((v - (*res.first))/bin_width)]++;
+    ctr_v[nbins-1] += ctr_v[nbins]; ctr_v[nbins] = 0;
+
+    auto max_it = std::max_element(std::begin(ctr_v),std::end(ctr_v));
+    double mean_max_occurrence = 0;
+    double num_occurrence = 0;
+    for(size_t bin=0; bin<ctr_v.size(); ++bin) {
+      if(ctr_v[bin] != (*max_it)) continue;
+      mean_max_occurrence += ((*res.first) + bin_width / 2. + bin_width * bin);
+      num_occurrence += 1.0;
+    }
+    return (mean_max_occurrence / num_occurrence);
+  }
+
+  std::vector<short> MakeWaveform(size_t n, size_t seed)
+  {
+    std::vector<short> wf(n);
+    for(size_t i=0; i<n; i++)
+      wf[i] = 2048 + (short)(((i+seed)*7919)%11) - 5 + (((i+seed)%97)==0? 300 : 0);
+    return wf;
+  }
+
+  template <typename F>
+  double TimeNs(F f, size_t nCalls)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    f();
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::nano>(stop-start).count()/nCalls;
+  }
+
+}
+
+int main()
+{
+  const size_t NSamples = 1500;
+  const size_t NWaveforms = 2000;
+  std::vector<std::vector<short>> wfs;
+  for(size_t i=0; i<NWaveforms; i++) wfs.push_back(MakeWaveform(NSamples,i));
+
+  // sliding windows, every sample
+  for(size_t window : {16, 64}){
+    const size_t nCalls = NWaveforms*(NSamples-window);
+    double check_old = 0, check_new = 0;
+    double const t_old = TimeNs([&]{
+	for(auto const& wf : wfs)
+	  for(size_t i=0; i+window<NSamples; i++){
+	    const double m = OldMean(wf,i,window);
+	    check_old += m + OldStd(wf,m,i,window);
+	  }
+      },nCalls);
+    double const t_new = TimeNs([&]{
+	for(auto const& wf : wfs)
+	  for(size_t i=0; i+window<NSamples; i++){
+	    const double m = pmtana::mean(wf,i,window);
+	    check_new += m + pmtana::std(wf,m,i,window);
+	  }
+      },nCalls);
+    std::printf("mean+std, %3zu samples: old %6.1f ns, new %6.1f ns (relative difference %.1e)\n",
+		window,t_old,t_new,std::abs(check_new-check_old)/check_old);
+  }
+
+  // mode of the rolling means of a waveform
+  std::vector<std::vector<double>> means;
+  for(auto const& wf : wfs){
+    std::vector<double> m(NSamples);
+    for(size_t i=0; i<NSamples; i++) m[i] = wf[i] + 0.01*(i%13);
+    means.push_back(m);
+  }
+  for(size_t nbins : {10, 100}){
+    double check_old = 0, check_new = 0;
+    std::vector<size_t> ctr_v;
+    double const t_old = TimeNs([&]{
+	for(auto const& m : means) check_old += OldBinnedMaxOccurrence(m,nbins);
+      },NWaveforms);
+    double const t_new = TimeNs([&]{
+	for(auto const& m : means) check_new += pmtana::BinnedMaxOccurrence(m.begin(),m.end(),nbins,ctr_v);
+      },NWaveforms);
+    std::printf("BinnedMaxOccurrence, %zu samples, %3zu bins: old %6.0f ns, new %6.0f ns (%s)\n",
+		NSamples,nbins,t_old,t_new,(check_old==check_new)? "same modes" : "MODES DIFFER");
+  }
+  return 0;
+}
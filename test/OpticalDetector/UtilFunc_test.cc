@@ -0,0 +1,129 @@
+#define BOOST_TEST_MODULE ( UtilFunc_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/OpHitFinder/UtilFunc.h"
+
+#include <cmath>
+#include <map>
+
+const double tolerance = 1e-9; // percent
+
+namespace {
+
+  std::vector<short> MakeWaveform(size_t n)
+  {
+    std::vector<short> wf(n);
+    for(size_t i=0; i<n; i++)
+      wf[i] = 2048 + (short)((i*7919)%11) - 5 + ((i%97)==0? 300 : 0);
+    return wf;
+  }
+
+  // straightforward implementations the primitives are checked against
+  double RefMean(std::vector<short> const& wf, size_t start, size_t n)
+  {
+    double sum=0;
+    for(size_t i=start; i<start+n; i++) sum += wf[i];
+    return sum/n;
+  }
+
+  double RefStd(std::vector<short> const& wf, double m, size_t start, size_t n)
+  {
+    double sum=0;
+    for(size_t i=start; i<start+n; i++) sum += std::pow(wf[i]-m,2);
+    return std::sqrt(sum/n);
+  }
+
+  double RefBinnedMaxTH1D(std::vector<double> const& v, int bins)
+  {
+    //TH1D binning: [min,max) with the maximum in the overflow
+    const double xmin = *std::min_element(v.begin(),v.end());
+    const double xmax = *std::max_element(v.begin(),v.end());
+    std::map<int,int> counts;
+    for(double x : v)
+      if(x < xmax) counts[int(bins*(x-xmin)/(xmax-xmin))]++;
+    int best_bin=0, best_count=-1;
+    for(auto const& c : counts)
+      if(c.second > best_count) { best_bin = c.first; best_count = c.second; }
+    return xmin + (best_bin+0.5)*(xmax-xmin)/bins;
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(UtilFunc_test)
+
+BOOST_AUTO_TEST_CASE(range_sum_checkWindows)
+{
+  const std::vector<short> wf = MakeWaveform(5000);
+  for(size_t window : {1ul,3ul,8ul,64ul,513ul,4096ul}){
+    for(size_t start : {0ul,1ul,7ul,900ul}){
+      long long ref=0;
+      for(size_t i=start; i<start+window; i++) ref += wf[i];
+      BOOST_CHECK_EQUAL(pmtana::range_sum(wf.begin()+start,wf.begin()+start+window),ref);
+      BOOST_CHECK_EQUAL(pmtana::mean(wf,start,window),RefMean(wf,start,window));
+      const double m = RefMean(wf,start,window);
+      BOOST_CHECK_CLOSE(pmtana::std(wf,m,start,window)+1.,RefStd(wf,m,start,window)+1.,tolerance);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(range_sum_checkDouble)
+{
+  const std::vector<double> v{0.5,1.25,-3.,8.,1e-3,2.};
+  BOOST_CHECK_CLOSE(pmtana::range_sum(v.begin(),v.end()),8.751,tolerance);
+  BOOST_CHECK_CLOSE(pmtana::range_sum_sq(v.begin(),v.end(),1.),0.25+0.0625+16+49+0.998001+1,tolerance);
+  BOOST_CHECK_EQUAL(pmtana::range_sum(v.begin(),v.begin()),0.);
+}
+
+BOOST_AUTO_TEST_CASE(range_minmax_check)
+{
+  const std::vector<short> wf = MakeWaveform(4096);
+  for(size_t window : {1ul,8ul,100ul,4096ul}){
+    auto const ref = std::minmax_element(wf.begin(),wf.begin()+window);
+    auto const res = pmtana::range_minmax(wf.begin(),wf.begin()+window);
+    BOOST_CHECK_EQUAL(res.first,*ref.first);
+    BOOST_CHECK_EQUAL(res.second,*ref.second);
+  }
+  const std::vector<double> empty;
+  BOOST_CHECK_THROW(pmtana::range_minmax(empty.begin(),empty.end()),pmtana::OpticalRecoException);
+}
+
+BOOST_AUTO_TEST_CASE(BinnedMaxOccurrence_checkMode)
+{
+  // most entries at 2.0, a few spread up to 10
+  pmtana::PedestalMean_t v(100,2.0);
+  for(size_t i=0; i<20; i++) v.push_back(2.5+0.375*i);
+  v.push_back(10.);
+
+  std::vector<size_t> scratch;
+  const double mode = pmtana::BinnedMaxOccurrence(v.begin(),v.end(),16,scratch);
+  BOOST_CHECK_CLOSE(mode,2.25,tolerance);
+  BOOST_CHECK_EQUAL(scratch.size(),16u);
+  BOOST_CHECK_EQUAL(pmtana::BinnedMaxOccurrence(v,16),mode);
+
+  // more bins than before: scratch is resized, not overrun
+  BOOST_CHECK_CLOSE(pmtana::BinnedMaxOccurrence(v.begin(),v.end(),1000,scratch),2.004,tolerance);
+  BOOST_CHECK_EQUAL(scratch.size(),1000u);
+}
+
+BOOST_AUTO_TEST_CASE(BinnedMaxOccurrence_checkFlat)
+{
+  const pmtana::PedestalMean_t v(10,3.);
+  BOOST_CHECK_EQUAL(pmtana::BinnedMaxOccurrence(v,100),3.);
+  BOOST_CHECK_THROW(pmtana::BinnedMaxOccurrence(v,0),pmtana::OpticalRecoException);
+}
+
+BOOST_AUTO_TEST_CASE(BinnedMaxHistogram_checkAgainstTH1DBinning)
+{
+  std::vector<double> v;
+  for(size_t i=0; i<2000; i++)
+    v.push_back(2048 + 3.*std::sin(0.37*i) + ((i%50)==0? 40. : 0.));
+
+  std::vector<size_t> scratch;
+  for(int bins : {1,10,100,1000}){
+    BOOST_CHECK_CLOSE(pmtana::BinnedMaxHistogram(v.begin(),v.end(),bins,scratch),
+		      RefBinnedMaxTH1D(v,bins),tolerance);
+    BOOST_CHECK_CLOSE(pmtana::BinnedMaxTH1D(v,bins),RefBinnedMaxTH1D(v,bins),tolerance);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+// Flash centroid and width of 32, 300 and 10000 opdets: the two-loop
+// FlashUtilities::GetPosition that was used before the weighted-moments
+// kernel, against GetPosition on AccumulateMoments, with the kernel also
+// timed accumulating in float and in double. Positions and widths must
+// agree to about 1e-5.
+// Built with the tests, not run by them.
+
+#include "larana/OpticalDetector/FlashUtilities.h"
+#include "larana/OpticalDetector/WeightedMoments.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+  const long NEntries = 30000000; // opdets times calls, per size
+  const int NFlashes = 4;
+
+  volatile double Sink; ///< keeps the timed results in use
+
+  /// FlashUtilities::GetPosition before the weighted-moments kernel
+  void OldGetPosition(const std::vector<float>& pe_vector,
+		      const std::vector<float>& pos_vector,
+		      float& mean, float& rms)
+  {
+    float sum = std::accumulate(pe_vector.begin(),pe_vector.end(),0.0);
+
+    if(sum < std::numeric_limits<float>::epsilon()){
+      mean=0; rms=0; return;
+    }
+
+    mean = std::inner_product(pe_vector.begin(),pe_vector.end(),pos_vector.begin(),0.0) / sum;
+
+    rms=0;
+    for(size_t i=0; i<pe_vector.size(); i++)
+      rms += pe_vector[i]*(pos_vector[i] - mean)*(pos_vector[i] - mean);
+
+    rms = std::sqrt(rms)/sum;
+  }
+
+  template <typename T>
+  T KernelMean(const std::vector<float>& pe_vector, const std::vector<float>& pos_vector)
+  {
+    opdet::WeightedMoments<T> moments;
+    opdet::AccumulateMoments(pe_vector.size(),pe_vector.data(),
+			     std::array<float const*,1>{{pos_vector.data()}},moments);
+    return moments.Mean();
+  }
+
+  bool Close(float value, float expected)
+  {
+    return std::abs(value-expected) <= 1e-5*std::max(1.f,std::abs(expected));
+  }
+
+  /// Time per call (ns)
+  template <typename F>
+  double TimeCalls(long nCalls, F f)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    for(long n=0; n<nCalls; n++) f(n);
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::nano>(stop-start).count()/nCalls;
+  }
+
+}
+
+int main()
+{
+  opdet::FlashUtilities util;
+
+  for(size_t nOpDets : {32, 300, 10000}){
+    // a few flashes, so that no call can be done once for all
+    std::vector<std::vector<float>> pe(NFlashes, std::vector<float>(nOpDets));
+    std::vector<float> pos(nOpDets);
+    for(size_t i=0; i<nOpDets; i++){
+      for(int f=0; f<NFlashes; f++)
+	pe[f][i] = (i%7==3)? 0. : 0.5 + (i*7919 + f*104729)%200;
+      pos[i] = -100. + 0.75*((i*13)%nOpDets);
+    }
+    long const nCalls = NEntries/nOpDets;
+
+    bool close = true;
+    for(int f=0; f<NFlashes; f++){
+      float old_mean, old_rms, mean, rms;
+      OldGetPosition(pe[f],pos,old_mean,old_rms);
+      util.GetPosition(pe[f],pos,mean,rms);
+      close = close && Close(mean,old_mean) && Close(rms,old_rms)
+	&& Close(KernelMean<float>(pe[f],pos),old_mean) && Close(KernelMean<double>(pe[f],pos),old_mean);
+    }
+
+    float mean, rms;
+    double sum = 0;
+    double const t_old = TimeCalls(nCalls, [&](long n){
+	OldGetPosition(pe[n%NFlashes],pos,mean,rms); sum += mean; });
+    double const t_new = TimeCalls(nCalls, [&](long n){
+	util.GetPosition(pe[n%NFlashes],pos,mean,rms); sum += mean; });
+    double const t_float = TimeCalls(nCalls, [&](long n){ sum += KernelMean<float>(pe[n%NFlashes],pos); });
+    double const t_double = TimeCalls(nCalls, [&](long n){ sum += KernelMean<double>(pe[n%NFlashes],pos); });
+
+    std::printf("%5zu opdets: two loops %9.1f ns, kernel %9.1f ns; kernel in float %9.1f ns, in double %9.1f ns (%s)\n",
+		nOpDets, t_old, t_new, t_float, t_double,
+		close ? "same positions within 1e-5" : "POSITIONS DIFFER");
+    Sink = sum;
+  }
+  return 0;
+}
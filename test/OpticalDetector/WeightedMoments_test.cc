@@ -0,0 +1,147 @@
+#define BOOST_TEST_MODULE ( WeightedMoments_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/OpticalDetector/WeightedMoments.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+  //reference sums, one entry at a time in long double
+  template <std::size_t N, typename W, typename X>
+  void Reference(std::vector<W> const& w,
+		 std::vector<X> const (&x)[N],
+		 long double& sw, long double (&swx)[N], long double (&swx2)[N])
+  {
+    sw = 0;
+    for(std::size_t c=0; c<N; c++) swx[c] = swx2[c] = 0;
+    for(std::size_t i=0; i<w.size(); i++){
+      sw += w[i];
+      for(std::size_t c=0; c<N; c++){
+	swx[c] += (long double)w[i]*x[c][i];
+	swx2[c] += (long double)w[i]*x[c][i]*x[c][i];
+      }
+    }
+  }
+
+  template <std::size_t N>
+  std::array<double const*,N> Pointers(std::vector<double> const (&x)[N])
+  {
+    std::array<double const*,N> p;
+    for(std::size_t c=0; c<N; c++) p[c] = x[c].data();
+    return p;
+  }
+
+  //integer weights and coordinates: all the sums are exact, in any order
+  template <std::size_t N>
+  void CheckExact()
+  {
+    for(std::size_t n : {0, 1, 3, 4, 5, 32, 300, 10000}){
+      std::vector<double> w(n);
+      std::vector<double> x[N];
+      for(std::size_t i=0; i<n; i++) w[i] = (i*7)%13;
+      for(std::size_t c=0; c<N; c++){
+	x[c].resize(n);
+	for(std::size_t i=0; i<n; i++) x[c][i] = int((i*31+c*17)%200) - 100;
+      }
+
+      long double sw, swx[N], swx2[N];
+      Reference<N>(w,x,sw,swx,swx2);
+
+      opdet::WeightedMoments<double,N> m;
+      opdet::AccumulateMoments(n,w.data(),Pointers<N>(x),m);
+      BOOST_CHECK_EQUAL(m.SumW,(double)sw);
+      for(std::size_t c=0; c<N; c++){
+	BOOST_CHECK_EQUAL(m.SumWX[c],(double)swx[c]);
+	BOOST_CHECK_EQUAL(m.SumWX2[c],(double)swx2[c]);
+      }
+
+      //one entry at a time
+      opdet::WeightedMoments<double,N> m1;
+      for(std::size_t i=0; i<n; i++){
+	std::array<double,N> xi;
+	for(std::size_t c=0; c<N; c++) xi[c] = x[c][i];
+	m1.Add(w[i],xi);
+      }
+      BOOST_CHECK_EQUAL(m1.SumW,m.SumW);
+      for(std::size_t c=0; c<N; c++){
+	BOOST_CHECK_EQUAL(m1.SumWX[c],m.SumWX[c]);
+	BOOST_CHECK_EQUAL(m1.SumWX2[c],m.SumWX2[c]);
+      }
+    }
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(WeightedMoments_test)
+
+BOOST_AUTO_TEST_CASE(AccumulateMoments_checkExact)
+{
+  CheckExact<1>();
+  CheckExact<2>();
+  CheckExact<3>();
+}
+
+BOOST_AUTO_TEST_CASE(AccumulateMoments_checkRandom)
+{
+  std::srand(42);
+  const std::size_t n = 1000;
+  std::vector<float> w(n);
+  std::vector<float> x[2] = { std::vector<float>(n), std::vector<float>(n) };
+  for(std::size_t i=0; i<n; i++){
+    w[i] = 100.f*std::rand()/RAND_MAX;
+    x[0][i] = -200.f + 400.f*std::rand()/RAND_MAX;
+    x[1][i] = 1000.f*std::rand()/RAND_MAX;
+  }
+  long double sw, swx[2], swx2[2];
+  Reference<2>(w,x,sw,swx,swx2);
+
+  std::array<float const*,2> const p{{x[0].data(),x[1].data()}};
+  opdet::WeightedMoments<double,2> md;
+  opdet::AccumulateMoments(n,w.data(),p,md);
+  opdet::WeightedMoments<float,2> mf;
+  opdet::AccumulateMoments(n,w.data(),p,mf);
+
+  BOOST_CHECK_CLOSE(md.SumW,(double)sw,1e-10);
+  BOOST_CHECK_CLOSE(mf.SumW,(float)sw,1e-3);
+  for(std::size_t c=0; c<2; c++){
+    BOOST_CHECK_CLOSE(md.SumWX[c],(double)swx[c],1e-9);
+    BOOST_CHECK_CLOSE(md.SumWX2[c],(double)swx2[c],1e-10);
+    BOOST_CHECK_CLOSE(mf.SumWX[c],(float)swx[c],1e-2);
+    BOOST_CHECK_CLOSE(mf.SumWX2[c],(float)swx2[c],1e-3);
+  }
+
+  //two halves added together
+  opdet::WeightedMoments<double,2> m1, m2;
+  opdet::AccumulateMoments(n/2,w.data(),p,m1);
+  opdet::AccumulateMoments(n-n/2,w.data()+n/2,
+			   std::array<float const*,2>{{x[0].data()+n/2,x[1].data()+n/2}},m2);
+  m1 += m2;
+  BOOST_CHECK_CLOSE(m1.SumW,md.SumW,1e-10);
+  for(std::size_t c=0; c<2; c++){
+    BOOST_CHECK_CLOSE(m1.SumWX[c],md.SumWX[c],1e-9);
+    BOOST_CHECK_CLOSE(m1.SumWX2[c],md.SumWX2[c],1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WeightedMoments_checkMeanAndWidth)
+{
+  //weights 1 and 3 at 2 and 6: mean 5, variance 3
+  opdet::WeightedMoments<double> m;
+  m.Add(1.,std::array<double,1>{{2.}});
+  m.Add(3.,std::array<double,1>{{6.}});
+  BOOST_CHECK_EQUAL(m.Mean(),5.);
+  BOOST_CHECK_EQUAL(m.SumWDev2(),12.);
+  BOOST_CHECK_CLOSE(m.Width(),std::sqrt(3.),1e-12);
+
+  //all at the same place: no width, even with rounding
+  opdet::WeightedMoments<float> same;
+  for(int i=0; i<10; i++) same.Add(0.1f*(i+1),std::array<float,1>{{0.3f}});
+  BOOST_CHECK_CLOSE(same.Mean(),0.3f,1e-4);
+  BOOST_CHECK_GE(same.SumWDev2(),0.f);
+  BOOST_CHECK_SMALL(same.Width(),1e-3f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+// Matching 20000 reco hits to 20000 truth hits on 2000 channels, with hit
+// widths (RMS) of about 5, 100 and 300 ticks: IndirectHitParticleAssns
+// keeping a channel -> tick -> std::set map with an entry per tick of each
+// truth hit, against the per-channel HitTickIntervals.
+// Built with the tests, not run by them.
+
+#include "larana/T0Finder/AssociationsTools/HitTickIntervals.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  const size_t NHits = 20000;
+  const raw::ChannelID_t NChannels = 2000;
+  const float NTicks = 6400;
+
+  struct FakeHit {
+    raw::ChannelID_t Channel;
+    float PeakTimeMinusRMS;
+    float PeakTimePlusRMS;
+  };
+
+  /// (particle, truth hit index) pairs, as the associations hold them
+  using PartData = std::pair<size_t, size_t>;
+
+  std::vector<std::vector<PartData>> TickMap(std::vector<FakeHit> const& truthHits,
+                                             std::vector<size_t> const& particles,
+                                             std::vector<FakeHit> const& recoHits)
+  {
+    std::unordered_map<raw::ChannelID_t, std::unordered_map<raw::TDCtick_t, std::set<PartData>>>
+      chanToTickPartDataMap;
+    for (size_t i = 0; i < truthHits.size(); ++i) {
+      auto& tickToPartDataMap = chanToTickPartDataMap[truthHits[i].Channel];
+      for (raw::TDCtick_t tick = truthHits[i].PeakTimeMinusRMS;
+           tick <= truthHits[i].PeakTimePlusRMS;
+           tick++)
+        tickToPartDataMap[tick].insert(PartData(particles[i], i));
+    }
+
+    std::vector<std::vector<PartData>> matches;
+    for (auto const& hit : recoHits) {
+      auto& tickToPartDataMap = chanToTickPartDataMap[hit.Channel];
+      std::set<PartData> particleDataSet;
+      for (raw::TDCtick_t tick = hit.PeakTimeMinusRMS; tick <= hit.PeakTimePlusRMS; tick++) {
+        auto const hitInfoItr = tickToPartDataMap.find(tick);
+        if (hitInfoItr != tickToPartDataMap.end())
+          particleDataSet.insert(hitInfoItr->second.begin(), hitInfoItr->second.end());
+      }
+      matches.emplace_back(particleDataSet.begin(), particleDataSet.end());
+    }
+    return matches;
+  }
+
+  std::vector<std::vector<PartData>> Intervals(std::vector<FakeHit> const& truthHits,
+                                               std::vector<size_t> const& particles,
+                                               std::vector<FakeHit> const& recoHits)
+  {
+    std::unordered_map<raw::ChannelID_t, t0::HitTickIntervals<PartData>> chanToIntervals;
+    for (size_t i = 0; i < truthHits.size(); ++i) {
+      auto const ticks =
+        t0::HitTickRange(truthHits[i].PeakTimeMinusRMS, truthHits[i].PeakTimePlusRMS);
+      chanToIntervals[truthHits[i].Channel].Add(
+        ticks.first, ticks.second, PartData(particles[i], i));
+    }
+    for (auto& chanIntervals : chanToIntervals)
+      chanIntervals.second.Sort();
+
+    std::vector<std::vector<PartData>> matches;
+    for (auto const& hit : recoHits) {
+      matches.emplace_back();
+      auto const chanItr = chanToIntervals.find(hit.Channel);
+      if (chanItr == chanToIntervals.end()) continue;
+      auto const ticks = t0::HitTickRange(hit.PeakTimeMinusRMS, hit.PeakTimePlusRMS);
+      auto& particleDataVec = matches.back();
+      chanItr->second.ForEachOverlap(ticks.first, ticks.second, [&](PartData const& partData) {
+        particleDataVec.push_back(partData);
+      });
+      std::sort(particleDataVec.begin(), particleDataVec.end());
+      particleDataVec.erase(std::unique(particleDataVec.begin(), particleDataVec.end()),
+                            particleDataVec.end());
+    }
+    return matches;
+  }
+
+  std::vector<FakeHit> MakeHits(float rms, std::mt19937& gen)
+  {
+    std::uniform_int_distribution<raw::ChannelID_t> channel(0, NChannels - 1);
+    std::uniform_real_distribution<float> time(0., NTicks);
+    std::uniform_real_distribution<float> width(0.5 * rms, 1.5 * rms);
+    std::vector<FakeHit> hits;
+    for (size_t i = 0; i < NHits; ++i) {
+      float const peak = time(gen);
+      float const hitRMS = width(gen);
+      hits.push_back({channel(gen), peak - hitRMS, peak + hitRMS});
+    }
+    return hits;
+  }
+
+  template <typename F>
+  double TimeMatching(F f, std::vector<FakeHit> const& truthHits,
+                      std::vector<size_t> const& particles,
+                      std::vector<FakeHit> const& recoHits,
+                      std::vector<std::vector<PartData>>& matches)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    matches = f(truthHits, particles, recoHits);
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count();
+  }
+
+}
+
+int main()
+{
+  std::mt19937 gen(37);
+
+  for (float rms : {5.f, 100.f, 300.f}) {
+    auto const truthHits = MakeHits(rms, gen);
+    auto const recoHits = MakeHits(rms, gen);
+    std::vector<size_t> particles(NHits);
+    for (size_t i = 0; i < NHits; ++i) particles[i] = i / 7;
+
+    std::vector<std::vector<PartData>> tick_map, intervals;
+    // intervals first: freeing the millions of tick map nodes slows what follows
+    double const t_intervals = TimeMatching(Intervals, truthHits, particles, recoHits, intervals);
+    double const t_tick_map = TimeMatching(TickMap, truthHits, particles, recoHits, tick_map);
+
+    std::printf("RMS ~%3.0f ticks, %zu truth and %zu reco hits on %u channels: tick map %8.1f ms, intervals %6.1f ms (%s)\n",
+                rms, NHits, NHits, NChannels, t_tick_map, t_intervals,
+                (tick_map == intervals) ? "same matches" : "MATCHES DIFFER");
+  }
+  return 0;
+}
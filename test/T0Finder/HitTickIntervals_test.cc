@@ -0,0 +1,176 @@
+#define BOOST_TEST_MODULE ( HitTickIntervals_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/T0Finder/AssociationsTools/HitTickIntervals.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  struct FakeHit {
+    raw::ChannelID_t Channel;
+    float PeakTimeMinusRMS;
+    float PeakTimePlusRMS;
+  };
+
+  /// (truth hit index, particle) pairs, as the associations hold them
+  using PartData = std::pair<size_t, size_t>;
+
+  /// Associations as IndirectHitParticleAssns used to find them, with a
+  /// map entry for every tick of every truth hit
+  std::vector<std::vector<PartData>> ReferenceMatches(std::vector<FakeHit> const& truthHits,
+                                                      std::vector<size_t> const& particles,
+                                                      std::vector<FakeHit> const& recoHits)
+  {
+    std::unordered_map<raw::ChannelID_t, std::unordered_map<raw::TDCtick_t, std::set<PartData>>>
+      chanToTickPartDataMap;
+    for (size_t i = 0; i < truthHits.size(); ++i) {
+      auto& tickToPartDataMap = chanToTickPartDataMap[truthHits[i].Channel];
+      for (raw::TDCtick_t tick = truthHits[i].PeakTimeMinusRMS;
+           tick <= truthHits[i].PeakTimePlusRMS;
+           tick++)
+        tickToPartDataMap[tick].insert(PartData(particles[i], i));
+    }
+
+    std::vector<std::vector<PartData>> matches;
+    for (auto const& hit : recoHits) {
+      auto& tickToPartDataMap = chanToTickPartDataMap[hit.Channel];
+      std::set<PartData> particleDataSet;
+      for (raw::TDCtick_t tick = hit.PeakTimeMinusRMS; tick <= hit.PeakTimePlusRMS; tick++) {
+        auto const hitInfoItr = tickToPartDataMap.find(tick);
+        if (hitInfoItr != tickToPartDataMap.end())
+          particleDataSet.insert(hitInfoItr->second.begin(), hitInfoItr->second.end());
+      }
+      matches.emplace_back(particleDataSet.begin(), particleDataSet.end());
+    }
+    return matches;
+  }
+
+  /// Same associations from the interval index
+  std::vector<std::vector<PartData>> IntervalMatches(std::vector<FakeHit> const& truthHits,
+                                                     std::vector<size_t> const& particles,
+                                                     std::vector<FakeHit> const& recoHits)
+  {
+    std::unordered_map<raw::ChannelID_t, t0::HitTickIntervals<PartData>> chanToIntervals;
+    for (size_t i = 0; i < truthHits.size(); ++i) {
+      auto const ticks =
+        t0::HitTickRange(truthHits[i].PeakTimeMinusRMS, truthHits[i].PeakTimePlusRMS);
+      chanToIntervals[truthHits[i].Channel].Add(
+        ticks.first, ticks.second, PartData(particles[i], i));
+    }
+    for (auto& chanIntervals : chanToIntervals)
+      chanIntervals.second.Sort();
+
+    std::vector<std::vector<PartData>> matches;
+    for (auto const& hit : recoHits) {
+      matches.emplace_back();
+      auto const chanItr = chanToIntervals.find(hit.Channel);
+      if (chanItr == chanToIntervals.end()) continue;
+      auto const ticks = t0::HitTickRange(hit.PeakTimeMinusRMS, hit.PeakTimePlusRMS);
+      auto& particleDataVec = matches.back();
+      chanItr->second.ForEachOverlap(ticks.first, ticks.second, [&](PartData const& partData) {
+        particleDataVec.push_back(partData);
+      });
+      std::sort(particleDataVec.begin(), particleDataVec.end());
+      particleDataVec.erase(std::unique(particleDataVec.begin(), particleDataVec.end()),
+                            particleDataVec.end());
+    }
+    return matches;
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(HitTickIntervals_test)
+
+BOOST_AUTO_TEST_CASE(HitTickRange_checkLoopBounds)
+{
+  // same ticks as the integer loop from low to high time
+  for (float low : {-3.7f, -1.5f, -0.2f, 0.f, 0.5f, 4.f, 4.99f, 120.3f})
+    for (float high : {-2.1f, -0.5f, 0.f, 0.3f, 4.f, 4.5f, 7.9f, 250.f}) {
+      std::vector<raw::TDCtick_t> ticks;
+      for (raw::TDCtick_t tick = low; tick <= high; tick++)
+        ticks.push_back(tick);
+
+      auto const range = t0::HitTickRange(low, high);
+      if (ticks.empty())
+        BOOST_CHECK_GT(range.first, range.second);
+      else {
+        BOOST_CHECK_EQUAL(range.first, ticks.front());
+        BOOST_CHECK_EQUAL(range.second, ticks.back());
+      }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(HitTickIntervals_checkOverlaps)
+{
+  t0::HitTickIntervals<int> intervals;
+  intervals.Add(10, 20, 0);
+  intervals.Add(0, 100, 1); // long range seen past its neighbours
+  intervals.Add(30, 30, 2);
+  intervals.Add(50, 40, 3); // empty, never matched
+  intervals.Add(21, 29, 4);
+  intervals.Sort();
+
+  auto overlaps = [&intervals](raw::TDCtick_t first, raw::TDCtick_t last) {
+    std::vector<int> found;
+    intervals.ForEachOverlap(first, last, [&found](int i) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+    return found;
+  };
+
+  BOOST_CHECK(overlaps(20, 21) == (std::vector<int>{0, 1, 4}));
+  BOOST_CHECK(overlaps(30, 30) == (std::vector<int>{1, 2}));
+  BOOST_CHECK(overlaps(42, 45) == (std::vector<int>{1}));
+  BOOST_CHECK(overlaps(-5, 9) == (std::vector<int>{1}));
+  BOOST_CHECK(overlaps(101, 200).empty());
+  BOOST_CHECK(overlaps(25, 24).empty());
+}
+
+BOOST_AUTO_TEST_CASE(HitTickIntervals_checkAgainstTickMap)
+{
+  std::mt19937 gen(4321);
+  std::uniform_real_distribution<float> flat(0.f, 1.f);
+
+  for (int trial = 0; trial < 30; ++trial) {
+
+    // narrow separated hits in even trials, wide overlapping ones in odd trials
+    bool const wide = (trial % 2 == 1);
+    raw::ChannelID_t const nChannels = 1 + trial;
+
+    auto makeHits = [&](size_t nHits) {
+      std::vector<FakeHit> hits;
+      for (size_t i = 0; i < nHits; ++i) {
+        float const peak = 3000.f * flat(gen) - 10.f;
+        float const rms = wide ? 5.f + 150.f * flat(gen) : 0.3f + 2.f * flat(gen);
+        hits.push_back({(raw::ChannelID_t)(nChannels * flat(gen)), peak - rms, peak + rms});
+      }
+      return hits;
+    };
+
+    std::vector<FakeHit> const truthHits = makeHits(20 + 10 * trial);
+    std::vector<size_t> particles;
+    for (size_t i = 0; i < truthHits.size(); ++i)
+      particles.push_back((size_t)(10 * flat(gen)));
+    std::vector<FakeHit> const recoHits = makeHits(50 + 10 * trial);
+
+    auto const expected = ReferenceMatches(truthHits, particles, recoHits);
+    auto const result = IntervalMatches(truthHits, particles, recoHits);
+    BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+    for (size_t i = 0; i < result.size(); ++i)
+      BOOST_CHECK(result[i] == expected[i]);
+
+    // the truth hits must find themselves
+    auto const self = IntervalMatches(truthHits, particles, truthHits);
+    for (size_t i = 0; i < truthHits.size(); ++i) {
+      auto const ticks = t0::HitTickRange(truthHits[i].PeakTimeMinusRMS, truthHits[i].PeakTimePlusRMS);
+      if (ticks.first > ticks.second) continue;
+      BOOST_CHECK(std::binary_search(self[i].begin(), self[i].end(), PartData(particles[i], i)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
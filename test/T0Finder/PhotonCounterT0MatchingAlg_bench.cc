@@ -0,0 +1,146 @@
+// Matching 2000 tracks of 200 trajectory points to 500 flashes spread over
+// 10 ms, with a 2.25 ms drift window: the loop PhotonCounterT0Matching ran,
+// trying every flash and computing the YZ separation of each one inside the
+// window, against PhotonCounterT0MatchingAlg (flashes sorted by time,
+// visited by a lower bound of the fit parameter). MatchCriteria 0, as in
+// photoncountert0matching.fcl.
+// Built with the tests, not run by them.
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/T0Finder/PhotonCounterT0MatchingAlg.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using Alg = lbne::PhotonCounterT0MatchingAlg;
+
+namespace {
+
+  const size_t NTracks = 2000;
+  const size_t NFlashes = 500;
+  const size_t NPoints = 200;
+  const double ReadoutWindow = 10000; // us
+  const double DriftWindow = 2250;    // us
+  const double DriftVelocity = 0.16;  // cm/us
+
+  const double PredictedXConstant = 214.841;
+  const double PredictedExpConstant = 5.22514;
+  const double PredictedExpGradient = -0.00394097;
+  const double WeightOfDeltaYZ = 1;
+  const double PEThreshold = 0;
+
+  struct Track {
+    double TimeCentre;
+    std::vector<Alg::YZPoint> Trajectory;
+  };
+
+  /// Every flash tried in turn, as PhotonCounterT0Matching::produce did
+  Alg::Match OldMatch(std::vector<Alg::Flash> const& flashes, Track const& track)
+  {
+    Alg::Match best;
+    for (size_t iFlash = 0; iFlash < flashes.size(); ++iFlash) {
+      double YZSep = 9999, minYZSep = 9999;
+      double const FlashTime = flashes[iFlash].Time;
+      double const TimeSep = track.TimeCentre - FlashTime;
+      if (TimeSep < 0 || TimeSep > DriftWindow) continue;
+      if (flashes[iFlash].TotalPE < PEThreshold) continue;
+
+      double const PredictedX = (PredictedXConstant / pow(flashes[iFlash].TotalPE, 1.)) +
+                                (exp(PredictedExpConstant +
+                                     (PredictedExpGradient * flashes[iFlash].TotalPE)));
+      double const TimeSepPredX = TimeSep * DriftVelocity;
+      double const DeltaPredX = fabs(TimeSepPredX - PredictedX);
+      for (size_t Point = 1; Point < track.Trajectory.size(); ++Point) {
+        YZSep = Alg::DistFromPoint(track.Trajectory[Point].Y,
+                                   track.Trajectory[Point - 1].Y,
+                                   track.Trajectory[Point].Z,
+                                   track.Trajectory[Point - 1].Z,
+                                   flashes[iFlash].YCenter,
+                                   flashes[iFlash].ZCenter);
+        if (Point == 1) minYZSep = YZSep;
+        if (YZSep < minYZSep) minYZSep = YZSep;
+      }
+      double const FitParam =
+        pow(((DeltaPredX * DeltaPredX) + (minYZSep * minYZSep * WeightOfDeltaYZ)), 0.5);
+
+      if (FitParam < best.FitParam) {
+        best.Flash = (int)iFlash;
+        best.FitParam = FitParam;
+        best.FlashTime = FlashTime;
+        best.TimeSep = TimeSep;
+        best.PredictedX = PredictedX;
+        best.TimeSepPredX = TimeSepPredX;
+        best.DeltaPredX = DeltaPredX;
+        best.MinYZSep = minYZSep;
+      }
+    }
+    return best;
+  }
+
+  bool SameMatch(Alg::Match const& a, Alg::Match const& b)
+  {
+    return a.Flash == b.Flash && a.FitParam == b.FitParam && a.TimeSep == b.TimeSep &&
+           a.DeltaPredX == b.DeltaPredX && a.MinYZSep == b.MinYZSep;
+  }
+
+}
+
+int main()
+{
+  std::mt19937 gen(39);
+  std::uniform_real_distribution<double> flat(0., 1.);
+
+  std::vector<Alg::Flash> flashes(NFlashes);
+  for (auto& flash : flashes) {
+    flash.Time = ReadoutWindow * flat(gen);
+    flash.TotalPE = 5. + 1000. * flat(gen);
+    flash.YCenter = 600. * flat(gen) - 300.;
+    flash.ZCenter = 1200. * flat(gen);
+  }
+
+  // straight cosmic-like tracks with a 1 cm step
+  std::vector<Track> tracks(NTracks);
+  for (auto& track : tracks) {
+    track.TimeCentre = ReadoutWindow * flat(gen);
+    double y = 600. * flat(gen) - 300., z = 1200. * flat(gen);
+    double const angle = 2. * M_PI * flat(gen);
+    for (size_t i = 0; i < NPoints; ++i)
+      track.Trajectory.push_back({y + i * std::sin(angle), z + i * std::cos(angle)});
+  }
+
+  fhicl::ParameterSet pset;
+  pset.put("PredictedXConstant", PredictedXConstant);
+  pset.put("PredictedExpConstant", PredictedExpConstant);
+  pset.put("PredictedExpGradient", PredictedExpGradient);
+  pset.put("WeightOfDeltaYZ", WeightOfDeltaYZ);
+  pset.put("MatchCriteria", 0.);
+  pset.put("PEThreshold", PEThreshold);
+  Alg alg(pset);
+
+  std::vector<Alg::Match> old_matches, matches;
+
+  auto const start_old = std::chrono::steady_clock::now();
+  for (auto const& track : tracks)
+    old_matches.push_back(OldMatch(flashes, track));
+  auto const stop_old = std::chrono::steady_clock::now();
+
+  auto const start = std::chrono::steady_clock::now();
+  alg.SetFlashes(flashes, DriftWindow, DriftVelocity);
+  for (auto const& track : tracks)
+    matches.push_back(alg.BestMatch(track.TimeCentre, track.Trajectory));
+  auto const stop = std::chrono::steady_clock::now();
+
+  bool same = true;
+  for (size_t i = 0; i < NTracks; ++i)
+    same = same && SameMatch(old_matches[i], matches[i]);
+
+  std::printf("%zu tracks of %zu points, %zu flashes: every flash %7.1f ms, pruned %6.1f ms (%s)\n",
+              NTracks, NPoints, NFlashes,
+              std::chrono::duration<double,std::milli>(stop_old-start_old).count(),
+              std::chrono::duration<double,std::milli>(stop-start).count(),
+              same ? "same best flashes" : "BEST FLASHES DIFFER");
+  return 0;
+}
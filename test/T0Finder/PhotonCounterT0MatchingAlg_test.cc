@@ -0,0 +1,179 @@
+#define BOOST_TEST_MODULE ( PhotonCounterT0MatchingAlg_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "larana/T0Finder/PhotonCounterT0MatchingAlg.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using Alg = lbne::PhotonCounterT0MatchingAlg;
+
+namespace {
+
+  struct MatchParams {
+    double PredictedXConstant = 214.841;
+    double PredictedExpConstant = 5.22514;
+    double PredictedExpGradient = -0.00394097;
+    double WeightOfDeltaYZ = 1;
+    double MatchCriteria = 0;
+    double PEThreshold = 0;
+
+    fhicl::ParameterSet PSet() const
+    {
+      fhicl::ParameterSet pset;
+      pset.put("PredictedXConstant", PredictedXConstant);
+      pset.put("PredictedExpConstant", PredictedExpConstant);
+      pset.put("PredictedExpGradient", PredictedExpGradient);
+      pset.put("WeightOfDeltaYZ", WeightOfDeltaYZ);
+      pset.put("MatchCriteria", MatchCriteria);
+      pset.put("PEThreshold", PEThreshold);
+      return pset;
+    }
+  };
+
+  /// Every flash tried in turn, as PhotonCounterT0Matching used to do
+  Alg::Match BruteForceMatch(MatchParams const& par,
+                             std::vector<Alg::Flash> const& flashes,
+                             double driftWindow,
+                             double driftVelocity,
+                             double trkTimeCentre,
+                             std::vector<Alg::YZPoint> const& trajectory)
+  {
+    Alg::Match best;
+    for (size_t iFlash = 0; iFlash < flashes.size(); ++iFlash) {
+      double YZSep = 9999, minYZSep = 9999;
+      double PredictedX = 9999, TimeSepPredX = 9999, DeltaPredX = 9999, FitParam = 9999;
+      double const FlashTime = flashes[iFlash].Time;
+      double const TimeSep = trkTimeCentre - FlashTime;
+      if (TimeSep < 0 || TimeSep > driftWindow) continue;
+      if (flashes[iFlash].TotalPE < par.PEThreshold) continue;
+
+      PredictedX = (par.PredictedXConstant / pow(flashes[iFlash].TotalPE, 1.)) +
+                   (exp(par.PredictedExpConstant +
+                        (par.PredictedExpGradient * flashes[iFlash].TotalPE)));
+      TimeSepPredX = TimeSep * driftVelocity;
+      DeltaPredX = fabs(TimeSepPredX - PredictedX);
+      for (size_t Point = 1; Point < trajectory.size(); ++Point) {
+        YZSep = Alg::DistFromPoint(trajectory[Point].Y,
+                                   trajectory[Point - 1].Y,
+                                   trajectory[Point].Z,
+                                   trajectory[Point - 1].Z,
+                                   flashes[iFlash].YCenter,
+                                   flashes[iFlash].ZCenter);
+        if (Point == 1) minYZSep = YZSep;
+        if (YZSep < minYZSep) minYZSep = YZSep;
+      }
+
+      if (par.MatchCriteria == 0)
+        FitParam =
+          pow(((DeltaPredX * DeltaPredX) + (minYZSep * minYZSep * par.WeightOfDeltaYZ)), 0.5);
+      else if (par.MatchCriteria == 1)
+        FitParam = minYZSep;
+      else if (par.MatchCriteria == 2)
+        FitParam = DeltaPredX;
+
+      if (FitParam < best.FitParam) {
+        best.Flash = (int)iFlash;
+        best.FitParam = FitParam;
+        best.FlashTime = FlashTime;
+        best.TimeSep = TimeSep;
+        best.PredictedX = PredictedX;
+        best.TimeSepPredX = TimeSepPredX;
+        best.DeltaPredX = DeltaPredX;
+        best.MinYZSep = minYZSep;
+      }
+    }
+    return best;
+  }
+
+  void CheckSameMatch(Alg::Match const& result, Alg::Match const& expected)
+  {
+    BOOST_CHECK_EQUAL(result.Flash, expected.Flash);
+    if (expected.Flash == -1) return;
+    BOOST_CHECK_EQUAL(result.FitParam, expected.FitParam);
+    BOOST_CHECK_EQUAL(result.FlashTime, expected.FlashTime);
+    BOOST_CHECK_EQUAL(result.TimeSep, expected.TimeSep);
+    BOOST_CHECK_EQUAL(result.PredictedX, expected.PredictedX);
+    BOOST_CHECK_EQUAL(result.TimeSepPredX, expected.TimeSepPredX);
+    BOOST_CHECK_EQUAL(result.DeltaPredX, expected.DeltaPredX);
+    // repeated trajectory points give a NaN separation
+    if (std::isnan(expected.MinYZSep))
+      BOOST_CHECK(std::isnan(result.MinYZSep));
+    else
+      BOOST_CHECK_EQUAL(result.MinYZSep, expected.MinYZSep);
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(PhotonCounterT0MatchingAlg_test)
+
+BOOST_AUTO_TEST_CASE(checkSimpleMatch)
+{
+  MatchParams par;
+  Alg alg(par.PSet());
+
+  // track along Z at Y = 0, 1000 us after the first two flashes;
+  // the second flash is closer in YZ, the third is after the track
+  std::vector<Alg::Flash> const flashes = {
+    {0., 100., 50., 100.}, {0., 100., 5., 100.}, {1200., 100., 0., 100.}};
+  alg.SetFlashes(flashes, 2000., 0.1);
+
+  std::vector<Alg::YZPoint> const trajectory = {{0., 0.}, {0., 100.}, {0., 200.}};
+  auto const best = alg.BestMatch(1000., trajectory);
+  BOOST_CHECK_EQUAL(best.Flash, 1);
+  BOOST_CHECK_CLOSE(best.MinYZSep, 5., 1e-8);
+  BOOST_CHECK_CLOSE(best.TimeSep, 1000., 1e-8);
+
+  // outside the drift window
+  BOOST_CHECK_EQUAL(alg.BestMatch(3500., trajectory).Flash, -1);
+  BOOST_CHECK_EQUAL(alg.BestMatch(-1., trajectory).Flash, -1);
+}
+
+BOOST_AUTO_TEST_CASE(checkAgainstBruteForce)
+{
+  std::mt19937 gen(777);
+  std::uniform_real_distribution<double> flat(0., 1.);
+
+  for (int trial = 0; trial < 60; ++trial) {
+
+    MatchParams par;
+    par.MatchCriteria = trial % 4; // 3 is not a valid criterion: never matches
+    par.WeightOfDeltaYZ = (trial % 5 == 4) ? -0.5 : 3. * flat(gen);
+    par.PEThreshold = (trial % 3 == 0) ? 0. : 50. * flat(gen);
+    Alg alg(par.PSet());
+
+    // flashes over 10 ms, some at the same time, some with equal PE
+    std::vector<Alg::Flash> flashes(1 + (size_t)(100 * flat(gen)));
+    for (auto& flash : flashes) {
+      flash.Time = (flat(gen) < 0.1) ? 500. : 10000. * flat(gen);
+      flash.TotalPE = (flat(gen) < 0.1) ? 100. : 1. + 500. * flat(gen);
+      flash.YCenter = 200. * flat(gen) - 100.;
+      flash.ZCenter = 1000. * flat(gen);
+    }
+    double const driftWindow = 500. + 2000. * flat(gen);
+    double const driftVelocity = 0.16;
+    alg.SetFlashes(flashes, driftWindow, driftVelocity);
+
+    for (int track = 0; track < 50; ++track) {
+      // a few degenerate trajectories: too short, or with repeated points
+      std::vector<Alg::YZPoint> trajectory((size_t)(20 * flat(gen)));
+      double y = 200. * flat(gen) - 100., z = 1000. * flat(gen);
+      for (auto& point : trajectory) {
+        if (flat(gen) > 0.05) {
+          y += 10. * flat(gen) - 5.;
+          z += 10. * flat(gen) - 5.;
+        }
+        point = {y, z};
+      }
+      double const trkTimeCentre = (track % 10 == 0) ? 500. + driftWindow : 12000. * flat(gen);
+
+      CheckSameMatch(
+        alg.BestMatch(trkTimeCentre, trajectory),
+        BruteForceMatch(par, flashes, driftWindow, driftVelocity, trkTimeCentre, trajectory));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,284 @@
+// Matching the hits of an event to MCParticles, 20000 hits of 6 TrackIDEs
+// each, for 1000 to 50000 particles: DirectHitParticleAssns looking each
+// new track ID up by a scan of the particle list (and summing the hit
+// TrackIDEs in a hash map) against MCParticleIndex and
+// HitTrackIDECollector. Then finding the dominant particle of 1000
+// reconstructed objects of 200 hits each, out of 10^5 hits: MCTruthT0Matching
+// backtracking every hit of every object into a std::map<int, double> and
+// scanning the particle list, against HitTrackIDECache,
+// TrackEnergyAccumulator and MCParticleIndex. The stand-in backtracker
+// only copies the TrackIDEs of the hit, so this times the bookkeeping; the
+// call counts show what is saved of the real BackTracker work.
+// Built with the tests, not run by them.
+
+#include "larana/T0Finder/AssociationsTools/TrackIDEMatching.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  const size_t NHits = 20000;
+  const size_t NIDEsPerHit = 6;
+
+  struct FakeParticle {
+    int fTrackId;
+    int TrackId() const { return fTrackId; }
+  };
+
+  /// Sum of the particle positions and matching fractions, to compare results
+  struct Check_t {
+    long long particles = 0;
+    double fractions = 0;
+  };
+
+  Check_t ScanLookup(std::vector<std::vector<sim::TrackIDE>> const& hits,
+                     std::vector<FakeParticle> const& mcpartList)
+  {
+    struct TrackIDEinfo {
+      float E;
+      float NumElectrons;
+    };
+    std::unordered_map<int, int> trkid_lookup;
+    std::unordered_map<int, TrackIDEinfo> trkide_collector;
+    Check_t check;
+
+    for (auto const& trkide_list : hits) {
+      trkide_collector.clear();
+      double maxe(-1.), tote(0.), maxn(-1.), totn(0.);
+      int maxtrkid(-1), maxntrkid(-1);
+
+      for (auto const& t : trkide_list) {
+        trkide_collector[t.trackID].E += t.energy;
+        tote += t.energy;
+        if (trkide_collector[t.trackID].E > maxe) {
+          maxe = trkide_collector[t.trackID].E;
+          maxtrkid = t.trackID;
+        }
+        trkide_collector[t.trackID].NumElectrons += t.numElectrons;
+        totn += t.numElectrons;
+        if (trkide_collector[t.trackID].NumElectrons > maxn) {
+          maxn = trkide_collector[t.trackID].NumElectrons;
+          maxntrkid = t.trackID;
+        }
+
+        if (trkid_lookup.find(t.trackID) == trkid_lookup.end()) {
+          size_t i_p = 0;
+          while (i_p < mcpartList.size()) {
+            if (mcpartList[i_p].TrackId() == abs(t.trackID)) {
+              trkid_lookup[t.trackID] = (int)i_p;
+              break;
+            }
+            ++i_p;
+          }
+          if (i_p == mcpartList.size()) trkid_lookup[t.trackID] = -1;
+        }
+      }
+
+      for (auto const& t : trkide_collector) {
+        int const mcpart_i = trkid_lookup[t.first];
+        if (mcpart_i == -1) continue;
+        check.particles += mcpart_i;
+        check.fractions += t.second.E / tote + (t.first == maxtrkid) + (t.first == maxntrkid);
+      }
+    }
+    return check;
+  }
+
+  Check_t IndexLookup(std::vector<std::vector<sim::TrackIDE>> const& hits,
+                      std::vector<FakeParticle> const& mcpartList)
+  {
+    t0::MCParticleIndex const trkid_index(mcpartList);
+    t0::HitTrackIDECollector trkide_collector;
+    Check_t check;
+
+    for (auto const& trkide_list : hits) {
+      trkide_collector.Fill(trkide_list);
+      trkide_collector.ForEachMatch(
+        [&](int const trackID, anab::BackTrackerHitMatchingData const& bthmd) {
+          int const mcpart_i = trkid_index.Find(std::abs(trackID));
+          if (mcpart_i == -1) return;
+          check.particles += mcpart_i;
+          check.fractions += bthmd.ideFraction + bthmd.isMaxIDE + bthmd.isMaxIDEN;
+        });
+    }
+    return check;
+  }
+
+  /// Stands in for the BackTracker: returns a copy of the TrackIDEs of a hit
+  struct FakeBackTracker {
+    std::vector<std::vector<sim::TrackIDE>> fTrackIDEs;
+    mutable size_t fNCalls = 0;
+    std::vector<sim::TrackIDE> HitToTrackIDEs(size_t hit) const
+    {
+      ++fNCalls;
+      return fTrackIDEs[hit];
+    }
+  };
+
+  /// Position of the dominant particle and cleanliness of each object
+  using Dominant_t = std::vector<std::pair<int, double>>;
+
+  Dominant_t PerObjectMap(std::vector<std::vector<size_t>> const& objects,
+                          FakeBackTracker const& bt,
+                          std::vector<FakeParticle> const& mcpartList)
+  {
+    Dominant_t dominant;
+    for (auto const& allHits : objects) {
+      std::map<int, double> trkide;
+      for (size_t const hit : allHits) {
+        std::vector<sim::TrackIDE> TrackIDs = bt.HitToTrackIDEs(hit);
+        for (size_t e = 0; e < TrackIDs.size(); ++e)
+          trkide[TrackIDs[e].trackID] += TrackIDs[e].energy;
+      }
+      double maxe = -1, tote = 0;
+      int TrackID = 0;
+      for (auto ii = trkide.begin(); ii != trkide.end(); ++ii) {
+        tote += ii->second;
+        if ((ii->second) > maxe) {
+          maxe = ii->second;
+          TrackID = ii->first;
+        }
+      }
+      int mcpart_i(-1);
+      for (auto const& particle : mcpartList) {
+        mcpart_i++;
+        if (TrackID == particle.TrackId()) break;
+      }
+      dominant.emplace_back(mcpart_i, maxe / tote);
+    }
+    return dominant;
+  }
+
+  Dominant_t EventCache(std::vector<std::vector<size_t>> const& objects,
+                        FakeBackTracker const& bt,
+                        std::vector<FakeParticle> const& mcpartList)
+  {
+    t0::MCParticleIndex const trkid_lookup(mcpartList);
+    t0::HitTrackIDECache<size_t> hitTrackIDEs;
+    t0::TrackEnergyAccumulator trkide;
+
+    Dominant_t dominant;
+    for (auto const& allHits : objects) {
+      trkide.Clear();
+      for (size_t const hit : allHits)
+        trkide.Add(hitTrackIDEs.Get(hit, [&]() { return bt.HitToTrackIDEs(hit); }));
+      double cleanliness = 0;
+      int const TrackID = trkide.DominantTrackID(cleanliness);
+      // a track ID missing from the list falls back to the last particle
+      int const mcpart_i = trkid_lookup.Find(TrackID);
+      dominant.emplace_back((mcpart_i == -1) ? (int)mcpartList.size() - 1 : mcpart_i, cleanliness);
+    }
+    return dominant;
+  }
+
+  template <typename F>
+  double TimeObjects(F f, std::vector<std::vector<size_t>> const& objects,
+                     FakeBackTracker const& bt, std::vector<FakeParticle> const& mcpartList,
+                     Dominant_t& dominant)
+  {
+    bt.fNCalls = 0;
+    auto const start = std::chrono::steady_clock::now();
+    dominant = f(objects, bt, mcpartList);
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count();
+  }
+
+  template <typename F>
+  double TimeEvent(F f, std::vector<std::vector<sim::TrackIDE>> const& hits,
+                   std::vector<FakeParticle> const& mcpartList, Check_t& check)
+  {
+    auto const start = std::chrono::steady_clock::now();
+    check = f(hits, mcpartList);
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(stop-start).count();
+  }
+
+}
+
+int main()
+{
+  std::mt19937 gen(36);
+
+  for (int nParticles : {1000, 10000, 50000}) {
+    std::vector<FakeParticle> mcpartList;
+    for (int i = 0; i < nParticles; ++i) mcpartList.push_back({i + 1});
+    std::shuffle(mcpartList.begin(), mcpartList.end(), gen);
+
+    // IDEs from a few neighbouring tracks per hit, some of them negative
+    // (EM shower daughters) and some unknown to the particle list
+    std::uniform_int_distribution<int> track(1, nParticles + nParticles / 20);
+    std::uniform_real_distribution<float> energy(0.01, 1.);
+    std::vector<std::vector<sim::TrackIDE>> hits(NHits);
+    for (auto& trkide_list : hits) {
+      int const first = track(gen);
+      for (size_t i = 0; i < NIDEsPerHit; ++i) {
+        sim::TrackIDE ide;
+        ide.trackID = (first + (int)(i % 3)) * ((i % 4 == 3) ? -1 : 1);
+        ide.energy = energy(gen);
+        ide.energyFrac = 0;
+        ide.numElectrons = 40000 * ide.energy;
+        trkide_list.push_back(ide);
+      }
+    }
+
+    Check_t scan, index;
+    double const t_scan = TimeEvent(ScanLookup, hits, mcpartList, scan);
+    double const t_index = TimeEvent(IndexLookup, hits, mcpartList, index);
+
+    // hash map iteration order differs: the sums agree up to rounding
+    bool const same = scan.particles == index.particles &&
+                      std::abs(scan.fractions - index.fractions) < 1e-6 * scan.fractions;
+    std::printf("%5d particles, %zu hits of %zu IDEs: particle list scan %8.1f ms, track ID index %6.1f ms (%s)\n",
+                nParticles, NHits, NIDEsPerHit, t_scan, t_index,
+                same ? "same matches" : "MATCHES DIFFER");
+  }
+
+  // 10^5 hits with IDEs from neighbouring tracks, 10000 particles, and
+  // 1000 objects of 200 hits each, overlapping their neighbours
+  const int nParticles = 10000;
+  const size_t nEventHits = 100000, nObjects = 1000, nObjectHits = 200;
+  std::vector<FakeParticle> mcpartList;
+  for (int i = 0; i < nParticles; ++i) mcpartList.push_back({i + 1});
+  std::shuffle(mcpartList.begin(), mcpartList.end(), gen);
+
+  std::uniform_real_distribution<float> energy(0.01, 1.);
+  FakeBackTracker bt;
+  bt.fTrackIDEs.resize(nEventHits);
+  for (size_t hit = 0; hit < nEventHits; ++hit)
+    for (size_t i = 0; i < NIDEsPerHit; ++i) {
+      sim::TrackIDE ide;
+      ide.trackID = 1 + (hit / 10 + i % 3) % nParticles;
+      ide.energy = energy(gen);
+      ide.energyFrac = 0;
+      ide.numElectrons = 40000 * ide.energy;
+      bt.fTrackIDEs[hit].push_back(ide);
+    }
+
+  std::uniform_int_distribution<size_t> spread(0, 2 * nObjectHits);
+  std::vector<std::vector<size_t>> objects(nObjects);
+  for (size_t o = 0; o < nObjects; ++o) {
+    size_t const first = o * (nEventHits - 2 * nObjectHits) / nObjects;
+    for (size_t h = 0; h < nObjectHits; ++h)
+      objects[o].push_back(first + spread(gen));
+  }
+
+  Dominant_t per_object, cached;
+  double const t_per_object = TimeObjects(PerObjectMap, objects, bt, mcpartList, per_object);
+  size_t const calls_per_object = bt.fNCalls;
+  double const t_cached = TimeObjects(EventCache, objects, bt, mcpartList, cached);
+  size_t const calls_cached = bt.fNCalls;
+
+  std::printf("%zu objects of %zu hits out of %zu: per object %6.1f ms (%zu backtracker calls), event cache %6.1f ms (%zu calls) (%s)\n",
+              nObjects, nObjectHits, nEventHits, t_per_object, calls_per_object,
+              t_cached, calls_cached,
+              (per_object == cached) ? "same particles and cleanliness" : "RESULTS DIFFER");
+  return 0;
+}
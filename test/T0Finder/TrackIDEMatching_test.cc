@@ -0,0 +1,360 @@
+#define BOOST_TEST_MODULE ( TrackIDEMatching_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "larana/T0Finder/AssociationsTools/TrackIDEMatching.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  struct FakeParticle {
+    int fTrackId;
+    int TrackId() const { return fTrackId; }
+  };
+
+  /// Stands in for the BackTracker: a fixed list of TrackIDEs per hit
+  struct FakeBackTracker {
+    std::vector<std::vector<sim::TrackIDE>> fTrackIDEs;
+    std::vector<sim::TrackIDE> const& HitToTrackIDEs(size_t hit) const { return fTrackIDEs[hit]; }
+  };
+
+  struct Match {
+    int TrackID;
+    int MCParticle;
+    anab::BackTrackerHitMatchingData Data;
+  };
+
+  bool operator<(Match const& a, Match const& b) { return a.TrackID < b.TrackID; }
+
+  /// Matching as DirectHitParticleAssns used to do it, with a linear
+  /// search of the particle list for each new track ID
+  std::vector<Match> ReferenceMatches(std::vector<sim::TrackIDE> const& trkide_list,
+                                      std::vector<FakeParticle> const& mcpartList,
+                                      std::unordered_map<int, int>& trkid_lookup)
+  {
+    struct TrackIDEinfo {
+      float E;
+      float NumElectrons;
+    };
+    std::unordered_map<int, TrackIDEinfo> collector;
+
+    double maxe(-1.), tote(0.), maxn(-1.), totn(0.);
+    int maxtrkid(-1), maxntrkid(-1);
+
+    for (auto const& t : trkide_list) {
+      collector[t.trackID].E += t.energy;
+      tote += t.energy;
+      if (collector[t.trackID].E > maxe) {
+        maxe = collector[t.trackID].E;
+        maxtrkid = t.trackID;
+      }
+      collector[t.trackID].NumElectrons += t.numElectrons;
+      totn += t.numElectrons;
+      if (collector[t.trackID].NumElectrons > maxn) {
+        maxn = collector[t.trackID].NumElectrons;
+        maxntrkid = t.trackID;
+      }
+
+      if (trkid_lookup.find(t.trackID) == trkid_lookup.end()) {
+        size_t i_p = 0;
+        while (i_p < mcpartList.size()) {
+          if (mcpartList[i_p].TrackId() == abs(t.trackID)) {
+            trkid_lookup[t.trackID] = (int)i_p;
+            break;
+          }
+          ++i_p;
+        }
+        if (i_p == mcpartList.size()) trkid_lookup[t.trackID] = -1;
+      }
+    }
+
+    std::vector<Match> matches;
+    for (auto const& t : collector) {
+      int mcpart_i = trkid_lookup[t.first];
+      if (mcpart_i == -1) continue;
+      anab::BackTrackerHitMatchingData bthmd;
+      bthmd.ideFraction = t.second.E / tote;
+      bthmd.isMaxIDE = (t.first == maxtrkid);
+      bthmd.ideNFraction = t.second.NumElectrons / totn;
+      bthmd.isMaxIDEN = (t.first == maxntrkid);
+      bthmd.energy = t.second.E;
+      bthmd.numElectrons = t.second.NumElectrons;
+      matches.push_back({t.first, mcpart_i, bthmd});
+    }
+    return matches;
+  }
+
+  void CheckSameMatches(std::vector<Match> result, std::vector<Match> expected)
+  {
+    std::sort(result.begin(), result.end());
+    std::sort(expected.begin(), expected.end());
+    BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+      BOOST_CHECK_EQUAL(result[i].TrackID, expected[i].TrackID);
+      BOOST_CHECK_EQUAL(result[i].MCParticle, expected[i].MCParticle);
+      BOOST_CHECK_EQUAL(result[i].Data.ideFraction, expected[i].Data.ideFraction);
+      BOOST_CHECK_EQUAL(result[i].Data.isMaxIDE, expected[i].Data.isMaxIDE);
+      BOOST_CHECK_EQUAL(result[i].Data.ideNFraction, expected[i].Data.ideNFraction);
+      BOOST_CHECK_EQUAL(result[i].Data.isMaxIDEN, expected[i].Data.isMaxIDEN);
+      BOOST_CHECK_EQUAL(result[i].Data.energy, expected[i].Data.energy);
+      BOOST_CHECK_EQUAL(result[i].Data.numElectrons, expected[i].Data.numElectrons);
+    }
+  }
+
+  /// Runs the new matching on all the hits and compares with the reference
+  void CheckAgainstReference(FakeBackTracker const& bt, std::vector<FakeParticle> const& mcpartList)
+  {
+    t0::MCParticleIndex const index(mcpartList);
+    t0::HitTrackIDECollector collector;
+    std::unordered_map<int, int> trkid_lookup;
+
+    for (size_t hit = 0; hit < bt.fTrackIDEs.size(); ++hit) {
+      collector.Fill(bt.HitToTrackIDEs(hit));
+
+      std::vector<Match> matches;
+      collector.ForEachMatch([&](int trackID, anab::BackTrackerHitMatchingData const& bthmd) {
+        int const mcpart_i = index.Find(std::abs(trackID));
+        if (mcpart_i != -1) matches.push_back({trackID, mcpart_i, bthmd});
+      });
+
+      CheckSameMatches(matches, ReferenceMatches(bt.HitToTrackIDEs(hit), mcpartList, trkid_lookup));
+    }
+  }
+
+
+  /// Dominant track of an object as MCTruthT0Matching used to find it,
+  /// backtracking every hit and summing into a std::map
+  int ReferenceDominantTrackID(FakeBackTracker const& bt,
+                               std::vector<size_t> const& hits,
+                               double& cleanliness)
+  {
+    std::map<int, double> trkide;
+    for (size_t hit : hits)
+      for (auto const& t : bt.HitToTrackIDEs(hit))
+        trkide[t.trackID] += t.energy;
+
+    int trackID = 0;
+    double maxe = -1;
+    double tote = 0;
+    for (auto const& ii : trkide) {
+      tote += ii.second;
+      if (ii.second > maxe) {
+        maxe = ii.second;
+        trackID = ii.first;
+      }
+    }
+    cleanliness = maxe / tote;
+    return trackID;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(TrackIDEMatching_test)
+
+BOOST_AUTO_TEST_CASE(MCParticleIndex_checkLookup)
+{
+  // compact IDs, with a duplicate: the first particle wins
+  std::vector<FakeParticle> const compact = {{3}, {1}, {2}, {5}, {2}};
+  t0::MCParticleIndex const compactIndex(compact);
+  BOOST_CHECK_EQUAL(compactIndex.Find(3), 0);
+  BOOST_CHECK_EQUAL(compactIndex.Find(1), 1);
+  BOOST_CHECK_EQUAL(compactIndex.Find(2), 2);
+  BOOST_CHECK_EQUAL(compactIndex.Find(-2), -1);
+  BOOST_CHECK_EQUAL(compactIndex.Find(5), 3);
+  BOOST_CHECK_EQUAL(compactIndex.Find(4), -1);
+  BOOST_CHECK_EQUAL(compactIndex.Find(0), -1);
+  BOOST_CHECK_EQUAL(compactIndex.Find(6), -1);
+  BOOST_CHECK_EQUAL(compactIndex.Find(100000), -1);
+
+  // negative IDs in a dense table: offsets from the extreme IDs overflow an int
+  std::vector<FakeParticle> const negative = {{-5}, {-1}, {2}};
+  t0::MCParticleIndex const negativeIndex(negative);
+  BOOST_CHECK_EQUAL(negativeIndex.Find(-5), 0);
+  BOOST_CHECK_EQUAL(negativeIndex.Find(2), 2);
+  BOOST_CHECK_EQUAL(negativeIndex.Find(0), -1);
+  BOOST_CHECK_EQUAL(negativeIndex.Find(std::numeric_limits<int>::max()), -1);
+  BOOST_CHECK_EQUAL(negativeIndex.Find(std::numeric_limits<int>::min()), -1);
+
+  // IDs too spread out for a dense table
+  std::vector<FakeParticle> const sparse = {{1}, {10000000}, {7}, {10000000}, {2000000000}};
+  t0::MCParticleIndex const sparseIndex(sparse);
+  BOOST_CHECK_EQUAL(sparseIndex.Find(1), 0);
+  BOOST_CHECK_EQUAL(sparseIndex.Find(10000000), 1);
+  BOOST_CHECK_EQUAL(sparseIndex.Find(-10000000), -1);
+  BOOST_CHECK_EQUAL(sparseIndex.Find(7), 2);
+  BOOST_CHECK_EQUAL(sparseIndex.Find(2000000000), 4);
+  BOOST_CHECK_EQUAL(sparseIndex.Find(8), -1);
+
+  t0::MCParticleIndex const emptyIndex(std::vector<FakeParticle>{});
+  BOOST_CHECK_EQUAL(emptyIndex.Find(1), -1);
+}
+
+BOOST_AUTO_TEST_CASE(HitTrackIDECollector_checkMatchData)
+{
+  // track 4 has the most energy, track -7 the most electrons
+  std::vector<sim::TrackIDE> const trkide_list = {
+    {4, 0.f, 3.f, 10.f}, {-7, 0.f, 1.f, 30.f}, {4, 0.f, 2.f, 5.f}, {9, 0.f, 4.f, 15.f}};
+
+  t0::HitTrackIDECollector collector;
+  collector.Fill(trkide_list);
+
+  std::vector<int> trackIDs;
+  std::vector<anab::BackTrackerHitMatchingData> data;
+  collector.ForEachMatch([&](int trackID, anab::BackTrackerHitMatchingData const& bthmd) {
+    trackIDs.push_back(trackID);
+    data.push_back(bthmd);
+  });
+
+  std::vector<int> const expectedIDs = {4, -7, 9};
+  BOOST_CHECK(trackIDs == expectedIDs);
+  BOOST_CHECK_CLOSE(data[0].ideFraction, 0.5, 1e-4);
+  BOOST_CHECK_CLOSE(data[0].ideNFraction, 0.25, 1e-4);
+  BOOST_CHECK_EQUAL(data[0].energy, 5.f);
+  BOOST_CHECK_EQUAL(data[0].numElectrons, 15.f);
+  BOOST_CHECK(data[0].isMaxIDE);
+  BOOST_CHECK(!data[0].isMaxIDEN);
+  BOOST_CHECK(!data[1].isMaxIDE);
+  BOOST_CHECK(data[1].isMaxIDEN);
+  BOOST_CHECK(!data[2].isMaxIDE);
+  BOOST_CHECK(!data[2].isMaxIDEN);
+
+  // in track ID order, with the same data
+  collector.SortByTrackID();
+  std::vector<int> sortedIDs;
+  std::vector<anab::BackTrackerHitMatchingData> sortedData;
+  collector.ForEachMatch([&](int trackID, anab::BackTrackerHitMatchingData const& bthmd) {
+    sortedIDs.push_back(trackID);
+    sortedData.push_back(bthmd);
+  });
+  std::vector<int> const expectedSortedIDs = {-7, 4, 9};
+  BOOST_CHECK(sortedIDs == expectedSortedIDs);
+  BOOST_CHECK_EQUAL(sortedData[0].ideNFraction, data[1].ideNFraction);
+  BOOST_CHECK(sortedData[0].isMaxIDEN);
+  BOOST_CHECK_EQUAL(sortedData[1].ideFraction, data[0].ideFraction);
+  BOOST_CHECK(sortedData[1].isMaxIDE);
+  BOOST_CHECK_EQUAL(sortedData[2].energy, data[2].energy);
+
+  // refilling forgets the previous hit
+  collector.Fill(std::vector<sim::TrackIDE>());
+  int calls = 0;
+  collector.ForEachMatch([&](int, anab::BackTrackerHitMatchingData const&) { ++calls; });
+  BOOST_CHECK_EQUAL(calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE(HitTrackIDECollector_checkAgainstReference)
+{
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<float> flat(0.f, 1.f);
+
+  for (int trial = 0; trial < 20; ++trial) {
+
+    // particles in shuffled order, with some IDs missing and, in odd
+    // trials, a few far away from the others
+    int const nParticles = 1 + 200 * trial;
+    std::vector<FakeParticle> mcpartList;
+    for (int id = 1; id <= nParticles; ++id)
+      if (flat(gen) > 0.1f) mcpartList.push_back({(trial % 2) ? id * (1 + (id % 7 == 0) * 100000) : id});
+    std::shuffle(mcpartList.begin(), mcpartList.end(), gen);
+
+    std::uniform_int_distribution<int> pickID(1, nParticles);
+    FakeBackTracker bt;
+    bt.fTrackIDEs.resize(500);
+    for (auto& trkide_list : bt.fTrackIDEs) {
+      int const nIDEs = (int)(12 * flat(gen));
+      for (int i = 0; i < nIDEs; ++i) {
+        int trackID = mcpartList.empty() ? 1 : mcpartList[pickID(gen) % mcpartList.size()].TrackId();
+        if (flat(gen) < 0.2f) trackID = -trackID;
+        if (flat(gen) < 0.05f) trackID = nParticles * 1000 + 1; // no such particle
+        // coarse values make ties between tracks likely
+        trkide_list.emplace_back(
+          trackID, 0.f, 1.f + std::round(4.f * flat(gen)), 1.f + std::round(40.f * flat(gen)));
+      }
+    }
+
+    CheckAgainstReference(bt, mcpartList);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HitTrackIDECache_checkBacktrackedOnce)
+{
+  FakeBackTracker bt;
+  bt.fTrackIDEs = {{{1, 0.f, 2.f, 5.f}}, {}, {{2, 0.f, 1.f, 3.f}, {-3, 0.f, 4.f, 1.f}}};
+
+  t0::HitTrackIDECache<size_t> cache;
+  std::vector<int> calls(bt.fTrackIDEs.size(), 0);
+  auto get = [&](size_t hit) {
+    return cache.Get(hit, [&]() {
+      ++calls[hit];
+      return bt.HitToTrackIDEs(hit);
+    });
+  };
+
+  for (int pass = 0; pass < 3; ++pass)
+    for (size_t hit : {2, 0, 1}) {
+      auto const range = get(hit);
+      std::vector<int> trackIDs;
+      for (auto const& t : range)
+        trackIDs.push_back(t.trackID);
+      std::vector<int> expected;
+      for (auto const& t : bt.HitToTrackIDEs(hit))
+        expected.push_back(t.trackID);
+      BOOST_CHECK(trackIDs == expected);
+    }
+
+  BOOST_CHECK_EQUAL(cache.NHits(), 3ul);
+  BOOST_CHECK(calls == (std::vector<int>{1, 1, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(TrackEnergyAccumulator_checkAgainstReference)
+{
+  std::mt19937 gen(98765);
+  std::uniform_real_distribution<float> flat(0.f, 1.f);
+
+  // hits shared between objects, with coarse energies to get ties
+  FakeBackTracker bt;
+  bt.fTrackIDEs.resize(2000);
+  for (auto& trkide_list : bt.fTrackIDEs) {
+    int const nIDEs = (int)(5 * flat(gen));
+    for (int i = 0; i < nIDEs; ++i)
+      trkide_list.emplace_back(
+        (int)(40 * flat(gen)) - 10, 0.f, 0.5f * std::round(8.f * flat(gen)), 1.f);
+  }
+
+  t0::HitTrackIDECache<size_t> cache;
+  size_t nBacktracked = 0;
+  t0::TrackEnergyAccumulator trkide;
+
+  for (int object = 0; object < 300; ++object) {
+    std::vector<size_t> hits((size_t)(60 * flat(gen)));
+    for (auto& hit : hits)
+      hit = (size_t)(bt.fTrackIDEs.size() * flat(gen));
+
+    trkide.Clear();
+    for (size_t hit : hits)
+      trkide.Add(cache.Get(hit, [&]() {
+        ++nBacktracked;
+        return bt.HitToTrackIDEs(hit);
+      }));
+    double cleanliness = 0;
+    int const trackID = trkide.DominantTrackID(cleanliness);
+
+    double expectedCleanliness = 0;
+    int const expectedTrackID = ReferenceDominantTrackID(bt, hits, expectedCleanliness);
+    BOOST_CHECK_EQUAL(trackID, expectedTrackID);
+    if (std::isnan(expectedCleanliness))
+      BOOST_CHECK(std::isnan(cleanliness));
+    else
+      BOOST_CHECK_EQUAL(cleanliness, expectedCleanliness);
+  }
+
+  BOOST_CHECK_EQUAL(nBacktracked, cache.NHits());
+  BOOST_CHECK_LE(nBacktracked, bt.fTrackIDEs.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()